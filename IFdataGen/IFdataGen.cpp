@@ -6,18 +6,24 @@
 #include <chrono>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <ctime>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
 #include "SignalSim.h"
+#include "OrbitCache.h"
+#include "IfDataWriter.h"
+#include "IfQuantize.h"
+#include "IfNoise.h"
 
 #define TOTAL_GPS_SAT 32
 #define TOTAL_BDS_SAT 63
 #define TOTAL_GAL_SAT 36
 #define TOTAL_GLO_SAT 24
 #define TOTAL_SAT_CHANNEL 128
+#define TOTAL_SAT_NUMBER (TOTAL_GPS_SAT + TOTAL_BDS_SAT + TOTAL_GAL_SAT + TOTAL_GLO_SAT)
 
 typedef enum {
     DataBitLNav, DataBitCNav, DataBitCNav2, // for GPS
@@ -34,16 +40,27 @@ struct CommandArguments
 	bool MultiThread;
 	bool ValidateOnly;
 	bool OutputTag;
+	std::string Kernel;
+	std::string ChipRun;
+	std::string SampleType;
+	int BlockMs;
+	int WriteSlots;	// ring slots between generation and writer thread, 0 to write synchronously
+	std::string WriteBackend;
+	unsigned long long NoiseSeed;
+	int NoisePoolMs;	// noise pool length in milliseconds of samples, 0 for exact noise
+	int NoisePeriod;
+	double OrbitInterval;	// satellite orbit interpolation node interval in second, 0 to calculate from ephemeris
+	double AtmosInterval;	// atmosphere delay interpolation node interval in second, 0 to calculate each millisecond
+	int AtmosOrder;	// atmosphere delay interpolation order, 1 for linear, 2 for quadratic
 };
 
 void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam);
 int StepToNextMs();
-complex_number GenerateNoise(double Sigma);
+int StepToNextBlock(int BlockMs);
+void InterpolateBlockParam(int Ms, int BlockMs);
 NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray[]);
-int QuantSamplesIQ2(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);	//TODO: Varify 2-bit quantization
-int QuantSamplesIQ4(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
-int QuantSamplesIQ8(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
-int QuantSamplesIQ16(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
+void DeleteInstances(CSatIfSignal *SatIfSignal[], NavBit *NavBitArray[], int NavBitNumber);
+template <typename T> int MixAndQuantize(typename IfSampleTraits<T>::AccumType NoiseArray[], CSatIfSignal *SatIfSignal[], int ChannelNumber, int FirstMs, int Length, unsigned char QuantArray[], double GainScale, bool MultiThread);
 
 void ShowHelp(const char* ProgramName);
 bool ParseCommandLineArgs(int argc, char* argv[], CommandArguments &Arguments);
@@ -76,7 +93,7 @@ const char *SignalName[][8] = {
 
 int main(int argc, char* argv[])
 {
-	int i, j;
+	int i;
 	JsonStream JsonTree;
 	JsonObject *Object;
 	UTC_TIME UtcTime;
@@ -93,7 +110,11 @@ int main(int argc, char* argv[])
 	int TotalChannelNumber, SignalIndex;
 	int IfFreq, FdmaOffset;
 	complex_number *NoiseArray;
+	complex_float *FloatNoiseArray;
+	complex_int32 *IntNoiseArray;
+	int QuantBytes, BlockSamples, BlockLength, Ms;
 	unsigned char *QuantArray;
+	CIfDataWriter *IfWriter;
 	FILE* IfFile = NULL;
 	CommandArguments Arguments;
 
@@ -103,6 +124,14 @@ int main(int argc, char* argv[])
 	Arguments.MultiThread = true; // Default to use multi-threading
 	Arguments.ValidateOnly = false;
 	Arguments.OutputTag = false;
+	Arguments.BlockMs = 1;
+	Arguments.WriteSlots = IF_WRITER_SLOTS;
+	Arguments.NoiseSeed = IF_NOISE_SEED;
+	Arguments.NoisePoolMs = 0;
+	Arguments.NoisePeriod = 0;
+	Arguments.OrbitInterval = ORBIT_NODE_INTERVAL;
+	Arguments.AtmosInterval = ATMOS_UPDATE_INTERVAL;
+	Arguments.AtmosOrder = 2;
 
 	SetOutputFile(stdout);
 //	SetOutputLevel(MSG_LEVEL_INFO);
@@ -116,6 +145,36 @@ int main(int argc, char* argv[])
 
 	if (!ParseCommandLineArgs(argc, argv, Arguments))
 		return 1;
+	if (!Arguments.Kernel.empty() && ((IfKernelFromName(Arguments.Kernel.c_str()) == IfKernelAuto && Arguments.Kernel != "auto") || !SetIfKernelIsa(IfKernelFromName(Arguments.Kernel.c_str()))))
+	{
+		std::cerr << "[ERROR]\tIF sample kernel " << Arguments.Kernel << " not supported\n";
+		return 1;
+	}
+	SetIfNoiseSeed(Arguments.NoiseSeed);
+	if (Arguments.ChipRun == "on")
+		SetIfChipRunMode(IfChipRunOn);
+	else if (Arguments.ChipRun == "off")
+		SetIfChipRunMode(IfChipRunOff);
+	else if (!Arguments.ChipRun.empty() && Arguments.ChipRun != "auto")
+	{
+		std::cerr << "[ERROR]\tUnknown chip run mode " << Arguments.ChipRun << "\n";
+		return 1;
+	}
+	if (!Arguments.SampleType.empty() && Arguments.SampleType != "double" && Arguments.SampleType != "float" && Arguments.SampleType != "int16")
+	{
+		std::cerr << "[ERROR]\tUnknown sample type " << Arguments.SampleType << "\n";
+		return 1;
+	}
+	if (!Arguments.WriteBackend.empty() && IfWriterBackendFromName(Arguments.WriteBackend.c_str()) == IfWriterAuto && Arguments.WriteBackend != "auto")
+	{
+		std::cerr << "[ERROR]\tUnknown output writer backend " << Arguments.WriteBackend << "\n";
+		return 1;
+	}
+	if (Arguments.NoisePeriod > 0 && Arguments.NoisePoolMs == 0)
+	{
+		std::cerr << "[ERROR]\tNoise period only applies to noise pool, use --noise-pool\n";
+		return 1;
+	}
 
 	
 	printf("\n================================================================================\n");
@@ -145,6 +204,8 @@ int main(int argc, char* argv[])
 		OutputParam.filename[255] = '\0';
 		printf("[INFO]\tUsing output file from command line: %s\n", OutputParam.filename);
 	}
+	if (!Arguments.SampleType.empty())
+		OutputParam.SampleType = (Arguments.SampleType == "float") ? IfSampleFloat : (Arguments.SampleType == "int16") ? IfSampleInt16 : IfSampleDouble;
 
 	// Validate configuration and exit if requested
 /*	if (Arguments.ValidateOnly)
@@ -169,7 +230,7 @@ int main(int argc, char* argv[])
 	if (!Arguments.ValidateOnly)
 	{
 		printf("[INFO]\tOpening output file: %s\n", OutputParam.filename);
-		if ((IfFile = fopen(OutputParam.filename, "wb")) == NULL)
+		if ((IfFile = fopen(OutputParam.filename, "w+b")) == NULL)	// readable for mmap output
 		{
 			printf("[ERROR]\tFailed to open output file: %s\n", OutputParam.filename);
 			return 0;
@@ -343,6 +404,28 @@ int main(int argc, char* argv[])
 		GalSatParam[i].Initialize(GalileoSystem, GalEph[i], &IonoModel, PowerControl.InitCN0, PowerControl.Adjust);
 	for (i = 0; i < TOTAL_GLO_SAT; i ++)
 		GloSatParam[i].Initialize(GlonassSystem, (PGPS_EPHEMERIS)GloEph[i], &IonoModel, PowerControl.InitCN0, PowerControl.Adjust);
+	if (Arguments.OrbitInterval != ORBIT_NODE_INTERVAL)
+	{
+		for (i = 0; i < TOTAL_GPS_SAT; i ++)
+			GpsSatParam[i].SetOrbitInterval(Arguments.OrbitInterval);
+		for (i = 0; i < TOTAL_BDS_SAT; i ++)
+			BdsSatParam[i].SetOrbitInterval(Arguments.OrbitInterval);
+		for (i = 0; i < TOTAL_GAL_SAT; i ++)
+			GalSatParam[i].SetOrbitInterval(Arguments.OrbitInterval);
+		for (i = 0; i < TOTAL_GLO_SAT; i ++)
+			GloSatParam[i].SetOrbitInterval(Arguments.OrbitInterval);
+	}
+	if (Arguments.AtmosInterval != ATMOS_UPDATE_INTERVAL || Arguments.AtmosOrder != 2)
+	{
+		for (i = 0; i < TOTAL_GPS_SAT; i ++)
+			GpsSatParam[i].SetAtmosInterval(Arguments.AtmosInterval, Arguments.AtmosOrder);
+		for (i = 0; i < TOTAL_BDS_SAT; i ++)
+			BdsSatParam[i].SetAtmosInterval(Arguments.AtmosInterval, Arguments.AtmosOrder);
+		for (i = 0; i < TOTAL_GAL_SAT; i ++)
+			GalSatParam[i].SetAtmosInterval(Arguments.AtmosInterval, Arguments.AtmosOrder);
+		for (i = 0; i < TOTAL_GLO_SAT; i ++)
+			GloSatParam[i].SetAtmosInterval(Arguments.AtmosInterval, Arguments.AtmosOrder);
+	}
 
 	ListCount = PowerControl.GetPowerControlList(0, PowerList);
 	UpdateSatParamList(CurTime, CurPos, ListCount, PowerList, NavData.GetGpsIono());
@@ -424,6 +507,31 @@ int main(int argc, char* argv[])
 	int TotalChannels = GpsSatNumber * GpsSignalCount + BdsSatNumber * BdsSignalCount + GalSatNumber * GalSignalCount + GloSatNumber * GloSignalCount;
 	printf("Total Visible SVs = %d, Total channels = %d\n\n", TotalVisibleSVs, TotalChannels);
 
+	// generate PRN codes of all channels in parallel, channels created below share cached codes
+	if (!Arguments.ValidateOnly)
+	{
+		PRN_CACHE_KEY PrnKeys[TOTAL_SAT_CHANNEL];
+		int KeyCount = 0, EntryCount, HitCount, GenerateCount, TotalBytes;
+		auto PreloadStart = std::chrono::high_resolution_clock::now();
+
+		for (SignalIndex = SIGNAL_INDEX_L1CA; SignalIndex <= SIGNAL_INDEX_L5; SignalIndex++)
+			for (i = 0; i < GpsSatNumber && KeyCount < TOTAL_SAT_CHANNEL && (OutputParam.FreqSelect[GpsSystem] & (1 << SignalIndex)); i++)
+				PrnKeys[KeyCount++] = { GpsSystem, SignalIndex, GpsEphVisible[i]->svid };
+		for (SignalIndex = SIGNAL_INDEX_B1C; SignalIndex <= SIGNAL_INDEX_B2b; SignalIndex++)
+			for (i = 0; i < BdsSatNumber && KeyCount < TOTAL_SAT_CHANNEL && (OutputParam.FreqSelect[BdsSystem] & (1 << SignalIndex)); i++)
+				PrnKeys[KeyCount++] = { BdsSystem, SignalIndex, BdsEphVisible[i]->svid };
+		for (SignalIndex = SIGNAL_INDEX_E1; SignalIndex <= SIGNAL_INDEX_E6; SignalIndex++)
+			for (i = 0; i < GalSatNumber && KeyCount < TOTAL_SAT_CHANNEL && (OutputParam.FreqSelect[GalileoSystem] & (1 << SignalIndex)); i++)
+				PrnKeys[KeyCount++] = { GalileoSystem, SignalIndex, GalEphVisible[i]->svid };
+		for (SignalIndex = SIGNAL_INDEX_G1; SignalIndex <= SIGNAL_INDEX_G2; SignalIndex++)
+			for (i = 0; i < GloSatNumber && KeyCount < TOTAL_SAT_CHANNEL && (OutputParam.FreqSelect[GlonassSystem] & (1 << SignalIndex)); i++)
+				PrnKeys[KeyCount++] = { GlonassSystem, SignalIndex, GloEphVisible[i]->n };
+		PrnCache::Preload(PrnKeys, KeyCount);
+		PrnCache::GetStatistics(EntryCount, HitCount, GenerateCount, TotalBytes);
+		printf("[INFO]\tPRN cache: %d codes (%.1f KB) for %d channels preloaded in %.1f ms\n\n", EntryCount, TotalBytes / 1024.0, KeyCount,
+			std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - PreloadStart).count());
+	}
+
 	// Detailed satellite and signal information in compact table format
 	for (SignalIndex = SIGNAL_INDEX_L1CA; SignalIndex <= SIGNAL_INDEX_L5; SignalIndex++)
 	{
@@ -441,7 +549,7 @@ int main(int argc, char* argv[])
 				break;
 			if (!Arguments.ValidateOnly)
 			{
-				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, GpsSystem, SignalIndex, GpsEphVisible[i]->svid);
+				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, GpsSystem, SignalIndex, GpsEphVisible[i]->svid, OutputParam.SampleType);
 				SatIfSignal[TotalChannelNumber]->InitState(CurTime, &GpsSatParam[GpsEphVisible[i]->svid-1], GetNavData(GpsSystem, SignalIndex, NavBitArray));
 			}
 			TotalChannelNumber++;
@@ -477,7 +585,7 @@ int main(int argc, char* argv[])
 				break;
 			if (!Arguments.ValidateOnly)
 			{
-				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, BdsSystem, SignalIndex, BdsEphVisible[i]->svid);
+				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, BdsSystem, SignalIndex, BdsEphVisible[i]->svid, OutputParam.SampleType);
 				SatIfSignal[TotalChannelNumber]->InitState(CurTime, &BdsSatParam[BdsEphVisible[i]->svid - 1], GetNavData(BdsSystem, SignalIndex, NavBitArray));
 			}
 			TotalChannelNumber++;
@@ -512,7 +620,7 @@ int main(int argc, char* argv[])
 				break;
 			if (!Arguments.ValidateOnly)
 			{
-				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, GalileoSystem, SignalIndex, GalEphVisible[i]->svid);
+				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, GalileoSystem, SignalIndex, GalEphVisible[i]->svid, OutputParam.SampleType);
 				SatIfSignal[TotalChannelNumber]->InitState(CurTime, &GalSatParam[GalEphVisible[i]->svid - 1], GetNavData(GalileoSystem, SignalIndex, NavBitArray));
 			}
 			TotalChannelNumber++;
@@ -548,7 +656,7 @@ int main(int argc, char* argv[])
 			FdmaOffset = (SignalIndex == SIGNAL_INDEX_G1) ? GloEphVisible[i]->freq * 562500 : (SignalIndex == SIGNAL_INDEX_G2) ? GloEphVisible[i]->freq * 437500 : 0;
 			if (!Arguments.ValidateOnly)
 			{
-				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq + FdmaOffset, GlonassSystem, SignalIndex, GloEphVisible[i]->n);
+				SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq + FdmaOffset, GlonassSystem, SignalIndex, GloEphVisible[i]->n, OutputParam.SampleType);
 				SatIfSignal[TotalChannelNumber]->InitState(CurTime, &GloSatParam[GloEphVisible[i]->n - 1], GetNavData(GlonassSystem, SignalIndex, NavBitArray));
 			}
 			TotalChannelNumber++;
@@ -578,90 +686,121 @@ int main(int argc, char* argv[])
 	printf("[INFO]\tSignal Sample rate: %0.4f MHz\n\n", OutputParam.SampleFreq/1000.0);
 	if (Arguments.ValidateOnly)
 	{
-		for (i = 0; i < static_cast<int>(sizeof(NavBitArray) / sizeof(NavBitArray[0])); ++i)
-			delete NavBitArray[i];
+		DeleteInstances(SatIfSignal, NavBitArray, sizeof(NavBitArray) / sizeof(NavBitArray[0]));
 		printf("Configuration validation completed\n");
 		return 0;
 	}
-
-	NoiseArray = new complex_number[OutputParam.SampleFreq];
-	QuantArray = new unsigned char[OutputParam.SampleFreq * 4];
+	printf("[INFO]\tIF sample kernel: %s\n", IfKernelName(GetIfKernelIsa()));
+	printf("[INFO]\tIF sample type: %s\n", (OutputParam.SampleType == IfSampleFloat) ? "float" : (OutputParam.SampleType == IfSampleInt16) ? "int16" : "double");
+	if (Arguments.OrbitInterval > 0)
+		printf("[INFO]\tSatellite orbit: interpolated from nodes every %g s\n", Arguments.OrbitInterval);
+	else
+		printf("[INFO]\tSatellite orbit: calculated from ephemeris\n");
+	if (Arguments.AtmosInterval > 0)
+		printf("[INFO]\tAtmosphere delay: %s interpolation of nodes every %g s\n", (Arguments.AtmosOrder == 1) ? "linear" : "quadratic", Arguments.AtmosInterval);
+	else
+		printf("[INFO]\tAtmosphere delay: calculated each millisecond\n");
+	if (Arguments.NoisePoolMs > 0)
+	{
+		SetIfNoisePool((long long)Arguments.NoisePoolMs * OutputParam.SampleFreq, Arguments.NoisePeriod, OutputParam.SampleType);
+		printf("[INFO]\tNoise pool: %lld samples (%.3f s), ", GetIfNoisePoolSize(), (double)GetIfNoisePoolSize() / OutputParam.SampleFreq / 1000.);
+		if (GetIfNoisePeriod() > 0)
+			printf("noise repeats every %d ms\n", GetIfNoisePeriod());
+		else
+			printf("no repeat period\n");
+	}
+	// noise, mixed samples and quantized output hold a whole block of milliseconds
+	BlockSamples = OutputParam.SampleFreq * Arguments.BlockMs;
+	NoiseArray = (OutputParam.SampleType == IfSampleDouble) ? new complex_number[BlockSamples] : NULL;
+	FloatNoiseArray = (OutputParam.SampleType == IfSampleFloat) ? new complex_float[BlockSamples] : NULL;
+	IntNoiseArray = (OutputParam.SampleType == IfSampleInt16) ? new complex_int32[BlockSamples] : NULL;
+	QuantBytes = (OutputParam.Format == OutputFormatIQ2) ? OutputParam.SampleFreq / 2 : (OutputParam.Format == OutputFormatIQ4) ? OutputParam.SampleFreq :
+		(OutputParam.Format == OutputFormatIQ16) ? OutputParam.SampleFreq * 4 : OutputParam.SampleFreq * 2;
+	// quantized samples of each block go into a ring slot, writer thread writes it to file while
+	// next block is generated, generation waits for a free slot if writing falls behind
+	// output size is known from trajectory length, mmap backend preallocates and maps it
+	IfWriter = new CIfDataWriter(IfFile, QuantBytes * Arguments.BlockMs, Arguments.WriteSlots,
+		Arguments.WriteBackend.empty() ? IfWriterStdio : IfWriterBackendFromName(Arguments.WriteBackend.c_str()), (long long)QuantBytes * totalDurationMs);
+	if (!Arguments.WriteBackend.empty() && Arguments.WriteBackend != "auto" && Arguments.WriteBackend != IfWriterBackendName(IfWriter->GetBackend()))
+		printf("[WARNING]\tOutput writer %s not supported for output file, use %s\n", Arguments.WriteBackend.c_str(), IfWriterBackendName(IfWriter->GetBackend()));
+	printf("[INFO]\tOutput writer: %s\n", IfWriterBackendName(IfWriter->GetBackend()));
 
 	// Calculate total data size and setup progress tracking
 	int exec_cycle = 0;
 	long long TotalClippedSamples = 0;
 	long long TotalSamples = 0;
 	double AGCGain = 1.0;
+	if (Arguments.BlockMs > 1)
+		printf("[INFO]\tBlock length: %d ms\n", Arguments.BlockMs);
+	if (IfWriter->GetSlotNumber() > 0)
+		printf("[INFO]\tOutput ring: %d slots of %d ms\n", IfWriter->GetSlotNumber(), Arguments.BlockMs);
 	printf("[INFO]\tStarting signal generation loop...\n");
 	fflush(stdout);
 	
 	auto start_time = std::chrono::high_resolution_clock::now();
 	
-	while (!StepToNextMs())
+	while ((BlockLength = StepToNextBlock(Arguments.BlockMs)) > 0)
 	{
-		exec_cycle ++;
-		// generate white noise
-		for (i = 0; i < OutputParam.SampleFreq; i ++)
-			NoiseArray[i] = GenerateNoise(1.0);
-		
-		// Use parallel or serial processing based on command line flag
-		if (Arguments.MultiThread)
-		{
-			#ifdef _OPENMP
-			// Parallel satellite signal generation using OpenMP (auto-detects thread count)
-			#pragma omp parallel for schedule(dynamic)
-			for (i = 0; i < TotalChannelNumber; i++)	// TOTAL_SAT_CHANNEL
-				SatIfSignal[i]->GetIfSample(CurTime);
-
-			#else
-			// OpenMP not available, fall back to sequential processing
-			for (i = 0; i < TotalChannelNumber; i++)
-				SatIfSignal[i]->GetIfSample(CurTime);
-			
-			#endif
-		}
-		else
+		exec_cycle += BlockLength;
+
+		// code/carrier NCO of each millisecond of the block from interpolated satellite parameters
+		for (Ms = 0; Ms < BlockLength; Ms ++)
 		{
-			// True serial execution - no OpenMP overhead
-			for (i = 0; i < TotalChannelNumber; i++)
-				SatIfSignal[i]->GetIfSample(CurTime);
+			GNSS_TIME MsTime = CurTime;
 
-		}
+			if (BlockLength > 1)
+			{
+				InterpolateBlockParam(Ms + 1, BlockLength);
+				if ((MsTime.MilliSeconds -= BlockLength - Ms - 1) < 0)
+				{
+					MsTime.Week --;
+					MsTime.MilliSeconds += 604800000;
+				}
+			}
+			// Use parallel or serial processing based on command line flag
+			if (Arguments.MultiThread)
+			{
+				#ifdef _OPENMP
+				// Parallel code/carrier NCO calculation using OpenMP (auto-detects thread count)
+				#pragma omp parallel for schedule(dynamic)
+				for (i = 0; i < TotalChannelNumber; i++)	// TOTAL_SAT_CHANNEL
+					SatIfSignal[i]->PrepareIfSample(MsTime, Ms);
+
+				#else
+				// OpenMP not available, fall back to sequential processing
+				for (i = 0; i < TotalChannelNumber; i++)
+					SatIfSignal[i]->PrepareIfSample(MsTime, Ms);
+				
+				#endif
+			}
+			else
+			{
+				// True serial execution - no OpenMP overhead
+				for (i = 0; i < TotalChannelNumber; i++)
+					SatIfSignal[i]->PrepareIfSample(MsTime, Ms);
 
-		// Sequential accumulation to avoid race conditions (Dont nest this loop, causes issues with OpenMP)
-		for (i = 0; i < TotalChannelNumber; i++)
-		{
-			for (j = 0; j < OutputParam.SampleFreq; j++)
-				NoiseArray[j] += SatIfSignal[i]->SampleArray[j];
+			}
 		}
 
-		
-		if (OutputParam.Format == OutputFormatIQ2) 
+		// generate samples of all channels tile by tile over the block, add white noise and quantize
+		BlockSamples = OutputParam.SampleFreq * BlockLength;
+		if ((QuantArray = IfWriter->AcquireSlot()) == NULL)
 		{
-			TotalClippedSamples += QuantSamplesIQ2(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			// Pack 2 samples per byte
-			fwrite(QuantArray, sizeof(unsigned char), OutputParam.SampleFreq / 2, IfFile);	// 1/2 byte/sample
-		}
-		else if (OutputParam.Format == OutputFormatIQ4) 
-		{
-			TotalClippedSamples += QuantSamplesIQ4(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			fwrite(QuantArray, sizeof(unsigned char), OutputParam.SampleFreq, IfFile); // 1 byte/sample
-		}
-		else if (OutputParam.Format == OutputFormatIQ16) 
-		{
-			TotalClippedSamples += QuantSamplesIQ16(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			fwrite(QuantArray, sizeof(unsigned char) * 4, OutputParam.SampleFreq, IfFile); // 4 bytes/sample
+			printf("\n[ERROR]\tFailed to map output file\n");
+			break;
 		}
+		if (OutputParam.SampleType == IfSampleFloat)
+			TotalClippedSamples += MixAndQuantize<complex_float>(FloatNoiseArray, SatIfSignal, TotalChannelNumber, exec_cycle - BlockLength, BlockSamples, QuantArray, AGCGain, Arguments.MultiThread);
+		else if (OutputParam.SampleType == IfSampleInt16)
+			TotalClippedSamples += MixAndQuantize<complex_int16>(IntNoiseArray, SatIfSignal, TotalChannelNumber, exec_cycle - BlockLength, BlockSamples, QuantArray, AGCGain, Arguments.MultiThread);
 		else
-		{
-			TotalClippedSamples += QuantSamplesIQ8(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			fwrite(QuantArray, sizeof(unsigned char) * 2, OutputParam.SampleFreq, IfFile); // 2 bytes/sample
-		}
-		TotalSamples += OutputParam.SampleFreq * 2; // I and Q
+			TotalClippedSamples += MixAndQuantize<complex_number>(NoiseArray, SatIfSignal, TotalChannelNumber, exec_cycle - BlockLength, BlockSamples, QuantArray, AGCGain, Arguments.MultiThread);
+		IfWriter->SubmitSlot(QuantBytes * BlockLength);
+		TotalSamples += (long long)BlockSamples * 2; // I and Q
 
 #if 1
 		// Adjust gain every 100ms
-		if ((exec_cycle % 100) == 0)
+		if ((exec_cycle / 100) != (exec_cycle - BlockLength) / 100)
 		{
 			double ClippingRate = (double)TotalClippedSamples / TotalSamples;
 			if (ClippingRate > 0.01) // clipped rate over 1%
@@ -683,7 +822,7 @@ int main(int argc, char* argv[])
 //		for (j = 0; j < OutputParam.SampleFreq; j ++)
 //			printf("%f %f\n", NoiseArray[j].real, NoiseArray[j].imag);
 		// Enhanced progress reporting with percentage, MB/s, and ETA
-		if ((exec_cycle % 25) == 0)
+		if ((exec_cycle / 25) != (exec_cycle - BlockLength) / 25)
 		{
 			auto current_time = std::chrono::high_resolution_clock::now();
 			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - start_time).count();
@@ -755,6 +894,8 @@ int main(int argc, char* argv[])
 	printf("] %d/%d ms | %.2f/%.2f MB | \tCOMPLETED\n",
 		   totalDurationMs, totalDurationMs, totalMB, totalMB); 
 	
+	if (!IfWriter->Finish())
+		printf("[ERROR]\tFailed to write IF data file, output may be incomplete\n");
 	auto end_time = std::chrono::high_resolution_clock::now();
 	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 	double finalMB = (exec_cycle * bytesPerMs) / (1024.0 * 1024.0);
@@ -772,48 +913,62 @@ int main(int argc, char* argv[])
 	printf("[INFO]\tTotal time taken: %0.2f s\n", duration.count()/1000.0);
 	printf("[INFO]\tData generated: %.2f MB\n", finalMB);
 	printf("[INFO]\tAverage rate: %.2f MB/s\n", avgMbPerSec);
+	const IF_WRITER_STATS &WriterStats = IfWriter->GetStats();
+	if (IfWriter->GetBackend() == IfWriterMmap)
+		printf("[INFO]\tOutput written in place to preallocated file, unmap and truncate %.3f ms\n", WriterStats.WriteLatency * 1000);
+	else
+		printf("[INFO]\tOutput writes (%s): %lld, average latency %.3f ms, max %.3f ms, %.2f MB/s while writing\n", IfWriterBackendName(IfWriter->GetBackend()), WriterStats.WriteCount,
+			WriterStats.WriteCount ? WriterStats.WriteLatency / WriterStats.WriteCount * 1000 : 0.0, WriterStats.MaxWriteLatency * 1000,
+			(WriterStats.IoTime > 0) ? WriterStats.BytesWritten / WriterStats.IoTime / (1024.0 * 1024.0) : 0.0);
+	if (IfWriter->GetSlotNumber() > 0)
+	{
+		printf("[INFO]\tOutput ring: average %.2f / max %d of %d slots filled\n", WriterStats.SlotsWritten ? WriterStats.OccupancySum / WriterStats.SlotsWritten : 0.0, WriterStats.MaxOccupancy, IfWriter->GetSlotNumber());
+		printf("[INFO]\tGeneration waited for writer: %lld times, %.3f s\n", WriterStats.ProducerStalls, WriterStats.ProducerWaitTime);
+		printf("[INFO]\tWriter waited for generation: %lld times, %.3f s\n", WriterStats.WriterStalls, WriterStats.WriterWaitTime);
+	}
 	printf("------------------------------------------------------------------\n\n");
 
-	for (i = 0; i < TOTAL_SAT_CHANNEL; i ++)
-		if (SatIfSignal[i]) delete SatIfSignal[i];
-	for (i = 0; i < static_cast<int>(sizeof(NavBitArray) / sizeof(NavBitArray[0])); ++i)
-		delete NavBitArray[i];
+	DeleteInstances(SatIfSignal, NavBitArray, sizeof(NavBitArray) / sizeof(NavBitArray[0]));
 	delete[] NoiseArray;
-	delete[] QuantArray;
+	delete[] FloatNoiseArray;
+	delete[] IntNoiseArray;
+	delete IfWriter;
 	fclose(IfFile);
 
 	return 0;
 }
 
-void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam)
+// visible satellite parameters of all systems
+static int GetVisibleSatParam(CSatelliteParam *SatParamList[])
 {
-	int i, index;
-	LLA_POSITION PosLLA = EcefToLla(CurPos);
-	int TotalSatNumber = 0;
+	int i, Number = 0;
 
 	for (i = 0; i < GpsSatNumber; i ++)
-	{
-		index = GpsEphVisible[i]->svid - 1;
-		GpsSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		GpsSatParam[index].UpdateCN0(ListCount, PowerList);
-	}
+		SatParamList[Number ++] = &GpsSatParam[GpsEphVisible[i]->svid - 1];
 	for (i = 0; i < BdsSatNumber; i ++)
-	{
-		index = BdsEphVisible[i]->svid - 1;
-		BdsSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		BdsSatParam[index].UpdateCN0(ListCount, PowerList);
-	}
+		SatParamList[Number ++] = &BdsSatParam[BdsEphVisible[i]->svid - 1];
 	for (i = 0; i < GalSatNumber; i ++)
+		SatParamList[Number ++] = &GalSatParam[GalEphVisible[i]->svid - 1];
+	for (i = 0; i < GloSatNumber; i ++)
+		SatParamList[Number ++] = &GloSatParam[GloEphVisible[i]->n - 1];
+	return Number;
+}
+
+// Ephemerides are read only and each CSatelliteParam keeps its own orbit propagation
+// state, so satellites are calculated in parallel threads
+void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam)
+{
+	CSatelliteParam *SatParamList[TOTAL_SAT_NUMBER];
+	int i, SatNumber = GetVisibleSatParam(SatParamList);
+	LLA_POSITION PosLLA = EcefToLla(CurPos);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic) if (SatNumber > 1)
+#endif
+	for (i = 0; i < SatNumber; i ++)
 	{
-		index = GalEphVisible[i]->svid - 1;
-		GalSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		GalSatParam[index].UpdateCN0(ListCount, PowerList);
-	}
-	for (i = 0; i < GloSatNumber; i++)
-	{
-		index = GloEphVisible[i]->n - 1;
-		GloSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		GloSatParam[index].UpdateCN0(ListCount, PowerList);
+		SatParamList[i]->CalculateParam(CurPos, PosLLA, CurTime);
+		SatParamList[i]->UpdateCN0(ListCount, PowerList);
 	}
 }
 
@@ -848,20 +1003,61 @@ int StepToNextMs()
 	return 0;
 }
 
-complex_number GenerateNoise(double Sigma)
+// Step to end of next block of up to BlockMs milliseconds. Trajectory still advances in 1ms
+// steps, satellite parameters are only calculated at middle and end of the block and
+// InterpolateBlockParam() gets them for each millisecond, which removes orbit/delay calculation
+// of the other milliseconds. Return number of milliseconds of the block, 0 at end of trajectory
+int StepToNextBlock(int BlockMs)
 {
-	double fvalue1, fvalue2, mag;
+	KINEMATIC_INFO PosList[MAX_IF_BLOCK_MS];
+	CSatelliteParam *SatParamList[TOTAL_SAT_NUMBER];
+	int i, Ms, SatNumber, ListCount;
+	PSIGNAL_POWER PowerList = NULL;
+	GNSS_TIME MidTime;
+
+	if (BlockMs <= 1)
+		return StepToNextMs() ? 0 : 1;
+	for (Ms = 0; Ms < BlockMs && Ms < MAX_IF_BLOCK_MS; Ms ++)
+		if (!Trajectory.GetNextPosVelECEF(0.001, PosList[Ms]))
+			break;
+	if (Ms == 0)
+		return 0;
 
-	// Marsaglia Polar method (improved Box-Muller method)
-    do
+	SatNumber = GetVisibleSatParam(SatParamList);
+	for (i = 0; i < SatNumber; i ++)
+		SatParamList[i]->SetBlockNode(0);
+	if (Ms > 1)
+	{
+		MidTime = CurTime;
+		if ((MidTime.MilliSeconds += Ms / 2) > 604800000)
+		{
+			MidTime.Week ++;
+			MidTime.MilliSeconds -= 604800000;
+		}
+		UpdateSatParamList(MidTime, PosList[Ms / 2 - 1], 0, NULL, NavData.GetGpsIono());
+		for (i = 0; i < SatNumber; i ++)
+			SatParamList[i]->SetBlockNode(1);
+	}
+	ListCount = PowerControl.GetPowerControlList(Ms, PowerList);
+	if ((CurTime.MilliSeconds += Ms) > 604800000)
 	{
-        fvalue1 = 2.0 * ((double)rand() / RAND_MAX) - 1.0;
-        fvalue2 = 2.0 * ((double)rand() / RAND_MAX) - 1.0;
-        mag = fvalue1 * fvalue1 + fvalue2 * fvalue2;
-    } while (mag >= 1.0 || mag == 0.0);
-	mag = sqrt(-2.0 * log(mag) / mag) * Sigma;
+		CurTime.Week ++;
+		CurTime.MilliSeconds -= 604800000;
+	}
+	UpdateSatParamList(CurTime, PosList[Ms - 1], ListCount, PowerList, NavData.GetGpsIono());
+	for (i = 0; i < SatNumber; i ++)
+		SatParamList[i]->SetBlockNode(2);
+	return Ms;
+}
+
+// set satellite parameters to millisecond Ms (1 to BlockMs) of the block StepToNextBlock() stepped
+void InterpolateBlockParam(int Ms, int BlockMs)
+{
+	CSatelliteParam *SatParamList[TOTAL_SAT_NUMBER];
+	int i, SatNumber = GetVisibleSatParam(SatParamList);
 
-	return complex_number(fvalue1 * mag, fvalue2 * mag);
+	for (i = 0; i < SatNumber; i ++)
+		SatParamList[i]->InterpolateBlock(Ms, BlockMs / 2, BlockMs);
 }
 
 NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray[])
@@ -914,160 +1110,108 @@ NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray
 	}
 }
 
-// PocketSDR compatible 2-bit IQ quantization 
-// (TODO: Test)
-// (FIXME: Optimize)
- int QuantSamplesIQ2(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
- {
-	int ClippedCount = 0;
-	const double threshold = 1.1 / GainScale;	// the optimal threshold for Gauss noise is Sigma, increase a little to compensate added signal power
-	const double ClippedThreshold = 5 * threshold;	// clip threshold set to 5 Sigma
-	double Value;
-	unsigned char QuantByte;
-
-     // Process 2 complex samples at a time to produce 1 byte of output.
-     // Bit definition within each byte is (from MSB): Sign-Q2, Mag-Q2, Sign-I2, Mag-I2, Sign-Q1, Mag-Q1, Sign-I1, Mag-I1
-    for (int i = 0; i < Length; i += 2)
-    {
-		QuantByte = (Samples[i].real < 0.0) ? 2 : 0;
-		Value = fabs(Samples[i].real);
-		QuantByte |= (Value < threshold) ? 0 : 1;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-		QuantByte |= (Samples[i].imag < 0.0) ? 8 : 0;
-		Value = fabs(Samples[i].imag);
-		QuantByte |= (Value < threshold) ? 0 : 4;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-
-		QuantByte = (Samples[i+1].real < 0.0) ? 0x20 : 0;
-		Value = fabs(Samples[i+1].real);
-		QuantByte |= (Value < threshold) ? 0 : 0x10;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-		QuantByte |= (Samples[i+1].imag < 0.0) ? 0x80 : 0;
-		Value = fabs(Samples[i+1].imag);
-		QuantByte |= (Value < threshold) ? 0 : 0x40;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-	}
+// delete channels (NULL for channels not created) and navigation bit instances created in main()
+void DeleteInstances(CSatIfSignal *SatIfSignal[], NavBit *NavBitArray[], int NavBitNumber)
+{
+	int i;
 
-	return ClippedCount;
+	for (i = 0; i < TOTAL_SAT_CHANNEL; i ++)
+		if (SatIfSignal[i]) delete SatIfSignal[i];
+	for (i = 0; i < NavBitNumber; i ++)
+		delete NavBitArray[i];
 }
 
-int QuantSamplesIQ4(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
+// Samples of one millisecond are synthesized in tiles small enough that the tile of
+// output and the tile of one channel both stay in L1/L2 cache, so each channel adds
+// into output right after generated instead of writing a whole millisecond to memory
+// and reading it back. Tile size is reduced with more threads to balance the load
+#define SYNTH_TILE_MAX 4096
+#define SYNTH_TILE_MIN 512
+#define SYNTH_TILES_PER_THREAD 4
+
+static int GetTileSize(int Length, bool MultiThread)
 {
-	int i;
-	double Value;
-	unsigned char QuantValue, QuantSample;
-	const double Gain = GainScale * 3.0;
-	int ClippedCount = 0;
+	int TileSize = SYNTH_TILE_MAX;
+
+#ifdef _OPENMP
+	if (MultiThread)
+		TileSize = Length / (omp_get_max_threads() * SYNTH_TILES_PER_THREAD);
+#endif
+	TileSize = (TileSize + 15) & ~15;	// keep multiple of SIMD width
+	return std::min(std::max(TileSize, SYNTH_TILE_MIN), SYNTH_TILE_MAX);
+}
+
+// add samples Start to Start+Count-1 of all channels to output, channels are added in
+// the same order for every sample so result does not depend on tile size or thread number
+template <typename T> static void MixTile(typename IfSampleTraits<T>::AccumType Output[], CSatIfSignal *SatIfSignal[], int ChannelNumber, int Start, int Count, T Samples[])
+{
+	int i, j;
 
-	for (i = 0; i < Length; i++)
+	Output += Start;
+	for (i = 0; i < ChannelNumber; i ++)
 	{
-		Value = fabs(Samples[i].real);
-		QuantValue = (int)(Value * Gain);	// optimal quantization for sigma=1 noise
-		if (QuantValue > 7)
-		{
-			QuantValue = 7;
-			ClippedCount ++;
-		}
-		QuantValue += ((Samples[i].real >= 0) ? 0 : (1 << 3));	// add sign bit as MSB
-		QuantSample = QuantValue << 4;
-		Value = fabs(Samples[i].imag);
-		QuantValue = (int)(Value * Gain);	// optimal quantization for sigma=1 noise
-		if (QuantValue > 7)
+		SatIfSignal[i]->GenerateIfSample(Samples, Start, Count);
+		for (j = 0; j < Count; j ++)
 		{
-			QuantValue = 7;
-			ClippedCount ++;
+			Output[j].real += Samples[j].real;
+			Output[j].imag += Samples[j].imag;
 		}
-		QuantValue += ((Samples[i].imag >= 0) ? 0 : (1 << 3));	// add sign bit as MSB
-		QuantSample |= QuantValue;
-		QuantSamples[i] = QuantSample;
 	}
+}
 
-	return ClippedCount;
+// quantize samples Start to Start+Count-1 into corresponding position of QuantArray,
+// Start should be even so that 2bit samples of a tile begin at byte boundary
+template <typename T> static int QuantizeTile(T Samples[], int Start, int Count, unsigned char QuantArray[], double GainScale)
+{
+	Samples += Start;
+	if (OutputParam.Format == OutputFormatIQ2)	// Pack 2 samples per byte
+		return QuantSamplesIQ2(Samples, Count, QuantArray + Start / 2, GainScale);
+	else if (OutputParam.Format == OutputFormatIQ4)
+		return QuantSamplesIQ4(Samples, Count, QuantArray + Start, GainScale);
+	else if (OutputParam.Format == OutputFormatIQ16)
+		return QuantSamplesIQ16(Samples, Count, QuantArray + Start * 4, GainScale);
+	else
+		return QuantSamplesIQ8(Samples, Count, QuantArray + Start * 2, GainScale);
 }
 
-int QuantSamplesIQ8(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
+// generate white noise, add samples of all channels and quantize Length samples (one or
+// more milliseconds beginning at millisecond FirstMs) to output format, PrepareIfSample()
+// of all channels should be called before
+// Each tile is owned by one thread from noise to quantized bytes, so noise is generated and
+// channels are summed into a tile resident in cache and quantized right away without another
+// pass over the whole block. Noise of each sample only depends on its position and only the
+// integer clipped counts of the threads are reduced, output does not depend on thread number
+template <typename T> int MixAndQuantize(typename IfSampleTraits<T>::AccumType NoiseArray[], CSatIfSignal *SatIfSignal[], int ChannelNumber, int FirstMs, int Length, unsigned char QuantArray[], double GainScale, bool MultiThread)
 {
-	int i;
-	int QuantValue;
-	const double Gain = GainScale * 25.0;
+	int TileSize = GetTileSize(Length, MultiThread);
+	int TileNumber = (Length + TileSize - 1) / TileSize;
 	int ClippedCount = 0;
 
-	for (i = 0; i < Length; i++)
+	// each thread synthesizes whole tiles, so no two threads write the same output sample
+#ifdef _OPENMP
+	#pragma omp parallel if (MultiThread) reduction(+:ClippedCount)
+#endif
 	{
-		QuantValue = (int)(Samples[i].real * Gain);	// sigma scaled at 25 -> +-5 sigma scaled within range of INT8
-		if (QuantValue > 127)	// saturate at -128~127
-		{
-			QuantValue = 127;
-			ClippedCount ++;
-		}
-		else if (QuantValue < -128)
-		{
-			QuantValue = -128;
-			ClippedCount ++;
-		}
-		QuantSamples[i * 2] = (unsigned char)(QuantValue & 0xff);
-		QuantValue = (int)(Samples[i].imag * Gain);	// sigma scaled at 25 -> +-5 sigma scaled within range of INT8
-		if (QuantValue > 127)	// saturate at -128~127
-		{
-			QuantValue = 127;
-			ClippedCount ++;
-		}
-		else if (QuantValue < -128)
+		T *Samples = new T[TileSize];
+		int i, Start, Count;
+
+#ifdef _OPENMP
+		#pragma omp for schedule(dynamic)
+#endif
+		for (i = 0; i < TileNumber; i ++)
 		{
-			QuantValue = -128;
-			ClippedCount ++;
+			Start = i * TileSize;
+			Count = std::min(TileSize, Length - Start);
+			GenerateIfNoise(NoiseArray + Start, FirstMs, OutputParam.SampleFreq, Start, Count);
+			MixTile(NoiseArray, SatIfSignal, ChannelNumber, Start, Count, Samples);
+			ClippedCount += QuantizeTile(NoiseArray, Start, Count, QuantArray, GainScale);
 		}
-		QuantSamples[i * 2 + 1] = (unsigned char)(QuantValue & 0xff);
+		delete[] Samples;
 	}
 
 	return ClippedCount;
 }
 
-int QuantSamplesIQ16(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
-{
-    int i;
-    int QuantValue;
-    
-    const double Gain = GainScale * 3277;
-    int ClippedCount = 0;
-
-    for (i = 0; i < Length; i++)
-    {
-        QuantValue = (int)(Samples[i].real * Gain);  
-        if (QuantValue > 32767)  
-        {
-            QuantValue = 32767;
-            ClippedCount++;
-        }
-        else if (QuantValue < -32768)
-        {
-            QuantValue = -32768;
-            ClippedCount++;
-        }
-    
-        QuantSamples[i * 4] = (unsigned char)(QuantValue & 0xff);       
-        QuantSamples[i * 4 + 1] = (unsigned char)((QuantValue >> 8) & 0xff);  
-
-      
-        QuantValue = (int)(Samples[i].imag * Gain);  
-        if (QuantValue > 32767)  
-        {
-            QuantValue = 32767;
-            ClippedCount++;
-        }
-        else if (QuantValue < -32768)
-        {
-            QuantValue = -32768;
-            ClippedCount++;
-        }
-      
-        QuantSamples[i * 4 + 2] = (unsigned char)(QuantValue & 0xff);        
-        QuantSamples[i * 4 + 3] = (unsigned char)((QuantValue >> 8) & 0xff);  
-    }
-
-    return ClippedCount;
-}
-
 void ShowHelp(const char* ProgramPath)
 {
 	// Extract just the executable name from the path
@@ -1088,6 +1232,18 @@ void ShowHelp(const char* ProgramPath)
 	std::cout << "   -mt, 	--multi-thread     Force use multi-thread\n";
 	std::cout << "   -st, 	--single-thread    Force use single-thread\n";
 	std::cout << "   -t,  	--tag              Output tag file (output file name with .tag appended)\n";
+	std::cout << "   -k, 	--kernel <ISA>     IF sample kernel: scalar, sse4.2, avx2, avx512 or auto (default)\n";
+	std::cout << "   -cr, 	--chip-run <MODE>  Chip run engine: on, off or auto (default, decided by samples per chip)\n";
+	std::cout << "   -sp, 	--sample-type <T>  IF synthesis sample type: double, float or int16 (overrides config)\n";
+	std::cout << "   -b, 	--block <MS>       Generate blocks of 1 (default) to 20 ms, satellite parameters interpolated within block\n";
+	std::cout << "   -ws, 	--write-slots <N>  Blocks buffered for writer thread (default 4), 0 writes synchronously\n";
+	std::cout << "   -wb, 	--write-backend <B> Output writer: stdio (default), direct (O_DIRECT), io_uring, mmap or auto\n";
+	std::cout << "   -ns, 	--noise-seed <N>   Seed of white noise (decimal or 0x hex), same seed gives same noise\n";
+	std::cout << "   -np, 	--noise-pool <MS>  Copy noise from a pool of MS milliseconds of samples instead of exact noise\n";
+	std::cout << "   -npp,	--noise-period <MS> Noise read from pool repeats every MS milliseconds (default no repeat)\n";
+	std::cout << "   -oi, 	--orbit-interval <S> Satellite orbit interpolation node interval (default 30), 0 calculates from ephemeris\n";
+	std::cout << "   -ai, 	--atmos-interval <S> Ionosphere/troposphere delay node interval (default 1), 0 calculates each millisecond\n";
+	std::cout << "   -aip,	--atmos-interp <M> Atmosphere delay interpolation between nodes: linear or quadratic (default)\n";
 	std::cout << "   -v, 	--version          Show version information\n";
 	std::cout << "   -h, 	--help             Show this help message\n\n";
 	std::cout << "Examples:\n";
@@ -1107,6 +1263,18 @@ bool ParseCommandLineArgs(int argc, char* argv[], CommandArguments &Arguments)
 		"--multi-thread", "-mt",	// 4
 		"--single-thread", "-st",	// 5
 		"--tag", "-t",	// 6
+		"--kernel", "-k",	// 7
+		"--chip-run", "-cr",	// 8
+		"--sample-type", "-sp",	// 9
+		"--block", "-b",	// 10
+		"--write-slots", "-ws",	// 11
+		"--write-backend", "-wb",	// 12
+		"--noise-seed", "-ns",	// 13
+		"--noise-pool", "-np",	// 14
+		"--noise-period", "-npp",	// 15
+		"--orbit-interval", "-oi",	// 16
+		"--atmos-interval", "-ai",	// 17
+		"--atmos-interp", "-aip",	// 18
 	};
 	std::string arg;
 	int i = 1, index;
@@ -1150,6 +1318,102 @@ bool ParseCommandLineArgs(int argc, char* argv[], CommandArguments &Arguments)
 		case 6:	// --tag
 			Arguments.OutputTag = true;
 			break;
+		case 7:	// --kernel
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a kernel name argument\n";
+				return false;
+			}
+			Arguments.Kernel = argv[++i];
+			break;
+		case 8:	// --chip-run
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a mode argument\n";
+				return false;
+			}
+			Arguments.ChipRun = argv[++i];
+			break;
+		case 9:	// --sample-type
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a sample type argument\n";
+				return false;
+			}
+			Arguments.SampleType = argv[++i];
+			break;
+		case 10:	// --block
+			if (i + 1 >= argc || atoi(argv[i+1]) < 1 || atoi(argv[i+1]) > MAX_IF_BLOCK_MS)
+			{
+				std::cerr << "[ERROR] " << arg << " requires block length of 1 to " << MAX_IF_BLOCK_MS << " ms\n";
+				return false;
+			}
+			Arguments.BlockMs = atoi(argv[++i]);
+			break;
+		case 11:	// --write-slots
+			if (i + 1 >= argc || atoi(argv[i+1]) < 0 || atoi(argv[i+1]) > IF_WRITER_MAX_SLOTS)
+			{
+				std::cerr << "[ERROR] " << arg << " requires slot number of 0 to " << IF_WRITER_MAX_SLOTS << "\n";
+				return false;
+			}
+			Arguments.WriteSlots = atoi(argv[++i]);
+			break;
+		case 12:	// --write-backend
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a backend name argument\n";
+				return false;
+			}
+			Arguments.WriteBackend = argv[++i];
+			break;
+		case 13:	// --noise-seed
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a seed argument\n";
+				return false;
+			}
+			Arguments.NoiseSeed = strtoull(argv[++i], NULL, 0);
+			break;
+		case 14:	// --noise-pool
+			if (i + 1 >= argc || atoi(argv[i+1]) < 1)
+			{
+				std::cerr << "[ERROR] " << arg << " requires pool length in ms\n";
+				return false;
+			}
+			Arguments.NoisePoolMs = atoi(argv[++i]);
+			break;
+		case 15:	// --noise-period
+			if (i + 1 >= argc || atoi(argv[i+1]) < 1)
+			{
+				std::cerr << "[ERROR] " << arg << " requires period in ms\n";
+				return false;
+			}
+			Arguments.NoisePeriod = atoi(argv[++i]);
+			break;
+		case 16:	// --orbit-interval
+			if (i + 1 >= argc || argv[i+1][0] == '-' || atof(argv[i+1]) < 0)
+			{
+				std::cerr << "[ERROR] " << arg << " requires interval in second\n";
+				return false;
+			}
+			Arguments.OrbitInterval = atof(argv[++i]);
+			break;
+		case 17:	// --atmos-interval
+			if (i + 1 >= argc || argv[i+1][0] == '-' || atof(argv[i+1]) < 0)
+			{
+				std::cerr << "[ERROR] " << arg << " requires interval in second\n";
+				return false;
+			}
+			Arguments.AtmosInterval = atof(argv[++i]);
+			break;
+		case 18:	// --atmos-interp
+			if (i + 1 >= argc || (std::string(argv[i+1]) != "linear" && std::string(argv[i+1]) != "quadratic"))
+			{
+				std::cerr << "[ERROR] " << arg << " requires linear or quadratic\n";
+				return false;
+			}
+			Arguments.AtmosOrder = (std::string(argv[++i]) == "linear") ? 1 : 2;
+			break;
 		default:
 			std::cout << "[WARNING] Unknown option " << arg << "\n";
 		}
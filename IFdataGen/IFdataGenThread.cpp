@@ -6,19 +6,26 @@
 #include <chrono>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <ctime>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <deque>
 
 #include "SignalSim.h"
+#include "IfDataWriter.h"
+#include "IfQuantize.h"
+#include "IfNoise.h"
 
 #define TOTAL_GPS_SAT 32
 #define TOTAL_BDS_SAT 63
 #define TOTAL_GAL_SAT 36
 #define TOTAL_GLO_SAT 24
 #define TOTAL_SAT_CHANNEL 128
+#define TOTAL_SAT_NUMBER (TOTAL_GPS_SAT + TOTAL_BDS_SAT + TOTAL_GAL_SAT + TOTAL_GLO_SAT)
 
 typedef enum {
     DataBitLNav, DataBitCNav, DataBitCNav2, // for GPS
@@ -33,18 +40,14 @@ struct CommandArguments
 	std::string ConfigFile;
 	std::string OutputFile;
 	bool MultiThread;
+	int Workers;	// number of worker threads including main thread
 	bool ValidateOnly;
 	bool OutputTag;
 };
 
 void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam);
 int StepToNextMs();
-complex_number GenerateNoise(double Sigma);
 NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray[]);
-int QuantSamplesIQ2(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
-int QuantSamplesIQ4(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
-int QuantSamplesIQ8(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
-int QuantSamplesIQ16(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale);
 
 void ShowHelp(const char* ProgramName);
 bool ParseCommandLineArgs(int argc, char* argv[], CommandArguments &Arguments);
@@ -75,57 +78,365 @@ const char *SignalName[][8] = {
 	{ "G1", "G2", },
 };
 
-// thread synchronize variables
-//const int NUM_THREADS = 3;  // Ïß³ÌÊýÁ¿
-std::mutex mtx;
-std::condition_variable cv_task;	// for start task
-std::condition_variable cv_ready;	// for task ready
-std::condition_variable cv_done;	// for task complete notification
-int exec_cycle = 0;
-int ready_tasks = 0;
-int completed_tasks = 0;
-bool shutdown = false;
-
-// IF signal generation thread
-void IF_generate_thread(CSatIfSignal* SatIfSignal)
+// Generation runs on a fixed number of workers, each millisecond in 3 phases:
+// prepare code/carrier NCO of all channels, generate samples of channels (expensive
+// channels split into sample ranges), then generate noise, add all channels and
+// quantize in chunks of samples. Satellite parameters of next millisecond are also
+// calculated as one task each satellite. Each worker has its own task queue, takes
+// tasks from front and steals from back of other queues when its own queue is empty
+#define POOL_SPIN_COUNT 2000	// yields before worker sleeps on condition variable
+#define POOL_TASKS_PER_WORKER 4	// expected generation tasks each worker
+#define POOL_MAX_SPLIT 8	// maximum number of ranges a channel is split into
+#define REDUCE_CHUNK_MAX 2048
+#define REDUCE_CHUNK_MIN 256
+
+enum IfTaskType { IfTaskPrepare, IfTaskGenerate, IfTaskReduce, IfTaskSatParam };
+
+typedef struct
 {
-	int thread_cycle = -1;
+	IfTaskType Type;
+	int Channel;	// channel index for prepare/generate task, satellite index for satellite parameter task
+	int Start, Count;	// sample range for generate/reduce task
+	int Index;	// index of task within phase to return result
+} IF_TASK, *PIF_TASK;
 
-	while (true)
+class CWorkerPool
+{
+public:
+	CWorkerPool(int Workers, void (*Execute)(const IF_TASK &Task));
+	~CWorkerPool();
+	int GetWorkerNumber() { return WorkerNumber; }
+	void AddTask(int Worker, const IF_TASK &Task);
+	void Run();	// run all added tasks, calling thread works as worker 0
+
+private:
+	typedef struct
 	{
-		std::unique_lock<std::mutex> lock(mtx);
+		std::mutex Lock;
+		std::deque<IF_TASK> Tasks;
+	} TASK_QUEUE;
+
+	int WorkerNumber;
+	void (*ExecuteTask)(const IF_TASK &Task);
+	TASK_QUEUE *Queues;
+	std::vector<std::thread> Threads;
+	std::atomic<int> Phase;	// increased to start each phase
+	std::atomic<int> Remaining;	// number of unfinished tasks
+	std::atomic<int> Parked;	// number of threads sleeping on ParkLock
+	std::atomic<bool> Shutdown;
+	std::mutex ParkLock;
+	std::condition_variable PhaseCond, DoneCond;
+
+	void WorkerLoop(int Index);
+	void RunTasks(int Index);
+	bool GetTask(int Index, IF_TASK &Task);
+	template <typename F> void SpinThenPark(F Ready, std::condition_variable &Cond);
+	void Wake(std::condition_variable &Cond);
+};
+
+CWorkerPool::CWorkerPool(int Workers, void (*Execute)(const IF_TASK &Task)) : Phase(0), Remaining(0), Parked(0), Shutdown(false)
+{
+	int i;
+
+	WorkerNumber = (Workers > 0) ? Workers : 1;
+	ExecuteTask = Execute;
+	Queues = new TASK_QUEUE[WorkerNumber];
+	for (i = 1; i < WorkerNumber; i ++)
+		Threads.emplace_back(&CWorkerPool::WorkerLoop, this, i);
+}
+
+CWorkerPool::~CWorkerPool()
+{
+	Shutdown = true;
+	Wake(PhaseCond);
+	for (auto& t : Threads)
+		t.join();
+	delete[] Queues;
+}
+
+void CWorkerPool::AddTask(int Worker, const IF_TASK &Task)
+{
+	std::lock_guard<std::mutex> lock(Queues[Worker].Lock);
+
+	Remaining ++;
+	Queues[Worker].Tasks.push_back(Task);
+}
 
-		++ready_tasks;
-		if (ready_tasks == TotalChannelNumber)
-			cv_ready.notify_one();  // notify main thread ready state
+void CWorkerPool::Run()
+{
+	Phase ++;
+	Wake(PhaseCond);
+	RunTasks(0);
+	SpinThenPark([this] { return Remaining == 0; }, DoneCond);
+}
 
-		// wait task or termineate
-		cv_task.wait(lock, [&] { return (exec_cycle > thread_cycle) || shutdown; });
+void CWorkerPool::WorkerLoop(int Index)
+{
+	int CurPhase = 0;
 
-		if (shutdown)
+	while (true)
+	{
+		SpinThenPark([&] { return Phase != CurPhase || Shutdown; }, PhaseCond);
+		if (Shutdown)
 			break;
+		CurPhase = Phase;
+		RunTasks(Index);
+	}
+}
+
+void CWorkerPool::RunTasks(int Index)
+{
+	IF_TASK Task;
+
+	while (GetTask(Index, Task))
+	{
+		ExecuteTask(Task);
+		if (--Remaining == 0)
+			Wake(DoneCond);
+	}
+}
+
+// own queue from front, other queues from back
+bool CWorkerPool::GetTask(int Index, IF_TASK &Task)
+{
+	int i, Victim;
+
+	for (i = 0; i < WorkerNumber; i ++)
+	{
+		Victim = (Index + i) % WorkerNumber;
+		std::lock_guard<std::mutex> lock(Queues[Victim].Lock);
+		if (Queues[Victim].Tasks.empty())
+			continue;
+		if (i == 0)
+		{
+			Task = Queues[Victim].Tasks.front();
+			Queues[Victim].Tasks.pop_front();
+		}
+		else
+		{
+			Task = Queues[Victim].Tasks.back();
+			Queues[Victim].Tasks.pop_back();
+		}
+		return true;
+	}
+	return false;
+}
+
+// phases within 1ms follow each other closely, so spin (yield) first and only sleep
+// on condition variable if waiting long, waker only takes the lock if any thread sleeps
+template <typename F> void CWorkerPool::SpinThenPark(F Ready, std::condition_variable &Cond)
+{
+	int i;
+
+	for (i = 0; i < POOL_SPIN_COUNT; i ++)
+	{
+		if (Ready())
+			return;
+		std::this_thread::yield();
+	}
+	std::unique_lock<std::mutex> lock(ParkLock);
+	Parked ++;
+	Cond.wait(lock, Ready);
+	Parked --;
+}
+
+void CWorkerPool::Wake(std::condition_variable &Cond)
+{
+	if (Parked > 0)
+	{
+		std::lock_guard<std::mutex> lock(ParkLock);
+		Cond.notify_all();
+	}
+}
+
+// data shared by tasks
+CSatIfSignal *ChannelSignal[TOTAL_SAT_CHANNEL];
+complex_number *ChannelSamples[TOTAL_SAT_CHANNEL];	// samples of current millisecond of each channel
+double ChannelCost[TOTAL_SAT_CHANNEL];	// measured generation time of each channel in ns
+std::vector<double> TaskTime;	// generation time of each generate task
+std::vector<int> TaskClipped;	// clipped count of each reduce task
+complex_number *NoiseArray;
+int NoiseMs = 0;	// millisecond index of noise
+unsigned char *QuantArray;
+double AGCGain = 1.0;
+
+// satellite parameter update shared by tasks, ephemerides are read only and each
+// CSatelliteParam has its own orbit propagation state
+typedef struct
+{
+	GNSS_TIME Time;
+	KINEMATIC_INFO Pos;
+	LLA_POSITION PosLLA;
+	int ListCount;
+	PSIGNAL_POWER PowerList;
+	CSatelliteParam *SatParam[TOTAL_SAT_NUMBER];
+} SAT_PARAM_UPDATE;
+SAT_PARAM_UPDATE SatParamUpdate;
+CWorkerPool *SatParamPool = NULL;	// satellites updated by calling thread before pool created
+
+// add samples of Source to Dest, plain loop over real/imag array to be vectorized by compiler
+static void AddSampleArray(complex_number Dest[], const complex_number Source[], int Length)
+{
+	double *DestValue = (double *)Dest;
+	const double *SourceValue = (const double *)Source;
+	int i;
+
+	Length *= 2;
+	for (i = 0; i < Length; i ++)
+		DestValue[i] += SourceValue[i];
+}
+
+// Samples Start to Start+Count-1 of all channels are added with pairwise tree, channel
+// k adds partial sums of k+1, k+2, k+4... (stop at lowest set bit of k). Tree shape
+// only depends on channel number so result does not depend on chunk size or workers.
+// Then noise generated for the chunk added and quantized, Start should be even for 2bit output
+static int ReduceChunk(int Start, int Count)
+{
+	int Stride, i;
+
+	GenerateIfNoise(NoiseArray + Start, NoiseMs, OutputParam.SampleFreq, Start, Count);
+	for (Stride = 1; Stride < TotalChannelNumber; Stride <<= 1)
+		for (i = 0; i + Stride < TotalChannelNumber; i += Stride * 2)
+			AddSampleArray(ChannelSamples[i] + Start, ChannelSamples[i + Stride] + Start, Count);
+	if (TotalChannelNumber > 0)
+		AddSampleArray(NoiseArray + Start, ChannelSamples[0] + Start, Count);
+
+	if (OutputParam.Format == OutputFormatIQ2)	// Pack 2 samples per byte
+		return QuantSamplesIQ2(NoiseArray + Start, Count, QuantArray + Start / 2, AGCGain);
+	else if (OutputParam.Format == OutputFormatIQ4)
+		return QuantSamplesIQ4(NoiseArray + Start, Count, QuantArray + Start, AGCGain);
+	else if (OutputParam.Format == OutputFormatIQ16)
+		return QuantSamplesIQ16(NoiseArray + Start, Count, QuantArray + Start * 4, AGCGain);
+	else
+		return QuantSamplesIQ8(NoiseArray + Start, Count, QuantArray + Start * 2, AGCGain);
+}
+
+static void ExecuteIfTask(const IF_TASK &Task)
+{
+	switch (Task.Type)
+	{
+	case IfTaskPrepare:
+		ChannelSignal[Task.Channel]->PrepareIfSample(CurTime);
+		break;
+	case IfTaskGenerate:
+	{
+		auto StartTime = std::chrono::steady_clock::now();
+		ChannelSignal[Task.Channel]->GenerateIfSample(ChannelSamples[Task.Channel] + Task.Start, Task.Start, Task.Count);
+		TaskTime[Task.Index] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - StartTime).count();
+		break;
+	}
+	case IfTaskReduce:
+		TaskClipped[Task.Index] = ReduceChunk(Task.Start, Task.Count);
+		break;
+	case IfTaskSatParam:
+		SatParamUpdate.SatParam[Task.Channel]->CalculateParam(SatParamUpdate.Pos, SatParamUpdate.PosLLA, SatParamUpdate.Time);
+		SatParamUpdate.SatParam[Task.Channel]->UpdateCN0(SatParamUpdate.ListCount, SatParamUpdate.PowerList);
+		break;
+	}
+}
 
-		thread_cycle = exec_cycle;
-		// unlock to have other threads continue
-		lock.unlock();
+static bool CompareTaskCost(const std::pair<double, IF_TASK> &a, const std::pair<double, IF_TASK> &b)
+{
+	return a.first > b.first;
+}
 
-//		std::cout << "[Sat " << SatIfSignal->Svid << "] for " << exec_cycle << " begin..." << std::endl;
-		SatIfSignal->GetIfSample(CurTime);
-//		std::cout << "[Sat " << SatIfSignal->Svid << "] for " << exec_cycle << " end" << std::endl;
+// Split channels with estimated cost (measured time of previous milliseconds) larger
+// than even share into sample ranges, then assign largest task first to worker with
+// least total cost, so each worker starts with a balanced queue before stealing
+static void DistributeGenerateTasks(CWorkerPool &Pool, std::vector<std::pair<double, IF_TASK> > &TaskList)
+{
+	int i, Pieces, Step, Start, Worker, Workers = Pool.GetWorkerNumber();
+	double Cost[TOTAL_SAT_CHANNEL], TotalCost = 0, Target;
+	std::vector<double> WorkerCost(Workers, 0.0);
+	IF_TASK Task;
 
-        // update complete count
+	TaskList.clear();
+	for (i = 0; i < TotalChannelNumber; i ++)
+	{
+		Cost[i] = (ChannelCost[i] > 0) ? ChannelCost[i] : 1.0;	// equal cost before first measurement
+		TotalCost += Cost[i];
+	}
+	Target = TotalCost / (Workers * POOL_TASKS_PER_WORKER);
+	Task.Type = IfTaskGenerate;
+	for (i = 0; i < TotalChannelNumber; i ++)
+	{
+		Pieces = (Workers > 1) ? std::min((int)ceil(Cost[i] / Target), POOL_MAX_SPLIT) : 1;
+		Step = ((OutputParam.SampleFreq / std::max(Pieces, 1)) + 15) & ~15;	// keep multiple of SIMD width
+		Task.Channel = i;
+		for (Start = 0; Start < OutputParam.SampleFreq; Start += Step)
 		{
-			std::lock_guard<std::mutex> lock(mtx);
-			++completed_tasks;
-			if (completed_tasks == TotalChannelNumber)
-				cv_done.notify_one();  // notify main thread work done
+			Task.Start = Start;
+			Task.Count = std::min(Step, OutputParam.SampleFreq - Start);
+			TaskList.push_back(std::make_pair(Cost[i] * Task.Count / OutputParam.SampleFreq, Task));
 		}
 	}
+	std::stable_sort(TaskList.begin(), TaskList.end(), CompareTaskCost);
+	if ((int)TaskTime.size() < (int)TaskList.size())
+		TaskTime.resize(TaskList.size());
+	for (i = 0; i < (int)TaskList.size(); i ++)
+	{
+		TaskList[i].second.Index = i;
+		TaskTime[i] = 0;
+		Worker = (int)(std::min_element(WorkerCost.begin(), WorkerCost.end()) - WorkerCost.begin());
+		WorkerCost[Worker] += TaskList[i].first;
+		Pool.AddTask(Worker, TaskList[i].second);
+	}
+}
+
+// generate one millisecond of quantized samples into QuantArray, return clipped count
+static int GenerateMs(CWorkerPool &Pool, std::vector<std::pair<double, IF_TASK> > &TaskList)
+{
+	int i, ChunkSize, ChunkNumber, Workers = Pool.GetWorkerNumber(), ClippedCount = 0;
+	double ChannelTime[TOTAL_SAT_CHANNEL];
+	IF_TASK Task;
+
+	// update code/carrier NCO of all channels
+	Task.Type = IfTaskPrepare;
+	Task.Start = Task.Count = Task.Index = 0;
+	for (i = 0; i < TotalChannelNumber; i ++)
+	{
+		Task.Channel = i;
+		Pool.AddTask(i % Workers, Task);
+	}
+	Pool.Run();
+
+	// generate channel samples, then update cost estimation
+	DistributeGenerateTasks(Pool, TaskList);
+	Pool.Run();
+	for (i = 0; i < TotalChannelNumber; i ++)
+		ChannelTime[i] = 0;
+	for (i = 0; i < (int)TaskList.size(); i ++)
+		if (TaskList[i].second.Type == IfTaskGenerate)
+			ChannelTime[TaskList[i].second.Channel] += TaskTime[i];
+	for (i = 0; i < TotalChannelNumber; i ++)
+		ChannelCost[i] = (ChannelCost[i] > 0) ? ChannelCost[i] * 0.875 + ChannelTime[i] * 0.125 : ChannelTime[i];
+
+	// generate and add noise to channels, quantize
+	ChunkSize = OutputParam.SampleFreq / (Workers * POOL_TASKS_PER_WORKER);
+	ChunkSize = std::min(std::max((ChunkSize + 15) & ~15, REDUCE_CHUNK_MIN), REDUCE_CHUNK_MAX);
+	ChunkNumber = (OutputParam.SampleFreq + ChunkSize - 1) / ChunkSize;
+	if ((int)TaskClipped.size() < ChunkNumber)
+		TaskClipped.resize(ChunkNumber);
+	Task.Type = IfTaskReduce;
+	Task.Channel = -1;
+	for (i = 0; i < ChunkNumber; i ++)
+	{
+		Task.Start = i * ChunkSize;
+		Task.Count = std::min(ChunkSize, OutputParam.SampleFreq - Task.Start);
+		Task.Index = i;
+		Pool.AddTask(i % Workers, Task);
+	}
+	Pool.Run();
+	for (i = 0; i < ChunkNumber; i ++)
+		ClippedCount += TaskClipped[i];
+	NoiseMs ++;
+
+	return ClippedCount;
 }
 
 int main(int argc, char* argv[])
 {
-	int i, j;
+	int i;
 	JsonStream JsonTree;
 	JsonObject *Object;
 	UTC_TIME UtcTime;
@@ -141,17 +452,16 @@ int main(int argc, char* argv[])
 	CSatIfSignal* SatIfSignal[TOTAL_SAT_CHANNEL];
 	int SignalIndex;
 	int IfFreq, FdmaOffset;
-	complex_number *NoiseArray;
-	unsigned char *QuantArray;
 	FILE* IfFile;
 	CommandArguments Arguments;
-
-    std::vector<std::thread> threads;
+	int exec_cycle = 0;
+	std::vector<std::pair<double, IF_TASK> > TaskList;
 
 	// Default arguments
 	Arguments.ConfigFile = "IfGenTest.json"; // Default JSON file
 	Arguments.OutputFile = "";
 	Arguments.MultiThread = true; // Default to use multi-threading
+	Arguments.Workers = std::max((int)std::thread::hardware_concurrency(), 1);
 	Arguments.ValidateOnly = false;
 	Arguments.OutputTag = false;
 
@@ -359,6 +669,17 @@ int main(int argc, char* argv[])
 	BdsSatNumber = (OutputParam.FreqSelect[BdsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, BdsSystem, BdsEph, TOTAL_BDS_SAT, BdsEphVisible) : 0;
 	GalSatNumber = (OutputParam.FreqSelect[GalileoSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GalileoSystem, GalEph, TOTAL_GAL_SAT, GalEphVisible) : 0;
 	GloSatNumber = (OutputParam.FreqSelect[GlonassSystem]) ? GetGlonassVisibleSatellite(CurPos, GlonassTime, OutputParam, GloEph, TOTAL_GLO_SAT, GloEphVisible) : 0;
+
+	CIonoKlobuchar8 IonoModel(NavData.GetGpsIono());
+	for (i = 0; i < TOTAL_GPS_SAT; i ++)
+		GpsSatParam[i].Initialize(GpsSystem, GpsEph[i], &IonoModel, PowerControl.InitCN0, PowerControl.Adjust);
+	for (i = 0; i < TOTAL_BDS_SAT; i ++)
+		BdsSatParam[i].Initialize(BdsSystem, BdsEph[i], &IonoModel, PowerControl.InitCN0, PowerControl.Adjust);
+	for (i = 0; i < TOTAL_GAL_SAT; i ++)
+		GalSatParam[i].Initialize(GalileoSystem, GalEph[i], &IonoModel, PowerControl.InitCN0, PowerControl.Adjust);
+	for (i = 0; i < TOTAL_GLO_SAT; i ++)
+		GloSatParam[i].Initialize(GlonassSystem, (PGPS_EPHEMERIS)GloEph[i], &IonoModel, PowerControl.InitCN0, PowerControl.Adjust);
+
 	ListCount = PowerControl.GetPowerControlList(0, PowerList);
 	UpdateSatParamList(CurTime, CurPos, ListCount, PowerList, NavData.GetGpsIono());
 
@@ -455,7 +776,6 @@ int main(int argc, char* argv[])
 				break;
 			SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, GpsSystem, SignalIndex, GpsEphVisible[i]->svid);
 			SatIfSignal[TotalChannelNumber]->InitState(CurTime, &GpsSatParam[GpsEphVisible[i]->svid-1], GetNavData(GpsSystem, SignalIndex, NavBitArray));
-	        threads.emplace_back(IF_generate_thread, SatIfSignal[TotalChannelNumber]);
 			TotalChannelNumber++;
 			
 			if (svCount % 4 == 0) printf("|");
@@ -488,7 +808,6 @@ int main(int argc, char* argv[])
 				break;
 			SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, BdsSystem, SignalIndex, BdsEphVisible[i]->svid);
 			SatIfSignal[TotalChannelNumber]->InitState(CurTime, &BdsSatParam[BdsEphVisible[i]->svid - 1], GetNavData(BdsSystem, SignalIndex, NavBitArray));
-	        threads.emplace_back(IF_generate_thread, SatIfSignal[TotalChannelNumber]);
 			TotalChannelNumber++;
 			
 			if (svCount % 4 == 0) printf("|");
@@ -520,7 +839,6 @@ int main(int argc, char* argv[])
 				break;
 			SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq, GalileoSystem, SignalIndex, GalEphVisible[i]->svid);
 			SatIfSignal[TotalChannelNumber]->InitState(CurTime, &GalSatParam[GalEphVisible[i]->svid - 1], GetNavData(GalileoSystem, SignalIndex, NavBitArray));
-	        threads.emplace_back(IF_generate_thread, SatIfSignal[TotalChannelNumber]);
 			TotalChannelNumber++;
 			
 			if (svCount % 4 == 0) printf("|");
@@ -553,7 +871,6 @@ int main(int argc, char* argv[])
 			FdmaOffset = (SignalIndex == SIGNAL_INDEX_G1) ? GloEphVisible[i]->freq * 562500 : (SignalIndex == SIGNAL_INDEX_G2) ? GloEphVisible[i]->freq * 437500 : 0;
 			SatIfSignal[TotalChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq + FdmaOffset, GlonassSystem, SignalIndex, GloEphVisible[i]->n);
 			SatIfSignal[TotalChannelNumber]->InitState(CurTime, &GloSatParam[GloEphVisible[i]->n - 1], GetNavData(GlonassSystem, SignalIndex, NavBitArray));
-	        threads.emplace_back(IF_generate_thread, SatIfSignal[TotalChannelNumber]);
 			TotalChannelNumber++;
 			
 			if (svCount % 4 == 0) printf("|");
@@ -572,8 +889,19 @@ int main(int argc, char* argv[])
 	printf("Total channels: %d\n\n", TotalChannelNumber);
 
 	NoiseArray = new complex_number[OutputParam.SampleFreq];
-	QuantArray = new unsigned char[OutputParam.SampleFreq * 4];
-
+	int QuantBytes = (OutputParam.Format == OutputFormatIQ2) ? OutputParam.SampleFreq / 2 : (OutputParam.Format == OutputFormatIQ4) ? OutputParam.SampleFreq :
+		(OutputParam.Format == OutputFormatIQ16) ? OutputParam.SampleFreq * 4 : OutputParam.SampleFreq * 2;
+	// writer thread writes previous millisecond from output ring while workers generate next one
+	CIfDataWriter *IfWriter = new CIfDataWriter(IfFile, QuantBytes);
+	for (i = 0; i < TotalChannelNumber; i ++)
+	{
+		ChannelSignal[i] = SatIfSignal[i];
+		ChannelSamples[i] = new complex_number[OutputParam.SampleFreq];
+		ChannelCost[i] = 0;
+	}
+	CWorkerPool *Pool = new CWorkerPool(Arguments.Workers, ExecuteIfTask);
+	printf("[INFO]\tWorker threads: %d\n", Pool->GetWorkerNumber());
+	SatParamPool = Pool;
 
 	// Calculate total data size and setup progress tracking
 	int totalDurationMs = (int)(Trajectory.GetTimeLength() * 1000);
@@ -581,7 +909,6 @@ int main(int argc, char* argv[])
 	double totalMB = (totalDurationMs * bytesPerMs) / (1024.0 * 1024.0);
 	long long TotalClippedSamples = 0;
 	long long TotalSamples = 0;
-	double AGCGain = 1.0;
 	printf("[INFO]\tStarting signal generation loop...\n");
 	printf("[INFO]\tSignal Duration: %0.2f s\n", totalDurationMs/1000.0);
 	printf("[INFO]\tSignal Size: %.2f MB\n", totalMB);
@@ -594,63 +921,10 @@ int main(int argc, char* argv[])
 
 	while (!StepToNextMs())
 	{
-		// wait for all tasks ready
-		{
-			std::unique_lock<std::mutex> lock(mtx);
-			while (ready_tasks < TotalChannelNumber)
-				cv_ready.wait(lock);
-//			std::cout << "all threads ready" << std::endl;
-			exec_cycle ++;
-		// reset ready count
-			ready_tasks = 0;
-        }
-
-		// wake all threads
-        cv_task.notify_all();
-
-		// generate white noise
-		for (i = 0; i < OutputParam.SampleFreq; i ++)
-			NoiseArray[i] = GenerateNoise(1.0);
-
-        // wait all threads complete
-		{
-			std::unique_lock<std::mutex> lock(mtx);
-			while (completed_tasks < TotalChannelNumber)
-				cv_done.wait(lock);
-//            std::cout << "all threads done for " << exec_cycle << std::endl;
-            completed_tasks = 0;
-        }
-
-		for (i = 0; i < TOTAL_SAT_CHANNEL; i++)
-		{
-			if (!SatIfSignal[i])
-				continue;
-//			SatIfSignal[i]->GetIfSample(CurTime);
-			for (j = 0; j < OutputParam.SampleFreq; j++)
-				NoiseArray[j] += SatIfSignal[i]->SampleArray[j];
-		}
-
-		if (OutputParam.Format == OutputFormatIQ2) 
-		{
-			TotalClippedSamples += QuantSamplesIQ2(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			// Pack 2 samples per byte
-			fwrite(QuantArray, sizeof(unsigned char), OutputParam.SampleFreq / 2, IfFile);	// 1/2 byte/sample
-		}
-		else if (OutputParam.Format == OutputFormatIQ4)
-		{
-			TotalClippedSamples += QuantSamplesIQ4(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			fwrite(QuantArray, sizeof(unsigned char), OutputParam.SampleFreq, IfFile);
-		}
-		else if (OutputParam.Format == OutputFormatIQ16)
-		{
-			TotalClippedSamples += QuantSamplesIQ16(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			fwrite(QuantArray, sizeof(unsigned char) * 4, OutputParam.SampleFreq, IfFile);
-		}
-		else
-		{
-			TotalClippedSamples += QuantSamplesIQ8(NoiseArray, OutputParam.SampleFreq, QuantArray, AGCGain);
-			fwrite(QuantArray, sizeof(unsigned char) * 2, OutputParam.SampleFreq, IfFile);
-		}
+		exec_cycle ++;
+		QuantArray = IfWriter->AcquireSlot();
+		TotalClippedSamples += GenerateMs(*Pool, TaskList);
+		IfWriter->SubmitSlot(QuantBytes);
 		TotalSamples += OutputParam.SampleFreq * 2; // I and Q
 
 #if 1
@@ -737,19 +1011,10 @@ int main(int argc, char* argv[])
 //		if (length == 2) break;
 	}
 
-	// terminate all threads
-	{
-		std::lock_guard<std::mutex> lock(mtx);
-		shutdown = true;
-		std::cout << "\nterminate all threads" << std::endl;
-	}
-	cv_task.notify_all();
-
-    // wait all threads complete
-	for (auto& t : threads)
-	{
-		if (t.joinable()) t.join();
-	}
+	// terminate all worker threads
+	std::cout << "\nterminate all threads" << std::endl;
+	SatParamPool = NULL;
+	delete Pool;
 	
 	// Final progress bar update to ensure 100% is shown
 	printf("\r[");
@@ -763,6 +1028,8 @@ int main(int argc, char* argv[])
 	printf("] %d/%d ms | %.2f/%.2f MB | \tCOMPLETED\n",
 		   totalDurationMs, totalDurationMs, totalMB, totalMB); 
 	
+	if (!IfWriter->Finish())
+		printf("[ERROR]\tFailed to write IF data file, output may be incomplete\n");
 	auto end_time = std::chrono::high_resolution_clock::now();
 	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 	double finalMB = (exec_cycle * bytesPerMs) / (1024.0 * 1024.0);
@@ -784,10 +1051,12 @@ int main(int argc, char* argv[])
 
 	for (i = 0; i < TOTAL_SAT_CHANNEL; i ++)
 		if (SatIfSignal[i]) delete SatIfSignal[i];
+	for (i = 0; i < TotalChannelNumber; i ++)
+		delete[] ChannelSamples[i];
 	for (i = 0; i < static_cast<int>(sizeof(NavBitArray) / sizeof(NavBitArray[0])); ++i)
 		delete NavBitArray[i];
 	delete[] NoiseArray;
-	delete[] QuantArray;
+	delete IfWriter;
 	fclose(IfFile);
 
 	return 0;
@@ -795,34 +1064,35 @@ int main(int argc, char* argv[])
 
 void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam)
 {
-	int i, index;
-	LLA_POSITION PosLLA = EcefToLla(CurPos);
-	int TotalSatNumber = 0;
-
+	int i, SatNumber = 0;
+	IF_TASK Task;
+
+	SatParamUpdate.Time = CurTime;
+	SatParamUpdate.Pos = CurPos;
+	SatParamUpdate.PosLLA = EcefToLla(CurPos);
+	SatParamUpdate.ListCount = ListCount;
+	SatParamUpdate.PowerList = PowerList;
 	for (i = 0; i < GpsSatNumber; i ++)
-	{
-		index = GpsEphVisible[i]->svid - 1;
-		GpsSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		GpsSatParam[index].UpdateCN0(ListCount, PowerList);
-	}
+		SatParamUpdate.SatParam[SatNumber ++] = &GpsSatParam[GpsEphVisible[i]->svid - 1];
 	for (i = 0; i < BdsSatNumber; i ++)
-	{
-		index = BdsEphVisible[i]->svid - 1;
-		BdsSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		BdsSatParam[index].UpdateCN0(ListCount, PowerList);
-	}
+		SatParamUpdate.SatParam[SatNumber ++] = &BdsSatParam[BdsEphVisible[i]->svid - 1];
 	for (i = 0; i < GalSatNumber; i ++)
+		SatParamUpdate.SatParam[SatNumber ++] = &GalSatParam[GalEphVisible[i]->svid - 1];
+	for (i = 0; i < GloSatNumber; i ++)
+		SatParamUpdate.SatParam[SatNumber ++] = &GloSatParam[GloEphVisible[i]->n - 1];
+
+	Task.Type = IfTaskSatParam;
+	Task.Start = Task.Count = Task.Index = 0;
+	for (i = 0; i < SatNumber; i ++)
 	{
-		index = GalEphVisible[i]->svid - 1;
-		GalSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		GalSatParam[index].UpdateCN0(ListCount, PowerList);
-	}
-	for (i = 0; i < GloSatNumber; i++)
-	{
-		index = GloEphVisible[i]->n - 1;
-		GloSatParam[index].CalculateParam(CurPos, PosLLA, CurTime);
-		GloSatParam[index].UpdateCN0(ListCount, PowerList);
+		Task.Channel = i;
+		if (SatParamPool)
+			SatParamPool->AddTask(i % SatParamPool->GetWorkerNumber(), Task);
+		else
+			ExecuteIfTask(Task);
 	}
+	if (SatParamPool)
+		SatParamPool->Run();
 }
 
 int StepToNextMs()
@@ -856,22 +1126,6 @@ int StepToNextMs()
 	return 0;
 }
 
-complex_number GenerateNoise(double Sigma)
-{
-	double fvalue1, fvalue2, mag;
-
-	// Marsaglia Polar method (improved Box-Muller method)
-    do
-	{
-        fvalue1 = 2.0 * ((double)rand() / RAND_MAX) - 1.0;
-        fvalue2 = 2.0 * ((double)rand() / RAND_MAX) - 1.0;
-        mag = fvalue1 * fvalue1 + fvalue2 * fvalue2;
-    } while (mag >= 1.0 || mag == 0.0);
-	mag = sqrt(-2.0 * log(mag) / mag) * Sigma;
-
-	return complex_number(fvalue1 * mag, fvalue2 * mag);
-}
-
 NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray[])
 {
 	switch (SatSystem)
@@ -922,159 +1176,6 @@ NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray
 	}
 }
 
-// PocketSDR compatible 2-bit IQ quantization 
-// (TODO: Test)
-// (FIXME: Optimize)
- int QuantSamplesIQ2(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
- {
-	int ClippedCount = 0;
-	const double threshold = 1.1 / GainScale;	// the optimal threshold for Gauss noise is Sigma, increase a little to compensate added signal power
-	const double ClippedThreshold = 5 * threshold;	// clip threshold set to 5 Sigma
-	double Value;
-	unsigned char QuantByte;
-
-     // Process 2 complex samples at a time to produce 1 byte of output.
-     // Bit definition within each byte is (from MSB): Sign-Q2, Mag-Q2, Sign-I2, Mag-I2, Sign-Q1, Mag-Q1, Sign-I1, Mag-I1
-    for (int i = 0; i < Length; i += 2)
-    {
-		QuantByte = (Samples[i].real < 0.0) ? 2 : 0;
-		Value = fabs(Samples[i].real);
-		QuantByte |= (Value < threshold) ? 0 : 1;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-		QuantByte |= (Samples[i].imag < 0.0) ? 8 : 0;
-		Value = fabs(Samples[i].imag);
-		QuantByte |= (Value < threshold) ? 0 : 4;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-
-		QuantByte = (Samples[i+1].real < 0.0) ? 0x20 : 0;
-		Value = fabs(Samples[i+1].real);
-		QuantByte |= (Value < threshold) ? 0 : 0x10;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-		QuantByte |= (Samples[i+1].imag < 0.0) ? 0x80 : 0;
-		Value = fabs(Samples[i+1].imag);
-		QuantByte |= (Value < threshold) ? 0 : 0x40;
-		if (Value >= ClippedThreshold) ClippedCount ++;
-	}
-
-	return ClippedCount;
-}
-
-int QuantSamplesIQ4(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
-{
-	int i;
-	double Value;
-	unsigned char QuantValue, QuantSample;
-	const double Gain = GainScale * 3.0;
-	int ClippedCount = 0;
-
-	for (i = 0; i < Length; i++)
-	{
-		Value = fabs(Samples[i].real);
-		QuantValue = (int)(Value * Gain);	// optimal quantization for sigma=1 noise
-		if (QuantValue > 7)
-		{
-			QuantValue = 7;
-			ClippedCount ++;
-		}
-		QuantValue += ((Samples[i].real >= 0) ? 0 : (1 << 3));	// add sign bit as MSB
-		QuantSample = QuantValue << 4;
-		Value = fabs(Samples[i].imag);
-		QuantValue = (int)(Value * Gain);	// optimal quantization for sigma=1 noise
-		if (QuantValue > 7)
-		{
-			QuantValue = 7;
-			ClippedCount ++;
-		}
-		QuantValue += ((Samples[i].imag >= 0) ? 0 : (1 << 3));	// add sign bit as MSB
-		QuantSample |= QuantValue;
-		QuantSamples[i] = QuantSample;
-	}
-
-	return ClippedCount;
-}
-
-int QuantSamplesIQ8(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
-{
-	int i;
-	int QuantValue;
-	const double Gain = GainScale * 25.0;
-	int ClippedCount = 0;
-
-	for (i = 0; i < Length; i++)
-	{
-		QuantValue = (int)(Samples[i].real * Gain);	// sigma scaled at 25 -> +-5 sigma scaled within range of INT8
-		if (QuantValue > 127)	// saturate at -128~127
-		{
-			QuantValue = 127;
-			ClippedCount ++;
-		}
-		else if (QuantValue < -128)
-		{
-			QuantValue = -128;
-			ClippedCount ++;
-		}
-		QuantSamples[i * 2] = (unsigned char)(QuantValue & 0xff);
-		QuantValue = (int)(Samples[i].imag * Gain);	// sigma scaled at 25 -> +-5 sigma scaled within range of INT8
-		if (QuantValue > 127)	// saturate at -128~127
-		{
-			QuantValue = 127;
-			ClippedCount ++;
-		}
-		else if (QuantValue < -128)
-		{
-			QuantValue = -128;
-			ClippedCount ++;
-		}
-		QuantSamples[i * 2 + 1] = (unsigned char)(QuantValue & 0xff);
-	}
-
-	return ClippedCount;
-}
-
-int QuantSamplesIQ16(complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale)
-{
-    int i;
-    int QuantValue;
-    
-    const double Gain = GainScale * 3277;
-    int ClippedCount = 0;
-
-    for (i = 0; i < Length; i++)
-    {
-        QuantValue = (int)(Samples[i].real * Gain);  
-        if (QuantValue > 32767)  
-        {
-            QuantValue = 32767;
-            ClippedCount++;
-        }
-        else if (QuantValue < -32768)
-        {
-            QuantValue = -32768;
-            ClippedCount++;
-        }
-
-		QuantSamples[i * 4] = (unsigned char)(QuantValue & 0xff);    
-		QuantSamples[i * 4 + 1] = (unsigned char)((QuantValue >> 8) & 0xff);
-
-		QuantValue = (int)(Samples[i].imag * Gain); 
-		if (QuantValue > 32767) 
-		{
-			QuantValue = 32767;
-			ClippedCount++;
-		}
-		else if (QuantValue < -32768)
-		{
-			QuantValue = -32768;
-			ClippedCount++;
-		}
-
-		QuantSamples[i * 4 + 2] = (unsigned char)(QuantValue & 0xff);  
-		QuantSamples[i * 4 + 3] = (unsigned char)((QuantValue >> 8) & 0xff); 
-    }
-
-    return ClippedCount;
-}
-
 void ShowHelp(const char* ProgramPath)
 {
 	// Extract just the executable name from the path
@@ -1094,6 +1195,7 @@ void ShowHelp(const char* ProgramPath)
 	std::cout << "   -vo, 	--validate-only    Validate configuration and exit\n";
 	std::cout << "   -mt, 	--multi-thread     Force use multi-thread\n";
 	std::cout << "   -st, 	--single-thread    Force use single-thread\n";
+	std::cout << "   -w,  	--workers <N>      Number of worker threads (default: hardware concurrency)\n";
 	std::cout << "   -t,  	--tag              Output tag file (output file name with .tag appended)\n";
 	std::cout << "   -v, 	--version          Show version information\n";
 	std::cout << "   -h, 	--help             Show this help message\n\n";
@@ -1114,6 +1216,7 @@ bool ParseCommandLineArgs(int argc, char* argv[], CommandArguments &Arguments)
 		"--multi-thread", "-mt",	// 4
 		"--single-thread", "-st",	// 5
 		"--tag", "-t",	// 6
+		"--workers", "-w",	// 7
 	};
 	std::string arg;
 	int i = 1, index;
@@ -1149,12 +1252,22 @@ bool ParseCommandLineArgs(int argc, char* argv[], CommandArguments &Arguments)
 			Arguments.ValidateOnly = true;
 			break;
 		case 4:	// --multi-thread
+			Arguments.Workers = std::max((int)std::thread::hardware_concurrency(), 1);
+			break;
 		case 5:	// --single-thread
-			std::cerr << "[WARNING] " << arg << " ignored in multi-thread version\n";
+			Arguments.Workers = 1;
 			break;
 		case 6:	// --tag
 			Arguments.OutputTag = true;
 			break;
+		case 7:	// --workers
+			if (i + 1 >= argc || atoi(argv[i+1]) <= 0)
+			{
+				std::cerr << "[ERROR] " << arg << " requires a positive number\n";
+				return false;
+			}
+			Arguments.Workers = atoi(argv[++i]);
+			break;
 		default:
 			std::cout << "[WARNING] Unknown option " << arg << "\n";
 		}
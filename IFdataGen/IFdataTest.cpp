@@ -0,0 +1,2081 @@
+#include <stdio.h>
+#include <memory.h>
+#include <math.h>
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "SignalSim.h"
+#include "OrbitCache.h"
+#include "OrbitBatch.h"
+#include "FastMath.h"
+#include "IfQuantize.h"
+#include "IfNoise.h"
+
+// Checks of IF synthesis, noise, quantization, orbit and atmosphere delay calculation run on the
+// scenario of a configuration file. Each check compares optimized code paths against reference
+// calculation, prints a table of error and speed, and returns non-zero exit code on failure
+
+#define TOTAL_GPS_SAT 32
+#define TOTAL_BDS_SAT 63
+#define TOTAL_GAL_SAT 36
+#define TOTAL_GLO_SAT 24
+#define TOTAL_SAT_CHANNEL 128
+#define TOTAL_SAT_NUMBER (TOTAL_GPS_SAT + TOTAL_BDS_SAT + TOTAL_GAL_SAT + TOTAL_GLO_SAT)
+
+typedef enum {
+    DataBitLNav, DataBitCNav, DataBitCNav2, // for GPS
+    DataBitGNav, DataBitGNav2,	// for GLONASS
+    DataBitD1D2, DataBitBCNav1, DataBitBCNav2, DataBitBCNav3,	// for BDS
+    DataBitINav, DataBitFNav, DataBitECNav,	// for Galileo
+    DataBitSbas, // for SBAS
+} DataBitType;
+
+struct TestArguments
+{
+	std::string Check;
+	std::string ConfigFile;
+	std::string Kernel;
+	std::string ChipRun;
+	std::string SampleType;
+	unsigned long long NoiseSeed;
+	int NoisePoolMs;	// noise pool length in milliseconds of samples, 0 for exact noise
+	int NoisePeriod;
+	double OrbitInterval;	// satellite orbit interpolation node interval in second, 0 to calculate from ephemeris
+	double AtmosInterval;	// atmosphere delay interpolation node interval in second, 0 to calculate each millisecond
+	int AtmosOrder;	// atmosphere delay interpolation order, 1 for linear, 2 for quadratic
+};
+
+int LoadScenario(const TestArguments &Arguments, KINEMATIC_INFO &CurPos, CSatIfSignal *SatIfSignal[]);
+void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam);
+int StepToNextMs();
+NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray[]);
+void DeleteChannels(CSatIfSignal *SatIfSignal[]);
+
+template <typename T> int KernelReport(CSatIfSignal *SatIfSignal[], int ChannelNumber);
+template <typename T> int VariantReport(CSatIfSignal *SatIfSignal[], int ChannelNumber);
+template <typename T> int SplitReport(CSatIfSignal *SatIfSignal[], int ChannelNumber);
+int PrecisionReport(CSatIfSignal *SatIfSignal[], int ChannelNumber);
+int Cn0Report(CSatIfSignal *SatIfSignal[], int ChannelNumber);
+int CarrierReport();
+int QuantReport();
+int NoiseReport();
+int PoolReport(int MsSampleNumber);
+int OrbitReport(double Interval);
+int AtmosReport(KINEMATIC_INFO Position, double Interval, int Order);
+
+void ShowHelp(const char* ProgramName);
+bool ParseCommandLineArgs(int argc, char* argv[], TestArguments &Arguments);
+
+CTrajectory Trajectory;
+CPowerControl PowerControl;
+CNavData NavData;
+OUTPUT_PARAM OutputParam;
+GNSS_TIME CurTime;
+PGPS_EPHEMERIS GpsEph[TOTAL_GPS_SAT], GpsEphVisible[TOTAL_GPS_SAT];
+PGPS_EPHEMERIS BdsEph[TOTAL_BDS_SAT], BdsEphVisible[TOTAL_BDS_SAT];
+PGPS_EPHEMERIS GalEph[TOTAL_GAL_SAT], GalEphVisible[TOTAL_GAL_SAT];
+PGLONASS_EPHEMERIS GloEph[TOTAL_GLO_SAT], GloEphVisible[TOTAL_GLO_SAT];
+CSatelliteParam GpsSatParam[TOTAL_GPS_SAT], BdsSatParam[TOTAL_BDS_SAT], GalSatParam[TOTAL_GAL_SAT], GloSatParam[TOTAL_GLO_SAT];
+int GpsSatNumber, BdsSatNumber, GalSatNumber, GloSatNumber;	// number of visible satellite
+CIonoKlobuchar8 SatIonoModel;	// ionosphere model referenced by satellite parameters
+LNavBit LNav;
+CNavBit CNav;
+CNav2Bit CNav2;
+GNavBit GNav;
+D1D2NavBit D1D2Nav;
+BCNav1Bit BCNav1;
+BCNav2Bit BCNav2;
+BCNav3Bit BCNav3;
+INavBit INav;
+FNavBit FNav;
+NavBit *NavBitArray[] = { &LNav, &CNav, &CNav2, &GNav, NULL, &D1D2Nav, &BCNav1, &BCNav2, &BCNav3, &INav, &FNav, NULL };	// in order of DataBitType
+const int SignalCenterFreq[][8] = {
+	{ FREQ_GPS_L1, FREQ_GPS_L1, FREQ_GPS_L2, FREQ_GPS_L2, FREQ_GPS_L5 },
+	{ FREQ_BDS_B1C, FREQ_BDS_B1I, FREQ_BDS_B2I, FREQ_BDS_B3I, FREQ_BDS_B2a, FREQ_BDS_B2b, FREQ_BDS_B2ab },
+	{ FREQ_GAL_E1, FREQ_GAL_E5a, FREQ_GAL_E5b, FREQ_GAL_E5, FREQ_GAL_E6 },
+	{ FREQ_GLO_G1, FREQ_GLO_G2 },
+};
+const char *SignalName[][8] = {
+	{ "L1CA", "L1C", "L2C", "L2P", "L5", },
+	{ "B1C", "B1I", "B2I", "B3I", "B2a", "B2b", "B2ab", },
+	{ "E1", "E5a", "E5b", "E5", "E6", },
+	{ "G1", "G2", },
+};
+
+int main(int argc, char* argv[])
+{
+	KINEMATIC_INFO CurPos;
+	CSatIfSignal* SatIfSignal[TOTAL_SAT_CHANNEL];
+	int ChannelNumber, Failed;
+	TestArguments Arguments;
+
+	// Default arguments
+	Arguments.ConfigFile = "configs/test/GPS_L1CA_L1C.json";
+	Arguments.NoiseSeed = IF_NOISE_SEED;
+	Arguments.NoisePoolMs = 0;
+	Arguments.NoisePeriod = 0;
+	Arguments.OrbitInterval = ORBIT_NODE_INTERVAL;
+	Arguments.AtmosInterval = ATMOS_UPDATE_INTERVAL;
+	Arguments.AtmosOrder = 2;
+
+	SetOutputFile(stdout);
+
+	if (argc == 1)
+	{
+		ShowHelp(argv[0]);
+		return 0;
+	}
+
+	if (!ParseCommandLineArgs(argc, argv, Arguments))
+		return 1;
+	if (Arguments.Check != "kernel" && Arguments.Check != "precision" && Arguments.Check != "cn0" && Arguments.Check != "carrier" && Arguments.Check != "variant" && Arguments.Check != "split" && Arguments.Check != "quant" && Arguments.Check != "noise" && Arguments.Check != "pool" && Arguments.Check != "orbit" && Arguments.Check != "atmos")
+	{
+		std::cerr << "[ERROR]\tUnknown check " << Arguments.Check << "\n";
+		return 1;
+	}
+	if (!Arguments.Kernel.empty() && ((IfKernelFromName(Arguments.Kernel.c_str()) == IfKernelAuto && Arguments.Kernel != "auto") || !SetIfKernelIsa(IfKernelFromName(Arguments.Kernel.c_str()))))
+	{
+		std::cerr << "[ERROR]\tIF sample kernel " << Arguments.Kernel << " not supported\n";
+		return 1;
+	}
+	SetIfNoiseSeed(Arguments.NoiseSeed);
+	if (Arguments.ChipRun == "on")
+		SetIfChipRunMode(IfChipRunOn);
+	else if (Arguments.ChipRun == "off")
+		SetIfChipRunMode(IfChipRunOff);
+	else if (!Arguments.ChipRun.empty() && Arguments.ChipRun != "auto")
+	{
+		std::cerr << "[ERROR]\tUnknown chip run mode " << Arguments.ChipRun << "\n";
+		return 1;
+	}
+	if (!Arguments.SampleType.empty() && Arguments.SampleType != "double" && Arguments.SampleType != "float" && Arguments.SampleType != "int16")
+	{
+		std::cerr << "[ERROR]\tUnknown sample type " << Arguments.SampleType << "\n";
+		return 1;
+	}
+	if (Arguments.NoisePeriod > 0 && Arguments.NoisePoolMs == 0)
+	{
+		std::cerr << "[ERROR]\tNoise period only applies to noise pool, use --noise-pool\n";
+		return 1;
+	}
+
+	if ((ChannelNumber = LoadScenario(Arguments, CurPos, SatIfSignal)) < 0)
+		return 1;
+	printf("[INFO]\tCheck %s on %s, %d channels\n", Arguments.Check.c_str(), Arguments.ConfigFile.c_str(), ChannelNumber);
+	printf("[INFO]\tIF sample kernel: %s\n", IfKernelName(GetIfKernelIsa()));
+	printf("[INFO]\tIF sample type: %s\n", (OutputParam.SampleType == IfSampleFloat) ? "float" : (OutputParam.SampleType == IfSampleInt16) ? "int16" : "double");
+	if (Arguments.NoisePoolMs > 0)
+		SetIfNoisePool((long long)Arguments.NoisePoolMs * OutputParam.SampleFreq, Arguments.NoisePeriod, OutputParam.SampleType);
+
+	if (Arguments.Check == "precision")
+		Failed = PrecisionReport(SatIfSignal, ChannelNumber);
+	else if (Arguments.Check == "cn0")
+		Failed = Cn0Report(SatIfSignal, ChannelNumber);
+	else if (Arguments.Check == "carrier")
+		Failed = CarrierReport();
+	else if (Arguments.Check == "quant")
+		Failed = QuantReport();
+	else if (Arguments.Check == "noise")
+		Failed = NoiseReport();
+	else if (Arguments.Check == "pool")
+		Failed = PoolReport(OutputParam.SampleFreq);
+	else if (Arguments.Check == "orbit")
+		Failed = OrbitReport(Arguments.OrbitInterval);
+	else if (Arguments.Check == "atmos")
+		Failed = AtmosReport(CurPos, Arguments.AtmosInterval, Arguments.AtmosOrder);
+	else if (Arguments.Check == "variant")
+		Failed = (OutputParam.SampleType == IfSampleFloat) ? VariantReport<complex_float>(SatIfSignal, ChannelNumber) :
+			(OutputParam.SampleType == IfSampleInt16) ? VariantReport<complex_int16>(SatIfSignal, ChannelNumber) : VariantReport<complex_number>(SatIfSignal, ChannelNumber);
+	else if (Arguments.Check == "split")
+		Failed = (OutputParam.SampleType == IfSampleFloat) ? SplitReport<complex_float>(SatIfSignal, ChannelNumber) :
+			(OutputParam.SampleType == IfSampleInt16) ? SplitReport<complex_int16>(SatIfSignal, ChannelNumber) : SplitReport<complex_number>(SatIfSignal, ChannelNumber);
+	else if (OutputParam.SampleType == IfSampleFloat)
+		Failed = KernelReport<complex_float>(SatIfSignal, ChannelNumber);
+	else if (OutputParam.SampleType == IfSampleInt16)
+		Failed = KernelReport<complex_int16>(SatIfSignal, ChannelNumber);
+	else
+		Failed = KernelReport<complex_number>(SatIfSignal, ChannelNumber);
+	printf("[INFO]\tCheck %s %s\n", Arguments.Check.c_str(), Failed ? "FAILED" : "PASSED");
+
+	DeleteChannels(SatIfSignal);
+	return Failed ? 1 : 0;
+}
+
+// read configuration file and set up the scenario at its start time the same way as IFdataGen:
+// ephemerides, visible satellites, satellite parameters and one channel for each visible
+// satellite of each signal within IF band. Return number of channels, -1 on failure
+int LoadScenario(const TestArguments &Arguments, KINEMATIC_INFO &CurPos, CSatIfSignal *SatIfSignal[])
+{
+	const int SatTotal[4] = { TOTAL_GPS_SAT, TOTAL_BDS_SAT, TOTAL_GAL_SAT, TOTAL_GLO_SAT };
+	const int SignalLast[4] = { SIGNAL_INDEX_L5, SIGNAL_INDEX_B2b, SIGNAL_INDEX_E6, SIGNAL_INDEX_G2 };	// same signals as IFdataGen creates channels for
+	CSatelliteParam *SatParam[4] = { GpsSatParam, BdsSatParam, GalSatParam, GloSatParam };
+	PGPS_EPHEMERIS *Eph[3] = { GpsEph, BdsEph, GalEph }, *EphVisible[3] = { GpsEphVisible, BdsEphVisible, GalEphVisible };
+	int i, System, SignalIndex, Svid, IfFreq, FdmaOffset, FreqLow, FreqHigh, ChannelNumber = 0;
+	JsonStream JsonTree;
+	UTC_TIME UtcTime;
+	LLA_POSITION StartPos;
+	LOCAL_SPEED StartVel;
+	GLONASS_TIME GlonassTime;
+	GNSS_TIME BdsTime;
+	int ListCount;
+	PSIGNAL_POWER PowerList;
+
+	memset(SatIfSignal, 0, sizeof(CSatIfSignal *) * TOTAL_SAT_CHANNEL);
+	printf("[INFO]\tLoading JSON file: %s\n", Arguments.ConfigFile.c_str());
+	if (JsonTree.ReadFile(Arguments.ConfigFile.c_str()) != 0)
+	{
+		std::cerr << "[ERROR]\tUnable to read JSON file: " << Arguments.ConfigFile << "\n";
+		return -1;
+	}
+	SetJsonFilePath(Arguments.ConfigFile.c_str());
+	AssignParameters(JsonTree.GetRootObject(), &UtcTime, &StartPos, &StartVel, &Trajectory, &NavData, &OutputParam, &PowerControl, NULL);
+	if (!Arguments.SampleType.empty())
+		OutputParam.SampleType = (Arguments.SampleType == "float") ? IfSampleFloat : (Arguments.SampleType == "int16") ? IfSampleInt16 : IfSampleDouble;
+
+	Trajectory.ResetTrajectoryTime();
+	CurTime = UtcToGpsTime(UtcTime);
+	GlonassTime = UtcToGlonassTime(UtcTime);
+	BdsTime = UtcToBdsTime(UtcTime);
+	CurPos = LlaToEcef(StartPos);
+	SpeedLocalToEcef(StartPos, StartVel, CurPos);
+
+	// remove signals out of IF band
+	FreqLow = (OutputParam.CenterFreq - OutputParam.SampleFreq / 2) * 1000;
+	FreqHigh = (OutputParam.CenterFreq + OutputParam.SampleFreq / 2) * 1000;
+	for (System = GpsSystem; System <= GlonassSystem; System ++)
+		for (SignalIndex = 0; SignalIndex <= SignalLast[System]; SignalIndex ++)
+			if (SignalCenterFreq[System][SignalIndex] < FreqLow || SignalCenterFreq[System][SignalIndex] > FreqHigh)
+				OutputParam.FreqSelect[System] &= ~(1 << SignalIndex);
+
+	// navigation data of each system
+	NavBitArray[DataBitLNav]->SetIonoUtc(NavData.GetGpsIono(), NavData.GetGpsUtcParam());
+	NavBitArray[DataBitCNav]->SetIonoUtc(NavData.GetGpsIono(), NavData.GetGpsUtcParam());
+	NavBitArray[DataBitCNav2]->SetIonoUtc(NavData.GetGpsIono(), NavData.GetGpsUtcParam());
+	NavBitArray[DataBitD1D2]->SetIonoUtc(NavData.GetBdsIono(), NavData.GetBdsUtcParam());
+	NavBitArray[DataBitINav]->SetIonoUtc(NavData.GetGalileoIono(), NavData.GetGalileoUtcParam());
+	NavBitArray[DataBitFNav]->SetIonoUtc(NavData.GetGalileoIono(), NavData.GetGalileoUtcParam());
+	for (i = 1; i <= TOTAL_GPS_SAT; i ++)
+	{
+		GpsEph[i-1] = NavData.FindEphemeris(GpsSystem, CurTime, i);
+		NavBitArray[DataBitLNav]->SetEphemeris(i, GpsEph[i - 1]);
+		NavBitArray[DataBitCNav]->SetEphemeris(i, GpsEph[i - 1]);
+		NavBitArray[DataBitCNav2]->SetEphemeris(i, GpsEph[i - 1]);
+	}
+	for (i = 1; i <= TOTAL_BDS_SAT; i ++)
+	{
+		BdsEph[i-1] = NavData.FindEphemeris(BdsSystem, BdsTime, i);
+		NavBitArray[DataBitD1D2]->SetEphemeris(i, BdsEph[i - 1]);
+		NavBitArray[DataBitBCNav1]->SetEphemeris(i, BdsEph[i - 1]);
+		NavBitArray[DataBitBCNav2]->SetEphemeris(i, BdsEph[i - 1]);
+		NavBitArray[DataBitBCNav3]->SetEphemeris(i, BdsEph[i - 1]);
+	}
+	for (i = 1; i <= TOTAL_GAL_SAT; i++)
+	{
+		GalEph[i - 1] = NavData.FindEphemeris(GalileoSystem, CurTime, i);
+		NavBitArray[DataBitINav]->SetEphemeris(i, GalEph[i - 1]);
+		NavBitArray[DataBitFNav]->SetEphemeris(i, GalEph[i - 1]);
+	}
+	for (i = 1; i <= TOTAL_GLO_SAT; i++)
+	{
+		GloEph[i - 1] = NavData.FindGloEphemeris(GlonassTime, i);
+		NavBitArray[DataBitGNav]->SetEphemeris(i, (PGPS_EPHEMERIS)GloEph[i - 1]);
+	}
+	NavData.CompleteAlmanac(BdsSystem, UtcTime);
+	NavData.CompleteAlmanac(GalileoSystem, UtcTime);
+	NavBitArray[DataBitLNav]->SetAlmanac(NavData.GetGpsAlmanac());
+	NavBitArray[DataBitCNav]->SetAlmanac(NavData.GetGpsAlmanac());
+	NavBitArray[DataBitCNav2]->SetAlmanac(NavData.GetGpsAlmanac());
+	NavBitArray[DataBitD1D2]->SetAlmanac(NavData.GetBdsAlmanac());
+	NavBitArray[DataBitBCNav1]->SetAlmanac(NavData.GetBdsAlmanac());
+	NavBitArray[DataBitBCNav2]->SetAlmanac(NavData.GetBdsAlmanac());
+	NavBitArray[DataBitBCNav3]->SetAlmanac(NavData.GetBdsAlmanac());
+	NavBitArray[DataBitINav]->SetAlmanac(NavData.GetGalileoAlmanac());
+	NavBitArray[DataBitFNav]->SetAlmanac(NavData.GetGalileoAlmanac());
+	NavBitArray[DataBitGNav]->SetAlmanac((PGPS_ALMANAC)NavData.GetGlonassAlmanac());
+
+	// visible satellites and their parameters at start time
+	GpsSatNumber = (OutputParam.FreqSelect[GpsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GpsSystem, GpsEph, TOTAL_GPS_SAT, GpsEphVisible) : 0;
+	BdsSatNumber = (OutputParam.FreqSelect[BdsSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, BdsSystem, BdsEph, TOTAL_BDS_SAT, BdsEphVisible) : 0;
+	GalSatNumber = (OutputParam.FreqSelect[GalileoSystem]) ? GetVisibleSatellite(CurPos, CurTime, OutputParam, GalileoSystem, GalEph, TOTAL_GAL_SAT, GalEphVisible) : 0;
+	GloSatNumber = (OutputParam.FreqSelect[GlonassSystem]) ? GetGlonassVisibleSatellite(CurPos, GlonassTime, OutputParam, GloEph, TOTAL_GLO_SAT, GloEphVisible) : 0;
+	const int SatNumber[4] = { GpsSatNumber, BdsSatNumber, GalSatNumber, GloSatNumber };
+
+	SatIonoModel.SetIonoParam(NavData.GetGpsIono());
+	for (System = GpsSystem; System <= GlonassSystem; System ++)
+		for (i = 0; i < SatTotal[System]; i ++)
+		{
+			SatParam[System][i].Initialize((GnssSystem)System, (System == GlonassSystem) ? (PGPS_EPHEMERIS)GloEph[i] : Eph[System][i], &SatIonoModel, PowerControl.InitCN0, PowerControl.Adjust);
+			if (Arguments.OrbitInterval != ORBIT_NODE_INTERVAL)
+				SatParam[System][i].SetOrbitInterval(Arguments.OrbitInterval);
+			if (Arguments.AtmosInterval != ATMOS_UPDATE_INTERVAL || Arguments.AtmosOrder != 2)
+				SatParam[System][i].SetAtmosInterval(Arguments.AtmosInterval, Arguments.AtmosOrder);
+		}
+	ListCount = PowerControl.GetPowerControlList(0, PowerList);
+	UpdateSatParamList(CurTime, CurPos, ListCount, PowerList, NavData.GetGpsIono());
+
+	// channels in the same order as IFdataGen
+	for (System = GpsSystem; System <= GlonassSystem; System ++)
+		for (SignalIndex = 0; SignalIndex <= SignalLast[System]; SignalIndex ++)
+		{
+			if (!(OutputParam.FreqSelect[System] & (1 << SignalIndex)))
+				continue;
+			IfFreq = SignalCenterFreq[System][SignalIndex] - OutputParam.CenterFreq * 1000;
+			for (i = 0; i < SatNumber[System] && ChannelNumber < TOTAL_SAT_CHANNEL; i ++)
+			{
+				if (System == GlonassSystem)
+				{
+					Svid = GloEphVisible[i]->n;
+					FdmaOffset = (SignalIndex == SIGNAL_INDEX_G1) ? GloEphVisible[i]->freq * 562500 : GloEphVisible[i]->freq * 437500;
+				}
+				else
+				{
+					Svid = EphVisible[System][i]->svid;
+					FdmaOffset = 0;
+				}
+				SatIfSignal[ChannelNumber] = new CSatIfSignal(OutputParam.SampleFreq, IfFreq + FdmaOffset, (GnssSystem)System, SignalIndex, Svid, OutputParam.SampleType);
+				SatIfSignal[ChannelNumber ++]->InitState(CurTime, &SatParam[System][Svid - 1], GetNavData((GnssSystem)System, SignalIndex, NavBitArray));
+			}
+		}
+
+	return ChannelNumber;
+}
+
+// visible satellite parameters of all systems
+static int GetVisibleSatParam(CSatelliteParam *SatParamList[])
+{
+	int i, Number = 0;
+
+	for (i = 0; i < GpsSatNumber; i ++)
+		SatParamList[Number ++] = &GpsSatParam[GpsEphVisible[i]->svid - 1];
+	for (i = 0; i < BdsSatNumber; i ++)
+		SatParamList[Number ++] = &BdsSatParam[BdsEphVisible[i]->svid - 1];
+	for (i = 0; i < GalSatNumber; i ++)
+		SatParamList[Number ++] = &GalSatParam[GalEphVisible[i]->svid - 1];
+	for (i = 0; i < GloSatNumber; i ++)
+		SatParamList[Number ++] = &GloSatParam[GloEphVisible[i]->n - 1];
+	return Number;
+}
+
+void UpdateSatParamList(GNSS_TIME CurTime, KINEMATIC_INFO CurPos, int ListCount, PSIGNAL_POWER PowerList, PIONO_PARAM IonoParam)
+{
+	CSatelliteParam *SatParamList[TOTAL_SAT_NUMBER];
+	int i, SatNumber = GetVisibleSatParam(SatParamList);
+	LLA_POSITION PosLLA = EcefToLla(CurPos);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic) if (SatNumber > 1)
+#endif
+	for (i = 0; i < SatNumber; i ++)
+	{
+		SatParamList[i]->CalculateParam(CurPos, PosLLA, CurTime);
+		SatParamList[i]->UpdateCN0(ListCount, PowerList);
+	}
+}
+
+int StepToNextMs()
+{
+	KINEMATIC_INFO CurPos;
+	int ListCount = 0;
+	PSIGNAL_POWER PowerList = NULL;
+
+	if (!Trajectory.GetNextPosVelECEF(0.001, CurPos))
+		return -1;
+
+	ListCount = PowerControl.GetPowerControlList(1, PowerList);
+	if (++CurTime.MilliSeconds > 604800000)
+	{
+		CurTime.Week ++;
+		CurTime.MilliSeconds -= 604800000;
+	}
+	UpdateSatParamList(CurTime, CurPos, ListCount, PowerList, NavData.GetGpsIono());
+	return 0;
+}
+
+NavBit* GetNavData(GnssSystem SatSystem, int SatSignalIndex, NavBit* NavBitArray[])
+{
+	switch (SatSystem)
+	{
+	case GpsSystem:
+		switch (SatSignalIndex)
+		{
+		case SIGNAL_INDEX_L1CA: return NavBitArray[DataBitLNav];
+		case SIGNAL_INDEX_L1C:  return NavBitArray[DataBitCNav2];
+		case SIGNAL_INDEX_L2C:  return NavBitArray[DataBitCNav];
+		case SIGNAL_INDEX_L2P:  return NavBitArray[DataBitLNav];
+		case SIGNAL_INDEX_L5:   return NavBitArray[DataBitCNav];
+		default: return NavBitArray[DataBitLNav];
+		}
+		break;
+	case BdsSystem:
+		switch (SatSignalIndex)
+		{
+		case SIGNAL_INDEX_B1C: return NavBitArray[DataBitBCNav1];
+		case SIGNAL_INDEX_B1I: return NavBitArray[DataBitD1D2];
+		case SIGNAL_INDEX_B2I: return NavBitArray[DataBitD1D2];
+		case SIGNAL_INDEX_B3I: return NavBitArray[DataBitD1D2];
+		case SIGNAL_INDEX_B2a: return NavBitArray[DataBitBCNav2];
+		case SIGNAL_INDEX_B2b: return NavBitArray[DataBitBCNav3];
+		default: return NavBitArray[DataBitD1D2];
+		}
+		break;
+	case GalileoSystem:
+		switch (SatSignalIndex)
+		{
+		case SIGNAL_INDEX_E1:  return NavBitArray[DataBitINav];
+		case SIGNAL_INDEX_E5a: return NavBitArray[DataBitFNav];
+		case SIGNAL_INDEX_E5b: return NavBitArray[DataBitINav];
+		case SIGNAL_INDEX_E5:  return NavBitArray[DataBitFNav];
+		case SIGNAL_INDEX_E6:  return NavBitArray[DataBitECNav];
+		default: return NavBitArray[DataBitINav];
+		}
+		break;
+	case GlonassSystem:
+		switch (SatSignalIndex)
+		{
+		case SIGNAL_INDEX_G1: return NavBitArray[DataBitGNav];
+		case SIGNAL_INDEX_G2: return NavBitArray[DataBitGNav];
+		default: return NavBitArray[DataBitINav];
+		}
+		break;
+	default: return NavBitArray[DataBitLNav];
+	}
+}
+
+// delete channels created by LoadScenario(), NULL for channels not created
+void DeleteChannels(CSatIfSignal *SatIfSignal[])
+{
+	int i;
+
+	for (i = 0; i < TOTAL_SAT_CHANNEL; i ++)
+		if (SatIfSignal[i]) delete SatIfSignal[i];
+}
+
+// Compare each supported IF sample kernel, with and without chip run engine,
+// against the per-sample scalar kernel on the configured scenario. All kernels
+// share the same fixed point code/carrier NCO, so the only difference allowed
+// is floating point rounding (int16 kernels must be bit exact), the error is
+// normalized to the peak amplitude of each channel
+#define KERNEL_REPORT_MS 200
+#define KERNEL_TOLERANCE 1e-12
+#define KERNEL_TOLERANCE_FLOAT 1e-6
+#define KERNEL_TOLERANCE_INT16 0.
+
+// reports comparing channels check nothing without visible channel, which is a failure
+static bool ReportHasChannel(int ChannelNumber)
+{
+	if (ChannelNumber > 0)
+		return true;
+	std::cerr << "[ERROR]\tNo visible channels, nothing checked\n";
+	return false;
+}
+
+template <typename T> int KernelReport(CSatIfSignal *SatIfSignal[], int ChannelNumber)
+{
+	if (!ReportHasChannel(ChannelNumber))
+		return 1;
+
+	int i, j, ms, Failed = 0;
+	int Variant, VariantNumber = (DetectIfKernelIsa() + 1) * 2;	// each kernel without/with chip run
+	T *Reference = new T[OutputParam.SampleFreq];
+	T *Result = new T[OutputParam.SampleFreq];
+	double Tolerance = (IfSampleTraits<T>::Type == IfSampleFloat) ? KERNEL_TOLERANCE_FLOAT : (IfSampleTraits<T>::Type == IfSampleInt16) ? KERNEL_TOLERANCE_INT16 : KERNEL_TOLERANCE;
+	double MaxError[IfKernelAuto * 2], Time[IfKernelAuto * 2];
+	double Peak, Error;
+	char Name[16];
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (Variant = 0; Variant < VariantNumber; Variant ++)
+		MaxError[Variant] = Time[Variant] = 0.;
+	printf("[INFO]\tComparing IF sample kernels on %d channels for %d ms...\n", ChannelNumber, KERNEL_REPORT_MS);
+	for (ms = 0; ms < KERNEL_REPORT_MS && !StepToNextMs(); ms ++)
+	{
+		for (i = 0; i < ChannelNumber; i ++)
+		{
+			SatIfSignal[i]->PrepareIfSample(CurTime);
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(Reference, IfKernelScalar, IfChipRunOff);
+			Time[0] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			for (j = 0, Peak = 0.; j < OutputParam.SampleFreq; j ++)
+				Peak = std::max(Peak, std::max(fabs((double)Reference[j].real), fabs((double)Reference[j].imag)));
+			if (Peak == 0.)
+				Peak = 1.;
+			for (Variant = 1; Variant < VariantNumber; Variant ++)
+			{
+				StartTime = std::chrono::high_resolution_clock::now();
+				SatIfSignal[i]->GenerateIfSample(Result, (IfKernelIsa)(Variant / 2), (Variant & 1) ? IfChipRunOn : IfChipRunOff);
+				Time[Variant] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+				for (j = 0; j < OutputParam.SampleFreq; j ++)
+				{
+					Error = std::max(fabs((double)Result[j].real - Reference[j].real), fabs((double)Result[j].imag - Reference[j].imag)) / Peak;
+					MaxError[Variant] = std::max(MaxError[Variant], Error);
+				}
+			}
+		}
+	}
+
+	printf("+------------+----------------+-----------------+---------+--------+\n");
+	printf("| Kernel     | Max rel. error | us/channel/ms   | Speedup | Result |\n");
+	printf("+------------+----------------+-----------------+---------+--------+\n");
+	for (Variant = 0; Variant < VariantNumber; Variant ++)
+	{
+		if (MaxError[Variant] > Tolerance)
+			Failed ++;
+		snprintf(Name, sizeof(Name), "%s%s", IfKernelName((IfKernelIsa)(Variant / 2)), (Variant & 1) ? "/run" : "");
+		printf("| %-10s | %14.3e | %15.2f | %7.2f | %-6s |\n", Name, MaxError[Variant],
+			(ms * ChannelNumber > 0) ? Time[Variant] * 1e6 / (ms * ChannelNumber) : 0., (Time[Variant] > 0.) ? Time[0] / Time[Variant] : 0.,
+			(MaxError[Variant] > Tolerance) ? "FAIL" : "PASS");
+	}
+	printf("+------------+----------------+-----------------+---------+--------+\n");
+	printf("[INFO]\t%s samples, tolerance: %.1e of channel peak amplitude, /run: chip run engine\n", (IfSampleTraits<T>::Type == IfSampleFloat) ? "float" : (IfSampleTraits<T>::Type == IfSampleInt16) ? "int16" : "double", Tolerance);
+
+	delete[] Reference;
+	delete[] Result;
+	return Failed;
+}
+
+// Compare compile time specialized PRN kernel selected by each channel against
+// the generic kernel checking PRN attributes at runtime, grouped by signal. Both
+// use the same instruction set and chip run mode, so results must be identical
+template <typename T> int VariantReport(CSatIfSignal *SatIfSignal[], int ChannelNumber)
+{
+	if (!ReportHasChannel(ChannelNumber))
+		return 1;
+
+	const char *SystemName[4] = { "GPS", "BDS", "Galileo", "GLONASS" };
+	int i, j, ms, System, SignalIndex, Failed = 0;
+	int Channels[4][8] = { { 0 } }, Mismatch[4][8] = { { 0 } };
+	double GenericTime[4][8] = { { 0. } }, SpecializedTime[4][8] = { { 0. } }, TotalGeneric = 0., TotalSpecialized = 0.;
+	unsigned int Variant[4][8];
+	T *Generic = new T[OutputParam.SampleFreq];
+	T *Specialized = new T[OutputParam.SampleFreq];
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (i = 0; i < ChannelNumber; i ++)
+	{
+		Channels[SatIfSignal[i]->GetSystem()][SatIfSignal[i]->GetSignalIndex()] ++;
+		Variant[SatIfSignal[i]->GetSystem()][SatIfSignal[i]->GetSignalIndex()] = SatIfSignal[i]->GetPrnVariant();
+	}
+	printf("[INFO]\tComparing specialized PRN kernels on %d channels for %d ms...\n", ChannelNumber, KERNEL_REPORT_MS);
+	for (ms = 0; ms < KERNEL_REPORT_MS && !StepToNextMs(); ms ++)
+	{
+		for (i = 0; i < ChannelNumber; i ++)
+		{
+			System = SatIfSignal[i]->GetSystem();
+			SignalIndex = SatIfSignal[i]->GetSignalIndex();
+			SatIfSignal[i]->PrepareIfSample(CurTime);
+			SetIfPrnSpecialized(FALSE);
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(Generic);
+			GenericTime[System][SignalIndex] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			SetIfPrnSpecialized(TRUE);
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(Specialized);
+			SpecializedTime[System][SignalIndex] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			for (j = 0; j < OutputParam.SampleFreq; j ++)
+				if (Generic[j].real != Specialized[j].real || Generic[j].imag != Specialized[j].imag)
+					Mismatch[System][SignalIndex] ++;
+		}
+	}
+
+	printf("+---------+--------+----------------+-----+------------+------------+---------+--------+\n");
+	printf("| System  | Signal | PRN variant    | Ch. | Generic us | Special us | Speedup | Result |\n");
+	printf("+---------+--------+----------------+-----+------------+------------+---------+--------+\n");
+	for (System = 0; System < 4; System ++)
+		for (SignalIndex = 0; SignalIndex < 8; SignalIndex ++)
+		{
+			if (Channels[System][SignalIndex] == 0)
+				continue;
+			if (Mismatch[System][SignalIndex])
+				Failed ++;
+			printf("| %-7s | %-6s | %-14s | %3d | %10.2f | %10.2f | %7.2f | %-6s |\n", SystemName[System], SignalName[System][SignalIndex],
+				IfPrnVariantName(Variant[System][SignalIndex]), Channels[System][SignalIndex],
+				(ms > 0) ? GenericTime[System][SignalIndex] * 1e6 / (ms * Channels[System][SignalIndex]) : 0.,
+				(ms > 0) ? SpecializedTime[System][SignalIndex] * 1e6 / (ms * Channels[System][SignalIndex]) : 0.,
+				(SpecializedTime[System][SignalIndex] > 0.) ? GenericTime[System][SignalIndex] / SpecializedTime[System][SignalIndex] : 0.,
+				Mismatch[System][SignalIndex] ? "FAIL" : "PASS");
+			TotalGeneric += GenericTime[System][SignalIndex];
+			TotalSpecialized += SpecializedTime[System][SignalIndex];
+		}
+	printf("+---------+--------+----------------+-----+------------+------------+---------+--------+\n");
+	printf("[INFO]\tKernel %s, us per channel per ms, total speedup %.2f, %d signals failed\n", IfKernelName(GetIfKernelIsa()),
+		(TotalSpecialized > 0.) ? TotalGeneric / TotalSpecialized : 0., Failed);
+
+	delete[] Generic;
+	delete[] Specialized;
+	return Failed;
+}
+
+// Generate each channel in sub-ranges split around every segment boundary (data code
+// period, where navigation bit and secondary code change) and at pseudo random offsets,
+// as a scheduler splitting heavy channels across threads would do, and compare against
+// generating the whole millisecond. Sub-range state is calculated in closed form, so
+// results must be identical. Channel cost per signal shows the imbalance splitting evens out
+#define SPLIT_MAX_CUT (MAX_IF_SEGMENT * 3 + 4)
+
+template <typename T> int SplitReport(CSatIfSignal *SatIfSignal[], int ChannelNumber)
+{
+	if (!ReportHasChannel(ChannelNumber))
+		return 1;
+
+	const char *SystemName[4] = { "GPS", "BDS", "Galileo", "GLONASS" };
+	int i, j, k, ms, System, SignalIndex, Offset, CutNumber, Failed = 0;
+	int Cut[SPLIT_MAX_CUT + 1];
+	int Channels[4][8] = { { 0 } }, Boundaries[4][8] = { { 0 } }, Mismatch[4][8] = { { 0 } };
+	double WholeTime[4][8] = { { 0. } }, SplitTime[4][8] = { { 0. } }, Cost, MaxCost = 0., TotalCost = 0.;
+	unsigned int Seed = 1;
+	T *Whole = new T[OutputParam.SampleFreq];
+	T *Split = new T[OutputParam.SampleFreq];
+	IF_SEGMENT_PARAM State;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (i = 0; i < ChannelNumber; i ++)
+		Channels[SatIfSignal[i]->GetSystem()][SatIfSignal[i]->GetSignalIndex()] ++;
+	printf("[INFO]\tComparing sub-range generation on %d channels for %d ms...\n", ChannelNumber, KERNEL_REPORT_MS);
+	for (ms = 0; ms < KERNEL_REPORT_MS && !StepToNextMs(); ms ++)
+	{
+		for (i = 0; i < ChannelNumber; i ++)
+		{
+			System = SatIfSignal[i]->GetSystem();
+			SignalIndex = SatIfSignal[i]->GetSignalIndex();
+			SatIfSignal[i]->PrepareIfSample(CurTime);
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(Whole);
+			WholeTime[System][SignalIndex] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+
+			// cut points: one sample before, at and after each segment boundary plus random offsets
+			CutNumber = 0;
+			for (Offset = 0; SatIfSignal[i]->GetSampleState(Offset, &State); )
+			{
+				if ((Offset += State.SampleCount) >= OutputParam.SampleFreq)
+					break;
+				Cut[CutNumber ++] = Offset - 1;
+				Cut[CutNumber ++] = Offset;
+				Cut[CutNumber ++] = Offset + 1;
+				Boundaries[System][SignalIndex] ++;
+			}
+			while (CutNumber < SPLIT_MAX_CUT)
+			{
+				Seed = Seed * 1664525 + 1013904223;
+				Cut[CutNumber ++] = (int)((unsigned long long)Seed * OutputParam.SampleFreq >> 32);
+			}
+			Cut[CutNumber ++] = OutputParam.SampleFreq;
+			std::sort(Cut, Cut + CutNumber);
+
+			StartTime = std::chrono::high_resolution_clock::now();
+			for (j = 0, Offset = 0; j < CutNumber; j ++)
+			{
+				if (Cut[j] <= Offset || Cut[j] > OutputParam.SampleFreq)
+					continue;
+				SatIfSignal[i]->GenerateIfSample(Split + Offset, Offset, Cut[j] - Offset);
+				Offset = Cut[j];
+			}
+			SplitTime[System][SignalIndex] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			for (k = 0; k < OutputParam.SampleFreq; k ++)
+				if (Whole[k].real != Split[k].real || Whole[k].imag != Split[k].imag)
+					Mismatch[System][SignalIndex] ++;
+		}
+	}
+
+	printf("+---------+--------+-----+------------+----------+----------+----------+--------+\n");
+	printf("| System  | Signal | Ch. | Boundaries | Whole us | Split us | Mismatch | Result |\n");
+	printf("+---------+--------+-----+------------+----------+----------+----------+--------+\n");
+	for (System = 0; System < 4; System ++)
+		for (SignalIndex = 0; SignalIndex < 8; SignalIndex ++)
+		{
+			if (Channels[System][SignalIndex] == 0)
+				continue;
+			if (Mismatch[System][SignalIndex])
+				Failed ++;
+			Cost = (ms > 0) ? WholeTime[System][SignalIndex] * 1e6 / (ms * Channels[System][SignalIndex]) : 0.;
+			MaxCost = std::max(MaxCost, Cost);
+			TotalCost += Cost * Channels[System][SignalIndex];
+			printf("| %-7s | %-6s | %3d | %10d | %8.2f | %8.2f | %8d | %-6s |\n", SystemName[System], SignalName[System][SignalIndex],
+				Channels[System][SignalIndex], Boundaries[System][SignalIndex], Cost,
+				(ms > 0) ? SplitTime[System][SignalIndex] * 1e6 / (ms * Channels[System][SignalIndex]) : 0.,
+				Mismatch[System][SignalIndex], Mismatch[System][SignalIndex] ? "FAIL" : "PASS");
+		}
+	printf("+---------+--------+-----+------------+----------+----------+----------+--------+\n");
+	printf("[INFO]\tus per channel per ms, up to %d sub-ranges, heaviest channel %.2f times of average cost, %d signals failed\n",
+		SPLIT_MAX_CUT + 1, (TotalCost > 0.) ? MaxCost * ChannelNumber / TotalCost : 0., Failed);
+
+	delete[] Whole;
+	delete[] Split;
+	return Failed;
+}
+
+// Convert quantized output back to sample value (in unit of quantization step)
+// so that SNR of quantized output can be measured
+static void DequantSamples(const unsigned char QuantSamples[], int Length, complex_number Samples[])
+{
+	int i;
+
+	for (i = 0; i < Length; i ++)
+	{
+		switch (OutputParam.Format)
+		{
+		case OutputFormatIQ2:
+			Samples[i].real = ((QuantSamples[i / 2] >> ((i & 1) * 4)) & 1) ? 3. : 1.;
+			Samples[i].imag = ((QuantSamples[i / 2] >> ((i & 1) * 4 + 2)) & 1) ? 3. : 1.;
+			if ((QuantSamples[i / 2] >> ((i & 1) * 4 + 1)) & 1) Samples[i].real = -Samples[i].real;
+			if ((QuantSamples[i / 2] >> ((i & 1) * 4 + 3)) & 1) Samples[i].imag = -Samples[i].imag;
+			break;
+		case OutputFormatIQ4:
+			Samples[i].real = ((QuantSamples[i] >> 4) & 7) + 0.5;
+			Samples[i].imag = (QuantSamples[i] & 7) + 0.5;
+			if (QuantSamples[i] & 0x80) Samples[i].real = -Samples[i].real;
+			if (QuantSamples[i] & 0x08) Samples[i].imag = -Samples[i].imag;
+			break;
+		case OutputFormatIQ16:
+			Samples[i].real = (short)(QuantSamples[i * 4] | (QuantSamples[i * 4 + 1] << 8));
+			Samples[i].imag = (short)(QuantSamples[i * 4 + 2] | (QuantSamples[i * 4 + 3] << 8));
+			break;
+		default:
+			Samples[i].real = (signed char)QuantSamples[i * 2];
+			Samples[i].imag = (signed char)QuantSamples[i * 2 + 1];
+			break;
+		}
+	}
+}
+
+// accumulate statistic to calculate SNR of Samples relative to Signal:
+// Samples = Gain * Signal + Residual, with Gain estimated by projection
+typedef struct
+{
+	double Correlation;	// <Samples, Signal>
+	double SignalPower;	// <Signal, Signal>
+	double SamplePower;	// <Samples, Samples>
+} SNR_STATISTIC;
+
+static void AccumulateSnr(SNR_STATISTIC &Statistic, const complex_number Samples[], const complex_number Signal[], int Length)
+{
+	int i;
+
+	for (i = 0; i < Length; i ++)
+	{
+		Statistic.Correlation += Samples[i].real * Signal[i].real + Samples[i].imag * Signal[i].imag;
+		Statistic.SignalPower += Signal[i].real * Signal[i].real + Signal[i].imag * Signal[i].imag;
+		Statistic.SamplePower += Samples[i].real * Samples[i].real + Samples[i].imag * Samples[i].imag;
+	}
+}
+
+static double GetSnr(const SNR_STATISTIC &Statistic)
+{
+	double Gain = Statistic.Correlation / Statistic.SignalPower;
+	double ResidualPower = Statistic.SamplePower - Gain * Statistic.Correlation;
+
+	return 10 * log10(Gain * Gain * Statistic.SignalPower / ResidualPower);
+}
+
+// Generate the configured scenario with both double and float synthesis.
+// Synthesis SNR compares each float channel against double channel, output SNR
+// is the SNR of composite signal (all channels) within noisy output before and
+// after quantization, the difference between two pipelines should be negligible
+// compared to the thermal noise
+#define PRECISION_REPORT_MS 200
+#define PRECISION_SNR_TOLERANCE 0.01	// maximum allowed output SNR loss in dB
+
+int PrecisionReport(CSatIfSignal *SatIfSignal[], int ChannelNumber)
+{
+	int i, j, ms, Failed = 0;
+	int SampleNumber = OutputParam.SampleFreq;
+	complex_number *Signal = new complex_number[SampleNumber];
+	complex_number *Samples = new complex_number[SampleNumber];
+	complex_number *Mixed = new complex_number[SampleNumber];
+	complex_number *Quantized = new complex_number[SampleNumber];
+	complex_float *FloatSamples = new complex_float[SampleNumber];
+	complex_float *FloatMixed = new complex_float[SampleNumber];
+	unsigned char *QuantArray = new unsigned char[SampleNumber * 4];
+	double SignalPower, ErrorPower, ChannelSnr, MinChannelSnr = 1e10;
+	double Time[2] = { 0., 0. };
+	SNR_STATISTIC Output[2], QuantOutput[2];	// 0 for double, 1 for float
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	memset(Output, 0, sizeof(Output));
+	memset(QuantOutput, 0, sizeof(QuantOutput));
+	printf("[INFO]\tComparing float and double IF synthesis on %d channels for %d ms...\n", ChannelNumber, PRECISION_REPORT_MS);
+	for (ms = 0; ms < PRECISION_REPORT_MS && !StepToNextMs(); ms ++)
+	{
+		for (j = 0; j < SampleNumber; j ++)
+		{
+			Signal[j] = complex_number(0, 0);
+			FloatMixed[j] = complex_float(0, 0);
+		}
+		for (i = 0; i < ChannelNumber; i ++)
+		{
+			SatIfSignal[i]->PrepareIfSample(CurTime);
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(Samples);
+			Time[0] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(FloatSamples);
+			Time[1] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			for (j = 0, SignalPower = ErrorPower = 0.; j < SampleNumber; j ++)
+			{
+				SignalPower += Samples[j].real * Samples[j].real + Samples[j].imag * Samples[j].imag;
+				ErrorPower += (FloatSamples[j].real - Samples[j].real) * (FloatSamples[j].real - Samples[j].real) + (FloatSamples[j].imag - Samples[j].imag) * (FloatSamples[j].imag - Samples[j].imag);
+				Signal[j] += Samples[j];
+				FloatMixed[j] += FloatSamples[j];
+			}
+			if (SignalPower > 0.)
+			{
+				ChannelSnr = (ErrorPower > 0.) ? 10 * log10(SignalPower / ErrorPower) : 400.;
+				MinChannelSnr = std::min(MinChannelSnr, ChannelSnr);
+			}
+		}
+		// same noise added to both pipelines
+		GenerateIfNoise(Mixed, ms, SampleNumber, 0, SampleNumber);
+		for (j = 0; j < SampleNumber; j ++)
+		{
+			FloatMixed[j] += complex_float(Mixed[j]);
+			Mixed[j] += Signal[j];
+			Samples[j] = complex_number(FloatMixed[j].real, FloatMixed[j].imag);
+		}
+		AccumulateSnr(Output[0], Mixed, Signal, SampleNumber);
+		AccumulateSnr(Output[1], Samples, Signal, SampleNumber);
+		switch (OutputParam.Format)
+		{
+		case OutputFormatIQ2: QuantSamplesIQ2(Mixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ4: QuantSamplesIQ4(Mixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ16: QuantSamplesIQ16(Mixed, SampleNumber, QuantArray, 1.0); break;
+		default: QuantSamplesIQ8(Mixed, SampleNumber, QuantArray, 1.0); break;
+		}
+		DequantSamples(QuantArray, SampleNumber, Quantized);
+		AccumulateSnr(QuantOutput[0], Quantized, Signal, SampleNumber);
+		switch (OutputParam.Format)
+		{
+		case OutputFormatIQ2: QuantSamplesIQ2(FloatMixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ4: QuantSamplesIQ4(FloatMixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ16: QuantSamplesIQ16(FloatMixed, SampleNumber, QuantArray, 1.0); break;
+		default: QuantSamplesIQ8(FloatMixed, SampleNumber, QuantArray, 1.0); break;
+		}
+		DequantSamples(QuantArray, SampleNumber, Quantized);
+		AccumulateSnr(QuantOutput[1], Quantized, Signal, SampleNumber);
+	}
+
+	printf("+---------------------------+-----------------+-----------------+-----------------+\n");
+	printf("| Item                      | double          | float           | Difference      |\n");
+	printf("+---------------------------+-----------------+-----------------+-----------------+\n");
+	printf("| Synthesis us/channel/ms   | %15.2f | %15.2f | %14.2fx |\n", Time[0] * 1e6 / std::max(ms * ChannelNumber, 1), Time[1] * 1e6 / std::max(ms * ChannelNumber, 1), (Time[1] > 0.) ? Time[0] / Time[1] : 0.);
+	printf("| Output SNR (dB)           | %15.6f | %15.6f | %15.2e |\n", GetSnr(Output[0]), GetSnr(Output[1]), GetSnr(Output[0]) - GetSnr(Output[1]));
+	printf("| Quantized output SNR (dB) | %15.6f | %15.6f | %15.2e |\n", GetSnr(QuantOutput[0]), GetSnr(QuantOutput[1]), GetSnr(QuantOutput[0]) - GetSnr(QuantOutput[1]));
+	printf("+---------------------------+-----------------+-----------------+-----------------+\n");
+	printf("[INFO]\tWorst channel float synthesis SNR against double: %.1f dB\n", (MinChannelSnr < 1e10) ? MinChannelSnr : 0.);
+	if (fabs(GetSnr(QuantOutput[0]) - GetSnr(QuantOutput[1])) > PRECISION_SNR_TOLERANCE)
+		Failed ++;
+	printf("[INFO]\tQuantized output SNR difference %s (tolerance %.2f dB)\n", Failed ? "FAIL" : "PASS", PRECISION_SNR_TOLERANCE);
+
+	delete[] Signal;
+	delete[] Samples;
+	delete[] Mixed;
+	delete[] Quantized;
+	delete[] FloatSamples;
+	delete[] FloatMixed;
+	delete[] QuantArray;
+	return Failed;
+}
+
+// Generate the configured scenario with both double and int16 pipeline.
+// CN0 of each channel is estimated as signal power over noise power density
+// of the same pipeline, so amplitude quantization and noise generation of
+// int16 pipeline both show up as CN0 error. Quantized output SNR compares the
+// composite signal within quantized output of two pipelines
+#define CN0_REPORT_MS 200
+#define CN0_TOLERANCE 0.05	// maximum allowed CN0 error of each channel in dB
+#define CN0_SNR_TOLERANCE 0.1	// maximum allowed quantized output SNR difference in dB
+
+int Cn0Report(CSatIfSignal *SatIfSignal[], int ChannelNumber)
+{
+	int i, j, ms, Failed = 0;
+	int SampleNumber = OutputParam.SampleFreq;
+	complex_number *Signal = new complex_number[SampleNumber];
+	complex_number *Samples = new complex_number[SampleNumber];
+	complex_number *Mixed = new complex_number[SampleNumber];
+	complex_number *Quantized = new complex_number[SampleNumber];
+	complex_int16 *IntSamples = new complex_int16[SampleNumber];
+	complex_int32 *IntMixed = new complex_int32[SampleNumber];
+	unsigned char *QuantArray = new unsigned char[SampleNumber * 4];
+	double *SignalPower = new double[ChannelNumber * 2];	// accumulated power of each channel, double and int16
+	double NoisePower[2] = { 0., 0. }, NoiseFourth = 0., Value;
+	double Time[2] = { 0., 0. };
+	double NoiseVariance[2], Cn0[2], Error, MaxError = 0., TotalSamples;
+	SNR_STATISTIC QuantOutput[2];	// 0 for double, 1 for int16
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (i = 0; i < ChannelNumber * 2; i ++)
+		SignalPower[i] = 0.;
+	memset(QuantOutput, 0, sizeof(QuantOutput));
+	printf("[INFO]\tComparing CN0 of int16 and double IF synthesis on %d channels for %d ms...\n", ChannelNumber, CN0_REPORT_MS);
+	for (ms = 0; ms < CN0_REPORT_MS && !StepToNextMs(); ms ++)
+	{
+		GenerateIfNoise(IntMixed, ms, SampleNumber, 0, SampleNumber);
+		for (j = 0; j < SampleNumber; j ++)
+		{
+			Signal[j] = complex_number(0, 0);
+			Value = (double)IntMixed[j].real * IntMixed[j].real;
+			NoisePower[1] += Value;
+			NoiseFourth += Value * Value;
+			Value = (double)IntMixed[j].imag * IntMixed[j].imag;
+			NoisePower[1] += Value;
+			NoiseFourth += Value * Value;
+		}
+		for (i = 0; i < ChannelNumber; i ++)
+		{
+			SatIfSignal[i]->PrepareIfSample(CurTime);
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(Samples);
+			Time[0] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			StartTime = std::chrono::high_resolution_clock::now();
+			SatIfSignal[i]->GenerateIfSample(IntSamples);
+			Time[1] += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			for (j = 0; j < SampleNumber; j ++)
+			{
+				SignalPower[i * 2] += Samples[j].real * Samples[j].real + Samples[j].imag * Samples[j].imag;
+				SignalPower[i * 2 + 1] += (double)IntSamples[j].real * IntSamples[j].real + (double)IntSamples[j].imag * IntSamples[j].imag;
+				Signal[j] += Samples[j];
+				IntMixed[j] += IntSamples[j];
+			}
+		}
+		GenerateIfNoise(Mixed, ms, SampleNumber, 0, SampleNumber);
+		for (j = 0; j < SampleNumber; j ++)
+		{
+			NoisePower[0] += Mixed[j].real * Mixed[j].real + Mixed[j].imag * Mixed[j].imag;
+			Mixed[j] += Signal[j];
+		}
+		switch (OutputParam.Format)
+		{
+		case OutputFormatIQ2: QuantSamplesIQ2(Mixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ4: QuantSamplesIQ4(Mixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ16: QuantSamplesIQ16(Mixed, SampleNumber, QuantArray, 1.0); break;
+		default: QuantSamplesIQ8(Mixed, SampleNumber, QuantArray, 1.0); break;
+		}
+		DequantSamples(QuantArray, SampleNumber, Quantized);
+		AccumulateSnr(QuantOutput[0], Quantized, Signal, SampleNumber);
+		switch (OutputParam.Format)
+		{
+		case OutputFormatIQ2: QuantSamplesIQ2(IntMixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ4: QuantSamplesIQ4(IntMixed, SampleNumber, QuantArray, 1.0); break;
+		case OutputFormatIQ16: QuantSamplesIQ16(IntMixed, SampleNumber, QuantArray, 1.0); break;
+		default: QuantSamplesIQ8(IntMixed, SampleNumber, QuantArray, 1.0); break;
+		}
+		DequantSamples(QuantArray, SampleNumber, Quantized);
+		AccumulateSnr(QuantOutput[1], Quantized, Signal, SampleNumber);
+	}
+
+	// noise variance of each I/Q component, CN0 is signal power over noise variance times sample rate
+	TotalSamples = (double)std::max(ms, 1) * SampleNumber;
+	NoiseVariance[0] = NoisePower[0] / TotalSamples / 2;
+	NoiseVariance[1] = NoisePower[1] / TotalSamples / 2;
+	printf("+---------+------------+------------+------------+------------+\n");
+	printf("| Channel | Configured | double     | int16      | Error (dB) |\n");
+	printf("+---------+------------+------------+------------+------------+\n");
+	for (i = 0; i < ChannelNumber; i ++)
+	{
+		if (SignalPower[i * 2] <= 0. || SignalPower[i * 2 + 1] <= 0.)
+		{
+			printf("| %7d | %10.2f | %10s | %10s | %10s |\n", i, SatIfSignal[i]->GetCN0(), "-", "-", "-");
+			continue;
+		}
+		for (j = 0; j < 2; j ++)
+			Cn0[j] = 10 * log10(SignalPower[i * 2 + j] / TotalSamples / NoiseVariance[j] * SampleNumber * 1000.);
+		Error = Cn0[1] - Cn0[0];
+		MaxError = std::max(MaxError, fabs(Error));
+		printf("| %7d | %10.2f | %10.3f | %10.3f | %+10.4f |\n", i, SatIfSignal[i]->GetCN0(), Cn0[0], Cn0[1], Error);
+	}
+	printf("+---------+------------+------------+------------+------------+\n");
+	printf("[INFO]\tNoise sigma: double %.5f, int16 %.5f (in unit of nominal sigma), int16 noise kurtosis %.4f (3 for Gaussian)\n",
+		sqrt(NoiseVariance[0]), sqrt(NoiseVariance[1]) / IF_INT_SIGMA, NoiseFourth / TotalSamples / 2 / (NoiseVariance[1] * NoiseVariance[1]));
+	printf("[INFO]\tSynthesis us/channel/ms: double %.2f, int16 %.2f (%.2fx)\n", Time[0] * 1e6 / std::max(ms * ChannelNumber, 1), Time[1] * 1e6 / std::max(ms * ChannelNumber, 1), (Time[1] > 0.) ? Time[0] / Time[1] : 0.);
+	printf("[INFO]\tQuantized output SNR: double %.4f dB, int16 %.4f dB\n", GetSnr(QuantOutput[0]), GetSnr(QuantOutput[1]));
+	if (MaxError > CN0_TOLERANCE)
+		Failed ++;
+	printf("[INFO]\tMaximum channel CN0 error %.4f dB %s (tolerance %.2f dB)\n", MaxError, (MaxError > CN0_TOLERANCE) ? "FAIL" : "PASS", CN0_TOLERANCE);
+	if (fabs(GetSnr(QuantOutput[0]) - GetSnr(QuantOutput[1])) > CN0_SNR_TOLERANCE)
+		Failed ++;
+	printf("[INFO]\tQuantized output SNR difference %s (tolerance %.2f dB)\n", (fabs(GetSnr(QuantOutput[0]) - GetSnr(QuantOutput[1])) > CN0_SNR_TOLERANCE) ? "FAIL" : "PASS", CN0_SNR_TOLERANCE);
+
+	delete[] Signal;
+	delete[] Samples;
+	delete[] Mixed;
+	delete[] Quantized;
+	delete[] IntSamples;
+	delete[] IntMixed;
+	delete[] QuantArray;
+	delete[] SignalPower;
+	return Failed;
+}
+
+// in place radix-2 FFT, Length must be power of 2
+static void Fft(complex_number Data[], int Length)
+{
+	int i, j, k, Half;
+	complex_number Temp, Twiddle;
+
+	for (i = 1, j = 0; i < Length; i ++)	// bit reversed order
+	{
+		for (k = Length >> 1; j & k; k >>= 1)
+			j ^= k;
+		j ^= k;
+		if (i < j)
+		{
+			Temp = Data[i]; Data[i] = Data[j]; Data[j] = Temp;
+		}
+	}
+	for (Half = 1; Half < Length; Half <<= 1)
+		for (k = 0; k < Half; k ++)
+		{
+			Twiddle = complex_number(cos(PI * k / Half), -sin(PI * k / Half));
+			for (i = k; i < Length; i += Half * 2)
+			{
+				Temp = Data[i + Half] * Twiddle;
+				Data[i + Half] = Data[i] - Temp;
+				Data[i] += Temp;
+			}
+		}
+}
+
+// carrier power over largest spur in dB, carrier at bin 1
+static double GetSfdr(complex_number Spectrum[], int Length)
+{
+	double Carrier = Spectrum[1].real * Spectrum[1].real + Spectrum[1].imag * Spectrum[1].imag;
+	double Spur = 0., Power;
+	int i;
+
+	for (i = 0; i < Length; i ++)
+	{
+		Power = Spectrum[i].real * Spectrum[i].real + Spectrum[i].imag * Spectrum[i].imag;
+		if (i != 1 && Power > Spur)
+			Spur = Power;
+	}
+	return (Spur > 0.) ? 10 * log10(Carrier / Spur) : 999.;
+}
+
+// Spurious free dynamic range of carrier NCO for each compact table size.
+// Carrier phase steps through all multiples of 2^32/CARRIER_REPORT_POINTS so
+// the output is exactly one period of the phase to amplitude mapping, its DFT
+// has the carrier at bin 1 and all spurs caused by table size, interpolation
+// and value precision. Legacy full table of FastMath::FastRotate() is listed
+// for comparison
+#define CARRIER_REPORT_POINTS (1 << 18)
+#define CARRIER_REPORT_REPEAT 16	// repeat NCO generation to measure speed
+#define CARRIER_SFDR_MIN 120.	// minimum SFDR in dBc of default double table
+#define CARRIER_SFDR_MIN_INT16 80.	// minimum SFDR in dBc of default int16 table
+
+int CarrierReport()
+{
+	const int Step = (int)(0x100000000ULL / CARRIER_REPORT_POINTS);
+	complex_number *Spectrum = new complex_number[CARRIER_REPORT_POINTS];
+	complex_float *FloatCarrier = new complex_float[CARRIER_REPORT_POINTS];
+	complex_int16 *IntCarrier = new complex_int16[CARRIER_REPORT_POINTS];
+	int i, Depth, Interpolate, Repeat, Failed = 0;
+	double Sfdr[3], Time;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	FastMath::InitializeLUT();
+	printf("[INFO]\tCarrier NCO spurious free dynamic range over %d phase points, kernel %s\n", CARRIER_REPORT_POINTS, IfKernelName(GetIfKernelIsa()));
+	printf("+---------+--------+------------------------+------------------------------+---------+\n");
+	printf("| Entries | Interp | Size KB double/flt/i16 | SFDR dBc double/float/int16  | ns/samp |\n");
+	printf("+---------+--------+------------------------+------------------------------+---------+\n");
+	// legacy table covers full cycle in double
+	StartTime = std::chrono::high_resolution_clock::now();
+	for (Repeat = 0; Repeat < CARRIER_REPORT_REPEAT; Repeat ++)
+		for (i = 0; i < CARRIER_REPORT_POINTS; i ++)
+			Spectrum[i] = FastMath::FastRotate((unsigned int)i * (unsigned int)Step);
+	Time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+	Fft(Spectrum, CARRIER_REPORT_POINTS);
+	printf("| %7d | %6s | %6d %6s %6s   | %8.2f %9s %9s  | %7.3f |\n", FastMath::TRIG_LUT_SIZE, "no",
+		(int)((FastMath::TRIG_LUT_SIZE + FastMath::TRIG_LUT_SIZE / 4) * sizeof(double) / 1024), "-", "-",
+		GetSfdr(Spectrum, CARRIER_REPORT_POINTS), "-", "-", Time * 1e9 / CARRIER_REPORT_POINTS / CARRIER_REPORT_REPEAT);
+
+	for (Depth = FastMath::CARRIER_LUT_MIN_DEPTH; Depth <= FastMath::CARRIER_LUT_MAX_DEPTH; Depth ++)
+		for (Interpolate = 0; Interpolate < 2; Interpolate ++)
+		{
+			FastMath::SetCarrierLut(Depth, Interpolate ? true : false);
+			StartTime = std::chrono::high_resolution_clock::now();
+			for (Repeat = 0; Repeat < CARRIER_REPORT_REPEAT; Repeat ++)
+				GenerateCarrier(0, Step, CARRIER_REPORT_POINTS, Spectrum);
+			Time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			Fft(Spectrum, CARRIER_REPORT_POINTS);
+			Sfdr[0] = GetSfdr(Spectrum, CARRIER_REPORT_POINTS);
+			GenerateCarrier(0, Step, CARRIER_REPORT_POINTS, FloatCarrier);
+			for (i = 0; i < CARRIER_REPORT_POINTS; i ++)
+				Spectrum[i] = complex_number(FloatCarrier[i].real, FloatCarrier[i].imag);
+			Fft(Spectrum, CARRIER_REPORT_POINTS);
+			Sfdr[1] = GetSfdr(Spectrum, CARRIER_REPORT_POINTS);
+			GenerateCarrier(0, Step, CARRIER_REPORT_POINTS, IntCarrier);
+			for (i = 0; i < CARRIER_REPORT_POINTS; i ++)
+				Spectrum[i] = complex_number(IntCarrier[i].real, IntCarrier[i].imag);
+			Fft(Spectrum, CARRIER_REPORT_POINTS);
+			Sfdr[2] = GetSfdr(Spectrum, CARRIER_REPORT_POINTS);
+			if (Depth == FastMath::CARRIER_LUT_DEFAULT_DEPTH && Interpolate && (Sfdr[0] < CARRIER_SFDR_MIN || Sfdr[2] < CARRIER_SFDR_MIN_INT16))
+				Failed ++;
+			printf("| %7d | %6s | %6.2f %6.2f %6.2f   | %8.2f %9.2f %9.2f %c| %7.3f |\n", 1 << Depth, Interpolate ? "yes" : "no",
+				(2 << Depth) * sizeof(double) / 1024., (2 << Depth) * sizeof(float) / 1024., (1 << Depth) * sizeof(int) / 1024.,
+				Sfdr[0], Sfdr[1], Sfdr[2], (Depth == FastMath::CARRIER_LUT_DEFAULT_DEPTH && Interpolate) ? '*' : ' ',
+				Time * 1e9 / CARRIER_REPORT_POINTS / CARRIER_REPORT_REPEAT);
+		}
+	printf("+---------+--------+------------------------+------------------------------+---------+\n");
+	printf("[INFO]\tCompact table entries cover a quarter cycle, * marks default table, ns/samp of double NCO\n");
+	printf("[INFO]\tDefault table SFDR %s (minimum %.0f dBc double, %.0f dBc int16)\n", Failed ? "FAIL" : "PASS", CARRIER_SFDR_MIN, CARRIER_SFDR_MIN_INT16);
+	FastMath::SetCarrierLut(FastMath::CARRIER_LUT_DEFAULT_DEPTH, true);
+
+	delete[] Spectrum;
+	delete[] FloatCarrier;
+	delete[] IntCarrier;
+	return Failed;
+}
+
+// quantize Length samples to given format, same as QuantizeTile() of IFdataGen with Start 0
+template <typename T> static int QuantizeFormat(OutputFormat Format, const T Samples[], int Length, unsigned char QuantArray[], double GainScale, IfKernelIsa Isa)
+{
+	switch (Format)
+	{
+	case OutputFormatIQ2: return QuantSamplesIQ2(Samples, Length, QuantArray, GainScale, Isa);
+	case OutputFormatIQ4: return QuantSamplesIQ4(Samples, Length, QuantArray, GainScale, Isa);
+	case OutputFormatIQ16: return QuantSamplesIQ16(Samples, Length, QuantArray, GainScale, Isa);
+	default: return QuantSamplesIQ8(Samples, Length, QuantArray, GainScale, Isa);
+	}
+}
+
+// Compare quantizer of each supported instruction set against scalar reference kernel,
+// output bytes and clipped count must be identical. Test samples are noise of sigma up
+// to 8 (so that all formats clip) following values on or next to each quantization and
+// clip boundary of every gain scale tested, odd length covers scalar tail of vector kernels
+#define QUANT_REPORT_SAMPLES 100003
+#define QUANT_REPORT_REPEAT 20	// repeat quantization to measure speed
+
+template <typename T> static int QuantReportType(const char *TypeName, const T Samples[])
+{
+	const OutputFormat FormatList[4] = { OutputFormatIQ2, OutputFormatIQ4, OutputFormatIQ8, OutputFormatIQ16 };
+	const char *FormatName[4] = { "IQ2", "IQ4", "IQ8", "IQ16" };
+	const double GainScaleList[3] = { 1.0, 0.37, 1.9 };
+	const int Bytes[4] = { (QUANT_REPORT_SAMPLES + 1) / 2, QUANT_REPORT_SAMPLES, QUANT_REPORT_SAMPLES * 2, QUANT_REPORT_SAMPLES * 4 };
+	unsigned char *Reference = new unsigned char[QUANT_REPORT_SAMPLES * 4];
+	unsigned char *QuantArray = new unsigned char[QUANT_REPORT_SAMPLES * 4];
+	int i, j, Format, Isa, ByteErrors, ClipErrors, ReferenceClip, Repeat, Failed = 0;
+	double Time, ScalarTime = 0.;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (Format = 0; Format < 4; Format ++)
+		for (Isa = IfKernelScalar; Isa < IfKernelAuto; Isa ++)
+		{
+			if (!IfKernelSupported((IfKernelIsa)Isa))
+				continue;
+			ByteErrors = ClipErrors = 0;
+			for (i = 0; i < 3; i ++)
+			{
+				ReferenceClip = QuantizeFormat(FormatList[Format], Samples, QUANT_REPORT_SAMPLES, Reference, GainScaleList[i], IfKernelScalar);
+				memset(QuantArray, 0x5a, QUANT_REPORT_SAMPLES * 4);	// make missing store visible
+				if (QuantizeFormat(FormatList[Format], Samples, QUANT_REPORT_SAMPLES, QuantArray, GainScaleList[i], (IfKernelIsa)Isa) != ReferenceClip)
+					ClipErrors ++;
+				for (j = 0; j < Bytes[Format]; j ++)
+					if (QuantArray[j] != Reference[j])
+						ByteErrors ++;
+			}
+			StartTime = std::chrono::high_resolution_clock::now();
+			for (Repeat = 0; Repeat < QUANT_REPORT_REPEAT; Repeat ++)
+				QuantizeFormat(FormatList[Format], Samples, QUANT_REPORT_SAMPLES, QuantArray, 1.0, (IfKernelIsa)Isa);
+			Time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count() * 1e9 / QUANT_REPORT_SAMPLES / QUANT_REPORT_REPEAT;
+			if (Isa == IfKernelScalar)
+				ScalarTime = Time;
+			if (ByteErrors || ClipErrors)
+				Failed ++;
+			printf("| %-6s | %-6s | %-7s | %11d | %11d | %7.3f | %6.2fx | %-6s |\n", TypeName, FormatName[Format], IfKernelName((IfKernelIsa)Isa),
+				ByteErrors, ClipErrors, Time, ScalarTime / Time, (ByteErrors || ClipErrors) ? "FAIL" : "PASS");
+		}
+
+	delete[] Reference;
+	delete[] QuantArray;
+	return Failed;
+}
+
+int QuantReport()
+{
+	const double GainScaleList[3] = { 1.0, 0.37, 1.9 };
+	const double FormatGain[3] = { 3.0, 25.0, 3277. };
+	const int FormatMax[3] = { 7, 127, 32767 };
+	complex_number *Samples = new complex_number[QUANT_REPORT_SAMPLES];
+	complex_float *FloatSamples = new complex_float[QUANT_REPORT_SAMPLES];
+	complex_int32 *IntSamples = new complex_int32[QUANT_REPORT_SAMPLES];
+	double *Value = (double *)Samples, Gain, Boundary[6];
+	int i, j, k, Count = 0, Failed = 0;
+
+	GenerateIfNoise(Samples, 0, QUANT_REPORT_SAMPLES, 0, QUANT_REPORT_SAMPLES);
+	for (i = 0; i < QUANT_REPORT_SAMPLES; i ++)
+		Samples[i] *= 1.0 + (i & 7);
+	// boundary values: IQ2 thresholds, truncation steps and saturation of other formats
+	for (i = 0; i < 3; i ++)
+	{
+		Value[Count ++] = 1.1 / GainScaleList[i];
+		Value[Count ++] = 5 * (1.1 / GainScaleList[i]);
+		for (j = 0; j < 3; j ++)
+		{
+			Gain = GainScaleList[i] * FormatGain[j];
+			Boundary[0] = 1. / Gain; Boundary[1] = 2. / Gain; Boundary[2] = FormatMax[j] / Gain;
+			Boundary[3] = (FormatMax[j] + 1) / Gain; Boundary[4] = (FormatMax[j] + 2) / Gain; Boundary[5] = (FormatMax[j] + 0.5) / Gain;
+			for (k = 0; k < 6; k ++)
+			{
+				Value[Count ++] = Boundary[k];
+				Value[Count ++] = -Boundary[k];
+				Value[Count ++] = nextafter(Boundary[k], 0.);
+				Value[Count ++] = -nextafter(Boundary[k], 0.);
+				Value[Count ++] = nextafter(Boundary[k], 1e9);
+				Value[Count ++] = -nextafter(Boundary[k], 1e9);
+			}
+		}
+	}
+	Value[Count ++] = 0.;
+	Value[Count ++] = -0.;
+	Value[Count ++] = 1e-30;
+	Value[Count ++] = -1e-30;
+	for (i = 0; i < QUANT_REPORT_SAMPLES; i ++)
+	{
+		FloatSamples[i] = complex_float((float)Samples[i].real, (float)Samples[i].imag);
+		IntSamples[i] = complex_int32((int)floor(Samples[i].real * IF_INT_SIGMA + 0.5), (int)floor(Samples[i].imag * IF_INT_SIGMA + 0.5));
+	}
+
+	printf("[INFO]\tCompare quantizers of each kernel against scalar kernel on %d samples\n", QUANT_REPORT_SAMPLES);
+	printf("+--------+--------+---------+-------------+-------------+---------+---------+--------+\n");
+	printf("| Type   | Format | Kernel  | Byte errors | Clip errors | ns/samp | Speedup | Result |\n");
+	printf("+--------+--------+---------+-------------+-------------+---------+---------+--------+\n");
+	Failed += QuantReportType("double", Samples);
+	Failed += QuantReportType("float", FloatSamples);
+	Failed += QuantReportType("int32", IntSamples);
+	printf("+--------+--------+---------+-------------+-------------+---------+---------+--------+\n");
+	printf("[INFO]\tErrors summed over gain scale 1.0, 0.37 and 1.9, %d kernels failed\n", Failed);
+
+	delete[] Samples;
+	delete[] FloatSamples;
+	delete[] IntSamples;
+	return Failed;
+}
+
+// Compare noise generator of each supported instruction set against scalar reference kernel,
+// samples must be bit identical. Noise generated in ranges of varying length by parallel
+// threads in reverse order must equal the noise generated at once. Moments, tail
+// probabilities and correlations of the reference noise are checked against the standard
+// normal distribution within 5 times of their standard error
+#define NOISE_REPORT_MS 20
+#define NOISE_REPORT_MS_SAMPLES 100003	// odd length covers scalar tail of vector kernels
+#define NOISE_REPORT_REPEAT 5	// repeat generation to measure speed
+#define NOISE_REPORT_SIGMA 5.
+
+template <typename T> static int NoiseReportType(const char *TypeName, T Noise[], T Reference[])
+{
+	int i, Isa, Mismatch, Repeat, Failed = 0, Total = NOISE_REPORT_MS * NOISE_REPORT_MS_SAMPLES;
+	double Time, ScalarTime = 0.;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	GenerateIfNoise(Reference, 0, NOISE_REPORT_MS_SAMPLES, 0, Total, IfKernelScalar);
+	for (Isa = IfKernelScalar; Isa < IfKernelAuto; Isa ++)
+	{
+		if (!IfKernelSupported((IfKernelIsa)Isa))
+			continue;
+		memset((void *)Noise, 0x5a, sizeof(T) * Total);	// make missing store visible
+		GenerateIfNoise(Noise, 0, NOISE_REPORT_MS_SAMPLES, 0, Total, (IfKernelIsa)Isa);
+		for (i = 0, Mismatch = 0; i < Total; i ++)
+			if (memcmp(&Noise[i], &Reference[i], sizeof(T)) != 0)
+				Mismatch ++;
+		StartTime = std::chrono::high_resolution_clock::now();
+		for (Repeat = 0; Repeat < NOISE_REPORT_REPEAT; Repeat ++)
+			GenerateIfNoise(Noise, 0, NOISE_REPORT_MS_SAMPLES, 0, Total, (IfKernelIsa)Isa);
+		Time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count() * 1e9 / Total / NOISE_REPORT_REPEAT;
+		if (Isa == IfKernelScalar)
+			ScalarTime = Time;
+		if (Mismatch)
+			Failed ++;
+		printf("| %-6s | %-7s | %11d | %7.3f | %6.2fx | %-6s |\n", TypeName, IfKernelName((IfKernelIsa)Isa), Mismatch, Time, ScalarTime / Time, Mismatch ? "FAIL" : "PASS");
+	}
+	return Failed;
+}
+
+static int NoiseCheck(const char *Name, double Value, double Expected, double Tolerance)
+{
+	int Failed = (fabs(Value - Expected) > Tolerance) ? 1 : 0;
+
+	printf("| %-22s | %12.6g | %12.6g | %12.3g | %-6s |\n", Name, Value, Expected, Tolerance, Failed ? "FAIL" : "PASS");
+	return Failed;
+}
+
+int NoiseReport()
+{
+	int Total = NOISE_REPORT_MS * NOISE_REPORT_MS_SAMPLES;
+	complex_number *Samples = new complex_number[Total];
+	complex_number *Reference = new complex_number[Total];
+	complex_float *FloatSamples = new complex_float[Total];
+	complex_float *FloatReference = new complex_float[Total];
+	complex_int32 *IntSamples = new complex_int32[Total];
+	complex_int32 *IntReference = new complex_int32[Total];
+	std::vector<int> PieceStart;
+	const double *Value = (const double *)Reference;
+	double N = Total * 2., x, x2, Sum[4] = { 0., 0., 0., 0. }, Tail[2] = { 0., 0. }, IqSum = 0., LagSum = 0., Peak = 0., Mean, Variance;
+	int i, Start, Mismatch = 0, Failed = 0;
+
+	printf("[INFO]\tCompare noise generator of each kernel against scalar kernel on %d ms of %d samples\n", NOISE_REPORT_MS, NOISE_REPORT_MS_SAMPLES);
+	printf("+--------+---------+-------------+---------+---------+--------+\n");
+	printf("| Type   | Kernel  | Mismatches  | ns/samp | Speedup | Result |\n");
+	printf("+--------+---------+-------------+---------+---------+--------+\n");
+	Failed += NoiseReportType("double", Samples, Reference);
+	Failed += NoiseReportType("float", FloatSamples, FloatReference);
+	Failed += NoiseReportType("int32", IntSamples, IntReference);
+	printf("+--------+---------+-------------+---------+---------+--------+\n");
+
+	// ranges of 1 to 6007 samples crossing millisecond boundaries, generated by parallel threads
+	for (Start = 0, i = 0; Start < Total; i ++)
+	{
+		PieceStart.push_back(Start);
+		Start += 1 + (i * 7919) % 6007;
+	}
+	PieceStart.push_back(Total);
+	memset((void *)Samples, 0x5a, sizeof(complex_number) * Total);
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (i = (int)PieceStart.size() - 2; i >= 0; i --)
+		GenerateIfNoise(Samples + PieceStart[i], 0, NOISE_REPORT_MS_SAMPLES, PieceStart[i], PieceStart[i + 1] - PieceStart[i]);
+	for (i = 0; i < Total; i ++)
+		if (Samples[i].real != Reference[i].real || Samples[i].imag != Reference[i].imag)
+			Mismatch ++;
+	if (Mismatch)
+		Failed ++;
+	printf("[INFO]\t%d ranges generated in parallel threads: %d mismatches %s\n", (int)PieceStart.size() - 1, Mismatch, Mismatch ? "FAIL" : "PASS");
+
+	// statistics of I/Q values against standard normal distribution
+	for (i = 0; i < Total * 2; i ++)
+	{
+		x = Value[i];
+		x2 = x * x;
+		Sum[0] += x; Sum[1] += x2; Sum[2] += x2 * x; Sum[3] += x2 * x2;
+		if (fabs(x) > 3.)
+			Tail[0] ++;
+		if (fabs(x) > 4.)
+			Tail[1] ++;
+		Peak = std::max(Peak, fabs(x));
+		if (i & 1)
+			IqSum += x * Value[i - 1];
+		if (i >= 2)
+			LagSum += x * Value[i - 2];
+	}
+	Mean = Sum[0] / N;
+	Variance = Sum[1] / N - Mean * Mean;
+	printf("+------------------------+--------------+--------------+--------------+--------+\n");
+	printf("| Statistic              | Value        | Expected     | Tolerance    | Result |\n");
+	printf("+------------------------+--------------+--------------+--------------+--------+\n");
+	Failed += NoiseCheck("Mean", Mean, 0., NOISE_REPORT_SIGMA * sqrt(1. / N));
+	Failed += NoiseCheck("Variance", Variance, 1., NOISE_REPORT_SIGMA * sqrt(2. / N));
+	Failed += NoiseCheck("Skewness", Sum[2] / N, 0., NOISE_REPORT_SIGMA * sqrt(15. / N));
+	Failed += NoiseCheck("Excess kurtosis", Sum[3] / N - 3., 0., NOISE_REPORT_SIGMA * sqrt(96. / N));
+	Failed += NoiseCheck("P(|x|>3)", Tail[0] / N, 2.699796e-3, NOISE_REPORT_SIGMA * sqrt(2.699796e-3 / N));
+	Failed += NoiseCheck("P(|x|>4)", Tail[1] / N, 6.334248e-5, NOISE_REPORT_SIGMA * sqrt(6.334248e-5 / N));
+	Failed += NoiseCheck("I/Q correlation", IqSum / (N / 2), 0., NOISE_REPORT_SIGMA * sqrt(2. / N));
+	Failed += NoiseCheck("Lag 1 correlation", LagSum / (N - 2), 0., NOISE_REPORT_SIGMA * sqrt(1. / N));
+	printf("+------------------------+--------------+--------------+--------------+--------+\n");
+	printf("[INFO]\tLargest magnitude %.3f sigma, noise seed 0x%llx, %d checks failed\n", Peak, GetIfNoiseSeed(), Failed);
+
+	delete[] Samples;
+	delete[] Reference;
+	delete[] FloatSamples;
+	delete[] FloatReference;
+	delete[] IntSamples;
+	delete[] IntReference;
+	return Failed;
+}
+
+// Check noise pool mode on noise of NOISE_REPORT_MS milliseconds of scenario sample rate.
+// Pool configured by --noise-pool is used, otherwise a pool of POOL_REPORT_POOL_MS. Noise
+// generated in ranges by parallel threads must equal the noise generated at once, noise
+// must repeat exactly at the configured period. Normalized autocorrelation at sample lags
+// within and across runs and at millisecond lags is checked within 5 times of its standard
+// error, fraction of runs read more than once in the window is compared to expectation
+#define POOL_REPORT_POOL_MS 2000
+#define POOL_REPORT_MAX_LAG 32
+
+static double PoolCorrelation(const complex_number Samples[], int Total, int Lag)
+{
+	double Real = 0., Imag = 0., Power = 0.;
+	int i;
+
+	for (i = 0; i < Total; i ++)
+		Power += Samples[i].real * Samples[i].real + Samples[i].imag * Samples[i].imag;
+	for (i = 0; i + Lag < Total; i ++)
+	{
+		Real += Samples[i].real * Samples[i + Lag].real + Samples[i].imag * Samples[i + Lag].imag;
+		Imag += Samples[i].imag * Samples[i + Lag].real - Samples[i].real * Samples[i + Lag].imag;
+	}
+	return sqrt(Real * Real + Imag * Imag) / Power;
+}
+
+static double NoiseTime(complex_number Samples[], int MsSampleNumber, int Total)
+{
+	std::chrono::high_resolution_clock::time_point StartTime = std::chrono::high_resolution_clock::now();
+	int Repeat;
+
+	for (Repeat = 0; Repeat < NOISE_REPORT_REPEAT; Repeat ++)
+		GenerateIfNoise(Samples, Repeat * NOISE_REPORT_MS, MsSampleNumber, 0, Total);
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count() * 1e9 / Total / NOISE_REPORT_REPEAT;
+}
+
+int PoolReport(int MsSampleNumber)
+{
+	long long PoolSize = GetIfNoisePoolSize();
+	int Period = GetIfNoisePeriod(), Total = NOISE_REPORT_MS * MsSampleNumber;
+	complex_number *Samples = new complex_number[Total];
+	complex_number *Reference = new complex_number[Total];
+	std::vector<int> PieceStart, LagList;
+	std::set<std::pair<double, double> > RunSet;
+	double ExactTime, PoolTime, BuildTime, Power = 0., Mean = 0., Runs, PoolRuns, Duplicate;
+	int i, Start, RunNumber, Mismatch = 0, Failed = 0;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	// throughput of exact noise, then build pool
+	SetIfNoisePool(0, 0, IfSampleDouble);
+	ExactTime = NoiseTime(Samples, MsSampleNumber, Total);
+	if (PoolSize == 0)
+		PoolSize = (long long)POOL_REPORT_POOL_MS * MsSampleNumber;
+	StartTime = std::chrono::high_resolution_clock::now();
+	SetIfNoisePool(PoolSize, Period, IfSampleDouble);
+	BuildTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+	PoolTime = NoiseTime(Samples, MsSampleNumber, Total);
+	PoolSize = GetIfNoisePoolSize();
+	printf("[INFO]\tNoise pool of %lld samples (%.3f s) built in %.3f s, %d ms of %d samples checked\n", PoolSize, (double)PoolSize / MsSampleNumber / 1000., BuildTime, NOISE_REPORT_MS, MsSampleNumber);
+	printf("[INFO]\tExact noise %.3f ns/sample, pool noise %.3f ns/sample, speedup %.2fx\n", ExactTime, PoolTime, ExactTime / PoolTime);
+
+	// ranges of 1 to 6007 samples crossing millisecond boundaries, generated by parallel threads
+	GenerateIfNoise(Reference, 0, MsSampleNumber, 0, Total);
+	for (Start = 0, i = 0; Start < Total; i ++)
+	{
+		PieceStart.push_back(Start);
+		Start += 1 + (i * 7919) % 6007;
+	}
+	PieceStart.push_back(Total);
+	memset((void *)Samples, 0x5a, sizeof(complex_number) * Total);
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (i = (int)PieceStart.size() - 2; i >= 0; i --)
+		GenerateIfNoise(Samples + PieceStart[i], 0, MsSampleNumber, PieceStart[i], PieceStart[i + 1] - PieceStart[i]);
+	for (i = 0; i < Total; i ++)
+		if (Samples[i].real != Reference[i].real || Samples[i].imag != Reference[i].imag)
+			Mismatch ++;
+	if (Mismatch)
+		Failed ++;
+	printf("[INFO]\t%d ranges generated in parallel threads: %d mismatches %s\n", (int)PieceStart.size() - 1, Mismatch, Mismatch ? "FAIL" : "PASS");
+
+	// noise one period later must be identical
+	if (Period > 0)
+	{
+		GenerateIfNoise(Samples, Period, MsSampleNumber, 0, Total);
+		for (i = 0, Mismatch = 0; i < Total; i ++)
+			if (Samples[i].real != Reference[i].real || Samples[i].imag != Reference[i].imag)
+				Mismatch ++;
+		if (Mismatch)
+			Failed ++;
+		printf("[INFO]\tNoise repeated after %d ms: %d mismatches %s\n", Period, Mismatch, Mismatch ? "FAIL" : "PASS");
+	}
+	else
+		printf("[INFO]\tNo repeat period configured\n");
+
+	// normalized autocorrelation, standard error of magnitude is about 1/sqrt(N)
+	for (i = 1; i <= POOL_REPORT_MAX_LAG; i *= 2)
+		LagList.push_back(i);
+	LagList.push_back(IF_NOISE_POOL_RUN - 1);
+	LagList.push_back(IF_NOISE_POOL_RUN);
+	LagList.push_back(IF_NOISE_POOL_RUN + 1);
+	for (i = 1; i <= NOISE_REPORT_MS / 2; i *= 2)
+		LagList.push_back(i * MsSampleNumber);
+	printf("+------------------------+--------------+--------------+--------------+--------+\n");
+	printf("| Statistic              | Value        | Expected     | Tolerance    | Result |\n");
+	printf("+------------------------+--------------+--------------+--------------+--------+\n");
+	for (i = 0; i < Total; i ++)
+	{
+		Mean += Reference[i].real + Reference[i].imag;
+		Power += Reference[i].real * Reference[i].real + Reference[i].imag * Reference[i].imag;
+	}
+	Failed += NoiseCheck("Mean", Mean / Total / 2, 0., NOISE_REPORT_SIGMA * sqrt(1. / Total / 2));
+	Failed += NoiseCheck("Variance", Power / Total / 2, 1., NOISE_REPORT_SIGMA * sqrt(2. / Total / 2));
+	for (i = 0; i < (int)LagList.size(); i ++)
+	{
+		char Name[32];
+
+		if (LagList[i] >= MsSampleNumber)
+			sprintf(Name, "|R(%d ms)|", LagList[i] / MsSampleNumber);
+		else
+			sprintf(Name, "|R(%d)|", LagList[i]);
+		Failed += NoiseCheck(Name, PoolCorrelation(Reference, Total, LagList[i]), 0., NOISE_REPORT_SIGMA / sqrt((double)(Total - LagList[i])));
+	}
+	printf("+------------------------+--------------+--------------+--------------+--------+\n");
+
+	// runs starting at run boundary of each millisecond identified by their first sample
+	for (i = 0, RunNumber = 0; i < Total; i ++)
+		if ((i % MsSampleNumber) % IF_NOISE_POOL_RUN == 0 && (i % MsSampleNumber) + IF_NOISE_POOL_RUN <= MsSampleNumber)
+		{
+			RunSet.insert(std::make_pair(Reference[i].real, Reference[i].imag));
+			RunNumber ++;
+		}
+	// milliseconds after first period read the same runs again
+	Runs = (Period > 0 && Period < NOISE_REPORT_MS) ? (double)RunNumber * Period / NOISE_REPORT_MS : RunNumber;
+	PoolRuns = (double)(PoolSize / IF_NOISE_POOL_RUN);
+	Duplicate = (RunNumber - (int)RunSet.size()) / (double)RunNumber;
+	printf("[INFO]\t%d full runs read, %.4f%% read more than once (%.4f%% expected for random runs), %d checks failed\n", RunNumber, Duplicate * 100., (1. - PoolRuns * (1. - pow(1. - 1. / PoolRuns, Runs)) / RunNumber) * 100., Failed);
+
+	delete[] Samples;
+	delete[] Reference;
+	return Failed;
+}
+
+#define ORBIT_REPORT_SPAN 3600.	// seconds around ephemeris reference time
+#define ORBIT_REPORT_STEP 0.0371	// receive time step in second
+#define ORBIT_REPORT_TRAVEL 0.075	// transmit time queried before receive time as in CSatelliteParam
+#define ORBIT_POS_TOLERANCE 1e-4	// maximum allowed position error in meter
+#define ORBIT_VEL_TOLERANCE 1e-5	// maximum allowed velocity error in m/s
+#define ORBIT_REPORT_GLONASS_MS 100000	// milliseconds of GLONASS queries to measure speed
+#define ORBIT_REPORT_BATCH_EPOCH 3600	// epochs of batch calculation over ORBIT_REPORT_SPAN
+
+typedef struct
+{
+	GnssSystem system;
+	int svid;
+	const void *Eph;
+	const void *RefEph;	// copy of GLONASS ephemeris without orbit table, same as Eph for others
+	double Center;	// toe or tb
+} ORBIT_REPORT_SAT;
+
+// maximum position/velocity/acceleration/relativity(in meter) error of each query against
+// sequential ephemeris calculation (Runge-Kutta integration for GLONASS), query pattern as
+// CSatelliteParam::CalculateParam()
+static void OrbitError(const ORBIT_REPORT_SAT &Sat, double Interval, double MaxError[4], double &Time)
+{
+	ORBIT_CACHE Cache, Reference;
+	KINEMATIC_INFO PosVel, PosVelRef;
+	double t, Query, Acc[3], AccRef[3], Diff, RelScale;
+	const GPS_EPHEMERIS *Eph = (const GPS_EPHEMERIS *)Sat.Eph;
+	int i, Step, StepNumber = (int)(ORBIT_REPORT_SPAN / ORBIT_REPORT_STEP);
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	RelScale = (Sat.system == GlonassSystem) ? 0. : WGS_F_GTR * Eph->ecc * Eph->sqrtA * LIGHT_SPEED;
+	MaxError[0] = MaxError[1] = MaxError[2] = MaxError[3] = 0.;
+	InitOrbitCache(&Cache, Interval);
+	InitOrbitCache(&Reference, 0.);
+	for (Step = 0; Step < StepNumber; Step ++)
+	{
+		t = Sat.Center - ORBIT_REPORT_SPAN / 2 + Step * ORBIT_REPORT_STEP;
+		for (i = 0; i < 2; i ++)
+		{
+			Query = t - i * ORBIT_REPORT_TRAVEL;
+			SatPosSpeedCache(Sat.system, Query, Sat.Eph, &PosVel, Acc, &Cache);
+			SatPosSpeedCache(Sat.system, Query, Sat.RefEph, &PosVelRef, AccRef, &Reference);
+			Diff = sqrt((PosVel.x - PosVelRef.x) * (PosVel.x - PosVelRef.x) + (PosVel.y - PosVelRef.y) * (PosVel.y - PosVelRef.y) + (PosVel.z - PosVelRef.z) * (PosVel.z - PosVelRef.z));
+			MaxError[0] = (Diff > MaxError[0]) ? Diff : MaxError[0];
+			Diff = sqrt((PosVel.vx - PosVelRef.vx) * (PosVel.vx - PosVelRef.vx) + (PosVel.vy - PosVelRef.vy) * (PosVel.vy - PosVelRef.vy) + (PosVel.vz - PosVelRef.vz) * (PosVel.vz - PosVelRef.vz));
+			MaxError[1] = (Diff > MaxError[1]) ? Diff : MaxError[1];
+			Diff = sqrt((Acc[0] - AccRef[0]) * (Acc[0] - AccRef[0]) + (Acc[1] - AccRef[1]) * (Acc[1] - AccRef[1]) + (Acc[2] - AccRef[2]) * (Acc[2] - AccRef[2]));
+			MaxError[2] = (Diff > MaxError[2]) ? Diff : MaxError[2];
+			Diff = fabs(RelScale * (sin(Cache.Ek) - sin(Reference.Ek)));
+			MaxError[3] = (Diff > MaxError[3]) ? Diff : MaxError[3];
+		}
+	}
+
+	// time of same queries without reference
+	InitOrbitCache(&Cache, Interval);
+	StartTime = std::chrono::high_resolution_clock::now();
+	for (Step = 0; Step < StepNumber; Step ++)
+	{
+		t = Sat.Center - ORBIT_REPORT_SPAN / 2 + Step * ORBIT_REPORT_STEP;
+		SatPosSpeedCache(Sat.system, t, Sat.Eph, &PosVel, NULL, &Cache);
+		SatPosSpeedCache(Sat.system, t - ORBIT_REPORT_TRAVEL, Sat.Eph, &PosVel, Acc, &Cache);
+	}
+	Time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+// batch calculation of all GPS/BDS/Galileo ephemerides against single satellite calculation,
+// AVX2 kernel against scalar kernel and time of each epoch, returns number of checks failed
+static int OrbitBatchReport()
+{
+	PGPS_EPHEMERIS *EphArray[3] = { GpsEph, BdsEph, GalEph };
+	int EphNumber[3] = { TOTAL_GPS_SAT, TOTAL_BDS_SAT, TOTAL_GAL_SAT };
+	GnssSystem SystemList[3] = { GpsSystem, BdsSystem, GalileoSystem };
+	ORBIT_BATCH Batch[3];
+	const GPS_EPHEMERIS *EphList[ORBIT_BATCH_SIZE];
+	KINEMATIC_INFO PosVel[ORBIT_BATCH_SIZE], PosVelAvx2[ORBIT_BATCH_SIZE], PosVelRef;
+	double Acc[ORBIT_BATCH_SIZE][3], AccAvx2[ORBIT_BATCH_SIZE][3], AccRef[3], Clock[ORBIT_BATCH_SIZE];
+	double t, Diff, MaxError[4] = { 0. }, Time[3] = { 0. };
+	bool Valid[ORBIT_BATCH_SIZE], Avx2 = IfKernelSupported(IfKernelAvx2) ? true : false;
+	int i, j, k, Number, SatNumber = 0, Mismatch = 0, Failed = 0;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (i = 0; i < 3; i ++)
+	{
+		for (j = 0, Number = 0; j < EphNumber[i]; j ++)
+			if (EphArray[i][j] && EphArray[i][j]->valid && EphArray[i][j]->health == 0)
+				EphList[Number ++] = EphArray[i][j];
+		SatNumber += SetOrbitBatch(&Batch[i], SystemList[i], EphList, Number);
+	}
+	if (SatNumber == 0)
+		return 0;
+
+	// difference to GpsSatPosSpeedEph() and between kernels
+	for (k = 0; k < ORBIT_REPORT_BATCH_EPOCH; k ++)
+		for (i = 0; i < 3; i ++)
+		{
+			if (Batch[i].SatNumber == 0)
+				continue;
+			t = Batch[i].toe[0] - ORBIT_REPORT_SPAN / 2 + k * ORBIT_REPORT_SPAN / ORBIT_REPORT_BATCH_EPOCH;
+			OrbitBatchPosSpeed(&Batch[i], t, PosVel, Acc, Clock, Valid, IfKernelScalar);
+			if (Avx2)
+			{
+				OrbitBatchPosSpeed(&Batch[i], t, PosVelAvx2, AccAvx2, NULL, NULL, IfKernelAvx2);
+				Mismatch += (memcmp(PosVel, PosVelAvx2, sizeof(KINEMATIC_INFO) * Batch[i].SatNumber) || memcmp(Acc, AccAvx2, sizeof(double) * 3 * Batch[i].SatNumber)) ? 1 : 0;
+			}
+			for (j = 0; j < Batch[i].SatNumber; j ++)
+			{
+				if (Valid[j] != GpsSatPosSpeedEph(SystemList[i], t, Batch[i].Eph[j], &PosVelRef, AccRef))
+					Failed ++;
+				Diff = sqrt((PosVel[j].x - PosVelRef.x) * (PosVel[j].x - PosVelRef.x) + (PosVel[j].y - PosVelRef.y) * (PosVel[j].y - PosVelRef.y) + (PosVel[j].z - PosVelRef.z) * (PosVel[j].z - PosVelRef.z));
+				MaxError[0] = (Diff > MaxError[0]) ? Diff : MaxError[0];
+				Diff = sqrt((PosVel[j].vx - PosVelRef.vx) * (PosVel[j].vx - PosVelRef.vx) + (PosVel[j].vy - PosVelRef.vy) * (PosVel[j].vy - PosVelRef.vy) + (PosVel[j].vz - PosVelRef.vz) * (PosVel[j].vz - PosVelRef.vz));
+				MaxError[1] = (Diff > MaxError[1]) ? Diff : MaxError[1];
+				Diff = sqrt((Acc[j][0] - AccRef[0]) * (Acc[j][0] - AccRef[0]) + (Acc[j][1] - AccRef[1]) * (Acc[j][1] - AccRef[1]) + (Acc[j][2] - AccRef[2]) * (Acc[j][2] - AccRef[2]));
+				MaxError[2] = (Diff > MaxError[2]) ? Diff : MaxError[2];
+				Diff = fabs(Clock[j] - GpsClockCorrection(Batch[i].Eph[j], t));
+				MaxError[3] = (Diff > MaxError[3]) ? Diff : MaxError[3];
+			}
+		}
+
+	// time of each epoch with single satellite calculation, scalar and AVX2 kernel
+	for (k = 0; k < 3; k ++)
+	{
+		if (k == 2 && !Avx2)
+			break;
+		StartTime = std::chrono::high_resolution_clock::now();
+		for (j = 0; j < ORBIT_REPORT_BATCH_EPOCH; j ++)
+			for (i = 0; i < 3; i ++)
+			{
+				t = Batch[i].toe[0] - ORBIT_REPORT_SPAN / 2 + j * ORBIT_REPORT_SPAN / ORBIT_REPORT_BATCH_EPOCH;
+				if (k == 0)
+				{
+					for (Number = 0; Number < Batch[i].SatNumber; Number ++)
+					{
+						Valid[Number] = GpsSatPosSpeedEph(SystemList[i], t, Batch[i].Eph[Number], &PosVel[Number], Acc[Number]);
+						Clock[Number] = GpsClockCorrection(Batch[i].Eph[Number], t);
+					}
+				}
+				else if (Batch[i].SatNumber > 0)
+					OrbitBatchPosSpeed(&Batch[i], t, PosVel, Acc, Clock, Valid, (k == 1) ? IfKernelScalar : IfKernelAvx2);
+			}
+		Time[k] = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count() * 1e6 / ORBIT_REPORT_BATCH_EPOCH;
+	}
+
+	if (MaxError[0] > ORBIT_POS_TOLERANCE || MaxError[1] > ORBIT_VEL_TOLERANCE)
+		Failed ++;
+	Failed += Mismatch;
+	printf("[INFO]\tBatch orbit of %d GPS/BDS/Galileo satellites against single satellite calculation: %.2e mm position, %.2e mm/s velocity, %.2e mm/s^2 acceleration, %.2e ns clock\n",
+		SatNumber, MaxError[0] * 1000, MaxError[1] * 1000, MaxError[2] * 1000, MaxError[3] * 1e9);
+	if (Avx2)
+		printf("[INFO]\tEach epoch: single satellite %.2f us, batch scalar %.2f us, batch AVX2 %.2f us, AVX2 %s scalar kernel\n", Time[0], Time[1], Time[2], Mismatch ? "DIFFERS FROM" : "bit exact to");
+	else
+		printf("[INFO]\tEach epoch: single satellite %.2f us, batch scalar %.2f us, AVX2 not supported\n", Time[0], Time[1]);
+	printf("[INFO]\tBatch orbit %s\n", Failed ? "FAIL" : "PASS");
+	return Failed;
+}
+
+// Compare orbit interpolated from nodes of different intervals against calculation from
+// ephemeris of each query on all visible satellites, and time of each query
+int OrbitReport(double Interval)
+{
+	std::vector<ORBIT_REPORT_SAT> SatList;
+	std::vector<GLONASS_EPHEMERIS> GloEphCopy(GloSatNumber);
+	std::vector<double> IntervalList = { 0., 5., 10., 30., 60., 120., 300. };
+	double MaxError[4], Error[4], Time, DirectTime = 0., TableTime = 0., IntegrateTime = 0.;
+	int i, j, k, Failed = 0;
+	KINEMATIC_INFO PosVel;
+	ORBIT_CONTEXT Context;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	for (i = 0; i < GpsSatNumber; i ++)
+		SatList.push_back({ GpsSystem, GpsEphVisible[i]->svid, GpsEphVisible[i], GpsEphVisible[i], (double)GpsEphVisible[i]->toe });
+	for (i = 0; i < BdsSatNumber; i ++)
+		SatList.push_back({ BdsSystem, BdsEphVisible[i]->svid, BdsEphVisible[i], BdsEphVisible[i], (double)BdsEphVisible[i]->toe });
+	for (i = 0; i < GalSatNumber; i ++)
+		SatList.push_back({ GalileoSystem, GalEphVisible[i]->svid, GalEphVisible[i], GalEphVisible[i], (double)GalEphVisible[i]->toe });
+	for (i = 0; i < GloSatNumber; i ++)
+	{
+		GloEphCopy[i] = *GloEphVisible[i];
+		GloEphCopy[i].OrbitTable = NULL;
+		SatList.push_back({ GlonassSystem, GloEphVisible[i]->n, GloEphVisible[i], &GloEphCopy[i], (double)GloEphVisible[i]->tb });
+	}
+	if (std::find(IntervalList.begin(), IntervalList.end(), Interval) == IntervalList.end())
+		IntervalList.push_back(Interval);
+	std::sort(IntervalList.begin(), IntervalList.end());
+
+	printf("[INFO]\tOrbit of %d satellites over %.0f s around ephemeris reference time, receive time step %.4f s\n", (int)SatList.size(), ORBIT_REPORT_SPAN, ORBIT_REPORT_STEP);
+	printf("+----------+-----------+------------+--------------+-----------+---------+--------+\n");
+	printf("| Interval | Pos (mm)  | Vel (mm/s) | Acc (mm/s^2) | Rel (mm)  | ns/qry  | Result |\n");
+	printf("+----------+-----------+------------+--------------+-----------+---------+--------+\n");
+	for (k = 0; k < (int)IntervalList.size(); k ++)
+	{
+		MaxError[0] = MaxError[1] = MaxError[2] = MaxError[3] = 0.;
+		Time = 0.;
+		for (i = 0; i < (int)SatList.size(); i ++)
+		{
+			OrbitError(SatList[i], IntervalList[k], Error, Time);
+			for (j = 0; j < 4; j ++)
+				MaxError[j] = (Error[j] > MaxError[j]) ? Error[j] : MaxError[j];
+		}
+		Time = Time * 1e9 / (2 * (int)(ORBIT_REPORT_SPAN / ORBIT_REPORT_STEP) * (double)SatList.size());
+		if (IntervalList[k] == 0.)
+		{
+			DirectTime = Time;
+			printf("|   direct |         - |          - |            - |         - | %7.1f |        |\n", Time);
+			continue;
+		}
+		printf("| %6.0f s | %9.2e | %10.2e | %12.2e | %9.2e | %7.1f |%s|\n", IntervalList[k], MaxError[0] * 1000, MaxError[1] * 1000, MaxError[2] * 1000, MaxError[3] * 1000, Time,
+			(IntervalList[k] != Interval) ? "        " : (MaxError[0] <= ORBIT_POS_TOLERANCE && MaxError[1] <= ORBIT_VEL_TOLERANCE && MaxError[3] <= ORBIT_POS_TOLERANCE) ? " * PASS " : " * FAIL ");
+		if (IntervalList[k] == Interval && (MaxError[0] > ORBIT_POS_TOLERANCE || MaxError[1] > ORBIT_VEL_TOLERANCE || MaxError[3] > ORBIT_POS_TOLERANCE))
+			Failed ++;
+	}
+	printf("+----------+-----------+------------+--------------+-----------+---------+--------+\n");
+	printf("[INFO]\t* marks interval in use, tolerance %.2f mm position and relativity, %.3f mm/s velocity, direct calculation %.1f ns/query\n", ORBIT_POS_TOLERANCE * 1000, ORBIT_VEL_TOLERANCE * 1000, DirectTime);
+
+	// GLONASS orbit table against integration from last query, one query each millisecond
+	for (i = 0; i < GloSatNumber; i ++)
+	{
+		StartTime = std::chrono::high_resolution_clock::now();
+		for (k = 0; k < ORBIT_REPORT_GLONASS_MS; k ++)
+			GlonassSatPosSpeedEph(GloEphVisible[i]->tb + k * 0.001, GloEphVisible[i], &PosVel, NULL);
+		TableTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+		Context.Eph = NULL;
+		StartTime = std::chrono::high_resolution_clock::now();
+		for (k = 0; k < ORBIT_REPORT_GLONASS_MS; k ++)
+			GlonassSatPosSpeedEph(GloEphVisible[i]->tb + k * 0.001, &GloEphCopy[i], &PosVel, NULL, &Context);
+		IntegrateTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+	}
+	if (GloSatNumber > 0)
+		printf("[INFO]\tGLONASS orbit table %.1f ns/query, Runge-Kutta integration %.1f ns/query\n", TableTime * 1e9 / ORBIT_REPORT_GLONASS_MS / GloSatNumber, IntegrateTime * 1e9 / ORBIT_REPORT_GLONASS_MS / GloSatNumber);
+	Failed += OrbitBatchReport();
+
+	return Failed;
+}
+
+#define ATMOS_REPORT_SPAN_MS 300000	// milliseconds from scenario start
+#define ATMOS_REPORT_STEP_MS 10	// receive time step in millisecond
+#define ATMOS_REPORT_TIME_MS 10000	// milliseconds of calculation each millisecond to measure speed
+#define ATMOS_DELAY_TOLERANCE 1e-3	// maximum allowed ionosphere/troposphere delay error in meter
+#define ATMOS_REPORT_JUMP 0.01	// delay change within one step taken as discontinuity of delay model
+
+typedef struct
+{
+	GnssSystem system;
+	PGPS_EPHEMERIS Eph;
+	std::vector<double> Iono, Tropo, Elevation;	// calculated each time
+	std::vector<int> JumpStep;	// steps with discontinuity of calculated delay
+} ATMOS_REPORT_SAT;
+
+// ionosphere/troposphere delay of one satellite calculated by CSatelliteParam at each receive
+// time, receiver moves along Receiver[], returns time used in second
+static double AtmosDelaySeries(const ATMOS_REPORT_SAT &Sat, CIonoDelay *IonoModel, const KINEMATIC_INFO Receiver[], const LLA_POSITION ReceiverLla[], int StepMs, int StepNumber, double Interval, int Order, double Iono[], double Tropo[], double Elevation[])
+{
+	CSatelliteParam SatParam;
+	GNSS_TIME Time = CurTime;
+	int Step;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	SatParam.Initialize(Sat.system, Sat.Eph, IonoModel, PowerControl.InitCN0, ElevationAdjustNone);
+	SatParam.SetAtmosInterval(Interval, Order);
+	StartTime = std::chrono::high_resolution_clock::now();
+	for (Step = 0; Step < StepNumber; Step ++)
+	{
+		SatParam.CalculateParam(Receiver[Step], ReceiverLla[Step], Time);
+		Iono[Step] = SatParam.IonoDelayMeter;
+		Tropo[Step] = SatParam.TropoDelayMeter;
+		Elevation[Step] = SatParam.Elevation;
+		if ((Time.MilliSeconds += StepMs) >= 604800000)
+		{
+			Time.Week ++;
+			Time.MilliSeconds -= 604800000;
+		}
+	}
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+}
+
+// Compare ionosphere/troposphere delay interpolated from nodes of different intervals against
+// calculation each time on all visible satellites above elevation mask, and time of each
+// CSatelliteParam::CalculateParam() with one call each millisecond
+int AtmosReport(KINEMATIC_INFO Position, double Interval, int Order)
+{
+	std::vector<ATMOS_REPORT_SAT> SatList;
+	std::vector<double> IntervalList = { 0., 0.1, 0.5, 1., 2., 5., 10. };
+	int StepNumber = ATMOS_REPORT_SPAN_MS / ATMOS_REPORT_STEP_MS, TimeStepNumber = ATMOS_REPORT_TIME_MS;
+	std::vector<KINEMATIC_INFO> Receiver(StepNumber), TimeReceiver(TimeStepNumber);
+	std::vector<LLA_POSITION> ReceiverLla(StepNumber), TimeReceiverLla(TimeStepNumber);
+	std::vector<double> Iono(StepNumber > TimeStepNumber ? StepNumber : TimeStepNumber), Tropo(Iono.size()), Elevation(Iono.size());
+	CIonoKlobuchar8 IonoModel(NavData.GetGpsIono());
+	double MaxError[2], Diff, t, Time, DirectTime = 0.;
+	int i, j, k, Step, JumpNumber = 0, Failed = 0;
+	size_t Jump;
+	bool Skip, Mark;
+
+	for (i = 0; i < GpsSatNumber; i ++)
+		SatList.push_back({ GpsSystem, GpsEphVisible[i] });
+	for (i = 0; i < BdsSatNumber; i ++)
+		SatList.push_back({ BdsSystem, BdsEphVisible[i] });
+	for (i = 0; i < GalSatNumber; i ++)
+		SatList.push_back({ GalileoSystem, GalEphVisible[i] });
+	for (i = 0; i < GloSatNumber; i ++)
+		SatList.push_back({ GlonassSystem, (PGPS_EPHEMERIS)GloEphVisible[i] });
+	if (Interval > 0 && std::find(IntervalList.begin(), IntervalList.end(), Interval) == IntervalList.end())
+		IntervalList.push_back(Interval);
+	std::sort(IntervalList.begin(), IntervalList.end());
+
+	// receiver moves with velocity at scenario start
+	for (Step = 0; Step < StepNumber; Step ++)
+	{
+		t = Step * ATMOS_REPORT_STEP_MS / 1000.;
+		Receiver[Step] = Position;
+		Receiver[Step].x += Position.vx * t; Receiver[Step].y += Position.vy * t; Receiver[Step].z += Position.vz * t;
+		ReceiverLla[Step] = EcefToLla(Receiver[Step]);
+	}
+	for (Step = 0; Step < TimeStepNumber; Step ++)
+	{
+		t = Step / 1000.;
+		TimeReceiver[Step] = Position;
+		TimeReceiver[Step].x += Position.vx * t; TimeReceiver[Step].y += Position.vy * t; TimeReceiver[Step].z += Position.vz * t;
+		TimeReceiverLla[Step] = EcefToLla(TimeReceiver[Step]);
+	}
+	for (i = 0; i < (int)SatList.size(); i ++)
+	{
+		SatList[i].Iono.resize(StepNumber);
+		SatList[i].Tropo.resize(StepNumber);
+		SatList[i].Elevation.resize(StepNumber);
+		AtmosDelaySeries(SatList[i], &IonoModel, Receiver.data(), ReceiverLla.data(), ATMOS_REPORT_STEP_MS, StepNumber, 0., 2, SatList[i].Iono.data(), SatList[i].Tropo.data(), SatList[i].Elevation.data());
+		for (Step = 1; Step < StepNumber; Step ++)
+			if (fabs(SatList[i].Iono[Step] - SatList[i].Iono[Step-1]) > ATMOS_REPORT_JUMP || fabs(SatList[i].Tropo[Step] - SatList[i].Tropo[Step-1]) > ATMOS_REPORT_JUMP)
+				SatList[i].JumpStep.push_back(Step);
+		JumpNumber += (int)SatList[i].JumpStep.size();
+	}
+
+	printf("[INFO]\tAtmosphere delay of %d satellites over %d s from scenario start, receive time step %d ms\n", (int)SatList.size(), ATMOS_REPORT_SPAN_MS / 1000, ATMOS_REPORT_STEP_MS);
+	printf("+----------+-----------+-----------+------------+---------+--------+\n");
+	printf("| Interval | Interp    | Iono (mm) | Tropo (mm) | ns/call | Result |\n");
+	printf("+----------+-----------+-----------+------------+---------+--------+\n");
+	for (k = 0; k < (int)IntervalList.size(); k ++)
+	{
+		for (j = 1; j <= 2; j ++)
+		{
+			if (IntervalList[k] == 0. && j == 1)
+				continue;
+			// error against calculation each time, skip steps within two intervals of delay model discontinuity
+			MaxError[0] = MaxError[1] = 0.;
+			if (IntervalList[k] > 0)
+			{
+				for (i = 0; i < (int)SatList.size(); i ++)
+				{
+					AtmosDelaySeries(SatList[i], &IonoModel, Receiver.data(), ReceiverLla.data(), ATMOS_REPORT_STEP_MS, StepNumber, IntervalList[k], j, Iono.data(), Tropo.data(), Elevation.data());
+					for (Step = 0, Jump = 0; Step < StepNumber; Step ++)
+					{
+						while (Jump < SatList[i].JumpStep.size() && (SatList[i].JumpStep[Jump] - Step) * ATMOS_REPORT_STEP_MS < -2000 * IntervalList[k])
+							Jump ++;
+						Skip = (Jump < SatList[i].JumpStep.size() && (SatList[i].JumpStep[Jump] - Step) * ATMOS_REPORT_STEP_MS <= 2000 * IntervalList[k]);
+						if (Skip || SatList[i].Elevation[Step] < OutputParam.ElevationMask)
+							continue;
+						Diff = fabs(Iono[Step] - SatList[i].Iono[Step]);
+						MaxError[0] = (Diff > MaxError[0]) ? Diff : MaxError[0];
+						Diff = fabs(Tropo[Step] - SatList[i].Tropo[Step]);
+						MaxError[1] = (Diff > MaxError[1]) ? Diff : MaxError[1];
+					}
+				}
+			}
+
+			// time of calculation each millisecond
+			for (i = 0, Time = 0.; i < (int)SatList.size(); i ++)
+				Time += AtmosDelaySeries(SatList[i], &IonoModel, TimeReceiver.data(), TimeReceiverLla.data(), 1, TimeStepNumber, IntervalList[k], j, Iono.data(), Tropo.data(), Elevation.data());
+			Time = Time * 1e9 / ((double)TimeStepNumber * SatList.size());
+			if (IntervalList[k] == 0.)
+			{
+				DirectTime = Time;
+				printf("|   direct |         - |         - |          - | %7.1f |        |\n", Time);
+				continue;
+			}
+			Mark = (IntervalList[k] == Interval && j == Order);
+			printf("| %6.1f s | %-9s | %9.2e | %10.2e | %7.1f |%s|\n", IntervalList[k], (j == 1) ? "linear" : "quadratic", MaxError[0] * 1000, MaxError[1] * 1000, Time,
+				!Mark ? "        " : (MaxError[0] <= ATMOS_DELAY_TOLERANCE && MaxError[1] <= ATMOS_DELAY_TOLERANCE) ? " * PASS " : " * FAIL ");
+			if (Mark && (MaxError[0] > ATMOS_DELAY_TOLERANCE || MaxError[1] > ATMOS_DELAY_TOLERANCE))
+				Failed ++;
+		}
+	}
+	printf("+----------+-----------+-----------+------------+---------+--------+\n");
+	printf("[INFO]\t* marks setting in use, tolerance %.2f mm, direct calculation %.1f ns/call, %d delay model discontinuities skipped\n", ATMOS_DELAY_TOLERANCE * 1000, DirectTime, JumpNumber);
+
+	return Failed;
+}
+
+void ShowHelp(const char* ProgramPath)
+{
+	// Extract just the executable name from the path
+	std::string PathName = ProgramPath;
+	std::string ProgramName;
+	size_t pos = PathName.find_last_of("/\\");
+	if (pos == std::string::npos)
+		ProgramName = PathName;
+	else
+		ProgramName = PathName.substr(pos + 1);
+
+	std::cout << "IFdataTest - checks of IFdataGen signal synthesis\n\n";
+	std::cout << "Usage: " << ProgramName << " <CHECK> [options]\n\n";
+	std::cout << "Available checks:\n";
+	std::cout << "   kernel     compare all supported kernels against scalar kernel\n";
+	std::cout << "   precision  compare float and double synthesis SNR\n";
+	std::cout << "   cn0        compare channel CN0 of int16 and double synthesis\n";
+	std::cout << "   carrier    carrier NCO SFDR of each table size\n";
+	std::cout << "   variant    compare specialized PRN kernels against generic kernel per signal\n";
+	std::cout << "   split      compare channel generated in sub-ranges against whole millisecond\n";
+	std::cout << "   quant      compare quantizers of all supported kernels against scalar kernel\n";
+	std::cout << "   noise      compare noise generators against scalar kernel and check statistics\n";
+	std::cout << "   pool       check noise pool repetition, autocorrelation and throughput\n";
+	std::cout << "   orbit      compare interpolated and batch satellite orbit against ephemeris calculation\n";
+	std::cout << "   atmos      compare interpolated atmosphere delay against calculation each time\n\n";
+	std::cout << "Available options:\n";
+	std::cout << "   -c, 	--config <FILE>    Configuration file (JSON) of the scenario (default configs/test/GPS_L1CA_L1C.json)\n";
+	std::cout << "   -k, 	--kernel <ISA>     IF sample kernel: scalar, sse4.2, avx2, avx512 or auto (default)\n";
+	std::cout << "   -cr, 	--chip-run <MODE>  Chip run engine: on, off or auto (default, decided by samples per chip)\n";
+	std::cout << "   -sp, 	--sample-type <T>  IF synthesis sample type: double, float or int16 (overrides config)\n";
+	std::cout << "   -ns, 	--noise-seed <N>   Seed of white noise (decimal or 0x hex)\n";
+	std::cout << "   -np, 	--noise-pool <MS>  Noise pool of MS milliseconds of samples\n";
+	std::cout << "   -npp,	--noise-period <MS> Noise read from pool repeats every MS milliseconds (default no repeat)\n";
+	std::cout << "   -oi, 	--orbit-interval <S> Satellite orbit interpolation node interval (default 30), 0 calculates from ephemeris\n";
+	std::cout << "   -ai, 	--atmos-interval <S> Ionosphere/troposphere delay node interval (default 1), 0 calculates each millisecond\n";
+	std::cout << "   -aip,	--atmos-interp <M> Atmosphere delay interpolation between nodes: linear or quadratic (default)\n";
+	std::cout << "   -h, 	--help             Show this help message\n\n";
+	std::cout << "Exit code is 0 if the check passes, 1 if it fails\n\n";
+	std::cout << "Examples:\n";
+	std::cout << "   " << ProgramName << " kernel -c configs/test/GPS_L5.json\n";
+	std::cout << "   " << ProgramName << " split -c configs/test/GPS_L1CA_L1C.json -sp int16\n";
+	std::cout << "   " << ProgramName << " pool -np 100 -npp 10\n\n";
+}
+
+bool ParseCommandLineArgs(int argc, char* argv[], TestArguments &Arguments)
+{
+	const std::vector<std::string> CommandList = {
+		"--help", "-h",	// 0
+		"--config", "-c",	// 1
+		"--kernel", "-k",	// 2
+		"--chip-run", "-cr",	// 3
+		"--sample-type", "-sp",	// 4
+		"--noise-seed", "-ns",	// 5
+		"--noise-pool", "-np",	// 6
+		"--noise-period", "-npp",	// 7
+		"--orbit-interval", "-oi",	// 8
+		"--atmos-interval", "-ai",	// 9
+		"--atmos-interp", "-aip",	// 10
+	};
+	std::string arg;
+	int i = 1, index;
+
+	while (i < argc)
+	{
+		auto it = std::find(CommandList.begin(), CommandList.end(), argv[i]);
+		index = (it == CommandList.end()) ? -1 : (it - CommandList.begin()) / 2;
+		arg = argv[i];
+
+		switch (index)
+		{
+		case 0:	// --help
+			ShowHelp(argv[0]);
+			exit(0);
+		case 1:	// --config
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a filename argument\n";
+				return false;
+			}
+			Arguments.ConfigFile = argv[++i];
+			break;
+		case 2:	// --kernel
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a kernel name argument\n";
+				return false;
+			}
+			Arguments.Kernel = argv[++i];
+			break;
+		case 3:	// --chip-run
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a mode argument\n";
+				return false;
+			}
+			Arguments.ChipRun = argv[++i];
+			break;
+		case 4:	// --sample-type
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a sample type argument\n";
+				return false;
+			}
+			Arguments.SampleType = argv[++i];
+			break;
+		case 5:	// --noise-seed
+			if (i + 1 >= argc || argv[i+1][0] == '-')
+			{
+				std::cerr << "[ERROR] " << arg << " requires a seed argument\n";
+				return false;
+			}
+			Arguments.NoiseSeed = strtoull(argv[++i], NULL, 0);
+			break;
+		case 6:	// --noise-pool
+			if (i + 1 >= argc || atoi(argv[i+1]) < 1)
+			{
+				std::cerr << "[ERROR] " << arg << " requires pool length in ms\n";
+				return false;
+			}
+			Arguments.NoisePoolMs = atoi(argv[++i]);
+			break;
+		case 7:	// --noise-period
+			if (i + 1 >= argc || atoi(argv[i+1]) < 1)
+			{
+				std::cerr << "[ERROR] " << arg << " requires period in ms\n";
+				return false;
+			}
+			Arguments.NoisePeriod = atoi(argv[++i]);
+			break;
+		case 8:	// --orbit-interval
+			if (i + 1 >= argc || argv[i+1][0] == '-' || atof(argv[i+1]) < 0)
+			{
+				std::cerr << "[ERROR] " << arg << " requires interval in second\n";
+				return false;
+			}
+			Arguments.OrbitInterval = atof(argv[++i]);
+			break;
+		case 9:	// --atmos-interval
+			if (i + 1 >= argc || argv[i+1][0] == '-' || atof(argv[i+1]) < 0)
+			{
+				std::cerr << "[ERROR] " << arg << " requires interval in second\n";
+				return false;
+			}
+			Arguments.AtmosInterval = atof(argv[++i]);
+			break;
+		case 10:	// --atmos-interp
+			if (i + 1 >= argc || (std::string(argv[i+1]) != "linear" && std::string(argv[i+1]) != "quadratic"))
+			{
+				std::cerr << "[ERROR] " << arg << " requires linear or quadratic\n";
+				return false;
+			}
+			Arguments.AtmosOrder = (std::string(argv[++i]) == "linear") ? 1 : 2;
+			break;
+		default:
+			if (arg[0] != '-' && Arguments.Check.empty())	// first argument not an option is the check to run
+				Arguments.Check = arg;
+			else
+				std::cout << "[WARNING] Unknown option " << arg << "\n";
+		}
+		i ++;	// move to next argument
+	}
+
+	return true;
+}
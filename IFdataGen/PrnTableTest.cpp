@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <memory.h>
+#include <iostream>
+#include <chrono>
+
+#include "PrnGenerate.h"
+
+// Check of PRN code tables generated at compile time (PRN_STATIC_TABLES) against the
+// runtime code generators, only built with PRN_STATIC_TABLES
+
+#define TOTAL_GPS_SAT 32
+#define TOTAL_BDS_SAT 63
+#define TOTAL_GAL_SAT 36
+#define TOTAL_GLO_SAT 24
+
+int PrnTableCheck();
+
+const char *SignalName[][8] = {
+	{ "L1CA", "L1C", "L2C", "L2P", "L5", },
+	{ "B1C", "B1I", "B2I", "B3I", "B2a", "B2b", "B2ab", },
+	{ "E1", "E5a", "E5b", "E5", "E6", },
+	{ "G1", "G2", },
+};
+
+int main()
+{
+	int Failed;
+
+	if (!PrnGenerate::HasStaticTable())
+	{
+		std::cerr << "[ERROR]\tStatic PRN tables not built, build with PRN_STATIC_TABLES\n";
+		return 1;
+	}
+	Failed = PrnTableCheck();
+	printf("[INFO]\tCheck prn %s\n", Failed ? "FAILED" : "PASSED");
+
+	return Failed ? 1 : 0;
+}
+
+// number of code arrays of two PrnGenerate objects with different content
+static int PrnCodeMismatch(const PrnGenerate *Prn1, const PrnGenerate *Prn2)
+{
+	int DataChips, PilotChips, Mismatch = 0;
+
+	if (Prn1->Attribute != Prn2->Attribute)
+		return 1;
+	if (!Prn1->Attribute)
+		return 0;
+	DataChips = Prn1->Attribute->DataPeriod * Prn1->Attribute->ChipRate;
+	PilotChips = Prn1->Attribute->PilotPeriod * Prn1->Attribute->ChipRate;
+	if (Prn1->Attribute->Attribute & (PRN_ATTRIBUTE_BOC | PRN_ATTRIBUTE_TMD))
+	{
+		DataChips >>= 1;
+		PilotChips >>= 1;
+	}
+	if (DataChips > 10230 * 2)	// P code not generated, only 20460 chips of zero
+		DataChips = 10230 * 2;
+	if ((!Prn1->DataPrn != !Prn2->DataPrn) || (Prn1->DataPrn && memcmp(Prn1->DataPrn, Prn2->DataPrn, (DataChips + 31) / 32 * sizeof(unsigned int))))
+		Mismatch ++;
+	if ((!Prn1->PilotPrn != !Prn2->PilotPrn) || (Prn1->PilotPrn && memcmp(Prn1->PilotPrn, Prn2->PilotPrn, (PilotChips + 31) / 32 * sizeof(unsigned int))))
+		Mismatch ++;
+	if ((!Prn1->CombinedPrn != !Prn2->CombinedPrn) || (Prn1->CombinedPrn && memcmp(Prn1->CombinedPrn, Prn2->CombinedPrn, (DataChips + 15) / 16 * sizeof(unsigned int))))
+		Mismatch ++;
+	return Mismatch;
+}
+
+// Compare PRN codes from compile time generated tables (built with PRN_STATIC_TABLES)
+// against runtime code generators for all satellites of each signal, and the time
+// to get the codes each way
+int PrnTableCheck()
+{
+	const GnssSystem SystemList[4] = { GpsSystem, BdsSystem, GalileoSystem, GlonassSystem };
+	const char *SystemName[4] = { "GPS", "BDS", "Galileo", "GLONASS" };
+	const int SatNumber[4] = { TOTAL_GPS_SAT, TOTAL_BDS_SAT, TOTAL_GAL_SAT, TOTAL_GLO_SAT };
+	const int SignalNumber[4] = { SIGNAL_INDEX_L5 + 1, SIGNAL_INDEX_B2b + 1, SIGNAL_INDEX_E6 + 1, SIGNAL_INDEX_G2 + 1 };
+	PrnGenerate *RuntimePrn[TOTAL_BDS_SAT], *StaticPrn[TOTAL_BDS_SAT];
+	int i, System, SignalIndex, Mismatch, Failed = 0;
+	double RuntimeTime, StaticTime, TotalRuntime = 0., TotalStatic = 0.;
+	std::chrono::high_resolution_clock::time_point StartTime;
+
+	printf("[INFO]\tCompare static PRN tables against runtime generators\n");
+	printf("+---------+--------+-----+------------+------------+-----------+--------+\n");
+	printf("| System  | Signal | SVs | Mismatches | Runtime ms | Static ms | Result |\n");
+	printf("+---------+--------+-----+------------+------------+-----------+--------+\n");
+	for (System = 0; System < 4; System ++)
+		for (SignalIndex = 0; SignalIndex < SignalNumber[System]; SignalIndex ++)
+		{
+			StartTime = std::chrono::high_resolution_clock::now();
+			for (i = 0; i < SatNumber[System]; i ++)
+				RuntimePrn[i] = new PrnGenerate(SystemList[System], SignalIndex, i + 1, FALSE);
+			RuntimeTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			StartTime = std::chrono::high_resolution_clock::now();
+			for (i = 0; i < SatNumber[System]; i ++)
+				StaticPrn[i] = new PrnGenerate(SystemList[System], SignalIndex, i + 1);
+			StaticTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - StartTime).count();
+			Mismatch = 0;
+			for (i = 0; i < SatNumber[System]; i ++)
+				Mismatch += PrnCodeMismatch(RuntimePrn[i], StaticPrn[i]);
+			if (RuntimePrn[0]->Attribute)	// skip signals without PRN code
+			{
+				printf("| %-7s | %-6s | %3d | %10d | %10.3f | %9.3f | %-6s |\n", SystemName[System], SignalName[System][SignalIndex], SatNumber[System],
+					Mismatch, RuntimeTime, StaticTime, Mismatch ? "FAIL" : "PASS");
+				TotalRuntime += RuntimeTime;
+				TotalStatic += StaticTime;
+			}
+			if (Mismatch)
+				Failed ++;
+			for (i = 0; i < SatNumber[System]; i ++)
+			{
+				delete RuntimePrn[i];
+				delete StaticPrn[i];
+			}
+		}
+	printf("+---------+--------+-----+------------+------------+-----------+--------+\n");
+	printf("[INFO]\tTotal %.3f ms runtime generation, %.3f ms static tables, %d signals failed\n", TotalRuntime, TotalStatic, Failed);
+
+	return Failed;
+}
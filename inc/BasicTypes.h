@@ -150,8 +150,6 @@ typedef struct // GPS ephemeris, also used by BDS, Galileo, QZSS and NavIC
 	double root_ecc;	// Square Root of One Minus Ecc Square, equals to sqrt(1-ecc^2)
 	double omega_t;		// Longitude of Ascending Node of Orbit Plane at toe, equals to omega0 - WGS_OMEGDOTE * toe
 	double omega_delta;	// Delta Between omega_dot and WGS_OMEGDOTE, equals to omega_dot - WGS_OMEGDOTE
-	double Ek;			// Ek, derived from Mk
-	double Ek_dot;		// change rate of Ek
 } GPS_EPHEMERIS, *PGPS_EPHEMERIS;
 
 // definitions for source field
@@ -186,10 +184,22 @@ typedef struct
 	double af1;			// Satellite Clock Correction
 } GPS_ALMANAC, *PGPS_ALMANAC;
 
+// GLONASS orbit integrated once from ephemeris into nodes within tb-Span to tb+Span,
+// position between nodes interpolated, integration continues from first or last node
+// for time out of the table
+typedef struct
+{
+	int NodeNumber;
+	double Step;		// node interval in second
+	double Span;		// table covers tb-Span to tb+Span
+	PKINEMATIC_INFO PosVel;	// position and velocity in PZ-90 at each node
+	double (*Acc)[3];	// acceleration in PZ-90 at each node
+	double StateFirst[6], StateLast[6];	// position and velocity in CIS coordinate at first and last node
+} GLONASS_ORBIT_TABLE, *PGLONASS_ORBIT_TABLE;
+
 typedef struct
 {
 	unsigned char flag;	// bit0 means ephemeris valid
-						// bit1 means position and velocity at tc valid (avoid extrapolation from beginning)
 	signed char freq;	// frequency number of satellite
 	unsigned char P;	// place P1, P2, P3, P4, ln, P from LSB at bit
 						//      0/1, 2, 3, 4, 5, 6/7
@@ -207,11 +217,19 @@ typedef struct
 	double x, y, z;		// posistion in PZ-90 at instant tb
 	double vx, vy, vz;	// velocity in PZ-90 at instant tb
 	double ax, ay, az;	// acceleration in PZ-90 at instant tb
+	PGLONASS_ORBIT_TABLE OrbitTable;	// built when ephemeris added to CNavData, NULL if not built
+} GLONASS_EPHEMERIS, *PGLONASS_EPHEMERIS;
 
-	// derived variables
+// orbit propagation state of one satellite, kept outside ephemeris so ephemeris is read
+// only during simulation and each satellite can be calculated in its own thread
+typedef struct
+{
+	const void *Eph;	// ephemeris the GLONASS state derived from, NULL if not yet calculated
+	double Ek;			// Ek of last calculation, derived from Mk
+	double Ek_dot;		// change rate of Ek
 	double tc;			// reference time giving the following position and velocity
 	KINEMATIC_INFO PosVelT;	// position and velocity in CIS coordinate at instant tc
-} GLONASS_EPHEMERIS, *PGLONASS_EPHEMERIS;
+} ORBIT_CONTEXT, *PORBIT_CONTEXT;
 
 typedef struct
 {
@@ -294,6 +312,7 @@ typedef struct
 
 typedef enum { OutputTypePosition, OutputTypeObservation, OutputTypeIFdata, OutputTypeBaseband } OutputType;
 typedef enum { OutputFormatEcef, OutputFormatLla, OutputFormatNmea, OutputFormatKml, OutputFormatRinex, OutputFormatIQ16, OutputFormatIQ8, OutputFormatIQ4, OutputFormatIQ2 } OutputFormat;
+typedef enum { IfSampleDouble, IfSampleFloat, IfSampleInt16 } IfSampleType;	// sample type of IF synthesis pipeline
 
 typedef struct
 {
@@ -308,6 +327,7 @@ typedef struct
 	int Interval;	// in millisecond
 	int SampleFreq, CenterFreq;	// in kHz
 	unsigned int FreqSelect[4];	// Frequency select mask, 0~3 for GPS/BDS/Galileo/GLONASS respectively, bit selection uses SIGNAL_INDEX_XXXX
+	IfSampleType SampleType;	// sample type used to synthesize IF data
 } OUTPUT_PARAM, *POUTPUT_PARAM;
 
 typedef struct
@@ -30,4 +30,42 @@ public:
 	complex_number conj();
 };
 
+// single precision complex number used by float32 IF sample pipeline
+class complex_float
+{
+public:
+	float real;
+	float imag;
+
+	complex_float() { real = imag = 0.f; };
+	complex_float(float real_part, float imag_part) { real = real_part; imag = imag_part; };
+	complex_float(const complex_number data) { real = (float)data.real; imag = (float)data.imag; };
+	void operator += (const complex_float data) { real += data.real; imag += data.imag; };
+	void operator *= (const float data) { real *= data; imag *= data; };
+};
+
+// 16bit integer complex number used by fixed point IF sample pipeline
+class complex_int16
+{
+public:
+	short real;
+	short imag;
+
+	complex_int16() { real = imag = 0; };
+	complex_int16(short real_part, short imag_part) { real = real_part; imag = imag_part; };
+};
+
+// 32bit integer complex number to accumulate complex_int16 samples without overflow
+class complex_int32
+{
+public:
+	int real;
+	int imag;
+
+	complex_int32() { real = imag = 0; };
+	complex_int32(int real_part, int imag_part) { real = real_part; imag = imag_part; };
+	void operator += (const complex_int16 data) { real += data.real; imag += data.imag; };
+	void operator += (const complex_int32 data) { real += data.real; imag += data.imag; };
+};
+
 #endif //!defined(__COMPLEX_NUMBER_H__)
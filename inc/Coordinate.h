@@ -11,10 +11,22 @@
 
 #include "BasicTypes.h"
 
-double GpsClockCorrection(PGPS_EPHEMERIS Eph, double TransmitTime);
-double GlonassClockCorrection(PGLONASS_EPHEMERIS Eph, double TransmitTime);
-bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pEph, PKINEMATIC_INFO pPosVel, double Acc[3]);
-bool GlonassSatPosSpeedEph(double TransmitTime, PGLONASS_EPHEMERIS pEph, PKINEMATIC_INFO pPosVel, double Acc[3]);
+double GpsClockCorrection(const GPS_EPHEMERIS *Eph, double TransmitTime);
+double GlonassClockCorrection(const GLONASS_EPHEMERIS *Eph, double TransmitTime);
+// ephemeris is not modified, propagation state (Ek, GLONASS state at last time) goes to
+// Context if given, GLONASS orbit integrated from tb if Context is NULL or of other ephemeris
+bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, const GPS_EPHEMERIS *pEph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CONTEXT Context = NULL);
+// rotate position/velocity/acceleration of BDS GEO satellite from orbit plane coordinate
+// to CGCS2000, DeltaT is time from toe
+void BdsGeoToCgcs2000(double DeltaT, PKINEMATIC_INFO pPosVel, double Acc[3]);
+bool GlonassSatPosSpeedEph(double TransmitTime, const GLONASS_EPHEMERIS *pEph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CONTEXT Context = NULL);
+// orbit table of GLONASS ephemeris (free() to release), GlonassSatPosSpeedEph() interpolates
+// within the table and integrates only out of the table
+PGLONASS_ORBIT_TABLE BuildGlonassOrbitTable(const GLONASS_EPHEMERIS *pEph);
+// quintic Hermite polynomial of x/y/z on s=(t-t0)/h within [0,1] matching position, velocity
+// and acceleration at t0 and t0+h, and position, velocity and acceleration at s
+void HermiteCoef(const KINEMATIC_INFO *PosVel0, const double Acc0[3], const KINEMATIC_INFO *PosVel1, const double Acc1[3], double h, double Coef[3][6]);
+void HermitePosSpeed(const double Coef[3][6], double s, double h, PKINEMATIC_INFO pPosVel, double Acc[3]);
 LLA_POSITION EcefToLla(KINEMATIC_INFO ecef_pos);
 KINEMATIC_INFO LlaToEcef(LLA_POSITION lla_pos);
 CONVERT_MATRIX CalcConvMatrix(KINEMATIC_INFO Position);
@@ -23,10 +23,76 @@ public:
     static constexpr int TRIG_LUT_SIZE = 1 << TRIG_LUT_DEPTH;
     static constexpr double TRIG_LUT_SCALE = TRIG_LUT_SIZE / PI2;
     static constexpr int TRIG_LUT_SHIFT = 32 - TRIG_LUT_DEPTH;
+
+    // Compact carrier NCO table: cos/sin of the first quadrant interleaved in one
+    // table, other quadrants derived by symmetry so that the double table of
+    // default depth (1024 entries) is 16KB and stays in L1 cache. Entry i is
+    // cos/sin at the center of bin i, residual phase within the bin optionally
+    // corrected by first order (tangent) interpolation
+    static constexpr int CARRIER_LUT_MIN_DEPTH = 7;
+    static constexpr int CARRIER_LUT_MAX_DEPTH = 12;
+    static constexpr int CARRIER_LUT_DEFAULT_DEPTH = 10;
+    static constexpr int CARRIER_LUT_INT_BITS = 14;	// fraction bits of int16 table (Q14)
+    static constexpr int CARRIER_RESIDUAL_BITS = 6;	// residual phase bits used by int16 interpolation
+    static constexpr double CARRIER_PHASE_SCALE = PI2 / 4294967296.;	// radian per LSB of 32bit phase
+
+    // Parameters of current carrier table, copied to local variable by kernels
+    struct CarrierNco {
+        const double *lut;	// cos/sin pairs
+        const float *lut_float;	// cos/sin pairs
+        const int *lut_int16;	// Q14 cos in lower 16bit and sin in upper 16bit
+        int depth;	// number of entries is 1 << depth
+        int shift;	// phase bits below table index
+        unsigned int index_mask;
+        unsigned int residual_mask;
+        int half_bin;	// residual phase is relative to bin center
+        double delta_scale;	// radian per residual LSB, 0 if no interpolation
+        int delta_shift;	// residual shift for int16 interpolation
+        int delta_scale_int;	// radian per shifted residual LSB in Q24, 0 if no interpolation
+
+        // cos/sin of 32bit phase (2^32 as one cycle)
+        FORCE_INLINE void Lookup(unsigned int phase, double &cos_value, double &sin_value) const {
+            int index = (phase >> shift) & index_mask;
+            double delta = (int)((phase & residual_mask) - half_bin) * delta_scale;
+            double c = lut[index * 2], s = lut[index * 2 + 1];
+            double cos_base = c - delta * s, sin_base = s + delta * c;
+            Rotate(phase, cos_base, sin_base, cos_value, sin_value);
+        }
+        FORCE_INLINE void Lookup(unsigned int phase, float &cos_value, float &sin_value) const {
+            int index = (phase >> shift) & index_mask;
+            float delta = (float)(int)((phase & residual_mask) - half_bin) * (float)delta_scale;
+            float c = lut_float[index * 2], s = lut_float[index * 2 + 1];
+            float cos_base = c - delta * s, sin_base = s + delta * c;
+            Rotate(phase, cos_base, sin_base, cos_value, sin_value);
+        }
+        // Q14 result
+        FORCE_INLINE void Lookup(unsigned int phase, int &cos_value, int &sin_value) const {
+            int pair = lut_int16[(phase >> shift) & index_mask];
+            int c = (short)(pair & 0xffff), s = pair >> 16;
+            int delta = ((int)((phase & residual_mask) - half_bin) >> delta_shift) * delta_scale_int;	// Q24 angle
+            int cos_base = c - ((s * delta + (1 << 23)) >> 24);
+            int sin_base = s + ((c * delta + (1 << 23)) >> 24);
+            Rotate(phase, cos_base, sin_base, cos_value, sin_value);
+        }
+        // rotate first quadrant value to quadrant of phase
+        template <typename T> static FORCE_INLINE void Rotate(unsigned int phase, T cos_base, T sin_base, T &cos_value, T &sin_value) {
+            int swap = (phase >> 30) & 1;
+            cos_value = swap ? sin_base : cos_base;
+            sin_value = swap ? cos_base : sin_base;
+            if ((phase + 0x40000000) & 0x80000000)	// second and third quadrant
+                cos_value = -cos_value;
+            if (phase & 0x80000000)	// third and fourth quadrant
+                sin_value = -sin_value;
+        }
+    };
     
 private:
     // Static lookup tables
     static double sin_lut[TRIG_LUT_SIZE + TRIG_LUT_SIZE / 4];
+    static double carrier_lut[2 << CARRIER_LUT_MAX_DEPTH];
+    static float carrier_lut_float[2 << CARRIER_LUT_MAX_DEPTH];
+    static int carrier_lut_int16[1 << CARRIER_LUT_MAX_DEPTH];
+    static CarrierNco carrier_nco;
 //    static double cos_lut[TRIG_LUT_SIZE];
     static bool lut_initialized;
     
@@ -39,10 +105,22 @@ public:
                 sin_lut[i] = std::sin(angle);
 //                cos_lut[i] = std::cos(angle);
             }
+            SetCarrierLut(CARRIER_LUT_DEFAULT_DEPTH, true);
             lut_initialized = true;
         }
     }
 
+    // Direct access to lookup table, cos(x) at index + TRIG_LUT_SIZE / 4
+    static const double *GetSinLut() {
+        return sin_lut;
+    }
+
+    // Rebuild carrier table with 1 << depth entries, not thread safe with running kernels
+    static bool SetCarrierLut(int depth, bool interpolate);
+    static const CarrierNco &GetCarrierNco() {
+        return carrier_nco;
+    }
+
     // Fast sine using lookup table - force inline for performance
     static FORCE_INLINE double FastSin(double angle) {
         // Normalize angle to [0, 2*PI)
@@ -94,16 +172,9 @@ public:
         return complex_number(sin_lut[angle_index + TRIG_LUT_SIZE / 4], sin_lut[angle_index]);
     }
     
-    // Fast noise generation using Box-Muller with cached values
+    // Gaussian noise using Marsaglia polar method, both outputs of each accepted
+    // pair are used as real and imaginary part
     static complex_number FastGaussianNoise(double sigma) {
-        static bool hasSpare = false;
-        static double spare;
-        
-        if (hasSpare) { // this will result the Gauss noise only has real part on every other sample
-            hasSpare = false;
-            return complex_number(spare * sigma, 0);
-        }
-        
         double u1, u2, mag;
         do {
             u1 = 2.0 * ((double)rand() / RAND_MAX) - 1.0;
@@ -111,11 +182,8 @@ public:
             mag = u1 * u1 + u2 * u2;
         } while (mag >= 1.0 || mag == 0.0);
         
-        double factor = std::sqrt(-2.0 * std::log(mag) / mag);
-        spare = u2 * factor;
-        hasSpare = true;
-        
-        return complex_number(u1 * factor * sigma, u2 * factor * sigma);
+        double factor = std::sqrt(-2.0 * std::log(mag) / mag) * sigma;
+        return complex_number(u1 * factor, u2 * factor);
     }
     
     // Batch noise generation for better cache efficiency
@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------
+// IfDataWriter.h:
+//   Declaration of IF data output stage writing quantized samples
+//   on a separate thread through a ring of buffer slots
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#ifndef __IF_DATA_WRITER_H__
+#define __IF_DATA_WRITER_H__
+
+#include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "BasicTypes.h"
+
+#define IF_WRITER_SLOTS 4	// default number of ring slots
+#define IF_WRITER_MAX_SLOTS 64
+#define IF_WRITER_CHUNK (4 << 20)	// size of aligned write buffer (and stdio buffer)
+#define IF_WRITER_ALIGN 4096	// buffer, size and offset alignment of O_DIRECT writes
+#define IF_WRITER_DEPTH 4	// write buffers in flight of io_uring backend
+
+// backend writing slots to file, direct and io_uring bypass page cache with O_DIRECT, mmap
+// quantizes into preallocated and mapped output file (all Linux only), auto selects the first
+// supported of io_uring, direct and stdio
+enum IfWriterBackend { IfWriterStdio = 0, IfWriterDirect, IfWriterUring, IfWriterMmap, IfWriterAuto };
+
+// statistics of output stage, time in seconds
+typedef struct
+{
+	long long SlotsWritten;
+	long long BytesWritten;
+	long long ProducerStalls;	// number of AcquireSlot() finding all slots full
+	long long WriterStalls;	// number of times writer thread found no slot to write
+	double ProducerWaitTime;	// time generation waited for a free slot
+	double WriterWaitTime;	// time writer thread waited for a filled slot
+	double OccupancySum;	// sum of filled slots seen at each SubmitSlot(), divided by SlotsWritten gives average
+	int MaxOccupancy;
+	long long WriteCount;	// number of fwrite() calls, O_DIRECT writes or io_uring requests
+	double WriteLatency;	// sum of latency of all writes, from issue to completion
+	double MaxWriteLatency;
+	double IoTime;	// time with at least one write in progress, BytesWritten / IoTime gives write rate
+} IF_WRITER_STATS, *PIF_WRITER_STATS;
+
+// Generation (producer) gets a free slot with AcquireSlot(), fills it and queues it with
+// SubmitSlot(), writer thread (consumer) writes queued slots to file in order, so the next
+// block is generated while the previous one is written. Single producer single consumer,
+// slot indices are atomics and each side only waits on condition variable when the ring is
+// full/empty. SlotNumber 0 writes synchronously within SubmitSlot() without a writer thread
+// Direct and io_uring backends collect slots into IF_WRITER_CHUNK aligned buffers and write
+// them through file descriptor of File with O_DIRECT, last partial block is written padded
+// and file is truncated to actual length at Finish(). Unsupported backend falls back to the
+// next one (io_uring -> direct -> stdio), GetBackend() gives the one in use
+// Mmap backend needs expected FileSize, it preallocates and maps the file and AcquireSlot()
+// returns the file position of the slot in the mapping, so generation threads write samples
+// in place with neither copy nor writer thread (SlotNumber becomes 0). The mapping grows if
+// more data comes and Finish() truncates file to the data submitted; falls back to stdio
+class CIfDataWriter
+{
+public:
+	CIfDataWriter(FILE *File, int SlotSize, int SlotNumber = IF_WRITER_SLOTS, IfWriterBackend Backend = IfWriterStdio, long long FileSize = 0);
+	~CIfDataWriter();
+	unsigned char *AcquireSlot();	// wait for a free slot and return its buffer of SlotSize bytes, NULL if mapping fails
+	void SubmitSlot(int Size);	// queue first Size bytes of slot from last AcquireSlot()
+	BOOL Finish();	// write all queued slots and stop writer thread, return FALSE if any write failed
+	int GetSlotNumber() { return SlotNumber; }
+	IfWriterBackend GetBackend() { return Backend; }
+	const IF_WRITER_STATS &GetStats() { return Stats; }
+
+private:
+	FILE *OutFile;
+	int SlotSize, SlotNumber;
+	unsigned char *Buffer;	// SlotNumber (at least 1) slots of SlotSize bytes
+	int *SlotLength;	// bytes to write of each slot
+	std::atomic<unsigned int> Head;	// number of slots submitted, written by producer
+	std::atomic<unsigned int> Tail;	// number of slots written, written by writer thread
+	std::atomic<bool> Stopping;
+	std::atomic<int> Sleeping;	// number of sides waiting on condition variable
+	std::atomic<bool> WriteFailed;
+	std::mutex Lock;
+	std::condition_variable SpaceCond, DataCond;
+	std::thread Writer;
+	IF_WRITER_STATS Stats;
+
+	// O_DIRECT, io_uring and mmap backends
+	IfWriterBackend Backend;
+	int FileFd;
+	long long FileOffset;	// file offset of current chunk
+	unsigned char *Chunk[IF_WRITER_DEPTH];	// aligned write buffers
+	int ChunkIndex, ChunkFill;	// buffer being filled and bytes in it
+	double IssueTime[IF_WRITER_DEPTH];	// time buffer write issued, negative if not in flight
+	int InFlight;
+	double IoStartTime;	// start of current period with writes in progress
+	std::chrono::steady_clock::time_point BaseTime;
+	void *Uring;	// io_uring rings, NULL if not used
+	unsigned char *Map;	// mapped output file of mmap backend
+	long long MapSize, MapFill;	// mapped size and bytes submitted
+
+	void WriterLoop();
+	BOOL WriteSlot(int Slot);
+	BOOL OpenDirect();
+	BOOL OpenUring();
+	void CloseUring();
+	void AppendChunk(const unsigned char *Data, int Size);
+	void WriteChunk(int Size);
+	void CompleteWrites(BOOL Wait);
+	void FinishDirect();
+	BOOL OpenMmap(long long FileSize);
+	BOOL MapFile(long long Size);
+	void FinishMmap();
+	double GetTime();
+	double BeginWrite();
+	void EndWrite(double StartTime);
+	template <typename F> double WaitFor(F Ready, std::condition_variable &Cond);
+	void Wake(std::condition_variable &Cond);
+};
+
+const char *IfWriterBackendName(IfWriterBackend Backend);
+IfWriterBackend IfWriterBackendFromName(const char *Name);	// IfWriterAuto for unknown name
+
+#endif // __IF_DATA_WRITER_H__
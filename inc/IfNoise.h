@@ -0,0 +1,51 @@
+//----------------------------------------------------------------------
+// IfNoise.h:
+//   Declaration of white Gaussian noise generation of IF samples
+//   with runtime instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#ifndef __IF_NOISE_H__
+#define __IF_NOISE_H__
+
+#include "BasicTypes.h"
+#include "ComplexNumber.h"
+#include "IfSampleKernel.h"
+
+#define IF_NOISE_SEED 0x5349474e414c5349ULL	// default seed
+#define IF_NOISE_POOL_RUN 256	// samples read contiguously from noise pool
+#define IF_NOISE_POOL_MAX_RUNS (1 << 20)	// maximum pool size in runs (256M samples)
+
+// Noise value of each I/Q component is a function of seed, millisecond index and sample
+// index within the millisecond only: a counter based hash of the position selects layer,
+// sign and abscissa of a 128 layer Ziggurat, the rare rejected values are replaced by a
+// scalar wedge/tail sampler with its own stream of the same position. So any range can be
+// generated by any thread in any order with identical result, and all instruction sets
+// give bit exact output of the scalar kernel (IfKernelScalar)
+void SetIfNoiseSeed(unsigned long long Seed);
+unsigned long long GetIfNoiseSeed();
+
+// Fill Count samples of Noise with samples Start to Start+Count-1 of a block beginning at
+// millisecond FirstMs with MsSampleNumber samples each millisecond. Floating point noise
+// has sigma of 1, fixed point noise has sigma of IF_INT_SIGMA (rounded to nearest)
+void GenerateIfNoise(complex_number Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa = IfKernelAuto);
+void GenerateIfNoise(complex_float Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa = IfKernelAuto);
+void GenerateIfNoise(complex_int32 Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa = IfKernelAuto);
+
+// Pool mode for bulk generation: noise is copied from a pool of white noise generated once
+// instead of generated for each sample. Pool has PoolSamples samples rounded up to power of 2
+// runs of IF_NOISE_POOL_RUN samples. Each millisecond reads its runs from a pool run offset
+// and odd run stride given by hash of millisecond index (or of millisecond index modulo
+// Period if Period > 0, so the noise repeats exactly every Period milliseconds), no run is
+// read twice within a millisecond unless the millisecond is longer than the pool.
+// Output still only depends on seed and sample position.
+// Pool of SampleType is generated here, pools of other types at their first use, reading
+// a generated pool takes no lock. Not to be called while noise is being generated.
+// PoolSamples 0 frees pools and returns to exact mode (default)
+void SetIfNoisePool(long long PoolSamples, int Period, IfSampleType SampleType);
+long long GetIfNoisePoolSize();	// pool size in samples, 0 in exact mode
+int GetIfNoisePeriod();
+
+#endif // __IF_NOISE_H__
@@ -0,0 +1,38 @@
+//----------------------------------------------------------------------
+// IfQuantize.h:
+//   Declaration of IF sample quantization to output formats with
+//   runtime instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#ifndef __IF_QUANTIZE_H__
+#define __IF_QUANTIZE_H__
+
+#include "BasicTypes.h"
+#include "ComplexNumber.h"
+#include "IfSampleKernel.h"
+
+// Quantize Length samples into QuantSamples and return number of clipped I/Q values.
+// Floating point samples have noise sigma of 1, fixed point samples of IF_INT_SIGMA.
+// All instruction sets give bit exact output of the scalar kernel (IfKernelScalar):
+//   IQ2: 2 samples per byte, bits from MSB Sign-Q2, Mag-Q2, Sign-I2, Mag-I2, Sign-Q1, Mag-Q1, Sign-I1, Mag-I1
+//        magnitude bit set at 1.1/GainScale sigma, clipped at 5 times of that
+//   IQ4: 1 sample per byte, I at high nibble, each nibble sign (bit 3) and magnitude saturated at 7
+//   IQ8: I/Q signed byte pair, 25*GainScale per sigma, truncated toward zero and saturated
+//   IQ16: I/Q little endian signed 16bit pair, 3277*GainScale per sigma, truncated and saturated
+int QuantSamplesIQ2(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ4(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ8(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ16(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ2(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ4(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ8(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ16(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ2(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ4(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ8(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+int QuantSamplesIQ16(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa = IfKernelAuto);
+
+#endif // __IF_QUANTIZE_H__
@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------
+// IfSampleKernel.h:
+//   Declaration of IF sample generation kernels with runtime
+//   instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#ifndef __IF_SAMPLE_KERNEL_H__
+#define __IF_SAMPLE_KERNEL_H__
+
+#include "BasicTypes.h"
+#include "ComplexNumber.h"
+
+// kernel implementations, in order of preference
+enum IfKernelIsa { IfKernelScalar = 0, IfKernelSse42, IfKernelAvx2, IfKernelAvx512, IfKernelAuto };
+// chip run engine calculates PRN value once for each run of samples within the same chip
+// instead of each sample, auto mode selects it according to samples per chip
+enum IfChipRunMode { IfChipRunOff = 0, IfChipRunOn, IfChipRunAuto, IfChipRunDefault };
+
+// int16 pipeline: sample value in unit of 1/IF_INT_SIGMA of noise sigma, PRN
+// modulation amplitude has IF_INT_AMP_FRAC extra fraction bits
+#define IF_INT_SIGMA 2048
+#define IF_INT_AMP_FRAC 3
+
+// PRN modulation variant of a channel, each combination of the flags has its own
+// compile time specialized kernel without per sample attribute checks and without
+// pilot code for data only signals. IF_PRN_GENERIC uses the runtime checks of segment
+// attribute and is used for combinations without specialized kernel
+#define IF_PRN_BOC 1	// BOC modulation, second half of each chip negated
+#define IF_PRN_TMD 2	// time multiplexed data/pilot chips (GPS L2C)
+#define IF_PRN_PILOT 4	// has pilot channel
+#define IF_PRN_COMBINED 8	// data/pilot code read from CombinedPrn
+#define IF_PRN_GENERIC 16
+
+// Parameters of a segment of samples within which data/pilot modulation
+// does not change, i.e. no data code period boundary within the segment.
+// Code phase uses 32.32 fixed point in unit of chip so that all kernels
+// get identical chip index for each sample; carrier phase uses the same
+// 32bit format as FastMath::FastRotate(unsigned int)
+typedef struct
+{
+	int SampleCount;	// number of samples in this segment
+	unsigned long long ChipPhase;	// code phase of first sample (32.32 fixed point)
+	unsigned long long ChipStep;	// code phase increment between samples (32.32 fixed point)
+	unsigned int CarrierPhase;	// carrier phase of first sample (2^32 as one cycle)
+	int CarrierStep;	// carrier phase increment between samples
+	int DataBase;	// chip count at beginning of current data code period
+	int PilotBase;	// pilot chip index corresponding to DataBase
+	const unsigned int *DataPrn;	// data channel PRN code, 1 bit per chip
+	const unsigned int *PilotPrn;	// pilot channel PRN code, 1 bit per chip, NULL if no pilot channel
+	const unsigned int *CombinedPrn;	// data/pilot PRN code 2 bits per chip, NULL if not available (PilotBase must be 0)
+	unsigned int Attribute;	// PRN_ATTRIBUTE_XXX
+	unsigned int PrnVariant;	// IF_PRN_XXX, from GetIfPrnVariant() or IF_PRN_GENERIC
+	complex_number DataSignal;	// data channel modulation with amplitude applied
+	complex_number PilotSignal;	// pilot channel modulation with amplitude applied
+} IF_SEGMENT_PARAM, *PIF_SEGMENT_PARAM;
+
+// sample type traits of templated IF sample pipeline, AccumType is used to add all channels and noise
+template <typename T> struct IfSampleTraits;
+template <> struct IfSampleTraits<complex_number> { typedef double ValueType; typedef complex_number AccumType; static const IfSampleType Type = IfSampleDouble; };
+template <> struct IfSampleTraits<complex_float> { typedef float ValueType; typedef complex_float AccumType; static const IfSampleType Type = IfSampleFloat; };
+template <> struct IfSampleTraits<complex_int16> { typedef short ValueType; typedef complex_int32 AccumType; static const IfSampleType Type = IfSampleInt16; };
+
+IfKernelIsa DetectIfKernelIsa();
+BOOL IfKernelSupported(IfKernelIsa Isa);
+BOOL SetIfKernelIsa(IfKernelIsa Isa);
+IfKernelIsa GetIfKernelIsa();
+const char *IfKernelName(IfKernelIsa Isa);
+IfKernelIsa IfKernelFromName(const char *Name);
+void SetIfChipRunMode(IfChipRunMode Mode);
+IfChipRunMode GetIfChipRunMode();
+// PRN variant of segment from its attribute and code pointers, channel gets it once as
+// it does not change with time, specialized kernels can be turned off for comparison
+unsigned int GetIfPrnVariant(const IF_SEGMENT_PARAM *Param);
+const char *IfPrnVariantName(unsigned int Variant);
+void SetIfPrnSpecialized(BOOL Enable);
+BOOL GetIfPrnSpecialized();
+void GenerateIfSegment(const IF_SEGMENT_PARAM *Param, complex_number *Output, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+void GenerateIfSegment(const IF_SEGMENT_PARAM *Param, complex_float *Output, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+void GenerateIfSegment(const IF_SEGMENT_PARAM *Param, complex_int16 *Output, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+// carrier NCO using FastMath compact carrier table, Count samples of cos/sin from
+// CarrierPhase with increment CarrierStep (2^32 as one cycle), int16 version in Q14
+void GenerateCarrier(unsigned int CarrierPhase, int CarrierStep, int Count, complex_number *Output, IfKernelIsa Isa = IfKernelAuto);
+void GenerateCarrier(unsigned int CarrierPhase, int CarrierStep, int Count, complex_float *Output, IfKernelIsa Isa = IfKernelAuto);
+void GenerateCarrier(unsigned int CarrierPhase, int CarrierStep, int Count, complex_int16 *Output, IfKernelIsa Isa = IfKernelAuto);
+
+#endif // __IF_SAMPLE_KERNEL_H__
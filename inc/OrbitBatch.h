@@ -0,0 +1,50 @@
+//----------------------------------------------------------------------
+// OrbitBatch.h:
+//   Declaration of batched satellite orbit calculation of GPS/BDS/Galileo
+//   ephemerides with runtime instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined (__ORBIT_BATCH_H__)
+#define __ORBIT_BATCH_H__
+
+#include "BasicTypes.h"
+#include "IfSampleKernel.h"
+
+#define ORBIT_BATCH_SIZE 64	// maximum satellites in one batch, multiple of vector width
+#define ORBIT_BATCH_WIDTH 4	// satellites calculated together by vector kernel
+
+// Ephemeris parameters of satellites of one system in structure of arrays, so that the
+// vector kernel loads the same parameter of ORBIT_BATCH_WIDTH satellites at once.
+// Array after SatNumber is filled with the last satellite up to multiple of ORBIT_BATCH_WIDTH.
+// Parameters are copied by SetOrbitBatch(), batch needs to be set again on ephemeris change
+typedef struct
+{
+	GnssSystem system;
+	int SatNumber;
+	const GPS_EPHEMERIS *Eph[ORBIT_BATCH_SIZE];
+	double toe[ORBIT_BATCH_SIZE], toc[ORBIT_BATCH_SIZE];
+	double M0[ORBIT_BATCH_SIZE], n[ORBIT_BATCH_SIZE], delta_n_dot[ORBIT_BATCH_SIZE];
+	double ecc[ORBIT_BATCH_SIZE], root_ecc[ORBIT_BATCH_SIZE], w[ORBIT_BATCH_SIZE];
+	double axis[ORBIT_BATCH_SIZE], axis_dot[ORBIT_BATCH_SIZE];
+	double i0[ORBIT_BATCH_SIZE], idot[ORBIT_BATCH_SIZE];
+	double omega_t[ORBIT_BATCH_SIZE], omega_delta[ORBIT_BATCH_SIZE];
+	double cuc[ORBIT_BATCH_SIZE], cus[ORBIT_BATCH_SIZE];
+	double crc[ORBIT_BATCH_SIZE], crs[ORBIT_BATCH_SIZE];
+	double cic[ORBIT_BATCH_SIZE], cis[ORBIT_BATCH_SIZE];
+	double af0[ORBIT_BATCH_SIZE], af1[ORBIT_BATCH_SIZE], af2[ORBIT_BATCH_SIZE];
+} ORBIT_BATCH, *PORBIT_BATCH;
+
+// copy Number (up to ORBIT_BATCH_SIZE) ephemerides of system to batch, returns number copied
+int SetOrbitBatch(PORBIT_BATCH Batch, GnssSystem system, const GPS_EPHEMERIS *const Eph[], int Number);
+// Position, velocity (and acceleration and clock correction if not NULL) of all satellites
+// in batch at TransmitTime, Valid[i] (if not NULL) as return value of GpsSatPosSpeedEph().
+// Kepler equation is solved with fixed number of Newton iterations and sin/cos/atan2 are
+// calculated by polynomial so that all satellites run the same instruction sequence, results
+// differ from GpsSatPosSpeedEph() by rounding only (below 1e-6m). AVX2 kernel (also used for
+// IfKernelAvx512, auto selects it if CPU supports AVX2) gives bit exact output of scalar kernel
+void OrbitBatchPosSpeed(const ORBIT_BATCH *Batch, double TransmitTime, KINEMATIC_INFO PosVel[], double Acc[][3], double ClockCorrection[], bool Valid[], IfKernelIsa Isa = IfKernelAuto);
+
+#endif //!defined(__ORBIT_BATCH_H__)
@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------
+// OrbitCache.h:
+//   Declaration of satellite orbit interpolation from broadcast
+//   ephemeris evaluated at coarse nodes
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+
+#if !defined (__ORBIT_CACHE_H__)
+#define __ORBIT_CACHE_H__
+
+#include "BasicTypes.h"
+
+#define ORBIT_NODE_INTERVAL 30.0	// default node interval in second
+
+// Satellite position, velocity and acceleration are calculated from ephemeris only at nodes
+// on multiples of Interval, between two nodes each of x/y/z is the quintic Hermite polynomial
+// matching position, velocity and acceleration at both nodes (and Ek the cubic Hermite
+// polynomial matching Ek and Ek_dot). Interpolation error is below h^6/46080*max|x^(6)|,
+// about 1e-10m for MEO orbits at 30s interval, far below the 1e-14 rad Kepler iteration
+// limit (~0.3um) of calculation from ephemeris, GLONASS nodes come from the orbit table of
+// the ephemeris (or are integrated in steps of 10s out of the table).
+// Three nodes are kept so that queries of receive time and transmit time ~0.1s before
+// use the same nodes, nodes move forward as time increases and are calculated again on
+// ephemeris change or time jump.
+// Cache is a plain structure and can be copied, each ephemeris in use needs its own cache
+typedef struct
+{
+	const void *Eph;	// ephemeris nodes calculated from, NULL if no node calculated
+	double Interval;	// node interval in second, 0 to calculate each query from ephemeris
+	double NodeTime[3];
+	KINEMATIC_INFO NodePosVel[3];
+	double NodeAcc[3][3];
+	double NodeEk[3], NodeEkDot[3];
+	bool NodeValid[3];	// ephemeris not expired at node
+	double Coef[2][3][6];	// x/y/z polynomial of segment between node i and i+1 on (t-NodeTime[i])/Interval
+	double EkCoef[2][4];	// Ek polynomial of each segment
+	double Ek;	// Ek at last query
+	ORBIT_CONTEXT Context;	// propagation state to calculate nodes
+} ORBIT_CACHE, *PORBIT_CACHE;
+
+void InitOrbitCache(PORBIT_CACHE Cache, double Interval = ORBIT_NODE_INTERVAL);
+// same as GpsSatPosSpeedEph() for GPS/BDS/Galileo and GlonassSatPosSpeedEph() for GLONASS
+// (Eph is GLONASS_EPHEMERIS), Ek of the query is in Cache->Ek
+bool SatPosSpeedCache(GnssSystem system, double TransmitTime, const void *Eph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CACHE Cache);
+
+#endif //!defined(__ORBIT_CACHE_H__)
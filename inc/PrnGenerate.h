@@ -36,16 +36,29 @@ struct PrnAttribute
 #define PRN_ATTRIBUTE_BOC 1
 #define PRN_ATTRIBUTE_TMD 2
 
+// Define PRN_STATIC_TABLES (requires C++17) to generate all PRN codes at compile time
+// into packed static tables, PrnGenerate then points to the tables instead of running
+// the code generators. StaticTable = FALSE forces runtime generation for verification
 class PrnGenerate
 {
 public:
-	PrnGenerate(GnssSystem System, int SignalIndex, int Svid);
+	PrnGenerate(GnssSystem System, int SignalIndex, int Svid, BOOL StaticTable = TRUE);
 	~PrnGenerate();
+	static BOOL HasStaticTable();
 
-	int *DataPrn, *PilotPrn;
+	// PRN codes packed as 1 bit per chip, chip n at bit (n & 31) of word (n >> 5)
+	const unsigned int *DataPrn, *PilotPrn;
+	// data (bit 0) and pilot (bit 1) code packed as 2 bits per chip, chip n at bit 2*(n & 15) of word (n >> 4)
+	// only available when data and pilot code have the same length, otherwise NULL
+	const unsigned int *CombinedPrn;
 	const PrnAttribute* Attribute;
 
 private:
+	BOOL StaticCode;	// code arrays point to static tables, not to be deleted
+	BOOL GetStaticCode(GnssSystem System, int SignalIndex, int Svid);
+	friend struct PrnStaticTable;
+	unsigned int *PackPrnBits(const int *Code, int Length);
+	unsigned int *PackCombinedBits(const int *DataCode, const int *PilotCode, int Length);
 	int *GetGoldCode(unsigned int G1Init, unsigned int G1Poly, unsigned int G2Init, unsigned int G2Poly, int Length, int Depth, int ResetPos);
 	void LegendreSequence(int *Data, int Length);
 	int *GetL1CWeil(int InsertPoint, int PhaseDiff);
@@ -79,4 +92,30 @@ private:
 	static const PrnAttribute PrnAttributes[];
 };
 
+// identify one PRN code in PrnCache
+typedef struct
+{
+	GnssSystem System;
+	int SignalIndex;
+	int Svid;
+} PRN_CACHE_KEY, *PPRN_CACHE_KEY;
+
+// Process wide PRN code cache. Each (system, signal, svid) code is generated at most
+// once and shared by all channels using it. Acquire() and Release() are thread safe,
+// an entry is freed when its last reference is released. Preload() generates missing
+// codes in parallel, preloaded entries are kept until acquired and released or Flush()
+class PrnCache
+{
+public:
+	static const PrnGenerate *Acquire(GnssSystem System, int SignalIndex, int Svid);
+	static void Release(const PrnGenerate *Prn);
+	static int Preload(const PRN_CACHE_KEY Keys[], int Count);
+	static void Flush();
+	static void GetStatistics(int &EntryCount, int &HitCount, int &GenerateCount, int &TotalBytes);
+
+private:
+	static unsigned int CacheKey(GnssSystem System, int SignalIndex, int Svid);
+	static int CodeBytes(const PrnGenerate *Prn);
+};
+
 #endif // __PRN_GENERATE_H__
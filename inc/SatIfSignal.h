@@ -10,15 +10,43 @@
 #include "PrnGenerate.h"
 #include "NavBit.h"
 #include "SatelliteSignal.h"
+#include "IfSampleKernel.h"
+
+// 1ms covers at most 2 data code period boundaries (shortest data period is 1ms)
+#define MAX_IF_SEGMENT 4
+// longest block of milliseconds prepared by PrepareIfSample() and generated at once
+#define MAX_IF_BLOCK_MS 20
 
 class CSatIfSignal
 {
 public:
-	CSatIfSignal(int MsSampleNumber, int SatIfFreq, GnssSystem SatSystem, int SatSignalIndex, unsigned char SatId);
+	CSatIfSignal(int MsSampleNumber, int SatIfFreq, GnssSystem SatSystem, int SatSignalIndex, unsigned char SatId, IfSampleType SatSampleType = IfSampleDouble);
 	~CSatIfSignal();
 	void InitState(GNSS_TIME CurTime, CSatelliteParam *pSatParam, NavBit* pNavData);
 	void GetIfSample(GNSS_TIME CurTime);
+	// prepare millisecond ending at CurTime as millisecond MsIndex of current block, MsIndex 0 starts
+	// a new block, samples of the millisecond have index from MsIndex*MsSampleNumber in GenerateIfSample()
+	void PrepareIfSample(GNSS_TIME CurTime, int MsIndex = 0);
+	void GenerateIfSample(complex_number *Output, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+	void GenerateIfSample(complex_float *Output, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+	void GenerateIfSample(complex_int16 *Output, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+	// generate Count samples from sample index Start of current block into Output[0] to Output[Count-1]
+	void GenerateIfSample(complex_number *Output, int Start, int Count, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+	void GenerateIfSample(complex_float *Output, int Start, int Count, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+	void GenerateIfSample(complex_int16 *Output, int Start, int Count, IfKernelIsa Isa = IfKernelAuto, IfChipRunMode ChipRun = IfChipRunDefault);
+	// closed form code/carrier/modulation state of sample Offset of current block (after PrepareIfSample())
+	BOOL GetSampleState(int Offset, PIF_SEGMENT_PARAM State);
+	template <typename T> T *GetSampleArray();
+	double GetCN0() { return SatParam ? SatParam->CN0 / 100. : 0.; }	// configured CN0 in dBHz
+	GnssSystem GetSystem() { return System; }
+	int GetSignalIndex() { return SignalIndex; }
+	unsigned int GetPrnVariant() { return PrnVariant; }	// IF_PRN_XXX selected at InitState()
+	IfSampleType SampleType;
+	// output of GetIfSample() of SampleType, allocated at first call of GetIfSample(), otherwise NULL
+	// (not used if samples are generated by GenerateIfSample() into caller's buffer)
 	complex_number *SampleArray;
+	complex_float *FloatSampleArray;
+	complex_int16 *Int16SampleArray;
 
 private:
 	int SampleNumber;	// sample number within 1ms
@@ -26,7 +54,7 @@ private:
 	GnssSystem System;
 	int SignalIndex;
 	int Svid;
-	PrnGenerate* PrnSequence;
+	const PrnGenerate* PrnSequence;	// shared through PrnCache
 	int DataLength, PilotLength;
 	CSatelliteSignal SatelliteSignal;
 //	PSATELLITE_PARAM SatParam;
@@ -34,9 +62,13 @@ private:
 	double StartCarrierPhase, EndCarrierPhase;
 	GNSS_TIME StartTransmitTime, EndTransmitTime, SignalTime;
 	complex_number DataSignal, PilotSignal;
+	int SegmentNumber;
+	unsigned int PrnVariant;	// kernel variant of PRN modulation, selected at InitState()
+	IF_SEGMENT_PARAM Segments[MAX_IF_SEGMENT * MAX_IF_BLOCK_MS];	// segments of current block split at millisecond and data code period boundaries
 
-	complex_number GetPrnValue(double &CurChip, double CodeStep);
-	complex_number GetRotateValue(double & CurPhase, double PhaseStep);
-	complex_number GetRotateValue(unsigned int & CurPhase, int PhaseStep);
-	void GenerateSamplesVectorized(int SampleCount, double& CurChip, double CodeStep, double& CurPhase, double PhaseStep, double Amp);
+	template <typename T> void GenerateSegments(T *Output, int Start, int Count, IfKernelIsa Isa, IfChipRunMode ChipRun);
 };
+
+template <> inline complex_number *CSatIfSignal::GetSampleArray<complex_number>() { return SampleArray; }
+template <> inline complex_float *CSatIfSignal::GetSampleArray<complex_float>() { return FloatSampleArray; }
+template <> inline complex_int16 *CSatIfSignal::GetSampleArray<complex_int16>() { return Int16SampleArray; }
@@ -13,6 +13,9 @@
 #include "BasicTypes.h"
 #include "PowerControl.h"
 #include "DelayModel.h"
+#include "OrbitCache.h"
+
+#define ATMOS_UPDATE_INTERVAL 1.0	// default interval of ionosphere/troposphere delay update in second
 
 int GetVisibleSatellite(KINEMATIC_INFO Position, GNSS_TIME time, OUTPUT_PARAM OutputParam, GnssSystem system, PGPS_EPHEMERIS Eph[], int Number, PGPS_EPHEMERIS EphVisible[]);
 int GetGlonassVisibleSatellite(KINEMATIC_INFO Position, GLONASS_TIME time, OUTPUT_PARAM OutputParam, PGLONASS_EPHEMERIS Eph[], int Number, PGLONASS_EPHEMERIS EphVisible[]);
@@ -25,6 +28,13 @@ int GetGlonassVisibleSatellite(KINEMATIC_INFO Position, GLONASS_TIME time, OUTPU
 GNSS_TIME GetTransmitTime(GNSS_TIME ReceiverTime, double TravelTime);
 
 // new CSatelliteParam class to support ephemeris change, precise ephemeris and different troposphere delay/ionosphere delay model
+// ephemerides are only read, orbit propagation state is kept in each object, so CalculateParam()
+// of different objects can run in parallel threads
+// satellite position is interpolated from nodes calculated every ORBIT_NODE_INTERVAL seconds,
+// SetOrbitInterval(0) to calculate each time from ephemeris
+// ionosphere and troposphere delay are calculated at nodes every ATMOS_UPDATE_INTERVAL seconds
+// and interpolated between nodes when CalculateParam() is called more than once within the
+// interval, SetAtmosInterval(0) to calculate each time
 class CSatelliteParam
 {
 public:
@@ -35,15 +45,22 @@ public:
 	void UpdateEphemeris(PGPS_EPHEMERIS Eph);
 	void CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION PositionLla, GNSS_TIME time);
 	void UpdateCN0(int PowerListCount, SIGNAL_POWER PowerList[]);
+	void SetOrbitInterval(double Interval);
+	void SetAtmosInterval(double Interval, int Order = 2);
 	double GetTravelTime(int SignalIndex);
 	double GetCarrierPhase(int SignalIndex);
 	double GetDoppler(int SignalIndex);
+	// interpolation within a block of milliseconds, CalculateParam() is only called at block
+	// start, middle and end, SetBlockNode() saves result of each as node 0/1/2
+	void SetBlockNode(int Node);
+	void InterpolateBlock(int Ms, int MidMs, int BlockMs);
 
 	GnssSystem system;
 	int svid;
 	int FreqID;	// for GLONASS only
 	PGPS_EPHEMERIS EphCur, EphPrev;
 	PGLONASS_EPHEMERIS GloEphCur, GloEphPrev;
+	ORBIT_CACHE OrbitCur, OrbitPrev;	// orbit nodes of EphCur/GloEphCur and EphPrev/GloEphPrev
 	CIonoDelay *IonoDelayModel;
 	double CN0Default;
 	enum ElevationAdjust CN0Adjust;
@@ -62,10 +79,17 @@ public:
 	double Azimuth;		// satellite azimuth in rad
 	double RelativeSpeed;	// satellite to receiver relative speed in m/s
 	double LosVector[3];	// LOS vecter
+	double BlockTravelTime[3], BlockIonoDelay[3];	// TravelTime and IonoDelayMeter at block start, middle and end
+	int AtmosInterval;	// atmosphere delay node interval in millisecond, 0 to calculate each time
+	int AtmosOrder;		// 1 for linear, 2 for quadratic interpolation of atmosphere delay
+	int AtmosNodeTime;	// receiver time of atmosphere delay node 1 in millisecond, -1 if no node calculated
+	double NodeIonoDelay[3], NodeTropoDelay[3];	// IonoDelayMeter and TropoDelayMeter at AtmosNodeTime - AtmosInterval, AtmosNodeTime and AtmosNodeTime + AtmosInterval
 
 private:
 	double GetWaveLength(int SignalIndex);
 	double GetIonoDelayFactor(int SignalIndex);
+	void UpdateAtmosDelay(KINEMATIC_INFO &PositionEcef, double SatelliteTime);
+	void CalcAtmosNode(int Node, KINEMATIC_INFO &PositionEcef, double SatelliteTime, double DeltaT);
 };
 
 #endif //!defined(__SATELLITE_PARAM_H__)
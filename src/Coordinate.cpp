@@ -6,12 +6,16 @@
 //
 //----------------------------------------------------------------------
 #include <math.h>
+#include <stdlib.h>
 
 #include "ConstVal.h"
 #include "BasicTypes.h"
 #include "Coordinate.h"
 
 #define COARSE_STEP 30
+#define GLONASS_TABLE_STEP 30	// node interval of GLONASS orbit table
+#define GLONASS_TABLE_SUB_STEP 3	// Runge-Kutta steps between nodes
+#define GLONASS_TABLE_SPAN 960	// table covers 15 minutes validity with one more node on each side
 #define COS_5 0.99619469809174553
 #define SIN_5 0.087155742747658173559
 
@@ -20,7 +24,7 @@ static void CalcAcceleration(double *State, double *Acc);
 static void PredictState(double *State, double *State1, double *VelAcc, double Step);
 static void CisToCts(double *State, double DeltaT, PKINEMATIC_INFO pCtsPos, double *Acc);
 
-double GpsClockCorrection(PGPS_EPHEMERIS Eph, double TransmitTime)
+double GpsClockCorrection(const GPS_EPHEMERIS *Eph, double TransmitTime)
 {
 	double TimeDiff = TransmitTime - Eph->toc;
 	double ClockAdj;
@@ -37,7 +41,7 @@ double GpsClockCorrection(PGPS_EPHEMERIS Eph, double TransmitTime)
 	return ClockAdj;
 }
 
-double GlonassClockCorrection(PGLONASS_EPHEMERIS Eph, double TransmitTime)
+double GlonassClockCorrection(const GLONASS_EPHEMERIS *Eph, double TransmitTime)
 {
 	double TimeDiff = TransmitTime - (double)Eph->tb;
 
@@ -49,7 +53,7 @@ double GlonassClockCorrection(PGLONASS_EPHEMERIS Eph, double TransmitTime)
 	return -Eph->tn + Eph->gamma * TimeDiff;
 }
 
-bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pEph, PKINEMATIC_INFO pPosVel, double Acc[3])
+bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, const GPS_EPHEMERIS *pEph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CONTEXT Context)
 {
 	int i;
 	double delta_t;
@@ -63,7 +67,7 @@ bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pE
 	double xp_dot, yp_dot;
 	double xp_dot2, yp_dot2;
 	double sin_temp, cos_temp;
-	double Ek_dot2, phi_dot2;
+	double Ek_dot, Ek_dot2, phi_dot2;
 	double uk_dot2, rk_dot2, ik_dot2;
 	double alpha, beta;
 
@@ -85,7 +89,6 @@ bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pE
 			break;
 		Ek1 = Ek;
 	}
-	pEph->Ek = Ek;
 
 	// assign Ek1 as 1-e*cos(Ek)
 	Ek1 = 1.0 - (pEph->ecc * cos(Ek));
@@ -107,10 +110,10 @@ bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pE
 	rk += drk;
 	ik += dik;
 	// calculate derivatives of r(k) and u(k)
-	pEph->Ek_dot = (pEph->n + alpha) / Ek1;
-	uk_dot = phi_dot = pEph->Ek_dot * pEph->root_ecc / Ek1;
+	Ek_dot = (pEph->n + alpha) / Ek1;
+	uk_dot = phi_dot = Ek_dot * pEph->root_ecc / Ek1;
 	phi_dot = phi_dot * 2.0;
-	rk_dot = pEph->axis * pEph->ecc * sin(Ek) * pEph->Ek_dot + pEph->axis_dot * Ek1;
+	rk_dot = pEph->axis * pEph->ecc * sin(Ek) * Ek_dot + pEph->axis_dot * Ek1;
 	drk_dot = ((pEph->crs * cos_temp) - (pEph->crc * sin_temp)) * phi_dot;
 	duk_dot = ((pEph->cus * cos_temp) - (pEph->cuc * sin_temp)) * phi_dot;
 	dik_dot = ((pEph->cis * cos_temp) - (pEph->cic * sin_temp)) * phi_dot;
@@ -120,11 +123,11 @@ bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pE
 	// calculate intermediate variables for acceleration
 	if (Acc)
 	{
-		Ek_dot2 = -pEph->Ek_dot * pEph->Ek_dot * pEph->ecc * sin(Ek) / Ek1;
+		Ek_dot2 = -Ek_dot * Ek_dot * pEph->ecc * sin(Ek) / Ek1;
 		phi_dot2 = 2 * Ek_dot2 * pEph->root_ecc / Ek1;
 		alpha = 2 * phi_dot2 / phi_dot;	// phi_dot2/phi_dot
 		beta = phi_dot * phi_dot;	// 4*phi_dot^2
-		rk_dot2 = pEph->axis * pEph->ecc * (sin(Ek) * Ek_dot2 + cos(Ek) * pEph->Ek_dot * pEph->Ek_dot);
+		rk_dot2 = pEph->axis * pEph->ecc * (sin(Ek) * Ek_dot2 + cos(Ek) * Ek_dot * Ek_dot);
 		rk_dot2 += alpha * drk_dot - beta * drk;
 		uk_dot2 = phi_dot2 + alpha * duk_dot - beta * duk;
 		ik_dot2 = alpha * dik_dot - beta * dik;
@@ -176,34 +179,12 @@ bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pE
 	}
 
 	if (system == BdsSystem && (pEph->svid <= 5 || pEph->svid >= 59))
+		BdsGeoToCgcs2000(delta_t, pPosVel, Acc);
+
+	if (Context)
 	{
-		// first rotate -5 degree
-		yp = pPosVel->y * COS_5 - pPosVel->z * SIN_5; // rotated y
-		pPosVel->z = pPosVel->z * COS_5 + pPosVel->y * SIN_5; // rotated z
-		yp_dot = pPosVel->vy * COS_5 - pPosVel->vz * SIN_5; // rotated vy
-		pPosVel->vz = pPosVel->vz * COS_5 + pPosVel->vy * SIN_5; // rotated vz
-		// rotate delta_t * CGS2000_OMEGDOTE
-		omega = CGCS2000_OMEGDOTE * delta_t;
-		sin_temp = sin(omega);
-		cos_temp = cos(omega);
-		pPosVel->y = yp * cos_temp - pPosVel->x * sin_temp;
-		pPosVel->x = pPosVel->x * cos_temp + yp * sin_temp;
-		pPosVel->vy = yp_dot * cos_temp - pPosVel->vx * sin_temp;
-		pPosVel->vx = pPosVel->vx * cos_temp + yp_dot * sin_temp;
-		// earth rotate compensation on velocity
-		pPosVel->vx += pPosVel->y * CGCS2000_OMEGDOTE;
-		pPosVel->vy -= pPosVel->x * CGCS2000_OMEGDOTE;
-		if (Acc)
-		{
-			// first rotate -5 degree
-			yp = Acc[1] * COS_5 - Acc[2] * SIN_5; // rotated ay
-			Acc[2] = Acc[2] * COS_5 + Acc[1] * SIN_5; // rotated az
-			Acc[1] = yp * cos_temp - Acc[0] * sin_temp;
-			Acc[0] = Acc[0] * cos_temp + yp * sin_temp;
-			// earth rotate compensation on acceleration
-			Acc[0] += pPosVel->vy * CGCS2000_OMEGDOTE;
-			Acc[1] -= pPosVel->vx * CGCS2000_OMEGDOTE;
-		}
+		Context->Ek = Ek;
+		Context->Ek_dot = Ek_dot;
 	}
 
 	// if ephemeris expire, return 0
@@ -215,10 +196,44 @@ bool GpsSatPosSpeedEph(GnssSystem system, double TransmitTime, PGPS_EPHEMERIS pE
 		return true;
 }
 
-bool GlonassSatPosSpeedEph(double TransmitTime, PGLONASS_EPHEMERIS pEph, PKINEMATIC_INFO pPosVel, double Acc[3])
+void BdsGeoToCgcs2000(double DeltaT, PKINEMATIC_INFO pPosVel, double Acc[3])
+{
+	double yp, yp_dot, omega, sin_temp, cos_temp;
+
+	// first rotate -5 degree
+	yp = pPosVel->y * COS_5 - pPosVel->z * SIN_5; // rotated y
+	pPosVel->z = pPosVel->z * COS_5 + pPosVel->y * SIN_5; // rotated z
+	yp_dot = pPosVel->vy * COS_5 - pPosVel->vz * SIN_5; // rotated vy
+	pPosVel->vz = pPosVel->vz * COS_5 + pPosVel->vy * SIN_5; // rotated vz
+	// rotate delta_t * CGS2000_OMEGDOTE
+	omega = CGCS2000_OMEGDOTE * DeltaT;
+	sin_temp = sin(omega);
+	cos_temp = cos(omega);
+	pPosVel->y = yp * cos_temp - pPosVel->x * sin_temp;
+	pPosVel->x = pPosVel->x * cos_temp + yp * sin_temp;
+	pPosVel->vy = yp_dot * cos_temp - pPosVel->vx * sin_temp;
+	pPosVel->vx = pPosVel->vx * cos_temp + yp_dot * sin_temp;
+	// earth rotate compensation on velocity
+	pPosVel->vx += pPosVel->y * CGCS2000_OMEGDOTE;
+	pPosVel->vy -= pPosVel->x * CGCS2000_OMEGDOTE;
+	if (Acc)
+	{
+		// first rotate -5 degree
+		yp = Acc[1] * COS_5 - Acc[2] * SIN_5; // rotated ay
+		Acc[2] = Acc[2] * COS_5 + Acc[1] * SIN_5; // rotated az
+		Acc[1] = yp * cos_temp - Acc[0] * sin_temp;
+		Acc[0] = Acc[0] * cos_temp + yp * sin_temp;
+		// earth rotate compensation on acceleration
+		Acc[0] += pPosVel->vy * CGCS2000_OMEGDOTE;
+		Acc[1] -= pPosVel->vx * CGCS2000_OMEGDOTE;
+	}
+}
+
+bool GlonassSatPosSpeedEph(double TransmitTime, const GLONASS_EPHEMERIS *pEph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CONTEXT Context)
 {
 	double DeltaT, DeltaT1;
-	double State[9];
+	double State[9], VelAcc[6], Coef[3][6], StartT;
+	const GLONASS_ORBIT_TABLE *Table = pEph->OrbitTable;
 	int i, StepNumber;
 
 	DeltaT = TransmitTime - (double)pEph->tb;
@@ -227,24 +242,55 @@ bool GlonassSatPosSpeedEph(double TransmitTime, PGLONASS_EPHEMERIS pEph, PKINEMA
 	else if (DeltaT < -43200.0)
 		DeltaT += 86400.0;
 
+	// interpolate within orbit table
+	if (Table && fabs(DeltaT) <= Table->Span)
+	{
+		i = (int)((DeltaT + Table->Span) / Table->Step);
+		if (i > Table->NodeNumber - 2)
+			i = Table->NodeNumber - 2;
+		HermiteCoef(&Table->PosVel[i], Table->Acc[i], &Table->PosVel[i+1], Table->Acc[i+1], Table->Step, Coef);
+		HermitePosSpeed(Coef, (DeltaT + Table->Span - i * Table->Step) / Table->Step, Table->Step, pPosVel, Acc);
+		return true;
+	}
+
 	// delta t correction according to satellite clock error and clock drift
 //	DeltaT += (pEph->tn + pEph->gamma * DeltaT);	
 
+	// time from tc to predict from, restart from table edge if the edge is nearer than tc
+	if (Context && Context->Eph == (const void *)pEph)
+	{
+		DeltaT1 = TransmitTime - Context->tc;
+		if (DeltaT1 > 43200.0)
+			DeltaT1 -= 86400.0;
+		else if (DeltaT1 < -43200.0)
+			DeltaT1 += 86400.0;
+	}
 	// if position and velocity at tc not yet calculated
-	if ((pEph->flag & 0x2) == 0)
+	if (Context == NULL || Context->Eph != (const void *)pEph || (Table && fabs(DeltaT1) > fabs(DeltaT) - Table->Span))
 	{
-		// satellite position and velocity in CIS coordinate
-		State[0] = pEph->x;
-		State[1] = pEph->y;
-		State[2] = pEph->z;
-		State[3] = pEph->vx - PZ90_OMEGDOTE * pEph->y;
-		State[4] = pEph->vy + PZ90_OMEGDOTE * pEph->x;
-		State[5] = pEph->vz;
+		// satellite position and velocity in CIS coordinate, from table edge if available
+		if (Table)
+		{
+			StartT = (DeltaT > 0) ? Table->Span : -Table->Span;
+			for (i = 0; i < 6; i ++)
+				State[i] = (DeltaT > 0) ? Table->StateLast[i] : Table->StateFirst[i];
+		}
+		else
+		{
+			StartT = 0;
+			State[0] = pEph->x;
+			State[1] = pEph->y;
+			State[2] = pEph->z;
+			State[3] = pEph->vx - PZ90_OMEGDOTE * pEph->y;
+			State[4] = pEph->vy + PZ90_OMEGDOTE * pEph->x;
+			State[5] = pEph->vz;
+		}
 		State[6] = pEph->ax;
 		State[7] = pEph->ay;
 		State[8] = pEph->az;
 
-		StepNumber = (int)DeltaT / COARSE_STEP;
+		DeltaT1 = DeltaT - StartT;
+		StepNumber = (int)DeltaT1 / COARSE_STEP;
 		if (StepNumber >= 0)
 		{
 			for (i = StepNumber; i > 0; i --)
@@ -259,39 +305,46 @@ bool GlonassSatPosSpeedEph(double TransmitTime, PGLONASS_EPHEMERIS pEph, PKINEMA
 				RungeKutta(-COARSE_STEP, State);
 			}
 		}
-		DeltaT1 = DeltaT - StepNumber * COARSE_STEP;
+		DeltaT1 -= StepNumber * COARSE_STEP;
 	}
 	// prediction from tc
 	else
 	{
-		State[0] = pEph->PosVelT.x;
-		State[1] = pEph->PosVelT.y;
-		State[2] = pEph->PosVelT.z;
-		State[3] = pEph->PosVelT.vx;
-		State[4] = pEph->PosVelT.vy;
-		State[5] = pEph->PosVelT.vz;
+		State[0] = Context->PosVelT.x;
+		State[1] = Context->PosVelT.y;
+		State[2] = Context->PosVelT.z;
+		State[3] = Context->PosVelT.vx;
+		State[4] = Context->PosVelT.vy;
+		State[5] = Context->PosVelT.vz;
 		State[6] = pEph->ax;
 		State[7] = pEph->ay;
 		State[8] = pEph->az;
-		DeltaT1 = TransmitTime - pEph->tc;
-		if (DeltaT1 > 43200.0)
-			DeltaT1 -= 86400.0;
-		else if (DeltaT1 < -43200.0)
-			DeltaT1 += 86400.0;
 
 		// delta t correction according to satellite clock error and clock drift
 //		DeltaT1 += pEph->gamma * DeltaT1;
 	}
 	RungeKutta(DeltaT1, State);
 	
-	pEph->tc = TransmitTime;
-	pEph->flag |= 0x2;	// can predict from pEph->tc instead of pEph->tn
-	pEph->PosVelT.x = State[0];
-	pEph->PosVelT.y = State[1];
-	pEph->PosVelT.z = State[2];
-	pEph->PosVelT.vx = State[3];
-	pEph->PosVelT.vy = State[4];
-	pEph->PosVelT.vz = State[5];
+	if (Context)	// next calculation can predict from tc instead of tb
+	{
+		Context->Eph = (const void *)pEph;
+		Context->tc = TransmitTime;
+		Context->PosVelT.x = State[0];
+		Context->PosVelT.y = State[1];
+		Context->PosVelT.z = State[2];
+		Context->PosVelT.vx = State[3];
+		Context->PosVelT.vy = State[4];
+		Context->PosVelT.vz = State[5];
+	}
+
+	// total acceleration in CIS coordinate replaces luni-solar acceleration
+	if (Acc)
+	{
+		CalcAcceleration(State, VelAcc);
+		State[6] = VelAcc[3];
+		State[7] = VelAcc[4];
+		State[8] = VelAcc[5];
+	}
 
 	// CIS to CTS(PZ-90) convertion
 	CisToCts(State, DeltaT, pPosVel, Acc);
@@ -299,6 +352,96 @@ bool GlonassSatPosSpeedEph(double TransmitTime, PGLONASS_EPHEMERIS pEph, PKINEMA
 	return true;
 }
 
+PGLONASS_ORBIT_TABLE BuildGlonassOrbitTable(const GLONASS_EPHEMERIS *pEph)
+{
+	const int NodeNumber = GLONASS_TABLE_SPAN * 2 / GLONASS_TABLE_STEP + 1, Center = GLONASS_TABLE_SPAN / GLONASS_TABLE_STEP;
+	PGLONASS_ORBIT_TABLE Table;
+	double State[9], NodeState[9], VelAcc[6];
+	int i, j, Direction, Node;
+
+	// table, node positions and node accelerations in one memory block
+	Table = (PGLONASS_ORBIT_TABLE)malloc(sizeof(GLONASS_ORBIT_TABLE) + NodeNumber * (sizeof(KINEMATIC_INFO) + 3 * sizeof(double)));
+	if (Table == NULL)
+		return NULL;
+	Table->NodeNumber = NodeNumber;
+	Table->Step = GLONASS_TABLE_STEP;
+	Table->Span = GLONASS_TABLE_SPAN;
+	Table->PosVel = (PKINEMATIC_INFO)(Table + 1);
+	Table->Acc = (double (*)[3])(Table->PosVel + NodeNumber);
+
+	// integrate forward and backward from tb
+	for (Direction = 1; Direction >= -1; Direction -= 2)
+	{
+		State[0] = pEph->x;
+		State[1] = pEph->y;
+		State[2] = pEph->z;
+		State[3] = pEph->vx - PZ90_OMEGDOTE * pEph->y;
+		State[4] = pEph->vy + PZ90_OMEGDOTE * pEph->x;
+		State[5] = pEph->vz;
+		State[6] = pEph->ax;
+		State[7] = pEph->ay;
+		State[8] = pEph->az;
+		for (Node = Center; Node >= 0 && Node < NodeNumber; Node += Direction)
+		{
+			if (Node != Center)
+				for (i = 0; i < GLONASS_TABLE_SUB_STEP; i ++)
+					RungeKutta((double)Direction * GLONASS_TABLE_STEP / GLONASS_TABLE_SUB_STEP, State);
+			// node in PZ-90 with total acceleration
+			CalcAcceleration(State, VelAcc);
+			for (j = 0; j < 6; j ++)
+				NodeState[j] = State[j];
+			NodeState[6] = VelAcc[3];
+			NodeState[7] = VelAcc[4];
+			NodeState[8] = VelAcc[5];
+			CisToCts(NodeState, (double)(Node - Center) * GLONASS_TABLE_STEP, &Table->PosVel[Node], Table->Acc[Node]);
+		}
+		for (j = 0; j < 6; j ++)
+			if (Direction > 0)
+				Table->StateLast[j] = State[j];
+			else
+				Table->StateFirst[j] = State[j];
+	}
+
+	return Table;
+}
+
+void HermiteCoef(const KINEMATIC_INFO *PosVel0, const double Acc0[3], const KINEMATIC_INFO *PosVel1, const double Acc1[3], double h, double Coef[3][6])
+{
+	double V0, V1, A0, A1, Delta;
+	int i;
+
+	// p(s) = p0 + V0*s + A0/2*s^2 + c3*s^3 + c4*s^4 + c5*s^5 with V=h*v, A=h*h*a
+	for (i = 0; i < 3; i ++)
+	{
+		V0 = PosVel0->PosVel[i+3] * h;
+		V1 = PosVel1->PosVel[i+3] * h;
+		A0 = Acc0[i] * h * h;
+		A1 = Acc1[i] * h * h;
+		Delta = PosVel1->PosVel[i] - PosVel0->PosVel[i];
+		Coef[i][0] = PosVel0->PosVel[i];
+		Coef[i][1] = V0;
+		Coef[i][2] = A0 * 0.5;
+		Coef[i][3] = 10 * Delta - 6 * V0 - 4 * V1 - 1.5 * A0 + 0.5 * A1;
+		Coef[i][4] = -15 * Delta + 8 * V0 + 7 * V1 + 1.5 * A0 - A1;
+		Coef[i][5] = 6 * Delta - 3 * V0 - 3 * V1 - 0.5 * A0 + 0.5 * A1;
+	}
+}
+
+void HermitePosSpeed(const double Coef[3][6], double s, double h, PKINEMATIC_INFO pPosVel, double Acc[3])
+{
+	const double *c;
+	int i;
+
+	for (i = 0; i < 3; i ++)
+	{
+		c = Coef[i];
+		pPosVel->PosVel[i] = c[0] + s * (c[1] + s * (c[2] + s * (c[3] + s * (c[4] + s * c[5]))));
+		pPosVel->PosVel[i+3] = (c[1] + s * (2 * c[2] + s * (3 * c[3] + s * (4 * c[4] + s * 5 * c[5])))) / h;
+		if (Acc)
+			Acc[i] = (2 * c[2] + s * (6 * c[3] + s * (12 * c[4] + s * 20 * c[5]))) / (h * h);
+	}
+}
+
 LLA_POSITION EcefToLla(KINEMATIC_INFO ecef_pos)
 {
 	double p;
@@ -621,9 +764,10 @@ static void CisToCts(double *State, double DeltaT, PKINEMATIC_INFO pCtsPos, doub
 	SinValue *= PZ90_OMEGDOTE;
 	pCtsPos->vx -= State[0] * SinValue - State[1] * CosValue;
 	pCtsPos->vy -= State[1] * SinValue + State[0] * CosValue;
+	// Coriolis and centrifugal acceleration
 	if (Acc)
 	{
-		Acc[0] -= State[3] * SinValue - State[4] * CosValue;
-		Acc[1] -= State[4] * SinValue + State[3] * CosValue;
+		Acc[0] -= 2 * (State[3] * SinValue - State[4] * CosValue) + pCtsPos->x * PZ90_OMEGDOTE * PZ90_OMEGDOTE;
+		Acc[1] -= 2 * (State[4] * SinValue + State[3] * CosValue) + pCtsPos->y * PZ90_OMEGDOTE * PZ90_OMEGDOTE;
 	}
 }
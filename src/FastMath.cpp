@@ -2,5 +2,41 @@
 
 // Static member definitions
 double FastMath::sin_lut[FastMath::TRIG_LUT_SIZE + TRIG_LUT_SIZE / 4];
+double FastMath::carrier_lut[2 << FastMath::CARRIER_LUT_MAX_DEPTH];
+float FastMath::carrier_lut_float[2 << FastMath::CARRIER_LUT_MAX_DEPTH];
+int FastMath::carrier_lut_int16[1 << FastMath::CARRIER_LUT_MAX_DEPTH];
+FastMath::CarrierNco FastMath::carrier_nco;
 //double FastMath::cos_lut[FastMath::TRIG_LUT_SIZE];
 bool FastMath::lut_initialized = false;
+
+bool FastMath::SetCarrierLut(int depth, bool interpolate)
+{
+    int i, size = 1 << depth;
+    double angle;
+    int cos_int, sin_int;
+
+    if (depth < CARRIER_LUT_MIN_DEPTH || depth > CARRIER_LUT_MAX_DEPTH)
+        return false;
+    for (i = 0; i < size; i++) {
+        angle = (i + 0.5) * (PI / 2) / size;	// center of bin
+        carrier_lut[i * 2] = std::cos(angle);
+        carrier_lut[i * 2 + 1] = std::sin(angle);
+        carrier_lut_float[i * 2] = (float)carrier_lut[i * 2];
+        carrier_lut_float[i * 2 + 1] = (float)carrier_lut[i * 2 + 1];
+        cos_int = (int)std::lround(carrier_lut[i * 2] * (1 << CARRIER_LUT_INT_BITS));
+        sin_int = (int)std::lround(carrier_lut[i * 2 + 1] * (1 << CARRIER_LUT_INT_BITS));
+        carrier_lut_int16[i] = (cos_int & 0xffff) | (sin_int << 16);
+    }
+    carrier_nco.lut = carrier_lut;
+    carrier_nco.lut_float = carrier_lut_float;
+    carrier_nco.lut_int16 = carrier_lut_int16;
+    carrier_nco.depth = depth;
+    carrier_nco.shift = 30 - depth;
+    carrier_nco.index_mask = size - 1;
+    carrier_nco.residual_mask = (1u << carrier_nco.shift) - 1;
+    carrier_nco.half_bin = 1 << (carrier_nco.shift - 1);
+    carrier_nco.delta_scale = interpolate ? CARRIER_PHASE_SCALE : 0.;
+    carrier_nco.delta_shift = carrier_nco.shift - CARRIER_RESIDUAL_BITS;
+    carrier_nco.delta_scale_int = interpolate ? (int)std::lround(CARRIER_PHASE_SCALE * (1 << carrier_nco.delta_shift) * (1 << 24)) : 0;
+    return true;
+}
@@ -632,14 +632,13 @@ void INavBit::ConvertEphToReducedEph(PGPS_EPHEMERIS Ephemeris, int RefTime, unsi
 			break;
 		Ek1 = Ek;
 	}
-	EphTemp.Ek = Ek;
-	double phi = atan2(EphTemp.root_ecc * sin(EphTemp.Ek), cos(EphTemp.Ek) - EphTemp.ecc) + EphTemp.w;
+	double phi = atan2(EphTemp.root_ecc * sin(Ek), cos(Ek) - EphTemp.ecc) + EphTemp.w;
 	double sin_temp = sin(phi + phi);
 	double cos_temp = cos(phi + phi);
 	double duk = (EphTemp.cuc * cos_temp) + (EphTemp.cus * sin_temp);
 	double drk = (EphTemp.crc * cos_temp) + (EphTemp.crs * sin_temp);
 	double dik = (EphTemp.cic * cos_temp) + (EphTemp.cis * sin_temp);
-	Ek1 = 1.0 - (EphTemp.ecc * cos(EphTemp.Ek));
+	Ek1 = 1.0 - (EphTemp.ecc * cos(Ek));
 	EphTemp.axis += drk / Ek1;
 	EphTemp.sqrtA = sqrt(EphTemp.axis);
 	EphTemp.w += duk;
@@ -0,0 +1,597 @@
+//----------------------------------------------------------------------
+// IfDataWriter.cpp:
+//   Implementation of IF data output stage writing quantized samples
+//   on a separate thread through a ring of buffer slots
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+
+#include "IfDataWriter.h"
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define IF_WRITER_LINUX
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define IF_WRITER_URING
+#endif
+#endif
+#endif
+
+#define WRITER_SPIN_COUNT 64	// yield loops before sleeping on condition variable
+
+#ifdef IF_WRITER_URING
+// io_uring submission/completion rings mapped from kernel, used without liburing
+typedef struct
+{
+	int RingFd;
+	unsigned int *SqTail, *SqMask, *SqArray;
+	unsigned int *CqHead, *CqTail, *CqMask;
+	struct io_uring_sqe *Sqes;
+	struct io_uring_cqe *Cqes;
+	void *SqRing, *CqRing;
+	size_t SqRingSize, CqRingSize, SqesSize;
+	struct iovec Iov[IF_WRITER_DEPTH];	// vector of each write buffer, valid until completion
+} URING_STATE;
+#endif
+
+static const char *BackendNames[] = { "stdio", "direct", "io_uring", "mmap", "auto" };
+
+const char *IfWriterBackendName(IfWriterBackend Backend)
+{
+	return BackendNames[Backend];
+}
+
+IfWriterBackend IfWriterBackendFromName(const char *Name)
+{
+	int i;
+
+	for (i = IfWriterStdio; i < IfWriterAuto; i ++)
+		if (strcmp(Name, BackendNames[i]) == 0)
+			return (IfWriterBackend)i;
+	return IfWriterAuto;
+}
+
+CIfDataWriter::CIfDataWriter(FILE *File, int Size, int Number, IfWriterBackend WriterBackend, long long FileSize) : Head(0), Tail(0), Stopping(false), Sleeping(0), WriteFailed(false)
+{
+	int i;
+
+	OutFile = File;
+	SlotSize = Size;
+	SlotNumber = (Number < 0) ? 0 : (Number > IF_WRITER_MAX_SLOTS) ? IF_WRITER_MAX_SLOTS : Number;
+	memset(&Stats, 0, sizeof(Stats));
+	BaseTime = std::chrono::steady_clock::now();
+	FileFd = -1;
+	FileOffset = 0;
+	ChunkIndex = ChunkFill = InFlight = 0;
+	IoStartTime = 0.;
+	Uring = NULL;
+	Map = NULL;
+	MapSize = MapFill = 0;
+	for (i = 0; i < IF_WRITER_DEPTH; i ++)
+	{
+		Chunk[i] = NULL;
+		IssueTime[i] = -1.;
+	}
+
+	// try requested backend then fall back to simpler ones
+	Backend = IfWriterStdio;
+	if ((WriterBackend == IfWriterUring || WriterBackend == IfWriterAuto) && OpenDirect())
+	{
+		if (OpenUring())
+			Backend = IfWriterUring;
+		else
+			Backend = IfWriterDirect;
+	}
+	else if (WriterBackend == IfWriterDirect && OpenDirect())
+		Backend = IfWriterDirect;
+	else if (WriterBackend == IfWriterMmap && OpenMmap(FileSize))
+	{
+		Backend = IfWriterMmap;
+		SlotNumber = 0;	// slots are windows of the mapped file, nothing left for writer thread
+	}
+	if (Backend == IfWriterStdio)
+		setvbuf(OutFile, NULL, _IOFBF, IF_WRITER_CHUNK);	// large writes, must be set before first output
+
+	Buffer = (Backend == IfWriterMmap) ? NULL : new unsigned char[(size_t)SlotSize * (SlotNumber ? SlotNumber : 1)];
+	SlotLength = new int[SlotNumber ? SlotNumber : 1];
+	if (SlotNumber > 0)
+		Writer = std::thread(&CIfDataWriter::WriterLoop, this);
+}
+
+CIfDataWriter::~CIfDataWriter()
+{
+	int i;
+
+	Finish();
+	CloseUring();
+	for (i = 0; i < IF_WRITER_DEPTH; i ++)
+		free(Chunk[i]);
+	delete[] Buffer;
+	delete[] SlotLength;
+}
+
+unsigned char *CIfDataWriter::AcquireSlot()
+{
+	unsigned int Submitted = Head.load(std::memory_order_relaxed);
+
+	if (Backend == IfWriterMmap)
+	{
+		if (MapFill + SlotSize > MapSize && !MapFile(MapSize + (long long)SlotSize * IF_WRITER_MAX_SLOTS))	// longer than expected
+		{
+			WriteFailed = true;
+			return NULL;
+		}
+		return Map + MapFill;
+	}
+	if (SlotNumber == 0)
+		return Buffer;
+	if (Submitted - Tail.load(std::memory_order_acquire) >= (unsigned int)SlotNumber)
+	{
+		Stats.ProducerStalls ++;
+		Stats.ProducerWaitTime += WaitFor([&]{ return Submitted - Tail.load() < (unsigned int)SlotNumber; }, SpaceCond);
+	}
+	return Buffer + (size_t)SlotSize * (Submitted % SlotNumber);
+}
+
+void CIfDataWriter::SubmitSlot(int Size)
+{
+	unsigned int Submitted = Head.load(std::memory_order_relaxed);
+	int Occupancy;
+
+	if (Backend == IfWriterMmap)
+	{
+		MapFill += Size;
+		Stats.SlotsWritten ++;
+		Stats.BytesWritten += Size;
+		return;
+	}
+	if (SlotNumber == 0)
+	{
+		SlotLength[0] = Size;
+		WriteSlot(0);
+		return;
+	}
+	SlotLength[Submitted % SlotNumber] = Size;
+	Head.store(Submitted + 1);	// seq_cst, see Wake()
+	Occupancy = (int)(Submitted + 1 - Tail.load(std::memory_order_acquire));
+	Stats.OccupancySum += Occupancy;
+	if (Stats.MaxOccupancy < Occupancy)
+		Stats.MaxOccupancy = Occupancy;
+	Wake(DataCond);
+}
+
+BOOL CIfDataWriter::Finish()
+{
+	if (Writer.joinable())
+	{
+		Stopping = true;
+		Wake(DataCond);
+		Writer.join();
+	}
+	if (Backend == IfWriterStdio)
+		fflush(OutFile);
+	else if (Backend == IfWriterMmap)
+		FinishMmap();
+	else
+		FinishDirect();
+	return WriteFailed ? FALSE : TRUE;
+}
+
+// writer thread, write submitted slots in order until stopped and ring is empty
+void CIfDataWriter::WriterLoop()
+{
+	unsigned int Written = 0;
+
+	while (1)
+	{
+		if (Head.load(std::memory_order_acquire) == Written)
+		{
+			if (Stopping)	// Finish() is called by producer after its last SubmitSlot()
+				break;
+			Stats.WriterStalls ++;
+			Stats.WriterWaitTime += WaitFor([&]{ return Head.load() != Written || Stopping; }, DataCond);
+			continue;
+		}
+		WriteSlot(Written % SlotNumber);
+		Tail.store(++ Written);	// seq_cst, see Wake()
+		Wake(SpaceCond);
+	}
+}
+
+BOOL CIfDataWriter::WriteSlot(int Slot)
+{
+	size_t Size = (size_t)SlotLength[Slot];
+	double StartTime;
+
+	if (Backend == IfWriterStdio)
+	{
+		StartTime = BeginWrite();
+		if (fwrite(Buffer + (size_t)SlotSize * Slot, 1, Size, OutFile) != Size)
+			WriteFailed = true;
+		EndWrite(StartTime);
+	}
+	else
+	{
+		AppendChunk(Buffer + (size_t)SlotSize * Slot, (int)Size);
+		if (InFlight > 0)
+			CompleteWrites(FALSE);	// collect finished writes so latency is measured at slot resolution
+	}
+	Stats.SlotsWritten ++;
+	Stats.BytesWritten += Size;
+	return WriteFailed ? FALSE : TRUE;
+}
+
+// switch file descriptor of OutFile to O_DIRECT, nothing written by stdio yet so file
+// position is the same, fails on filesystems without O_DIRECT support (e.g. tmpfs)
+BOOL CIfDataWriter::OpenDirect()
+{
+#ifdef IF_WRITER_LINUX
+	int Flags;
+	void *Memory;
+
+	fflush(OutFile);
+	FileFd = fileno(OutFile);
+	FileOffset = (long long)lseek(FileFd, 0, SEEK_CUR);
+	if (FileOffset < 0 || (FileOffset % IF_WRITER_ALIGN) != 0)
+		return FALSE;
+	if ((Flags = fcntl(FileFd, F_GETFL)) < 0 || fcntl(FileFd, F_SETFL, Flags | O_DIRECT) < 0)
+		return FALSE;
+	if (posix_memalign(&Memory, IF_WRITER_ALIGN, IF_WRITER_CHUNK) != 0)
+	{
+		fcntl(FileFd, F_SETFL, Flags);
+		return FALSE;
+	}
+	Chunk[0] = (unsigned char *)Memory;
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+// set up io_uring with a submission entry for each write buffer, fails if kernel does not
+// support io_uring or it is not allowed (e.g. seccomp filter of container)
+BOOL CIfDataWriter::OpenUring()
+{
+#ifdef IF_WRITER_URING
+	struct io_uring_params Params;
+	URING_STATE *State;
+	unsigned char *SqPtr, *CqPtr;
+	void *Memory;
+	int i;
+
+	for (i = 1; i < IF_WRITER_DEPTH; i ++)	// first buffer allocated by OpenDirect()
+	{
+		if (posix_memalign(&Memory, IF_WRITER_ALIGN, IF_WRITER_CHUNK) != 0)
+			return FALSE;
+		Chunk[i] = (unsigned char *)Memory;
+	}
+	memset(&Params, 0, sizeof(Params));
+	State = new URING_STATE;
+	memset(State, 0, sizeof(URING_STATE));
+	if ((State->RingFd = (int)syscall(__NR_io_uring_setup, IF_WRITER_DEPTH, &Params)) < 0)
+	{
+		delete State;
+		return FALSE;
+	}
+	State->SqRingSize = Params.sq_off.array + Params.sq_entries * sizeof(unsigned int);
+	State->CqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(struct io_uring_cqe);
+	if (Params.features & IORING_FEAT_SINGLE_MMAP)
+		State->SqRingSize = State->CqRingSize = (State->SqRingSize > State->CqRingSize) ? State->SqRingSize : State->CqRingSize;
+	State->SqesSize = Params.sq_entries * sizeof(struct io_uring_sqe);
+	State->SqRing = mmap(NULL, State->SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, State->RingFd, IORING_OFF_SQ_RING);
+	State->CqRing = (Params.features & IORING_FEAT_SINGLE_MMAP) ? State->SqRing :
+		mmap(NULL, State->CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, State->RingFd, IORING_OFF_CQ_RING);
+	State->Sqes = (struct io_uring_sqe *)mmap(NULL, State->SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, State->RingFd, IORING_OFF_SQES);
+	Uring = State;
+	if (State->SqRing == MAP_FAILED || State->CqRing == MAP_FAILED || (void *)State->Sqes == MAP_FAILED)
+	{
+		CloseUring();
+		return FALSE;
+	}
+	SqPtr = (unsigned char *)State->SqRing;
+	CqPtr = (unsigned char *)State->CqRing;
+	State->SqTail = (unsigned int *)(SqPtr + Params.sq_off.tail);
+	State->SqMask = (unsigned int *)(SqPtr + Params.sq_off.ring_mask);
+	State->SqArray = (unsigned int *)(SqPtr + Params.sq_off.array);
+	State->CqHead = (unsigned int *)(CqPtr + Params.cq_off.head);
+	State->CqTail = (unsigned int *)(CqPtr + Params.cq_off.tail);
+	State->CqMask = (unsigned int *)(CqPtr + Params.cq_off.ring_mask);
+	State->Cqes = (struct io_uring_cqe *)(CqPtr + Params.cq_off.cqes);
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+void CIfDataWriter::CloseUring()
+{
+#ifdef IF_WRITER_URING
+	URING_STATE *State = (URING_STATE *)Uring;
+
+	if (!State)
+		return;
+	if ((void *)State->Sqes != MAP_FAILED && State->Sqes)
+		munmap(State->Sqes, State->SqesSize);
+	if (State->CqRing != MAP_FAILED && State->CqRing && State->CqRing != State->SqRing)
+		munmap(State->CqRing, State->CqRingSize);
+	if (State->SqRing != MAP_FAILED && State->SqRing)
+		munmap(State->SqRing, State->SqRingSize);
+	close(State->RingFd);
+	delete State;
+	Uring = NULL;
+#endif
+}
+
+// copy slot data into current aligned buffer, write buffer when full
+void CIfDataWriter::AppendChunk(const unsigned char *Data, int Size)
+{
+	int Length;
+
+	while (Size > 0)
+	{
+		Length = (Size < IF_WRITER_CHUNK - ChunkFill) ? Size : IF_WRITER_CHUNK - ChunkFill;
+		memcpy(Chunk[ChunkIndex] + ChunkFill, Data, Length);
+		ChunkFill += Length;
+		Data += Length;
+		Size -= Length;
+		if (ChunkFill == IF_WRITER_CHUNK)
+			WriteChunk(IF_WRITER_CHUNK);
+	}
+}
+
+// write Size bytes (multiple of IF_WRITER_ALIGN) of current buffer at FileOffset, direct backend
+// writes synchronously, io_uring queues the write and moves to next buffer, waiting for it if
+// still in flight
+void CIfDataWriter::WriteChunk(int Size)
+{
+#ifdef IF_WRITER_LINUX
+	if (Backend == IfWriterDirect)
+	{
+		double StartTime = BeginWrite();
+		ssize_t Written;
+		int Offset = 0;
+
+		while (Offset < Size)
+		{
+			if ((Written = pwrite(FileFd, Chunk[0] + Offset, Size - Offset, FileOffset + Offset)) <= 0)
+			{
+				if (Written < 0 && errno == EINTR)
+					continue;
+				WriteFailed = true;
+				break;
+			}
+			Offset += (int)Written;
+		}
+		EndWrite(StartTime);
+	}
+#endif
+#ifdef IF_WRITER_URING
+	if (Backend == IfWriterUring)
+	{
+		URING_STATE *State = (URING_STATE *)Uring;
+		unsigned int SqTail = *State->SqTail, Index = SqTail & *State->SqMask;
+		struct io_uring_sqe *Sqe = &State->Sqes[Index];
+
+		State->Iov[ChunkIndex].iov_base = Chunk[ChunkIndex];
+		State->Iov[ChunkIndex].iov_len = Size;
+		memset(Sqe, 0, sizeof(struct io_uring_sqe));
+		Sqe->opcode = IORING_OP_WRITEV;
+		Sqe->fd = FileFd;
+		Sqe->off = FileOffset;
+		Sqe->addr = (unsigned long long)(size_t)&State->Iov[ChunkIndex];
+		Sqe->len = 1;
+		Sqe->user_data = ChunkIndex;
+		State->SqArray[Index] = Index;
+		__atomic_store_n(State->SqTail, SqTail + 1, __ATOMIC_RELEASE);
+		IssueTime[ChunkIndex] = BeginWrite();
+		if (syscall(__NR_io_uring_enter, State->RingFd, 1, 0, 0, NULL, 0) != 1)
+		{
+			WriteFailed = true;
+			EndWrite(IssueTime[ChunkIndex]);
+			IssueTime[ChunkIndex] = -1.;
+		}
+		ChunkIndex = (ChunkIndex + 1) % IF_WRITER_DEPTH;
+		while (IssueTime[ChunkIndex] >= 0.)
+			CompleteWrites(TRUE);
+	}
+#endif
+	FileOffset += Size;
+	ChunkFill = 0;
+}
+
+// collect finished io_uring writes, wait for at least one if Wait is TRUE
+void CIfDataWriter::CompleteWrites(BOOL Wait)
+{
+#ifdef IF_WRITER_URING
+	URING_STATE *State = (URING_STATE *)Uring;
+	unsigned int CqHead, CqTail;
+	struct io_uring_cqe *Cqe;
+	int Index;
+
+	if (!State)
+		return;
+	CqHead = *State->CqHead;
+	CqTail = __atomic_load_n(State->CqTail, __ATOMIC_ACQUIRE);
+	if (Wait && CqHead == CqTail)
+	{
+		while (syscall(__NR_io_uring_enter, State->RingFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno == EINTR)
+			;
+		CqTail = __atomic_load_n(State->CqTail, __ATOMIC_ACQUIRE);
+	}
+	for (; CqHead != CqTail; CqHead ++)
+	{
+		Cqe = &State->Cqes[CqHead & *State->CqMask];
+		Index = (int)Cqe->user_data;
+		if (Cqe->res != (int)State->Iov[Index].iov_len)
+			WriteFailed = true;
+		EndWrite(IssueTime[Index]);
+		IssueTime[Index] = -1.;
+	}
+	__atomic_store_n(State->CqHead, CqHead, __ATOMIC_RELEASE);
+#endif
+}
+
+// write last partial buffer padded to alignment, wait all writes, then cut padding and turn
+// file descriptor back to normal mode at end of written data
+void CIfDataWriter::FinishDirect()
+{
+#ifdef IF_WRITER_LINUX
+	long long FileSize;
+	int Flags, Size;
+
+	if (FileFd < 0)
+		return;
+	FileSize = FileOffset + ChunkFill;
+	if (ChunkFill > 0)
+	{
+		Size = (ChunkFill + IF_WRITER_ALIGN - 1) & ~(IF_WRITER_ALIGN - 1);
+		memset(Chunk[ChunkIndex] + ChunkFill, 0, Size - ChunkFill);
+		WriteChunk(Size);
+	}
+	while (InFlight > 0)
+		CompleteWrites(TRUE);
+	if (ftruncate(FileFd, FileSize) != 0)
+		WriteFailed = true;
+	if ((Flags = fcntl(FileFd, F_GETFL)) >= 0)
+		fcntl(FileFd, F_SETFL, Flags & ~O_DIRECT);
+	lseek(FileFd, FileSize, SEEK_SET);
+	FileOffset = FileSize;
+	FileFd = -1;
+#endif
+}
+
+// preallocate FileSize bytes (plus a slot of margin) of output file and map it, quantized samples
+// are written in place by the threads generating them, kernel writes dirty pages back to file
+// File must be opened for both read and write (shared mapping needs a readable descriptor)
+BOOL CIfDataWriter::OpenMmap(long long FileSize)
+{
+#ifdef IF_WRITER_LINUX
+	if (FileSize <= 0)
+		return FALSE;
+	fflush(OutFile);
+	FileFd = fileno(OutFile);
+	FileOffset = (long long)lseek(FileFd, 0, SEEK_CUR);
+	if (FileOffset < 0 || (FileOffset % sysconf(_SC_PAGESIZE)) != 0)
+		return FALSE;
+	if (MapFile(FileSize + SlotSize))
+		return TRUE;
+	if (ftruncate(FileFd, FileOffset) != 0)	// undo preallocation for fallback backend
+		WriteFailed = true;
+	return FALSE;
+#else
+	return FALSE;
+#endif
+}
+
+// (re)map Size bytes of file from FileOffset, allocate blocks with fallocate() so that writing
+// mapped pages does not fail or fragment on full disk, sparse file if filesystem does not support it
+BOOL CIfDataWriter::MapFile(long long Size)
+{
+#ifdef IF_WRITER_LINUX
+	void *Address;
+
+	if (Map)
+		munmap(Map, (size_t)MapSize);
+	Map = NULL;
+	if (fallocate(FileFd, 0, FileOffset, Size) != 0 && ftruncate(FileFd, FileOffset + Size) != 0)
+		return FALSE;
+	if ((Address = mmap(NULL, (size_t)Size, PROT_READ | PROT_WRITE, MAP_SHARED, FileFd, FileOffset)) == MAP_FAILED)
+		return FALSE;
+	madvise(Address, (size_t)Size, MADV_SEQUENTIAL);
+	Map = (unsigned char *)Address;
+	MapSize = Size;
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+// unmap file and cut preallocated size to data actually written
+void CIfDataWriter::FinishMmap()
+{
+#ifdef IF_WRITER_LINUX
+	double StartTime;
+
+	if (FileFd < 0)
+		return;
+	StartTime = BeginWrite();
+	if (Map)
+		munmap(Map, (size_t)MapSize);
+	Map = NULL;
+	if (ftruncate(FileFd, FileOffset + MapFill) != 0)
+		WriteFailed = true;
+	EndWrite(StartTime);
+	lseek(FileFd, FileOffset + MapFill, SEEK_SET);
+	FileFd = -1;
+#endif
+}
+
+double CIfDataWriter::GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - BaseTime).count();
+}
+
+// latency of each write and time with any write in progress
+double CIfDataWriter::BeginWrite()
+{
+	double Time = GetTime();
+
+	if (InFlight ++ == 0)
+		IoStartTime = Time;
+	return Time;
+}
+
+void CIfDataWriter::EndWrite(double StartTime)
+{
+	double Time = GetTime();
+
+	Stats.WriteCount ++;
+	Stats.WriteLatency += Time - StartTime;
+	if (Stats.MaxWriteLatency < Time - StartTime)
+		Stats.MaxWriteLatency = Time - StartTime;
+	if (-- InFlight == 0)
+		Stats.IoTime += Time - IoStartTime;
+}
+
+// slots are produced and consumed at millisecond pace, so spin (yield) first and only sleep
+// on condition variable if waiting long, waker only takes the lock if the other side sleeps
+// return time waited in seconds
+template <typename F> double CIfDataWriter::WaitFor(F Ready, std::condition_variable &Cond)
+{
+	double StartTime = GetTime();
+	int i;
+
+	for (i = 0; i < WRITER_SPIN_COUNT && !Ready(); i ++)
+		std::this_thread::yield();
+	if (i == WRITER_SPIN_COUNT)
+	{
+		std::unique_lock<std::mutex> lock(Lock);
+		Sleeping ++;
+		Cond.wait(lock, Ready);
+		Sleeping --;
+	}
+	return GetTime() - StartTime;
+}
+
+// Head/Tail store before Wake() and Sleeping++ before Ready() in WaitFor() are all seq_cst,
+// so either the waker sees Sleeping > 0 or the sleeper sees the new Head/Tail, fence makes
+// sure the store is not still in store buffer when Sleeping is read (no lost wakeup)
+void CIfDataWriter::Wake(std::condition_variable &Cond)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (Sleeping > 0)
+	{
+		std::lock_guard<std::mutex> lock(Lock);
+		Cond.notify_one();
+	}
+}
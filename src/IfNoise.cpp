@@ -0,0 +1,564 @@
+//----------------------------------------------------------------------
+// IfNoise.cpp:
+//   Implementation of white Gaussian noise generation of IF samples
+//   with runtime instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include <mutex>
+#include <atomic>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "IfNoise.h"
+#include "FastMath.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IF_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE42
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+#endif
+
+#define ZIGGURAT_LAYERS 128
+#define ZIGGURAT_R 3.442619855899	// start of tail (right edge of base layer)
+#define ZIGGURAT_V 9.91256303526217e-3	// area of each layer
+#define ZIGGURAT_M 16777216.0	// range of 24bit abscissa of hash
+
+#define NOISE_GOLDEN 0x9e3779b97f4a7c15ULL
+#define NOISE_BATCH 2048	// I/Q values generated between fixing rejected values
+#define NOISE_POOL_PIECE (1 << 20)	// pool samples generated with one key
+
+// Marsaglia-Tsang Ziggurat tables for 24bit abscissa u, value u*Wn[i] of layer i is
+// accepted if u < Kn[i], Fn[i] is density at right edge of layer i for wedge test
+typedef struct
+{
+	int Kn[ZIGGURAT_LAYERS];
+	float Wn[ZIGGURAT_LAYERS];
+	double Fn[ZIGGURAT_LAYERS];
+} ZIGGURAT_TABLE;
+
+// hash keys of one millisecond, Key0/Key1 for Ziggurat hash of each I/Q value
+// and Key2 for stream of fallback sampler
+typedef struct
+{
+	unsigned int Key0, Key1;
+	unsigned long long Key2;
+} NOISE_KEY;
+
+static unsigned long long NoiseSeed = IF_NOISE_SEED;
+
+// noise pool of each value type, PoolRunNumber is 0 in exact mode, pool pointer is published
+// once the pool is filled so that generation threads read it without lock
+static int PoolRunNumber = 0, PoolPeriod = 0;
+static std::atomic<double *> DoublePool(NULL);
+static std::atomic<float *> FloatPool(NULL);
+static std::atomic<int *> IntPool(NULL);
+static std::mutex PoolLock;	// serializes pool creation and free
+
+static ZIGGURAT_TABLE BuildZigguratTable()
+{
+	ZIGGURAT_TABLE Table;
+	double dn = ZIGGURAT_R, tn = dn, q = ZIGGURAT_V / exp(-0.5 * dn * dn);
+	int i;
+
+	Table.Kn[0] = (int)((dn / q) * ZIGGURAT_M);
+	Table.Kn[1] = 0;
+	Table.Wn[0] = (float)(q / ZIGGURAT_M);
+	Table.Wn[ZIGGURAT_LAYERS - 1] = (float)(dn / ZIGGURAT_M);
+	Table.Fn[0] = 1.0;
+	Table.Fn[ZIGGURAT_LAYERS - 1] = exp(-0.5 * dn * dn);
+	for (i = ZIGGURAT_LAYERS - 2; i >= 1; i --)
+	{
+		dn = sqrt(-2.0 * log(ZIGGURAT_V / dn + exp(-0.5 * dn * dn)));
+		Table.Kn[i + 1] = (int)((dn / tn) * ZIGGURAT_M);
+		tn = dn;
+		Table.Fn[i] = exp(-0.5 * dn * dn);
+		Table.Wn[i] = (float)(dn / ZIGGURAT_M);
+	}
+	return Table;
+}
+
+static const ZIGGURAT_TABLE &GetZigguratTable()
+{
+	static const ZIGGURAT_TABLE Table = BuildZigguratTable();
+
+	return Table;
+}
+
+static FORCE_INLINE unsigned long long SplitMix64(unsigned long long Value)
+{
+	Value += NOISE_GOLDEN;
+	Value = (Value ^ (Value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	Value = (Value ^ (Value >> 27)) * 0x94d049bb133111ebULL;
+	return Value ^ (Value >> 31);
+}
+
+static FORCE_INLINE unsigned int Fmix32(unsigned int Value)
+{
+	Value ^= Value >> 16;
+	Value *= 0x85ebca6b;
+	Value ^= Value >> 13;
+	Value *= 0xc2b2ae35;
+	return Value ^ (Value >> 16);
+}
+
+static void GetNoiseKey(int Ms, NOISE_KEY &Key)
+{
+	unsigned long long Value = SplitMix64(NoiseSeed ^ SplitMix64((unsigned long long)(long long)Ms));
+
+	Key.Key0 = (unsigned int)Value;
+	Key.Key1 = (unsigned int)(Value >> 32);
+	Key.Key2 = SplitMix64(Value);
+}
+
+// hash of I/Q value Slot (2*sample index within millisecond + 0 for I, 1 for Q)
+// bit 31-25 layer index, bit 24 sign, bit 23-0 abscissa
+static FORCE_INLINE unsigned int SlotHash(const NOISE_KEY &Key, unsigned int Slot)
+{
+	return Fmix32(Fmix32(Slot * 0x9e3779b9U + Key.Key0) ^ Key.Key1);
+}
+
+// Ziggurat value of hash, return FALSE if value rejected. Sign bit is put in without
+// branch, it is unpredictable and would cost more than the rest of the calculation
+static FORCE_INLINE BOOL ZigguratValue(const ZIGGURAT_TABLE &Table, unsigned int Hash, float &Value)
+{
+	int Layer = Hash >> 25, Abscissa = Hash & 0xffffff;
+	unsigned int Bits;
+
+	Value = (float)Abscissa * Table.Wn[Layer];
+	memcpy(&Bits, &Value, sizeof(Bits));
+	Bits ^= (Hash << 7) & 0x80000000;
+	memcpy(&Value, &Bits, sizeof(Bits));
+	return (Abscissa < Table.Kn[Layer]) ? TRUE : FALSE;
+}
+
+// index of lowest set bit by de Bruijn sequence, Bits should not be 0
+static const unsigned char DeBruijnIndex[64] = {
+	 0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4, 62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+	63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11, 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6,
+};
+
+static FORCE_INLINE int LowestBit(unsigned long long Bits)
+{
+	return DeBruijnIndex[((Bits & (~Bits + 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+// uniform random number in (0,1) from fallback stream
+static FORCE_INLINE double FallbackUniform(unsigned long long &State)
+{
+	State += NOISE_GOLDEN;
+	return ((SplitMix64(State) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// replace rejected value of Slot by wedge or tail sampling with fallback stream of the slot,
+// further layers drawn are accepted the same way as the kernels do
+static float ZigguratFallback(const ZIGGURAT_TABLE &Table, const NOISE_KEY &Key, unsigned int Slot)
+{
+	unsigned long long State = Key.Key2 + Slot * NOISE_GOLDEN;
+	unsigned int Hash = SlotHash(Key, Slot);
+	int Layer;
+	double x, y, Sign;
+	float Value;
+
+	for (;;)
+	{
+		Layer = Hash >> 25;
+		Sign = (Hash & 0x1000000) ? -1.0 : 1.0;
+		if (Layer == 0)	// tail beyond ZIGGURAT_R
+		{
+			do
+			{
+				x = -log(FallbackUniform(State)) / ZIGGURAT_R;
+				y = -log(FallbackUniform(State));
+			} while (y + y < x * x);
+			return (float)(Sign * (ZIGGURAT_R + x));
+		}
+		x = (double)((float)(int)(Hash & 0xffffff) * Table.Wn[Layer]);
+		if (Table.Fn[Layer] + FallbackUniform(State) * (Table.Fn[Layer - 1] - Table.Fn[Layer]) < exp(-0.5 * x * x))
+			return (float)(Sign * x);
+		State += NOISE_GOLDEN;
+		Hash = (unsigned int)(SplitMix64(State) >> 32);
+		if (ZigguratValue(Table, Hash, Value))
+			return Value;
+	}
+}
+
+static FORCE_INLINE void StoreValue(float Value, float &Output)
+{
+	Output = Value;
+}
+
+static FORCE_INLINE void StoreValue(float Value, double &Output)
+{
+	Output = (double)Value;
+}
+
+static FORCE_INLINE void StoreValue(float Value, int &Output)
+{
+	Output = (int)lrintf(Value * IF_INT_SIGMA);	// round to nearest even as vector conversion
+}
+
+// values First to Count-1 of Slot, bit of Reject set for rejected values
+template <typename ValueType> static void NoiseScalar(const ZIGGURAT_TABLE &Table, const NOISE_KEY &Key, unsigned int Slot, int First, int Count, ValueType Output[], unsigned long long Reject[])
+{
+	int i;
+	unsigned long long Rejected;
+	float Value;
+
+	for (i = First; i < Count; i ++)
+	{
+		Rejected = ZigguratValue(Table, SlotHash(Key, Slot + i), Value) ? 0 : 1;
+		StoreValue(Value, Output[i]);
+		Reject[i >> 6] |= Rejected << (i & 63);
+	}
+}
+
+#if defined(IF_KERNEL_X86)
+// Vector kernels hash 4/8/16 consecutive slots with 32bit multiplies, look up layer
+// tables (gather for AVX2/AVX-512) and convert accepted values the same way as
+// StoreValue(), rejected lanes are marked and overwritten after the batch. Kernels
+// return number of values done, the rest is done by scalar kernel after upper half of
+// YMM/ZMM registers cleared, so neither scalar tail nor fallback sampler (which calls
+// log/exp of libm) runs with dirty upper state
+
+//*************** SSE4.2 kernels ****************
+TARGET_SSE42 static FORCE_INLINE __m128i Fmix32Sse42(__m128i Value)
+{
+	Value = _mm_xor_si128(Value, _mm_srli_epi32(Value, 16));
+	Value = _mm_mullo_epi32(Value, _mm_set1_epi32((int)0x85ebca6b));
+	Value = _mm_xor_si128(Value, _mm_srli_epi32(Value, 13));
+	Value = _mm_mullo_epi32(Value, _mm_set1_epi32((int)0xc2b2ae35));
+	return _mm_xor_si128(Value, _mm_srli_epi32(Value, 16));
+}
+
+// no gather in SSE4.2, hash is vectorized and table look up done for each lane
+template <typename ValueType> TARGET_SSE42 static int NoiseSse42(const ZIGGURAT_TABLE &Table, const NOISE_KEY &Key, unsigned int Slot, int Count, ValueType Output[], unsigned long long Reject[])
+{
+	__m128i Counter = _mm_add_epi32(_mm_set1_epi32((int)Slot), _mm_setr_epi32(0, 1, 2, 3));
+	__m128i Golden = _mm_set1_epi32((int)0x9e3779b9), Key0 = _mm_set1_epi32((int)Key.Key0), Key1 = _mm_set1_epi32((int)Key.Key1);
+	unsigned int Hash[4];
+	unsigned long long Rejected;
+	float Value;
+	int i, j;
+
+	for (i = 0; i + 4 <= Count; i += 4)
+	{
+		_mm_storeu_si128((__m128i *)Hash, Fmix32Sse42(_mm_xor_si128(Fmix32Sse42(_mm_add_epi32(_mm_mullo_epi32(Counter, Golden), Key0)), Key1)));
+		Counter = _mm_add_epi32(Counter, _mm_set1_epi32(4));
+		for (j = 0; j < 4; j ++)
+		{
+			Rejected = ZigguratValue(Table, Hash[j], Value) ? 0 : 1;
+			StoreValue(Value, Output[i + j]);
+			Reject[(i + j) >> 6] |= Rejected << ((i + j) & 63);
+		}
+	}
+	return i;
+}
+
+//*************** AVX2 kernels ****************
+TARGET_AVX2 static FORCE_INLINE __m256i Fmix32Avx2(__m256i Value)
+{
+	Value = _mm256_xor_si256(Value, _mm256_srli_epi32(Value, 16));
+	Value = _mm256_mullo_epi32(Value, _mm256_set1_epi32((int)0x85ebca6b));
+	Value = _mm256_xor_si256(Value, _mm256_srli_epi32(Value, 13));
+	Value = _mm256_mullo_epi32(Value, _mm256_set1_epi32((int)0xc2b2ae35));
+	return _mm256_xor_si256(Value, _mm256_srli_epi32(Value, 16));
+}
+
+TARGET_AVX2 static FORCE_INLINE void StoreAvx2(__m256 Value, float *Output)
+{
+	_mm256_storeu_ps(Output, Value);
+}
+
+TARGET_AVX2 static FORCE_INLINE void StoreAvx2(__m256 Value, double *Output)
+{
+	_mm256_storeu_pd(Output, _mm256_cvtps_pd(_mm256_castps256_ps128(Value)));
+	_mm256_storeu_pd(Output + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(Value, 1)));
+}
+
+TARGET_AVX2 static FORCE_INLINE void StoreAvx2(__m256 Value, int *Output)
+{
+	_mm256_storeu_si256((__m256i *)Output, _mm256_cvtps_epi32(_mm256_mul_ps(Value, _mm256_set1_ps((float)IF_INT_SIGMA))));
+}
+
+template <typename ValueType> TARGET_AVX2 static int NoiseAvx2(const ZIGGURAT_TABLE &Table, const NOISE_KEY &Key, unsigned int Slot, int Count, ValueType Output[], unsigned long long Reject[])
+{
+	__m256i Counter = _mm256_add_epi32(_mm256_set1_epi32((int)Slot), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	__m256i Golden = _mm256_set1_epi32((int)0x9e3779b9), Key0 = _mm256_set1_epi32((int)Key.Key0), Key1 = _mm256_set1_epi32((int)Key.Key1);
+	__m256i AbscissaMask = _mm256_set1_epi32(0xffffff), SignMask = _mm256_set1_epi32((int)0x80000000);
+	__m256i Hash, Layer, Abscissa, Kn;
+	__m256 Value;
+	unsigned int Rejected;
+	int i;
+
+	for (i = 0; i + 8 <= Count; i += 8)
+	{
+		Hash = Fmix32Avx2(_mm256_xor_si256(Fmix32Avx2(_mm256_add_epi32(_mm256_mullo_epi32(Counter, Golden), Key0)), Key1));
+		Counter = _mm256_add_epi32(Counter, _mm256_set1_epi32(8));
+		Layer = _mm256_srli_epi32(Hash, 25);
+		Abscissa = _mm256_and_si256(Hash, AbscissaMask);
+		Kn = _mm256_i32gather_epi32(Table.Kn, Layer, 4);
+		Value = _mm256_mul_ps(_mm256_cvtepi32_ps(Abscissa), _mm256_i32gather_ps(Table.Wn, Layer, 4));
+		Value = _mm256_xor_ps(Value, _mm256_castsi256_ps(_mm256_and_si256(_mm256_slli_epi32(Hash, 7), SignMask)));
+		StoreAvx2(Value, Output + i);
+		Rejected = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(Kn, Abscissa))) & 0xff;
+		Reject[i >> 6] |= (unsigned long long)Rejected << (i & 63);
+	}
+	return i;
+}
+
+//*************** AVX-512 kernels ****************
+TARGET_AVX512 static FORCE_INLINE __m512i Fmix32Avx512(__m512i Value)
+{
+	__m512i Shift;
+
+	Shift = _mm512_maskz_srli_epi32(0xffff, Value, 16);
+	Value = _mm512_mullo_epi32(_mm512_xor_si512(Value, Shift), _mm512_set1_epi32((int)0x85ebca6b));
+	Shift = _mm512_maskz_srli_epi32(0xffff, Value, 13);
+	Value = _mm512_mullo_epi32(_mm512_xor_si512(Value, Shift), _mm512_set1_epi32((int)0xc2b2ae35));
+	Shift = _mm512_maskz_srli_epi32(0xffff, Value, 16);
+	return _mm512_xor_si512(Value, Shift);
+}
+
+TARGET_AVX512 static FORCE_INLINE void StoreAvx512(__m512 Value, float *Output)
+{
+	_mm512_storeu_ps(Output, Value);
+}
+
+TARGET_AVX512 static FORCE_INLINE void StoreAvx512(__m512 Value, double *Output)
+{
+	__m256 Low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xf, _mm512_castps_pd(Value), 0));
+	__m256 High = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xf, _mm512_castps_pd(Value), 1));
+
+	_mm512_storeu_pd(Output, _mm512_maskz_cvtps_pd(0xff, Low));
+	_mm512_storeu_pd(Output + 8, _mm512_maskz_cvtps_pd(0xff, High));
+}
+
+TARGET_AVX512 static FORCE_INLINE void StoreAvx512(__m512 Value, int *Output)
+{
+	__m512 Scaled = _mm512_mul_ps(Value, _mm512_set1_ps((float)IF_INT_SIGMA));
+
+	_mm512_storeu_si512(Output, _mm512_maskz_cvtps_epi32(0xffff, Scaled));
+}
+
+template <typename ValueType> TARGET_AVX512 static int NoiseAvx512(const ZIGGURAT_TABLE &Table, const NOISE_KEY &Key, unsigned int Slot, int Count, ValueType Output[], unsigned long long Reject[])
+{
+	__m512i Counter = _mm512_add_epi32(_mm512_set1_epi32((int)Slot), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	__m512i Golden = _mm512_set1_epi32((int)0x9e3779b9), Key0 = _mm512_set1_epi32((int)Key.Key0), Key1 = _mm512_set1_epi32((int)Key.Key1);
+	__m512i AbscissaMask = _mm512_set1_epi32(0xffffff), SignMask = _mm512_set1_epi32((int)0x80000000);
+	__m512i Hash, Layer, Abscissa, Kn, Sign;
+	__m512 Value, Wn;
+	int i;
+
+	// all-lane masked (zeroing) forms of intrinsics are used, unmasked forms pass undefined
+	// merge source in avx512fintrin.h which GCC 12 reports as used uninitialized
+	for (i = 0; i + 16 <= Count; i += 16)
+	{
+		Hash = Fmix32Avx512(_mm512_xor_si512(Fmix32Avx512(_mm512_add_epi32(_mm512_mullo_epi32(Counter, Golden), Key0)), Key1));
+		Counter = _mm512_add_epi32(Counter, _mm512_set1_epi32(16));
+		Layer = _mm512_maskz_srli_epi32(0xffff, Hash, 25);
+		Abscissa = _mm512_and_si512(Hash, AbscissaMask);
+		Kn = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xffff, Layer, Table.Kn, 4);
+		Wn = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, Layer, Table.Wn, 4);
+		Value = _mm512_mul_ps(_mm512_maskz_cvtepi32_ps(0xffff, Abscissa), Wn);
+		Sign = _mm512_and_si512(_mm512_maskz_slli_epi32(0xffff, Hash, 7), SignMask);
+		Value = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(Value), Sign));
+		StoreAvx512(Value, Output + i);
+		Reject[i >> 6] |= (unsigned long long)_mm512_cmpge_epi32_mask(Abscissa, Kn) << (i & 63);
+	}
+	return i;
+}
+
+// see IfSampleKernel.cpp, clear upper half of YMM/ZMM registers after AVX kernels
+TARGET_AVX2 static void ZeroUpperAvx()
+{
+	_mm256_zeroupper();
+}
+#endif
+
+// Count I/Q values from Slot of one millisecond with kernel of given instruction set,
+// rejected values of each batch replaced in slot order
+template <typename ValueType> static void NoiseIsa(const NOISE_KEY &Key, unsigned int Slot, int Count, ValueType Output[], IfKernelIsa Isa)
+{
+	const ZIGGURAT_TABLE &Table = GetZigguratTable();
+	unsigned long long Reject[NOISE_BATCH / 64], Bits;
+	int i, j, Batch, Done;
+
+	for (i = 0; i < Count; i += NOISE_BATCH)
+	{
+		Batch = (Count - i < NOISE_BATCH) ? Count - i : NOISE_BATCH;
+		memset(Reject, 0, sizeof(Reject));
+		switch (Isa)
+		{
+#if defined(IF_KERNEL_X86)
+		case IfKernelSse42: Done = NoiseSse42(Table, Key, Slot + i, Batch, Output + i, Reject); break;
+		case IfKernelAvx2: Done = NoiseAvx2(Table, Key, Slot + i, Batch, Output + i, Reject); ZeroUpperAvx(); break;
+		case IfKernelAvx512: Done = NoiseAvx512(Table, Key, Slot + i, Batch, Output + i, Reject); ZeroUpperAvx(); break;
+#endif
+		default: Done = 0; break;
+		}
+		NoiseScalar(Table, Key, Slot + i, Done, Batch, Output + i, Reject);
+		for (j = 0; j < Batch; j += 64)
+			for (Bits = Reject[j >> 6]; Bits; Bits &= Bits - 1)
+				StoreValue(ZigguratFallback(Table, Key, Slot + i + j + LowestBit(Bits)), Output[i + j + LowestBit(Bits)]);
+	}
+}
+
+static std::atomic<double *> &PoolPointer(double *) { return DoublePool; }
+static std::atomic<float *> &PoolPointer(float *) { return FloatPool; }
+static std::atomic<int *> &PoolPointer(int *) { return IntPool; }
+
+// pool of ValueType, generated in pieces with keys of negative millisecond index (never
+// used by exact mode) at first call, later calls only load the published pointer
+template <typename ValueType> static const ValueType *GetNoisePool()
+{
+	std::atomic<ValueType *> &PoolAtomic = PoolPointer((ValueType *)NULL);
+	ValueType *Pool = PoolAtomic.load(std::memory_order_acquire);
+	long long Values = (long long)PoolRunNumber * IF_NOISE_POOL_RUN * 2;
+	int i, PieceNumber = (int)((Values + NOISE_POOL_PIECE * 2 - 1) / (NOISE_POOL_PIECE * 2));
+	IfKernelIsa Isa;
+
+	if (Pool != NULL || PoolRunNumber == 0)
+		return Pool;
+	std::lock_guard<std::mutex> Guard(PoolLock);
+	if ((Pool = PoolAtomic.load(std::memory_order_relaxed)) != NULL)	// filled by other thread while waiting
+		return Pool;
+	Isa = GetIfKernelIsa();
+	Pool = new ValueType[Values];
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (i = 0; i < PieceNumber; i ++)
+	{
+		NOISE_KEY Key;
+		long long Start = (long long)i * NOISE_POOL_PIECE * 2;
+
+		GetNoiseKey(-1 - i, Key);
+		NoiseIsa(Key, 0, (int)((Values - Start < NOISE_POOL_PIECE * 2) ? Values - Start : NOISE_POOL_PIECE * 2), Pool + Start, Isa);
+	}
+	PoolAtomic.store(Pool, std::memory_order_release);
+	return Pool;
+}
+
+static void FreeNoisePool()
+{
+	delete[] DoublePool.exchange(NULL);
+	delete[] FloatPool.exchange(NULL);
+	delete[] IntPool.exchange(NULL);
+}
+
+// copy Length samples from sample Index of millisecond Ms from the pool, run r of the
+// millisecond is pool run Offset+r*Stride, unsigned arithmetic wraps at power of 2
+template <typename ValueType> static void ReadNoisePool(const ValueType Pool[], int Ms, int Index, int Length, ValueType Output[])
+{
+	unsigned long long Hash = SplitMix64(~NoiseSeed ^ SplitMix64((unsigned long long)(long long)((PoolPeriod > 0) ? Ms % PoolPeriod : Ms)));
+	unsigned int Mask = PoolRunNumber - 1, Offset = (unsigned int)Hash & Mask, Stride = ((unsigned int)(Hash >> 32) & Mask) | 1;
+	unsigned int Run;
+	int Position, Count;
+
+	while (Length > 0)
+	{
+		Run = Index / IF_NOISE_POOL_RUN;
+		Position = Index % IF_NOISE_POOL_RUN;
+		Count = (Length < IF_NOISE_POOL_RUN - Position) ? Length : IF_NOISE_POOL_RUN - Position;
+		memcpy(Output, Pool + (((Offset + Run * Stride) & Mask) * IF_NOISE_POOL_RUN + Position) * 2, Count * 2 * sizeof(ValueType));
+		Output += Count * 2;
+		Index += Count;
+		Length -= Count;
+	}
+}
+
+// split range into pieces within each millisecond, each millisecond has its own keys
+template <typename ValueType, typename SampleType> static void GenerateNoise(SampleType Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa)
+{
+	NOISE_KEY Key;
+	int Ms = Start / MsSampleNumber, Index = Start % MsSampleNumber, Length;
+	const ValueType *Pool = (PoolRunNumber > 0) ? GetNoisePool<ValueType>() : NULL;
+
+	if (Isa == IfKernelAuto)
+		Isa = GetIfKernelIsa();
+	while (Count > 0)
+	{
+		Length = (Count < MsSampleNumber - Index) ? Count : MsSampleNumber - Index;
+		if (Pool)
+			ReadNoisePool(Pool, FirstMs + Ms, Index, Length, (ValueType *)Noise);
+		else
+		{
+			GetNoiseKey(FirstMs + Ms, Key);
+			NoiseIsa(Key, (unsigned int)Index * 2, Length * 2, (ValueType *)Noise, Isa);
+		}
+		Noise += Length;
+		Count -= Length;
+		Ms ++;
+		Index = 0;
+	}
+}
+
+void SetIfNoiseSeed(unsigned long long Seed)
+{
+	NoiseSeed = Seed;
+}
+
+unsigned long long GetIfNoiseSeed()
+{
+	return NoiseSeed;
+}
+
+void SetIfNoisePool(long long PoolSamples, int Period, IfSampleType SampleType)
+{
+	long long Runs = (PoolSamples + IF_NOISE_POOL_RUN - 1) / IF_NOISE_POOL_RUN;
+
+	{
+		std::lock_guard<std::mutex> Guard(PoolLock);
+		FreeNoisePool();
+		for (PoolRunNumber = (PoolSamples > 0) ? 1 : 0; PoolRunNumber > 0 && PoolRunNumber < Runs && PoolRunNumber < IF_NOISE_POOL_MAX_RUNS; PoolRunNumber <<= 1)
+			;
+		PoolPeriod = (Period > 0) ? Period : 0;
+	}
+	if (PoolRunNumber == 0)
+		return;
+	if (SampleType == IfSampleFloat)
+		GetNoisePool<float>();
+	else if (SampleType == IfSampleInt16)
+		GetNoisePool<int>();
+	else
+		GetNoisePool<double>();
+}
+
+long long GetIfNoisePoolSize()
+{
+	return (long long)PoolRunNumber * IF_NOISE_POOL_RUN;
+}
+
+int GetIfNoisePeriod()
+{
+	return PoolPeriod;
+}
+
+void GenerateIfNoise(complex_number Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa)
+{
+	GenerateNoise<double>(Noise, FirstMs, MsSampleNumber, Start, Count, Isa);
+}
+
+void GenerateIfNoise(complex_float Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa)
+{
+	GenerateNoise<float>(Noise, FirstMs, MsSampleNumber, Start, Count, Isa);
+}
+
+void GenerateIfNoise(complex_int32 Noise[], int FirstMs, int MsSampleNumber, int Start, int Count, IfKernelIsa Isa)
+{
+	GenerateNoise<int>(Noise, FirstMs, MsSampleNumber, Start, Count, Isa);
+}
@@ -0,0 +1,744 @@
+//----------------------------------------------------------------------
+// IfQuantize.cpp:
+//   Implementation of IF sample quantization to output formats with
+//   runtime instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+#include <math.h>
+#include <stdlib.h>
+
+#include "IfQuantize.h"
+#include "FastMath.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IF_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE42
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+#endif
+
+// fixed point gain in Q16, applied to samples in unit of 1/IF_INT_SIGMA of noise sigma
+#define INT_GAIN_SHIFT 16
+
+// Quantization constants of samples with ValueType, calculated once for each call
+// so that the scalar kernel and all vector kernels use the same values. IQ8/IQ16 and
+// IQ4 magnitude clamp the scaled value to [Low, High] before truncation, High and Low
+// are one step beyond saturation so a clamped value is still seen as clipped
+template <typename ValueType> struct QuantParam
+{
+	ValueType Gain;	// quantized value per unit of sample value (Q16 for fixed point)
+	ValueType Threshold, ClipThreshold;	// IQ2 magnitude bit and clip threshold
+	ValueType Low, High;	// clamp range of scaled value (floating point only)
+	int Max;	// largest quantized value (magnitude for IQ4)
+};
+
+// 4bit mask with bit n moved to bit 2n, interleaves IQ2 sign/magnitude masks of compares
+static const unsigned char SpreadTable[16] = {
+	0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15, 0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55,
+};
+
+// IQ2 bytes of 8 values (2 values for low byte) from magnitude and sign masks of compares
+static FORCE_INLINE unsigned int SpreadBits(unsigned int MagnitudeBits, unsigned int SignBits)
+{
+	return (SpreadTable[MagnitudeBits & 0xf] | (SpreadTable[SignBits & 0xf] << 1)) | ((SpreadTable[(MagnitudeBits >> 4) & 0xf] | (SpreadTable[(SignBits >> 4) & 0xf] << 1)) << 8);
+}
+
+static double FormatGain(OutputFormat Format)
+{
+	switch (Format)
+	{
+	case OutputFormatIQ2: return 1.0;
+	case OutputFormatIQ4: return 3.0;	// optimal quantization for sigma=1 noise
+	case OutputFormatIQ16: return 3277.0;
+	default: return 25.0;	// sigma scaled at 25 -> +-5 sigma scaled within range of INT8
+	}
+}
+
+static int FormatMax(OutputFormat Format)
+{
+	switch (Format)
+	{
+	case OutputFormatIQ2: return 1;
+	case OutputFormatIQ4: return 7;
+	case OutputFormatIQ16: return 32767;
+	default: return 127;
+	}
+}
+
+template <typename ValueType> static void GetQuantParam(OutputFormat Format, double GainScale, QuantParam<ValueType> &Param)
+{
+	Param.Gain = (ValueType)(GainScale * FormatGain(Format));
+	Param.Threshold = (ValueType)(1.1 / GainScale);	// the optimal threshold for Gauss noise is Sigma, increase a little to compensate added signal power
+	Param.ClipThreshold = 5 * Param.Threshold;	// clip threshold set to 5 Sigma
+	Param.Max = FormatMax(Format);
+	Param.High = (ValueType)(Param.Max + 1);
+	Param.Low = (Format == OutputFormatIQ4) ? (ValueType)0 : (ValueType)(-Param.Max - 2);	// IQ4 clamps magnitude
+}
+
+static void GetQuantParam(OutputFormat Format, double GainScale, QuantParam<int> &Param)
+{
+	Param.Gain = (int)(GainScale * FormatGain(Format) * (1 << INT_GAIN_SHIFT) / IF_INT_SIGMA + 0.5);
+	Param.Threshold = (int)(1.1 / GainScale * IF_INT_SIGMA + 0.5);	// same threshold as floating point version
+	Param.ClipThreshold = 5 * Param.Threshold;
+	Param.Max = FormatMax(Format);
+	Param.Low = Param.High = 0;
+}
+
+// output byte of I/Q value Index
+template <OutputFormat Format> static FORCE_INLINE int QuantOffset(int Index)
+{
+	return (Format == OutputFormatIQ2) ? Index / 4 : (Format == OutputFormatIQ4) ? Index / 2 : (Format == OutputFormatIQ16) ? Index * 2 : Index;
+}
+
+//*************** scalar reference kernels ****************
+// quantized value of one I/Q value: sign/magnitude bits (IQ2), sign and magnitude nibble (IQ4)
+// or saturated value (IQ8/IQ16), value scaled and truncated toward zero
+template <OutputFormat Format, typename ValueType> static FORCE_INLINE int QuantValue(ValueType Value, const QuantParam<ValueType> &Param, int &ClippedCount)
+{
+	ValueType Scaled;
+
+	if (Format == OutputFormatIQ2)
+	{
+		Scaled = fabs(Value);
+		if (Scaled >= Param.ClipThreshold)
+			ClippedCount ++;
+		return ((Value < 0) ? 2 : 0) | ((Scaled >= Param.Threshold) ? 1 : 0);
+	}
+	else if (Format == OutputFormatIQ4)
+	{
+		Scaled = fabs(Value) * Param.Gain;
+		if (Scaled >= Param.High)
+		{
+			ClippedCount ++;
+			return Param.Max | ((Value < 0) ? 8 : 0);
+		}
+		return (int)Scaled | ((Value < 0) ? 8 : 0);	// add sign bit as MSB
+	}
+	Scaled = Value * Param.Gain;
+	if (Scaled >= Param.High)	// truncated value exceeds Max
+	{
+		ClippedCount ++;
+		return Param.Max;
+	}
+	else if (Scaled <= Param.Low)	// truncated value below -Max-1
+	{
+		ClippedCount ++;
+		return -Param.Max - 1;
+	}
+	return (int)Scaled;
+}
+
+template <OutputFormat Format> static FORCE_INLINE int QuantValue(int Value, const QuantParam<int> &Param, int &ClippedCount)
+{
+	int Quant;
+
+	if (Format == OutputFormatIQ2)
+	{
+		Quant = abs(Value);
+		if (Quant >= Param.ClipThreshold)
+			ClippedCount ++;
+		return ((Value < 0) ? 2 : 0) | ((Quant >= Param.Threshold) ? 1 : 0);
+	}
+	else if (Format == OutputFormatIQ4)
+	{
+		Quant = (abs(Value) * Param.Gain) >> INT_GAIN_SHIFT;
+		if (Quant > Param.Max)
+		{
+			ClippedCount ++;
+			Quant = Param.Max;
+		}
+		return (Quant | ((Value < 0) ? 8 : 0)) & 0xf;
+	}
+	else if (Format == OutputFormatIQ16)	// product may exceed 32bit
+		Quant = (int)(((long long)Value * Param.Gain) / (1 << INT_GAIN_SHIFT));
+	else
+		Quant = (Value * Param.Gain) / (1 << INT_GAIN_SHIFT);	// division to truncate toward zero
+	if (Quant > Param.Max)
+	{
+		ClippedCount ++;
+		Quant = Param.Max;
+	}
+	else if (Quant < -Param.Max - 1)
+	{
+		ClippedCount ++;
+		Quant = -Param.Max - 1;
+	}
+	return Quant;
+}
+
+// quantize Count I/Q values (real and imaginary part interleaved), also the tail of vector kernels
+template <OutputFormat Format, typename ValueType> static int QuantScalar(const ValueType Value[], int Count, unsigned char Output[], const QuantParam<ValueType> &Param)
+{
+	int i, Quant, ClippedCount = 0;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Quant = QuantValue<Format>(Value[i], Param, ClippedCount);
+		if (Format == OutputFormatIQ2)	// 4 values (2 samples) in each byte from LSB
+			Output[i >> 2] = (unsigned char)(((i & 3) ? Output[i >> 2] : 0) | (Quant << ((i & 3) * 2)));
+		else if (Format == OutputFormatIQ4)	// 2 values (1 sample) in each byte from MSB
+			Output[i >> 1] = (unsigned char)((i & 1) ? (Output[i >> 1] | Quant) : (Quant << 4));
+		else if (Format == OutputFormatIQ16)	// little endian
+		{
+			Output[i * 2] = (unsigned char)(Quant & 0xff);
+			Output[i * 2 + 1] = (unsigned char)((Quant >> 8) & 0xff);
+		}
+		else
+			Output[i] = (unsigned char)(Quant & 0xff);
+	}
+
+	return ClippedCount;
+}
+
+#if defined(IF_KERNEL_X86)
+// Vector kernels process 16 I/Q values each loop: values are scaled, clamped and
+// truncated into int32 lanes, packed by saturating packs (IQ8/IQ16) or multiply-add of
+// nibble pairs (IQ4), IQ2 sign/magnitude compare masks are interleaved by SpreadTable[].
+// Clipped lanes are counted in a vector accumulator and summed at the end
+
+//*************** SSE4.2 kernels ****************
+// scaled and truncated values of 4 I/Q values (magnitude for IQ4) and IQ4 sign bit
+template <OutputFormat Format> TARGET_SSE42 static FORCE_INLINE __m128i ScaleSse42(const double *Value, const QuantParam<double> &Param, __m128i &Sign)
+{
+	__m128d Value0 = _mm_loadu_pd(Value), Value1 = _mm_loadu_pd(Value + 2);
+	__m128d Gain = _mm_set1_pd(Param.Gain), Low = _mm_set1_pd(Param.Low), High = _mm_set1_pd(Param.High);
+
+	if (Format == OutputFormatIQ4)
+	{
+		__m128d SignBit = _mm_set1_pd(8.), Zero = _mm_setzero_pd();
+		Sign = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_and_pd(_mm_cmplt_pd(Value0, Zero), SignBit)), _mm_cvttpd_epi32(_mm_and_pd(_mm_cmplt_pd(Value1, Zero), SignBit)));
+		Value0 = _mm_andnot_pd(_mm_set1_pd(-0.), Value0);
+		Value1 = _mm_andnot_pd(_mm_set1_pd(-0.), Value1);
+	}
+	Value0 = _mm_min_pd(_mm_max_pd(_mm_mul_pd(Value0, Gain), Low), High);
+	Value1 = _mm_min_pd(_mm_max_pd(_mm_mul_pd(Value1, Gain), Low), High);
+	return _mm_unpacklo_epi64(_mm_cvttpd_epi32(Value0), _mm_cvttpd_epi32(Value1));
+}
+
+template <OutputFormat Format> TARGET_SSE42 static FORCE_INLINE __m128i ScaleSse42(const float *Value, const QuantParam<float> &Param, __m128i &Sign)
+{
+	__m128 Data = _mm_loadu_ps(Value);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Sign = _mm_castps_si128(_mm_and_ps(_mm_cmplt_ps(Data, _mm_setzero_ps()), _mm_castsi128_ps(_mm_set1_epi32(8))));
+		Data = _mm_andnot_ps(_mm_set1_ps(-0.f), Data);
+	}
+	Data = _mm_min_ps(_mm_max_ps(_mm_mul_ps(Data, _mm_set1_ps(Param.Gain)), _mm_set1_ps(Param.Low)), _mm_set1_ps(Param.High));
+	return _mm_cvttps_epi32(Data);
+}
+
+template <OutputFormat Format> TARGET_SSE42 static FORCE_INLINE __m128i ScaleSse42(const int *Value, const QuantParam<int> &Param, __m128i &Sign)
+{
+	__m128i Data = _mm_loadu_si128((const __m128i *)Value), Gain = _mm_set1_epi32(Param.Gain);
+	__m128i Magnitude, ProductEven, ProductOdd, Product;
+
+	if (Format == OutputFormatIQ4)
+	{
+		Sign = _mm_and_si128(_mm_srai_epi32(Data, 31), _mm_set1_epi32(8));
+		return _mm_srai_epi32(_mm_mullo_epi32(_mm_abs_epi32(Data), Gain), INT_GAIN_SHIFT);
+	}
+	else if (Format == OutputFormatIQ16)	// 64bit product of magnitude, limited beyond saturation before sign applied
+	{
+		Magnitude = _mm_abs_epi32(Data);
+		ProductEven = _mm_srli_epi64(_mm_mul_epu32(Magnitude, Gain), INT_GAIN_SHIFT);
+		ProductOdd = _mm_slli_epi64(_mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(Magnitude, 32), Gain), INT_GAIN_SHIFT), 32);
+		Product = _mm_min_epu32(_mm_blend_epi16(ProductEven, ProductOdd, 0xcc), _mm_set1_epi32(Param.Max + 2));
+		return _mm_sign_epi32(Product, Data);
+	}
+	Product = _mm_mullo_epi32(Data, Gain);	// add 2^16-1 to negative product to truncate toward zero
+	return _mm_srai_epi32(_mm_add_epi32(Product, _mm_srli_epi32(_mm_srai_epi32(Product, 31), 32 - INT_GAIN_SHIFT)), INT_GAIN_SHIFT);
+}
+
+// output code of 4 scaled values, count clipped lanes
+template <OutputFormat Format> TARGET_SSE42 static FORCE_INLINE __m128i CodeSse42(__m128i Scaled, __m128i Sign, int Max, __m128i &Clipped)
+{
+	__m128i Limit = _mm_set1_epi32(Max);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Clipped = _mm_sub_epi32(Clipped, _mm_cmpgt_epi32(Scaled, Limit));
+		return _mm_and_si128(_mm_or_si128(_mm_min_epi32(Scaled, Limit), Sign), _mm_set1_epi32(0xf));
+	}
+	Clipped = _mm_sub_epi32(Clipped, _mm_or_si128(_mm_cmpgt_epi32(Scaled, Limit), _mm_cmplt_epi32(Scaled, _mm_set1_epi32(-Max - 1))));
+	return Scaled;	// saturated by pack
+}
+
+template <OutputFormat Format> TARGET_SSE42 static FORCE_INLINE void StoreSse42(const __m128i Code[4], unsigned char Output[])
+{
+	__m128i Packed;
+
+	if (Format == OutputFormatIQ16)
+	{
+		_mm_storeu_si128((__m128i *)Output, _mm_packs_epi32(Code[0], Code[1]));
+		_mm_storeu_si128((__m128i *)(Output + 16), _mm_packs_epi32(Code[2], Code[3]));
+	}
+	else if (Format == OutputFormatIQ4)	// nibble pair of each sample combined as 16*I+Q by multiply-add
+	{
+		Packed = _mm_packus_epi16(_mm_packus_epi32(Code[0], Code[1]), _mm_packus_epi32(Code[2], Code[3]));
+		Packed = _mm_maddubs_epi16(Packed, _mm_set1_epi16(0x0110));
+		_mm_storel_epi64((__m128i *)Output, _mm_packus_epi16(Packed, Packed));
+	}
+	else
+		_mm_storeu_si128((__m128i *)Output, _mm_packs_epi16(_mm_packs_epi32(Code[0], Code[1]), _mm_packs_epi32(Code[2], Code[3])));
+}
+
+// IQ2 byte of 4 I/Q values, magnitude and sign masks interleaved through SpreadTable[]
+TARGET_SSE42 static FORCE_INLINE int Iq2Sse42(const double *Value, const QuantParam<double> &Param, __m128i &Clipped)
+{
+	__m128d Value0 = _mm_loadu_pd(Value), Value1 = _mm_loadu_pd(Value + 2);
+	__m128d Magnitude0 = _mm_andnot_pd(_mm_set1_pd(-0.), Value0), Magnitude1 = _mm_andnot_pd(_mm_set1_pd(-0.), Value1);
+	__m128d Threshold = _mm_set1_pd(Param.Threshold), ClipThreshold = _mm_set1_pd(Param.ClipThreshold), Zero = _mm_setzero_pd();
+	int MagnitudeBits, SignBits;
+
+	Clipped = _mm_sub_epi32(Clipped, _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(_mm_cmpge_pd(Magnitude0, ClipThreshold)), _mm_castpd_ps(_mm_cmpge_pd(Magnitude1, ClipThreshold)), _MM_SHUFFLE(2, 0, 2, 0))));
+	MagnitudeBits = _mm_movemask_pd(_mm_cmpge_pd(Magnitude0, Threshold)) | (_mm_movemask_pd(_mm_cmpge_pd(Magnitude1, Threshold)) << 2);
+	SignBits = _mm_movemask_pd(_mm_cmplt_pd(Value0, Zero)) | (_mm_movemask_pd(_mm_cmplt_pd(Value1, Zero)) << 2);
+	return SpreadBits(MagnitudeBits, SignBits);
+}
+
+TARGET_SSE42 static FORCE_INLINE int Iq2Sse42(const float *Value, const QuantParam<float> &Param, __m128i &Clipped)
+{
+	__m128 Data = _mm_loadu_ps(Value), Magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), Data);
+
+	Clipped = _mm_sub_epi32(Clipped, _mm_castps_si128(_mm_cmpge_ps(Magnitude, _mm_set1_ps(Param.ClipThreshold))));
+	return SpreadBits(_mm_movemask_ps(_mm_cmpge_ps(Magnitude, _mm_set1_ps(Param.Threshold))), _mm_movemask_ps(_mm_cmplt_ps(Data, _mm_setzero_ps())));
+}
+
+TARGET_SSE42 static FORCE_INLINE int Iq2Sse42(const int *Value, const QuantParam<int> &Param, __m128i &Clipped)
+{
+	__m128i Data = _mm_loadu_si128((const __m128i *)Value), Magnitude = _mm_abs_epi32(Data);
+
+	// thresholds are positive, so >= is > of threshold minus 1
+	Clipped = _mm_sub_epi32(Clipped, _mm_cmpgt_epi32(Magnitude, _mm_set1_epi32(Param.ClipThreshold - 1)));
+	return SpreadBits(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(Magnitude, _mm_set1_epi32(Param.Threshold - 1)))), _mm_movemask_ps(_mm_castsi128_ps(Data)));
+}
+
+TARGET_SSE42 static FORCE_INLINE int HorizontalSumSse42(__m128i Value)
+{
+	Value = _mm_add_epi32(Value, _mm_shuffle_epi32(Value, _MM_SHUFFLE(1, 0, 3, 2)));
+	Value = _mm_add_epi32(Value, _mm_shuffle_epi32(Value, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(Value);
+}
+
+template <OutputFormat Format, typename ValueType> TARGET_SSE42 static int QuantSse42(const ValueType Value[], int Count, unsigned char Output[], const QuantParam<ValueType> &Param)
+{
+	__m128i Clipped = _mm_setzero_si128(), Sign = _mm_setzero_si128(), Code[4];
+	int i, j;
+
+	for (i = 0; i + 16 <= Count; i += 16)
+	{
+		if (Format == OutputFormatIQ2)
+		{
+			for (j = 0; j < 4; j ++)
+				Output[i / 4 + j] = (unsigned char)Iq2Sse42(Value + i + j * 4, Param, Clipped);
+			continue;
+		}
+		for (j = 0; j < 4; j ++)
+		{
+			Code[j] = ScaleSse42<Format>(Value + i + j * 4, Param, Sign);
+			Code[j] = CodeSse42<Format>(Code[j], Sign, Param.Max, Clipped);
+		}
+		StoreSse42<Format>(Code, Output + QuantOffset<Format>(i));
+	}
+
+	return HorizontalSumSse42(Clipped) + QuantScalar<Format>(Value + i, Count - i, Output + QuantOffset<Format>(i), Param);
+}
+
+//*************** AVX2 kernels ****************
+template <OutputFormat Format> TARGET_AVX2 static FORCE_INLINE __m256i ScaleAvx2(const double *Value, const QuantParam<double> &Param, __m256i &Sign)
+{
+	__m256d Value0 = _mm256_loadu_pd(Value), Value1 = _mm256_loadu_pd(Value + 4);
+	__m256d Gain = _mm256_set1_pd(Param.Gain), Low = _mm256_set1_pd(Param.Low), High = _mm256_set1_pd(Param.High);
+
+	if (Format == OutputFormatIQ4)
+	{
+		__m256d SignBit = _mm256_set1_pd(8.), Zero = _mm256_setzero_pd();
+		Sign = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(_mm256_and_pd(_mm256_cmp_pd(Value0, Zero, _CMP_LT_OQ), SignBit))),
+			_mm256_cvttpd_epi32(_mm256_and_pd(_mm256_cmp_pd(Value1, Zero, _CMP_LT_OQ), SignBit)), 1);
+		Value0 = _mm256_andnot_pd(_mm256_set1_pd(-0.), Value0);
+		Value1 = _mm256_andnot_pd(_mm256_set1_pd(-0.), Value1);
+	}
+	Value0 = _mm256_min_pd(_mm256_max_pd(_mm256_mul_pd(Value0, Gain), Low), High);
+	Value1 = _mm256_min_pd(_mm256_max_pd(_mm256_mul_pd(Value1, Gain), Low), High);
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(Value0)), _mm256_cvttpd_epi32(Value1), 1);
+}
+
+template <OutputFormat Format> TARGET_AVX2 static FORCE_INLINE __m256i ScaleAvx2(const float *Value, const QuantParam<float> &Param, __m256i &Sign)
+{
+	__m256 Data = _mm256_loadu_ps(Value);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Sign = _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(Data, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_castsi256_ps(_mm256_set1_epi32(8))));
+		Data = _mm256_andnot_ps(_mm256_set1_ps(-0.f), Data);
+	}
+	Data = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(Data, _mm256_set1_ps(Param.Gain)), _mm256_set1_ps(Param.Low)), _mm256_set1_ps(Param.High));
+	return _mm256_cvttps_epi32(Data);
+}
+
+template <OutputFormat Format> TARGET_AVX2 static FORCE_INLINE __m256i ScaleAvx2(const int *Value, const QuantParam<int> &Param, __m256i &Sign)
+{
+	__m256i Data = _mm256_loadu_si256((const __m256i *)Value), Gain = _mm256_set1_epi32(Param.Gain);
+	__m256i Magnitude, ProductEven, ProductOdd, Product;
+
+	if (Format == OutputFormatIQ4)
+	{
+		Sign = _mm256_and_si256(_mm256_srai_epi32(Data, 31), _mm256_set1_epi32(8));
+		return _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_abs_epi32(Data), Gain), INT_GAIN_SHIFT);
+	}
+	else if (Format == OutputFormatIQ16)
+	{
+		Magnitude = _mm256_abs_epi32(Data);
+		ProductEven = _mm256_srli_epi64(_mm256_mul_epu32(Magnitude, Gain), INT_GAIN_SHIFT);
+		ProductOdd = _mm256_slli_epi64(_mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(Magnitude, 32), Gain), INT_GAIN_SHIFT), 32);
+		Product = _mm256_min_epu32(_mm256_blend_epi32(ProductEven, ProductOdd, 0xaa), _mm256_set1_epi32(Param.Max + 2));
+		return _mm256_sign_epi32(Product, Data);
+	}
+	Product = _mm256_mullo_epi32(Data, Gain);
+	return _mm256_srai_epi32(_mm256_add_epi32(Product, _mm256_srli_epi32(_mm256_srai_epi32(Product, 31), 32 - INT_GAIN_SHIFT)), INT_GAIN_SHIFT);
+}
+
+template <OutputFormat Format> TARGET_AVX2 static FORCE_INLINE __m256i CodeAvx2(__m256i Scaled, __m256i Sign, int Max, __m256i &Clipped)
+{
+	__m256i Limit = _mm256_set1_epi32(Max);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Clipped = _mm256_sub_epi32(Clipped, _mm256_cmpgt_epi32(Scaled, Limit));
+		return _mm256_and_si256(_mm256_or_si256(_mm256_min_epi32(Scaled, Limit), Sign), _mm256_set1_epi32(0xf));
+	}
+	Clipped = _mm256_sub_epi32(Clipped, _mm256_or_si256(_mm256_cmpgt_epi32(Scaled, Limit), _mm256_cmpgt_epi32(_mm256_set1_epi32(-Max - 1), Scaled)));
+	return Scaled;
+}
+
+// packs work within 128bit lanes, permute restores value order
+template <OutputFormat Format> TARGET_AVX2 static FORCE_INLINE void StoreAvx2(const __m256i Code[2], unsigned char Output[])
+{
+	__m256i Packed;
+	__m128i Nibbles;
+
+	if (Format == OutputFormatIQ16)
+		_mm256_storeu_si256((__m256i *)Output, _mm256_permute4x64_epi64(_mm256_packs_epi32(Code[0], Code[1]), _MM_SHUFFLE(3, 1, 2, 0)));
+	else if (Format == OutputFormatIQ4)
+	{
+		Packed = _mm256_packus_epi32(Code[0], Code[1]);
+		Packed = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(Packed, Packed), _mm256_setr_epi32(0, 4, 1, 5, 0, 4, 1, 5));
+		Nibbles = _mm_maddubs_epi16(_mm256_castsi256_si128(Packed), _mm_set1_epi16(0x0110));
+		_mm_storel_epi64((__m128i *)Output, _mm_packus_epi16(Nibbles, Nibbles));
+	}
+	else
+	{
+		Packed = _mm256_packs_epi32(Code[0], Code[1]);
+		Packed = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(Packed, Packed), _mm256_setr_epi32(0, 4, 1, 5, 0, 4, 1, 5));
+		_mm_storeu_si128((__m128i *)Output, _mm256_castsi256_si128(Packed));
+	}
+}
+
+// IQ2 bytes of 8 I/Q values (2 bytes in low and high byte)
+TARGET_AVX2 static FORCE_INLINE int Iq2Avx2(const double *Value, const QuantParam<double> &Param, __m256i &Clipped)
+{
+	__m256d Value0 = _mm256_loadu_pd(Value), Value1 = _mm256_loadu_pd(Value + 4);
+	__m256d Magnitude0 = _mm256_andnot_pd(_mm256_set1_pd(-0.), Value0), Magnitude1 = _mm256_andnot_pd(_mm256_set1_pd(-0.), Value1);
+	__m256d Threshold = _mm256_set1_pd(Param.Threshold), ClipThreshold = _mm256_set1_pd(Param.ClipThreshold), Zero = _mm256_setzero_pd();
+	__m256d Clip0 = _mm256_cmp_pd(Magnitude0, ClipThreshold, _CMP_GE_OQ), Clip1 = _mm256_cmp_pd(Magnitude1, ClipThreshold, _CMP_GE_OQ);
+	int MagnitudeBits, SignBits;
+
+	// 64bit masks to 32bit lanes, lane order does not matter for counting
+	Clipped = _mm256_sub_epi32(Clipped, _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castpd_ps(Clip0), _mm256_castpd_ps(Clip1), _MM_SHUFFLE(2, 0, 2, 0))));
+	MagnitudeBits = _mm256_movemask_pd(_mm256_cmp_pd(Magnitude0, Threshold, _CMP_GE_OQ)) | (_mm256_movemask_pd(_mm256_cmp_pd(Magnitude1, Threshold, _CMP_GE_OQ)) << 4);
+	SignBits = _mm256_movemask_pd(_mm256_cmp_pd(Value0, Zero, _CMP_LT_OQ)) | (_mm256_movemask_pd(_mm256_cmp_pd(Value1, Zero, _CMP_LT_OQ)) << 4);
+	return SpreadBits(MagnitudeBits, SignBits);
+}
+
+TARGET_AVX2 static FORCE_INLINE int Iq2Avx2(const float *Value, const QuantParam<float> &Param, __m256i &Clipped)
+{
+	__m256 Data = _mm256_loadu_ps(Value), Magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.f), Data);
+
+	Clipped = _mm256_sub_epi32(Clipped, _mm256_castps_si256(_mm256_cmp_ps(Magnitude, _mm256_set1_ps(Param.ClipThreshold), _CMP_GE_OQ)));
+	return SpreadBits(_mm256_movemask_ps(_mm256_cmp_ps(Magnitude, _mm256_set1_ps(Param.Threshold), _CMP_GE_OQ)), _mm256_movemask_ps(_mm256_cmp_ps(Data, _mm256_setzero_ps(), _CMP_LT_OQ)));
+}
+
+TARGET_AVX2 static FORCE_INLINE int Iq2Avx2(const int *Value, const QuantParam<int> &Param, __m256i &Clipped)
+{
+	__m256i Data = _mm256_loadu_si256((const __m256i *)Value), Magnitude = _mm256_abs_epi32(Data);
+
+	Clipped = _mm256_sub_epi32(Clipped, _mm256_cmpgt_epi32(Magnitude, _mm256_set1_epi32(Param.ClipThreshold - 1)));
+	return SpreadBits(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(Magnitude, _mm256_set1_epi32(Param.Threshold - 1)))), _mm256_movemask_ps(_mm256_castsi256_ps(Data)));
+}
+
+template <OutputFormat Format, typename ValueType> TARGET_AVX2 static int QuantAvx2(const ValueType Value[], int Count, unsigned char Output[], const QuantParam<ValueType> &Param)
+{
+	__m256i Clipped = _mm256_setzero_si256(), Sign = _mm256_setzero_si256(), Code[2];
+	int i, j, Bits;
+
+	for (i = 0; i + 16 <= Count; i += 16)
+	{
+		if (Format == OutputFormatIQ2)
+		{
+			for (j = 0; j < 2; j ++)
+			{
+				Bits = Iq2Avx2(Value + i + j * 8, Param, Clipped);
+				Output[i / 4 + j * 2] = (unsigned char)(Bits & 0xff);
+				Output[i / 4 + j * 2 + 1] = (unsigned char)(Bits >> 8);
+			}
+			continue;
+		}
+		for (j = 0; j < 2; j ++)
+		{
+			Code[j] = ScaleAvx2<Format>(Value + i + j * 8, Param, Sign);
+			Code[j] = CodeAvx2<Format>(Code[j], Sign, Param.Max, Clipped);
+		}
+		StoreAvx2<Format>(Code, Output + QuantOffset<Format>(i));
+	}
+
+	return HorizontalSumSse42(_mm_add_epi32(_mm256_castsi256_si128(Clipped), _mm256_extracti128_si256(Clipped, 1))) +
+		QuantScalar<Format>(Value + i, Count - i, Output + QuantOffset<Format>(i), Param);
+}
+
+// GCC 12 reports '__Y' used uninitialized inside avx512fintrin.h for unmasked AVX-512
+// intrinsics, which pass an undefined merge source that never reaches the result, the false
+// warning is disabled for AVX-512 kernels only
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+//*************** AVX-512 kernels ****************
+// compares give bit masks directly, converts with saturation to int8/int16 store packed values
+template <OutputFormat Format> TARGET_AVX512 static FORCE_INLINE __m512i ScaleAvx512(const double *Value, const QuantParam<double> &Param, __m512i &Sign)
+{
+	__m512d Value0 = _mm512_loadu_pd(Value), Value1 = _mm512_loadu_pd(Value + 8);
+	__m512d Gain = _mm512_set1_pd(Param.Gain), Low = _mm512_set1_pd(Param.Low), High = _mm512_set1_pd(Param.High);
+
+	if (Format == OutputFormatIQ4)
+	{
+		__mmask16 Negative = (__mmask16)(_mm512_cmp_pd_mask(Value0, _mm512_setzero_pd(), _CMP_LT_OQ) | (_mm512_cmp_pd_mask(Value1, _mm512_setzero_pd(), _CMP_LT_OQ) << 8));
+		Sign = _mm512_maskz_mov_epi32(Negative, _mm512_set1_epi32(8));
+		Value0 = _mm512_abs_pd(Value0);
+		Value1 = _mm512_abs_pd(Value1);
+	}
+	Value0 = _mm512_min_pd(_mm512_max_pd(_mm512_mul_pd(Value0, Gain), Low), High);
+	Value1 = _mm512_min_pd(_mm512_max_pd(_mm512_mul_pd(Value1, Gain), Low), High);
+	return _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvttpd_epi32(Value0)), _mm512_cvttpd_epi32(Value1), 1);
+}
+
+template <OutputFormat Format> TARGET_AVX512 static FORCE_INLINE __m512i ScaleAvx512(const float *Value, const QuantParam<float> &Param, __m512i &Sign)
+{
+	__m512 Data = _mm512_loadu_ps(Value);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Sign = _mm512_maskz_mov_epi32(_mm512_cmp_ps_mask(Data, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_epi32(8));
+		Data = _mm512_abs_ps(Data);
+	}
+	Data = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(Data, _mm512_set1_ps(Param.Gain)), _mm512_set1_ps(Param.Low)), _mm512_set1_ps(Param.High));
+	return _mm512_cvttps_epi32(Data);
+}
+
+template <OutputFormat Format> TARGET_AVX512 static FORCE_INLINE __m512i ScaleAvx512(const int *Value, const QuantParam<int> &Param, __m512i &Sign)
+{
+	__m512i Data = _mm512_loadu_si512((const void *)Value), Gain = _mm512_set1_epi32(Param.Gain), Zero = _mm512_setzero_si512();
+	__m512i Magnitude, ProductEven, ProductOdd, Product;
+	__mmask16 Negative = _mm512_cmplt_epi32_mask(Data, Zero);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Sign = _mm512_maskz_mov_epi32(Negative, _mm512_set1_epi32(8));
+		return _mm512_srai_epi32(_mm512_mullo_epi32(_mm512_abs_epi32(Data), Gain), INT_GAIN_SHIFT);
+	}
+	else if (Format == OutputFormatIQ16)
+	{
+		Magnitude = _mm512_abs_epi32(Data);
+		ProductEven = _mm512_srli_epi64(_mm512_mul_epu32(Magnitude, Gain), INT_GAIN_SHIFT);
+		ProductOdd = _mm512_slli_epi64(_mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(Magnitude, 32), Gain), INT_GAIN_SHIFT), 32);
+		Product = _mm512_min_epu32(_mm512_mask_blend_epi32(0xaaaa, ProductEven, ProductOdd), _mm512_set1_epi32(Param.Max + 2));
+		return _mm512_mask_sub_epi32(Product, Negative, Zero, Product);
+	}
+	Product = _mm512_mullo_epi32(Data, Gain);
+	return _mm512_srai_epi32(_mm512_add_epi32(Product, _mm512_srli_epi32(_mm512_srai_epi32(Product, 31), 32 - INT_GAIN_SHIFT)), INT_GAIN_SHIFT);
+}
+
+template <OutputFormat Format> TARGET_AVX512 static FORCE_INLINE __m512i CodeAvx512(__m512i Scaled, __m512i Sign, int Max, __m512i &Clipped)
+{
+	__m512i Limit = _mm512_set1_epi32(Max), One = _mm512_set1_epi32(1);
+
+	if (Format == OutputFormatIQ4)
+	{
+		Clipped = _mm512_mask_add_epi32(Clipped, _mm512_cmpgt_epi32_mask(Scaled, Limit), Clipped, One);
+		return _mm512_and_si512(_mm512_or_si512(_mm512_min_epi32(Scaled, Limit), Sign), _mm512_set1_epi32(0xf));
+	}
+	Clipped = _mm512_mask_add_epi32(Clipped, _mm512_cmpgt_epi32_mask(Scaled, Limit) | _mm512_cmplt_epi32_mask(Scaled, _mm512_set1_epi32(-Max - 1)), Clipped, One);
+	return Scaled;
+}
+
+template <OutputFormat Format> TARGET_AVX512 static FORCE_INLINE void StoreAvx512(__m512i Code, unsigned char Output[])
+{
+	if (Format == OutputFormatIQ16)
+		_mm256_storeu_si256((__m256i *)Output, _mm512_cvtsepi32_epi16(Code));
+	else if (Format == OutputFormatIQ4)	// 16*I+Q in low byte of each 64bit lane
+		_mm_storel_epi64((__m128i *)Output, _mm512_cvtepi64_epi8(_mm512_or_si512(_mm512_slli_epi64(Code, 4), _mm512_srli_epi64(Code, 32))));
+	else
+		_mm_storeu_si128((__m128i *)Output, _mm512_cvtsepi32_epi8(Code));
+}
+
+// IQ2 bytes of 16 I/Q values, 8 values in each 16bit half
+TARGET_AVX512 static FORCE_INLINE unsigned int Iq2Avx512(const double *Value, const QuantParam<double> &Param, __m512i &Clipped)
+{
+	__m512d Value0 = _mm512_loadu_pd(Value), Value1 = _mm512_loadu_pd(Value + 8);
+	__m512d Magnitude0 = _mm512_abs_pd(Value0), Magnitude1 = _mm512_abs_pd(Value1);
+	__m512d Threshold = _mm512_set1_pd(Param.Threshold), ClipThreshold = _mm512_set1_pd(Param.ClipThreshold), Zero = _mm512_setzero_pd();
+	__mmask16 Clip = (__mmask16)(_mm512_cmp_pd_mask(Magnitude0, ClipThreshold, _CMP_GE_OQ) | (_mm512_cmp_pd_mask(Magnitude1, ClipThreshold, _CMP_GE_OQ) << 8));
+	unsigned int MagnitudeBits, SignBits;
+
+	Clipped = _mm512_mask_add_epi32(Clipped, Clip, Clipped, _mm512_set1_epi32(1));
+	MagnitudeBits = _mm512_cmp_pd_mask(Magnitude0, Threshold, _CMP_GE_OQ) | (_mm512_cmp_pd_mask(Magnitude1, Threshold, _CMP_GE_OQ) << 8);
+	SignBits = _mm512_cmp_pd_mask(Value0, Zero, _CMP_LT_OQ) | (_mm512_cmp_pd_mask(Value1, Zero, _CMP_LT_OQ) << 8);
+	return SpreadBits(MagnitudeBits & 0xff, SignBits & 0xff) | (SpreadBits(MagnitudeBits >> 8, SignBits >> 8) << 16);
+}
+
+TARGET_AVX512 static FORCE_INLINE unsigned int Iq2Avx512(const float *Value, const QuantParam<float> &Param, __m512i &Clipped)
+{
+	__m512 Data = _mm512_loadu_ps(Value), Magnitude = _mm512_abs_ps(Data);
+	unsigned int MagnitudeBits, SignBits;
+
+	Clipped = _mm512_mask_add_epi32(Clipped, _mm512_cmp_ps_mask(Magnitude, _mm512_set1_ps(Param.ClipThreshold), _CMP_GE_OQ), Clipped, _mm512_set1_epi32(1));
+	MagnitudeBits = _mm512_cmp_ps_mask(Magnitude, _mm512_set1_ps(Param.Threshold), _CMP_GE_OQ);
+	SignBits = _mm512_cmp_ps_mask(Data, _mm512_setzero_ps(), _CMP_LT_OQ);
+	return SpreadBits(MagnitudeBits & 0xff, SignBits & 0xff) | (SpreadBits(MagnitudeBits >> 8, SignBits >> 8) << 16);
+}
+
+TARGET_AVX512 static FORCE_INLINE unsigned int Iq2Avx512(const int *Value, const QuantParam<int> &Param, __m512i &Clipped)
+{
+	__m512i Data = _mm512_loadu_si512((const void *)Value), Magnitude = _mm512_abs_epi32(Data);
+	unsigned int MagnitudeBits, SignBits;
+
+	Clipped = _mm512_mask_add_epi32(Clipped, _mm512_cmpge_epi32_mask(Magnitude, _mm512_set1_epi32(Param.ClipThreshold)), Clipped, _mm512_set1_epi32(1));
+	MagnitudeBits = _mm512_cmpge_epi32_mask(Magnitude, _mm512_set1_epi32(Param.Threshold));
+	SignBits = _mm512_cmplt_epi32_mask(Data, _mm512_setzero_si512());
+	return SpreadBits(MagnitudeBits & 0xff, SignBits & 0xff) | (SpreadBits(MagnitudeBits >> 8, SignBits >> 8) << 16);
+}
+
+template <OutputFormat Format, typename ValueType> TARGET_AVX512 static int QuantAvx512(const ValueType Value[], int Count, unsigned char Output[], const QuantParam<ValueType> &Param)
+{
+	__m512i Clipped = _mm512_setzero_si512(), Sign = _mm512_setzero_si512(), Code;
+	unsigned int Bits;
+	int i;
+
+	for (i = 0; i + 16 <= Count; i += 16)
+	{
+		if (Format == OutputFormatIQ2)
+		{
+			Bits = Iq2Avx512(Value + i, Param, Clipped);
+			Output[i / 4] = (unsigned char)(Bits & 0xff);
+			Output[i / 4 + 1] = (unsigned char)((Bits >> 8) & 0xff);
+			Output[i / 4 + 2] = (unsigned char)((Bits >> 16) & 0xff);
+			Output[i / 4 + 3] = (unsigned char)(Bits >> 24);
+			continue;
+		}
+		Code = ScaleAvx512<Format>(Value + i, Param, Sign);
+		StoreAvx512<Format>(CodeAvx512<Format>(Code, Sign, Param.Max, Clipped), Output + QuantOffset<Format>(i));
+	}
+
+	return _mm512_reduce_add_epi32(Clipped) + QuantScalar<Format>(Value + i, Count - i, Output + QuantOffset<Format>(i), Param);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// see IfSampleKernel.cpp, clear upper half of YMM/ZMM registers after AVX kernels
+TARGET_AVX2 static void ZeroUpperAvx()
+{
+	_mm256_zeroupper();
+}
+#endif
+
+// quantize Count I/Q values with kernel of given instruction set
+template <OutputFormat Format, typename ValueType> static int QuantIsa(const ValueType Value[], int Count, unsigned char Output[], double GainScale, IfKernelIsa Isa)
+{
+	QuantParam<ValueType> Param;
+	int ClippedCount;
+
+	GetQuantParam(Format, GainScale, Param);
+	if (Isa == IfKernelAuto)
+		Isa = GetIfKernelIsa();
+	switch (Isa)
+	{
+#if defined(IF_KERNEL_X86)
+	case IfKernelSse42: return QuantSse42<Format>(Value, Count, Output, Param);
+	case IfKernelAvx2: ClippedCount = QuantAvx2<Format>(Value, Count, Output, Param); ZeroUpperAvx(); return ClippedCount;
+	case IfKernelAvx512: ClippedCount = QuantAvx512<Format>(Value, Count, Output, Param); ZeroUpperAvx(); return ClippedCount;
+#endif
+	default: return QuantScalar<Format>(Value, Count, Output, Param);
+	}
+}
+
+int QuantSamplesIQ2(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ2>((const double *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ4(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ4>((const double *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ8(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ8>((const double *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ16(const complex_number Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ16>((const double *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ2(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ2>((const float *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ4(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ4>((const float *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ8(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ8>((const float *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ16(const complex_float Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ16>((const float *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ2(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ2>((const int *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ4(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ4>((const int *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ8(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ8>((const int *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
+
+int QuantSamplesIQ16(const complex_int32 Samples[], int Length, unsigned char QuantSamples[], double GainScale, IfKernelIsa Isa)
+{
+	return QuantIsa<OutputFormatIQ16>((const int *)Samples, Length * 2, QuantSamples, GainScale, Isa);
+}
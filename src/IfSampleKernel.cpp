@@ -0,0 +1,1726 @@
+//----------------------------------------------------------------------
+// IfSampleKernel.cpp:
+//   Implementation of IF sample generation kernels with runtime
+//   instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+#include <string.h>
+
+#include "IfSampleKernel.h"
+#include "PrnGenerate.h"
+#include "FastMath.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IF_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE42
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#include <cpuid.h>
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+#endif
+
+static IfKernelIsa CurrentIsa = DetectIfKernelIsa();
+
+// PRN code bit of packed code, 1 bit per chip
+#define PRN_BIT(Code, Index) (((Code)[(Index) >> 5] >> ((Index) & 0x1f)) & 1)
+// data (bit 0) and pilot (bit 1) code of combined code, 2 bits per chip
+#define PRN_SYMBOL(Code, Index) (((Code)[(Index) >> 4] >> (((Index) & 0xf) << 1)) & 3)
+
+#define CHIP_RUN_BLOCK 256	// number of samples expanded by chip run engine each time
+#define CHIP_RUN_PAD 32	// extra buffer space to fill chip run with constant length
+
+static IfChipRunMode CurrentChipRun = IfChipRunAuto;
+static BOOL CurrentPrnSpecialized = TRUE;
+#define CHIP_RUN_NEVER 1e30	// auto mode does not use chip run engine with this kernel
+// minimum samples per chip to use chip run engine in auto mode for each kernel, vector
+// kernels generate per sample PRN faster than chip run fill and carrier pass at any rate
+static const double ChipRunThreshold[IfKernelAuto] = { 10.0, 12.0, CHIP_RUN_NEVER, CHIP_RUN_NEVER };	// measured crossover of each kernel
+
+// int16 pipeline: PRN modulation in Q(IF_INT_AMP_FRAC) multiplied by Q14 carrier NCO
+#define INT_AMP_SCALE (IF_INT_SIGMA << IF_INT_AMP_FRAC)
+#define INT_AMP_LIMIT 16383	// limit each channel so that data + pilot modulation fits in int16
+#define INT_SAMPLE_SHIFT (FastMath::CARRIER_LUT_INT_BITS + IF_INT_AMP_FRAC)
+#define INT_SAMPLE_ROUND (1 << (INT_SAMPLE_SHIFT - 1))
+
+// segment parameters used to get PRN value, copied to local variable so that
+// compiler can keep them in registers
+typedef struct
+{
+	const unsigned int *DataPrn, *PilotPrn, *CombinedPrn;
+	int DataBase, PilotBase;
+	int HalfChip, IsBoc, IsTmd, HasPilot;
+	double DataReal, DataImag, PilotReal, PilotImag;
+	int DataRealInt, DataImagInt, PilotRealInt, PilotImagInt;	// modulation in fixed point for int16 pipeline
+} PRN_CONTEXT;
+
+// convert modulation amplitude (with noise sigma as 1) to fixed point of int16 pipeline
+static FORCE_INLINE int FixedAmplitude(double Value)
+{
+	Value *= INT_AMP_SCALE;
+	if (Value >= INT_AMP_LIMIT)
+		return INT_AMP_LIMIT;
+	else if (Value <= -INT_AMP_LIMIT)
+		return -INT_AMP_LIMIT;
+	return (int)std::floor(Value + 0.5);
+}
+
+static FORCE_INLINE void GetPrnContext(const IF_SEGMENT_PARAM *Param, PRN_CONTEXT &Context)
+{
+	Context.DataPrn = Param->DataPrn;
+	Context.PilotPrn = Param->PilotPrn ? Param->PilotPrn : Param->DataPrn;	// dummy pointer masked out if no pilot
+	Context.CombinedPrn = Param->CombinedPrn;
+	Context.DataBase = Param->DataBase;
+	Context.PilotBase = Param->PilotBase;
+	Context.HalfChip = (Param->Attribute & (PRN_ATTRIBUTE_BOC | PRN_ATTRIBUTE_TMD)) ? 1 : 0;
+	Context.IsBoc = (Param->Attribute & PRN_ATTRIBUTE_BOC) ? 1 : 0;
+	Context.IsTmd = ((Param->Attribute & PRN_ATTRIBUTE_TMD) && Param->PilotPrn) ? 1 : 0;
+	Context.HasPilot = Param->PilotPrn ? 1 : 0;
+	Context.DataReal = Param->DataSignal.real;
+	Context.DataImag = Param->DataSignal.imag;
+	Context.PilotReal = Param->PilotSignal.real;
+	Context.PilotImag = Param->PilotSignal.imag;
+	Context.DataRealInt = FixedAmplitude(Param->DataSignal.real);
+	Context.DataImagInt = FixedAmplitude(Param->DataSignal.imag);
+	Context.PilotRealInt = FixedAmplitude(Param->PilotSignal.real);
+	Context.PilotImagInt = FixedAmplitude(Param->PilotSignal.imag);
+}
+
+// Attributes of PRN variant (IF_PRN_XXX) as compile time constants so that the checks
+// fold away in specialized kernels, generic variant reads them from context at runtime
+template <unsigned int Variant> struct PrnVariant
+{
+	static const int Generic = (Variant == IF_PRN_GENERIC);
+	static const int Pilot = Generic || (Variant & IF_PRN_PILOT);	// pilot code is read and modulated
+	static FORCE_INLINE int HalfChip(const PRN_CONTEXT &Context) { return Generic ? Context.HalfChip : ((Variant & (IF_PRN_BOC | IF_PRN_TMD)) ? 1 : 0); }
+	static FORCE_INLINE int IsBoc(const PRN_CONTEXT &Context) { return Generic ? Context.IsBoc : ((Variant & IF_PRN_BOC) ? 1 : 0); }
+	static FORCE_INLINE int IsTmd(const PRN_CONTEXT &Context) { return Generic ? Context.IsTmd : (((Variant & IF_PRN_TMD) && (Variant & IF_PRN_PILOT)) ? 1 : 0); }
+	static FORCE_INLINE int HasPilot(const PRN_CONTEXT &Context) { return Generic ? Context.HasPilot : ((Variant & IF_PRN_PILOT) ? 1 : 0); }
+	static FORCE_INLINE BOOL Combined(const PRN_CONTEXT &Context) { return Generic ? (Context.CombinedPrn != NULL) : ((Variant & IF_PRN_COMBINED) ? TRUE : FALSE); }
+};
+
+// PRN sign (+1/-1, or 0 for TMD slot of the other channel) of data and pilot channel of given chip count within the segment
+template <unsigned int Variant> static FORCE_INLINE void GetPrnSign(const PRN_CONTEXT &Context, int ChipCount, int &DataSign, int &PilotSign)
+{
+	typedef PrnVariant<Variant> Traits;
+	int Chip = ChipCount - Context.DataBase;
+	int CodeIndex = Chip >> Traits::HalfChip(Context);
+	unsigned int Symbol, DataBit, PilotBit = 0;
+
+	if (Traits::Combined(Context))
+	{
+		Symbol = PRN_SYMBOL(Context.CombinedPrn, CodeIndex);
+		DataBit = Symbol & 1;
+		PilotBit = Symbol >> 1;
+	}
+	else
+	{
+		DataBit = PRN_BIT(Context.DataPrn, CodeIndex);
+		if (Traits::Pilot)
+		{
+			CodeIndex = (Context.PilotBase + Chip) >> Traits::HalfChip(Context);
+			PilotBit = PRN_BIT(Context.PilotPrn, CodeIndex);
+		}
+	}
+	DataSign = 1 - 2 * (int)DataBit;
+	PilotSign = (1 - 2 * (int)PilotBit) * Traits::HasPilot(Context);
+	if (Traits::IsTmd(Context))	// even chip for L2CM, odd chip for L2CL
+	{
+		if (ChipCount & 1)
+			DataSign = 0;
+		else
+			PilotSign = 0;
+	}
+	if (Traits::IsBoc(Context) && (ChipCount & 1))	// second half of BOC code
+	{
+		DataSign = -DataSign;
+		PilotSign = -PilotSign;
+	}
+}
+
+// PRN modulation (with data/pilot signal) of given chip count within the segment
+template <unsigned int Variant> static FORCE_INLINE void GetPrnValue(const PRN_CONTEXT &Context, int ChipCount, double &PrnReal, double &PrnImag)
+{
+	int DataSign, PilotSign;
+
+	GetPrnSign<Variant>(Context, ChipCount, DataSign, PilotSign);
+	if (PrnVariant<Variant>::Pilot)
+	{
+		PrnReal = DataSign * Context.DataReal + PilotSign * Context.PilotReal;
+		PrnImag = DataSign * Context.DataImag + PilotSign * Context.PilotImag;
+	}
+	else	// compiler does not remove floating point multiplication of zero
+	{
+		PrnReal = DataSign * Context.DataReal;
+		PrnImag = DataSign * Context.DataImag;
+	}
+}
+
+// float32 pipeline rounds data/pilot amplitude to float and adds in float as vector kernels do,
+// so that tail of a vectorized segment finished by scalar kernel gives the same rounding
+template <unsigned int Variant> static FORCE_INLINE void GetPrnValue(const PRN_CONTEXT &Context, int ChipCount, float &PrnReal, float &PrnImag)
+{
+	int DataSign, PilotSign;
+
+	GetPrnSign<Variant>(Context, ChipCount, DataSign, PilotSign);
+	if (PrnVariant<Variant>::Pilot)
+	{
+		PrnReal = (float)DataSign * (float)Context.DataReal + (float)PilotSign * (float)Context.PilotReal;
+		PrnImag = (float)DataSign * (float)Context.DataImag + (float)PilotSign * (float)Context.PilotImag;
+	}
+	else
+	{
+		PrnReal = (float)DataSign * (float)Context.DataReal;
+		PrnImag = (float)DataSign * (float)Context.DataImag;
+	}
+}
+
+// int16 pipeline uses fixed point modulation, chips are +1/-1/0 so no multiplication needed
+template <unsigned int Variant> static FORCE_INLINE void GetPrnValue(const PRN_CONTEXT &Context, int ChipCount, short &PrnReal, short &PrnImag)
+{
+	int DataSign, PilotSign;
+
+	GetPrnSign<Variant>(Context, ChipCount, DataSign, PilotSign);
+	PrnReal = (short)(DataSign * Context.DataRealInt + PilotSign * Context.PilotRealInt);
+	PrnImag = (short)(DataSign * Context.DataImagInt + PilotSign * Context.PilotImagInt);
+}
+
+// multiply PRN modulation with carrier of given phase, carrier NCO has the same precision as output sample
+template <typename T> static FORCE_INLINE void RotateSample(T &Sample, typename IfSampleTraits<T>::ValueType PrnReal, typename IfSampleTraits<T>::ValueType PrnImag, const FastMath::CarrierNco &Nco, unsigned int CarrierPhase)
+{
+	typedef typename IfSampleTraits<T>::ValueType ValueType;
+	ValueType CosValue, SinValue;
+
+	Nco.Lookup(CarrierPhase, CosValue, SinValue);
+
+	Sample.real = PrnReal * CosValue - PrnImag * SinValue;
+	Sample.imag = PrnReal * SinValue + PrnImag * CosValue;
+}
+
+// int16 version, product accumulated in int32 then rounded back to sample unit
+static FORCE_INLINE void RotateSample(complex_int16 &Sample, short PrnReal, short PrnImag, const FastMath::CarrierNco &Nco, unsigned int CarrierPhase)
+{
+	int CosValue, SinValue;
+
+	Nco.Lookup(CarrierPhase, CosValue, SinValue);
+
+	Sample.real = (short)((PrnReal * CosValue - PrnImag * SinValue + INT_SAMPLE_ROUND) >> INT_SAMPLE_SHIFT);
+	Sample.imag = (short)((PrnReal * SinValue + PrnImag * CosValue + INT_SAMPLE_ROUND) >> INT_SAMPLE_SHIFT);
+}
+
+//*************** Scalar reference kernel ****************
+// Generate samples from index Start to End-1 of a segment.
+// Code and carrier phase are calculated from segment start for each sample
+// so this can also be used to finish the tail of vectorized kernels
+template <unsigned int Variant, typename T> static void IfSegmentScalar(const IF_SEGMENT_PARAM *Param, T *Output, int Start, int End)
+{
+	typedef typename IfSampleTraits<T>::ValueType ValueType;
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i;
+	unsigned long long ChipPhase;
+	unsigned int CarrierPhase;
+	ValueType PrnReal, PrnImag;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	for (i = Start; i < End; i ++)
+	{
+		ChipPhase = Param->ChipPhase + (unsigned long long)i * Param->ChipStep;
+		CarrierPhase = Param->CarrierPhase + (unsigned int)i * (unsigned int)Param->CarrierStep;
+		GetPrnValue<Variant>(Context, (int)(ChipPhase >> 32), PrnReal, PrnImag);
+		RotateSample(Output[i], PrnReal, PrnImag, Nco, CarrierPhase);
+	}
+}
+
+//*************** Chip run engine ****************
+// Fill PRN modulation of samples Start to End-1 of a segment into PrnReal/PrnImag.
+// The sample where each chip boundary falls is found from code NCO, so PRN value
+// is calculated once for each run of samples within the same chip
+template <unsigned int Variant, typename ValueType> static void ChipRunFill(const IF_SEGMENT_PARAM *Param, int Start, int End, ValueType *PrnReal, ValueType *PrnImag)
+{
+	unsigned long long Step = Param->ChipStep;
+	unsigned long long ChipPhase = Param->ChipPhase + (unsigned long long)Start * Step;
+	unsigned long long Boundary;
+	int FullRun = (int)(0x100000000ULL / Step);	// a full chip has FullRun or FullRun+1 samples
+	int FillLength = FullRun + 1;
+	int i, k, Run, ChipCount, Count = End - Start;
+	ValueType Real, Imag;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	for (i = 0; i < Count; i += Run)
+	{
+		ChipCount = (int)(ChipPhase >> 32);
+		Boundary = (unsigned long long)(ChipCount + 1) << 32;
+		// number of samples before code phase reaches next chip
+		if (i == 0)	// first chip may be partial
+			Run = (int)((Boundary - ChipPhase - 1) / Step) + 1;
+		else
+			Run = (ChipPhase + Step * FullRun < Boundary) ? FullRun + 1 : FullRun;
+		if (Run > Count - i)
+			Run = Count - i;
+		GetPrnValue<Variant>(Context, ChipCount, Real, Imag);
+		// fill a constant length (buffer has CHIP_RUN_PAD extra space) to make loop count predictable
+		if (FillLength <= CHIP_RUN_PAD && Run <= FillLength)
+		{
+			for (k = 0; k < FillLength; k ++)
+			{
+				PrnReal[i + k] = Real;
+				PrnImag[i + k] = Imag;
+			}
+		}
+		else
+		{
+			for (k = 0; k < Run; k ++)
+			{
+				PrnReal[i + k] = Real;
+				PrnImag[i + k] = Imag;
+			}
+		}
+		ChipPhase += Step * Run;
+	}
+}
+
+// multiply PRN modulation with carrier for Count samples
+template <typename T> static void RotateScalar(const typename IfSampleTraits<T>::ValueType *PrnReal, const typename IfSampleTraits<T>::ValueType *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, T *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i;
+
+	for (i = 0; i < Count; i ++)
+	{
+		RotateSample(Output[i], PrnReal[i], PrnImag[i], Nco, CarrierPhase);
+		CarrierPhase += CarrierStep;
+	}
+}
+
+// carrier NCO output of Count samples, int16 version outputs Q14 values
+template <typename T> static void NcoScalar(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, T *Output)
+{
+	typedef typename IfSampleTraits<T>::ValueType ValueType;
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	ValueType CosValue, SinValue;
+	int i;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Nco.Lookup(CarrierPhase, CosValue, SinValue);
+		Output[i].real = CosValue;
+		Output[i].imag = SinValue;
+		CarrierPhase += CarrierStep;
+	}
+}
+
+static void NcoScalar(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, CosValue, SinValue;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Nco.Lookup(CarrierPhase, CosValue, SinValue);
+		Output[i].real = (short)CosValue;
+		Output[i].imag = (short)SinValue;
+		CarrierPhase += CarrierStep;
+	}
+}
+
+#if defined(IF_KERNEL_X86)
+//*************** SSE4.2 kernels ****************
+// PRN sign (+1/-1, or 0 for TMD slot of the other channel) of data and pilot
+// channel for 4 samples, PRN read by scalar loads (no gather instruction).
+// Generic variant applies TMD/BOC by masks from context, specialized variants
+// only keep the steps they need
+template <unsigned int Variant> TARGET_SSE42 static FORCE_INLINE void PrnSignSse42(const PRN_CONTEXT &Context, __m128i ChipCount, __m128i &DataSign, __m128i &PilotSign)
+{
+	typedef PrnVariant<Variant> Traits;
+	__m128i One = _mm_set1_epi32(1);
+	__m128i TmdMask = _mm_set1_epi32(-Traits::IsTmd(Context)), BocMask = _mm_set1_epi32(-Traits::IsBoc(Context));
+	__m128i HalfChip = _mm_cvtsi32_si128(Traits::HalfChip(Context));
+	__m128i Chip = _mm_sub_epi32(ChipCount, _mm_set1_epi32(Context.DataBase));
+	__m128i Symbol, DataBit, PilotBit = _mm_setzero_si128(), OddMask, SignMask;
+	int DataIndex[4], PilotIndex[4];
+
+	_mm_storeu_si128((__m128i *)DataIndex, _mm_srl_epi32(Chip, HalfChip));
+	if (Traits::Combined(Context))
+	{
+		Symbol = _mm_setr_epi32(PRN_SYMBOL(Context.CombinedPrn, DataIndex[0]), PRN_SYMBOL(Context.CombinedPrn, DataIndex[1]), PRN_SYMBOL(Context.CombinedPrn, DataIndex[2]), PRN_SYMBOL(Context.CombinedPrn, DataIndex[3]));
+		DataBit = _mm_and_si128(Symbol, One);
+		PilotBit = _mm_srli_epi32(Symbol, 1);
+	}
+	else
+	{
+		DataBit = _mm_setr_epi32(PRN_BIT(Context.DataPrn, DataIndex[0]), PRN_BIT(Context.DataPrn, DataIndex[1]), PRN_BIT(Context.DataPrn, DataIndex[2]), PRN_BIT(Context.DataPrn, DataIndex[3]));
+		if (Traits::Pilot)
+		{
+			_mm_storeu_si128((__m128i *)PilotIndex, _mm_srl_epi32(_mm_add_epi32(Chip, _mm_set1_epi32(Context.PilotBase)), HalfChip));
+			PilotBit = _mm_setr_epi32(PRN_BIT(Context.PilotPrn, PilotIndex[0]), PRN_BIT(Context.PilotPrn, PilotIndex[1]), PRN_BIT(Context.PilotPrn, PilotIndex[2]), PRN_BIT(Context.PilotPrn, PilotIndex[3]));
+		}
+	}
+	// PRN bit 0 maps to +1, 1 maps to -1
+	DataSign = _mm_sub_epi32(One, _mm_slli_epi32(DataBit, 1));
+	PilotSign = Traits::Pilot ? _mm_and_si128(_mm_sub_epi32(One, _mm_slli_epi32(PilotBit, 1)), _mm_set1_epi32(-Traits::HasPilot(Context))) : _mm_setzero_si128();
+	OddMask = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(ChipCount, One));
+	if (Traits::Generic || Traits::IsTmd(Context))
+	{
+		DataSign = _mm_andnot_si128(_mm_and_si128(TmdMask, OddMask), DataSign);
+		PilotSign = _mm_andnot_si128(_mm_andnot_si128(OddMask, TmdMask), PilotSign);
+	}
+	if (Traits::Generic || Traits::IsBoc(Context))
+	{
+		SignMask = _mm_and_si128(BocMask, OddMask);
+		DataSign = _mm_sub_epi32(_mm_xor_si128(DataSign, SignMask), SignMask);
+		PilotSign = _mm_sub_epi32(_mm_xor_si128(PilotSign, SignMask), SignMask);
+	}
+}
+
+// data plus pilot modulation of 2 or 4 samples, pilot part skipped for variants without pilot
+template <unsigned int Variant> TARGET_SSE42 static FORCE_INLINE __m128d PrnModulation(__m128d DataSign, __m128d DataAmp, __m128d PilotSign, __m128d PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm_add_pd(_mm_mul_pd(DataSign, DataAmp), _mm_mul_pd(PilotSign, PilotAmp)) : _mm_mul_pd(DataSign, DataAmp);
+}
+
+template <unsigned int Variant> TARGET_SSE42 static FORCE_INLINE __m128 PrnModulation(__m128 DataSign, __m128 DataAmp, __m128 PilotSign, __m128 PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm_add_ps(_mm_mul_ps(DataSign, DataAmp), _mm_mul_ps(PilotSign, PilotAmp)) : _mm_mul_ps(DataSign, DataAmp);
+}
+
+// PRN sign applied to fixed point amplitude by sign instruction
+template <unsigned int Variant> TARGET_SSE42 static FORCE_INLINE __m128i PrnModulation(__m128i DataSign, __m128i DataAmp, __m128i PilotSign, __m128i PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm_add_epi32(_mm_sign_epi32(DataAmp, DataSign), _mm_sign_epi32(PilotAmp, PilotSign)) : _mm_sign_epi32(DataAmp, DataSign);
+}
+
+// carrier of 4 samples by scalar lookup (no gather instruction), int for Q14 values of int16 pipeline
+template <typename ValueType> TARGET_SSE42 static FORCE_INLINE void CarrierSse42(const FastMath::CarrierNco &Nco, __m128i CarrierPhase, ValueType CosValue[4], ValueType SinValue[4])
+{
+	unsigned int Phase[4];
+	int i;
+
+	_mm_storeu_si128((__m128i *)Phase, CarrierPhase);
+	for (i = 0; i < 4; i ++)
+		Nco.Lookup(Phase[i], CosValue[i], SinValue[i]);
+}
+
+// 4 samples each loop, carrier table read by scalar loads
+template <unsigned int Variant> TARGET_SSE42 static void IfSegmentSse42(const IF_SEGMENT_PARAM *Param, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	unsigned int CarrierStep = (unsigned int)Param->CarrierStep;
+	int Count = Param->SampleCount & ~3;
+	int i;
+	double CosArray[4], SinArray[4];
+	double *Dest = (double *)Output;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m128i ChipPhase0 = _mm_set_epi64x((long long)(Phase + Step), (long long)Phase);
+	__m128i ChipPhase1 = _mm_set_epi64x((long long)(Phase + Step * 3), (long long)(Phase + Step * 2));
+	__m128i ChipStep4 = _mm_set1_epi64x((long long)(Step * 4));
+	__m128i CarrierPhase = _mm_setr_epi32((int)Param->CarrierPhase, (int)(Param->CarrierPhase + CarrierStep), (int)(Param->CarrierPhase + CarrierStep * 2), (int)(Param->CarrierPhase + CarrierStep * 3));
+	__m128i CarrierStep4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m128d DataReal = _mm_set1_pd(Context.DataReal), DataImag = _mm_set1_pd(Context.DataImag);
+	__m128d PilotReal = _mm_set1_pd(Context.PilotReal), PilotImag = _mm_set1_pd(Context.PilotImag);
+	__m128i ChipCount, DataSign, PilotSign;
+	__m128d DataSign0, DataSign1, PilotSign0, PilotSign1, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 4)
+	{
+		// integer part of 4 code phases
+		ChipCount = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(ChipPhase0), _mm_castsi128_ps(ChipPhase1), _MM_SHUFFLE(3, 1, 3, 1)));
+		PrnSignSse42<Variant>(Context, ChipCount, DataSign, PilotSign);
+		CarrierSse42(Nco, CarrierPhase, CosArray, SinArray);
+		DataSign0 = _mm_cvtepi32_pd(DataSign);
+		DataSign1 = _mm_cvtepi32_pd(_mm_unpackhi_epi64(DataSign, DataSign));
+		PilotSign0 = _mm_cvtepi32_pd(PilotSign);
+		PilotSign1 = _mm_cvtepi32_pd(_mm_unpackhi_epi64(PilotSign, PilotSign));
+
+		// first two samples
+		PrnReal = PrnModulation<Variant>(DataSign0, DataReal, PilotSign0, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSign0, DataImag, PilotSign0, PilotImag);
+		CosValue = _mm_loadu_pd(CosArray);
+		SinValue = _mm_loadu_pd(SinArray);
+		Real = _mm_sub_pd(_mm_mul_pd(PrnReal, CosValue), _mm_mul_pd(PrnImag, SinValue));
+		Imag = _mm_add_pd(_mm_mul_pd(PrnReal, SinValue), _mm_mul_pd(PrnImag, CosValue));
+		_mm_storeu_pd(Dest + i * 2, _mm_unpacklo_pd(Real, Imag));
+		_mm_storeu_pd(Dest + i * 2 + 2, _mm_unpackhi_pd(Real, Imag));
+		// last two samples
+		PrnReal = PrnModulation<Variant>(DataSign1, DataReal, PilotSign1, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSign1, DataImag, PilotSign1, PilotImag);
+		CosValue = _mm_loadu_pd(CosArray + 2);
+		SinValue = _mm_loadu_pd(SinArray + 2);
+		Real = _mm_sub_pd(_mm_mul_pd(PrnReal, CosValue), _mm_mul_pd(PrnImag, SinValue));
+		Imag = _mm_add_pd(_mm_mul_pd(PrnReal, SinValue), _mm_mul_pd(PrnImag, CosValue));
+		_mm_storeu_pd(Dest + i * 2 + 4, _mm_unpacklo_pd(Real, Imag));
+		_mm_storeu_pd(Dest + i * 2 + 6, _mm_unpackhi_pd(Real, Imag));
+
+		ChipPhase0 = _mm_add_epi64(ChipPhase0, ChipStep4);
+		ChipPhase1 = _mm_add_epi64(ChipPhase1, ChipStep4);
+		CarrierPhase = _mm_add_epi32(CarrierPhase, CarrierStep4);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// float32 version, 4 samples each loop
+template <unsigned int Variant> TARGET_SSE42 static void IfSegmentSse42(const IF_SEGMENT_PARAM *Param, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	unsigned int CarrierStep = (unsigned int)Param->CarrierStep;
+	int Count = Param->SampleCount & ~3;
+	int i;
+	float CosArray[4], SinArray[4];
+	float *Dest = (float *)Output;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m128i ChipPhase0 = _mm_set_epi64x((long long)(Phase + Step), (long long)Phase);
+	__m128i ChipPhase1 = _mm_set_epi64x((long long)(Phase + Step * 3), (long long)(Phase + Step * 2));
+	__m128i ChipStep4 = _mm_set1_epi64x((long long)(Step * 4));
+	__m128i CarrierPhase = _mm_setr_epi32((int)Param->CarrierPhase, (int)(Param->CarrierPhase + CarrierStep), (int)(Param->CarrierPhase + CarrierStep * 2), (int)(Param->CarrierPhase + CarrierStep * 3));
+	__m128i CarrierStep4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m128 DataReal = _mm_set1_ps((float)Context.DataReal), DataImag = _mm_set1_ps((float)Context.DataImag);
+	__m128 PilotReal = _mm_set1_ps((float)Context.PilotReal), PilotImag = _mm_set1_ps((float)Context.PilotImag);
+	__m128i ChipCount, DataSign, PilotSign;
+	__m128 DataSignF, PilotSignF, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 4)
+	{
+		ChipCount = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(ChipPhase0), _mm_castsi128_ps(ChipPhase1), _MM_SHUFFLE(3, 1, 3, 1)));
+		PrnSignSse42<Variant>(Context, ChipCount, DataSign, PilotSign);
+		CarrierSse42(Nco, CarrierPhase, CosArray, SinArray);
+		DataSignF = _mm_cvtepi32_ps(DataSign);
+		PilotSignF = _mm_cvtepi32_ps(PilotSign);
+
+		PrnReal = PrnModulation<Variant>(DataSignF, DataReal, PilotSignF, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSignF, DataImag, PilotSignF, PilotImag);
+		CosValue = _mm_loadu_ps(CosArray);
+		SinValue = _mm_loadu_ps(SinArray);
+		Real = _mm_sub_ps(_mm_mul_ps(PrnReal, CosValue), _mm_mul_ps(PrnImag, SinValue));
+		Imag = _mm_add_ps(_mm_mul_ps(PrnReal, SinValue), _mm_mul_ps(PrnImag, CosValue));
+		_mm_storeu_ps(Dest + i * 2, _mm_unpacklo_ps(Real, Imag));
+		_mm_storeu_ps(Dest + i * 2 + 4, _mm_unpackhi_ps(Real, Imag));
+
+		ChipPhase0 = _mm_add_epi64(ChipPhase0, ChipStep4);
+		ChipPhase1 = _mm_add_epi64(ChipPhase1, ChipStep4);
+		CarrierPhase = _mm_add_epi32(CarrierPhase, CarrierStep4);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// int16 version, 4 samples each loop
+template <unsigned int Variant> TARGET_SSE42 static void IfSegmentSse42(const IF_SEGMENT_PARAM *Param, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	unsigned int CarrierStep = (unsigned int)Param->CarrierStep;
+	int Count = Param->SampleCount & ~3;
+	int i, CosArray[4], SinArray[4];
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m128i ChipPhase0 = _mm_set_epi64x((long long)(Phase + Step), (long long)Phase);
+	__m128i ChipPhase1 = _mm_set_epi64x((long long)(Phase + Step * 3), (long long)(Phase + Step * 2));
+	__m128i ChipStep4 = _mm_set1_epi64x((long long)(Step * 4));
+	__m128i CarrierPhase = _mm_setr_epi32((int)Param->CarrierPhase, (int)(Param->CarrierPhase + CarrierStep), (int)(Param->CarrierPhase + CarrierStep * 2), (int)(Param->CarrierPhase + CarrierStep * 3));
+	__m128i CarrierStep4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m128i DataReal = _mm_set1_epi32(Context.DataRealInt), DataImag = _mm_set1_epi32(Context.DataImagInt);
+	__m128i PilotReal = _mm_set1_epi32(Context.PilotRealInt), PilotImag = _mm_set1_epi32(Context.PilotImagInt);
+	__m128i Round = _mm_set1_epi32(INT_SAMPLE_ROUND), LowMask = _mm_set1_epi32(0xffff);
+	__m128i ChipCount, DataSign, PilotSign, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 4)
+	{
+		ChipCount = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(ChipPhase0), _mm_castsi128_ps(ChipPhase1), _MM_SHUFFLE(3, 1, 3, 1)));
+		PrnSignSse42<Variant>(Context, ChipCount, DataSign, PilotSign);
+		CarrierSse42(Nco, CarrierPhase, CosArray, SinArray);
+		PrnReal = PrnModulation<Variant>(DataSign, DataReal, PilotSign, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSign, DataImag, PilotSign, PilotImag);
+		CosValue = _mm_loadu_si128((const __m128i *)CosArray);
+		SinValue = _mm_loadu_si128((const __m128i *)SinArray);
+		Real = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_mullo_epi32(PrnReal, CosValue), _mm_mullo_epi32(PrnImag, SinValue)), Round), INT_SAMPLE_SHIFT);
+		Imag = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(PrnReal, SinValue), _mm_mullo_epi32(PrnImag, CosValue)), Round), INT_SAMPLE_SHIFT);
+		// each real/imag pair packed into one 32bit word
+		_mm_storeu_si128((__m128i *)(Output + i), _mm_or_si128(_mm_and_si128(Real, LowMask), _mm_slli_epi32(Imag, 16)));
+
+		ChipPhase0 = _mm_add_epi64(ChipPhase0, ChipStep4);
+		ChipPhase1 = _mm_add_epi64(ChipPhase1, ChipStep4);
+		CarrierPhase = _mm_add_epi32(CarrierPhase, CarrierStep4);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+//*************** AVX2 kernels ****************
+// PRN sign of data and pilot channel for 4 samples, packed PRN words read by gather instructions
+template <unsigned int Variant> TARGET_AVX2 static FORCE_INLINE void PrnSignAvx2(const PRN_CONTEXT &Context, __m128i ChipCount, __m128i &DataSign, __m128i &PilotSign)
+{
+	typedef PrnVariant<Variant> Traits;
+	__m128i One = _mm_set1_epi32(1);
+	__m128i TmdMask = _mm_set1_epi32(-Traits::IsTmd(Context)), BocMask = _mm_set1_epi32(-Traits::IsBoc(Context));
+	__m128i HalfChip = _mm_cvtsi32_si128(Traits::HalfChip(Context));
+	__m128i Chip = _mm_sub_epi32(ChipCount, _mm_set1_epi32(Context.DataBase));
+	__m128i CodeIndex = _mm_srl_epi32(Chip, HalfChip);
+	__m128i Symbol, DataBit, PilotBit = _mm_setzero_si128(), OddMask, SignMask;
+
+	if (Traits::Combined(Context))
+	{
+		// one gather gets both data and pilot code
+		Symbol = _mm_i32gather_epi32((const int *)Context.CombinedPrn, _mm_srli_epi32(CodeIndex, 4), 4);
+		Symbol = _mm_srlv_epi32(Symbol, _mm_slli_epi32(_mm_and_si128(CodeIndex, _mm_set1_epi32(0xf)), 1));
+		DataBit = _mm_and_si128(Symbol, One);
+		PilotBit = _mm_and_si128(_mm_srli_epi32(Symbol, 1), One);
+	}
+	else
+	{
+		DataBit = _mm_i32gather_epi32((const int *)Context.DataPrn, _mm_srli_epi32(CodeIndex, 5), 4);
+		DataBit = _mm_and_si128(_mm_srlv_epi32(DataBit, _mm_and_si128(CodeIndex, _mm_set1_epi32(0x1f))), One);
+		if (Traits::Pilot)
+		{
+			CodeIndex = _mm_srl_epi32(_mm_add_epi32(Chip, _mm_set1_epi32(Context.PilotBase)), HalfChip);
+			PilotBit = _mm_i32gather_epi32((const int *)Context.PilotPrn, _mm_srli_epi32(CodeIndex, 5), 4);
+			PilotBit = _mm_and_si128(_mm_srlv_epi32(PilotBit, _mm_and_si128(CodeIndex, _mm_set1_epi32(0x1f))), One);
+		}
+	}
+	DataSign = _mm_sub_epi32(One, _mm_slli_epi32(DataBit, 1));
+	PilotSign = Traits::Pilot ? _mm_and_si128(_mm_sub_epi32(One, _mm_slli_epi32(PilotBit, 1)), _mm_set1_epi32(-Traits::HasPilot(Context))) : _mm_setzero_si128();
+	OddMask = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(ChipCount, One));
+	if (Traits::Generic || Traits::IsTmd(Context))
+	{
+		DataSign = _mm_andnot_si128(_mm_and_si128(TmdMask, OddMask), DataSign);
+		PilotSign = _mm_andnot_si128(_mm_andnot_si128(OddMask, TmdMask), PilotSign);
+	}
+	if (Traits::Generic || Traits::IsBoc(Context))
+	{
+		SignMask = _mm_and_si128(BocMask, OddMask);
+		DataSign = _mm_sub_epi32(_mm_xor_si128(DataSign, SignMask), SignMask);
+		PilotSign = _mm_sub_epi32(_mm_xor_si128(PilotSign, SignMask), SignMask);
+	}
+}
+
+// data plus pilot modulation of 4 or 8 samples
+template <unsigned int Variant> TARGET_AVX2 static FORCE_INLINE __m256d PrnModulation(__m256d DataSign, __m256d DataAmp, __m256d PilotSign, __m256d PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm256_add_pd(_mm256_mul_pd(DataSign, DataAmp), _mm256_mul_pd(PilotSign, PilotAmp)) : _mm256_mul_pd(DataSign, DataAmp);
+}
+
+template <unsigned int Variant> TARGET_AVX2 static FORCE_INLINE __m256 PrnModulation(__m256 DataSign, __m256 DataAmp, __m256 PilotSign, __m256 PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm256_add_ps(_mm256_mul_ps(DataSign, DataAmp), _mm256_mul_ps(PilotSign, PilotAmp)) : _mm256_mul_ps(DataSign, DataAmp);
+}
+
+template <unsigned int Variant> TARGET_AVX2 static FORCE_INLINE __m256i PrnModulation(__m256i DataSign, __m256i DataAmp, __m256i PilotSign, __m256i PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm256_add_epi32(_mm256_sign_epi32(DataAmp, DataSign), _mm256_sign_epi32(PilotAmp, PilotSign)) : _mm256_sign_epi32(DataAmp, DataSign);
+}
+
+// carrier of 4 samples in double, cos/sin pair of first quadrant read by gather
+// instructions and rotated to quadrant of phase by blend and sign bit flip
+TARGET_AVX2 static FORCE_INLINE void CarrierAvx2(const FastMath::CarrierNco &Nco, __m128i Phase, __m256d &CosValue, __m256d &SinValue)
+{
+	__m128i SignBit = _mm_set1_epi32(0x80000000);
+	__m128i Index = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(Phase, _mm_cvtsi32_si128(Nco.shift)), _mm_set1_epi32(Nco.index_mask)), 1);
+	__m128i Residual = _mm_sub_epi32(_mm_and_si128(Phase, _mm_set1_epi32(Nco.residual_mask)), _mm_set1_epi32(Nco.half_bin));
+	__m256d Delta = _mm256_mul_pd(_mm256_cvtepi32_pd(Residual), _mm256_set1_pd(Nco.delta_scale));
+	__m256d AllLanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));	// masked gather with zero source, unmasked form warns on GCC 12
+	__m256d CosBase = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), Nco.lut, Index, AllLanes, 8);
+	__m256d SinBase = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), Nco.lut + 1, Index, AllLanes, 8);
+	__m256d Cos = _mm256_sub_pd(CosBase, _mm256_mul_pd(Delta, SinBase));
+	__m256d Sin = _mm256_add_pd(SinBase, _mm256_mul_pd(Delta, CosBase));
+	// expand bit 30 (swap), bit 31 of phase plus quarter cycle (cos sign) and bit 31 (sin sign) to 64bit sign bit
+	__m256d Swap = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepu32_epi64(_mm_slli_epi32(Phase, 1)), 32));
+	__m256d CosSign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepu32_epi64(_mm_and_si128(_mm_add_epi32(Phase, _mm_set1_epi32(0x40000000)), SignBit)), 32));
+	__m256d SinSign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepu32_epi64(_mm_and_si128(Phase, SignBit)), 32));
+
+	CosValue = _mm256_xor_pd(_mm256_blendv_pd(Cos, Sin, Swap), CosSign);
+	SinValue = _mm256_xor_pd(_mm256_blendv_pd(Sin, Cos, Swap), SinSign);
+}
+
+// carrier of 8 samples in float
+TARGET_AVX2 static FORCE_INLINE void CarrierAvx2(const FastMath::CarrierNco &Nco, __m256i Phase, __m256 &CosValue, __m256 &SinValue)
+{
+	__m256i SignBit = _mm256_set1_epi32(0x80000000);
+	__m256i Index = _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(Phase, _mm_cvtsi32_si128(Nco.shift)), _mm256_set1_epi32(Nco.index_mask)), 1);
+	__m256i Residual = _mm256_sub_epi32(_mm256_and_si256(Phase, _mm256_set1_epi32(Nco.residual_mask)), _mm256_set1_epi32(Nco.half_bin));
+	__m256 Delta = _mm256_mul_ps(_mm256_cvtepi32_ps(Residual), _mm256_set1_ps((float)Nco.delta_scale));
+	__m256 CosBase = _mm256_i32gather_ps(Nco.lut_float, Index, 4);
+	__m256 SinBase = _mm256_i32gather_ps(Nco.lut_float + 1, Index, 4);
+	__m256 Cos = _mm256_sub_ps(CosBase, _mm256_mul_ps(Delta, SinBase));
+	__m256 Sin = _mm256_add_ps(SinBase, _mm256_mul_ps(Delta, CosBase));
+	__m256 Swap = _mm256_castsi256_ps(_mm256_slli_epi32(Phase, 1));
+	__m256 CosSign = _mm256_castsi256_ps(_mm256_and_si256(_mm256_add_epi32(Phase, _mm256_set1_epi32(0x40000000)), SignBit));
+	__m256 SinSign = _mm256_castsi256_ps(_mm256_and_si256(Phase, SignBit));
+
+	CosValue = _mm256_xor_ps(_mm256_blendv_ps(Cos, Sin, Swap), CosSign);
+	SinValue = _mm256_xor_ps(_mm256_blendv_ps(Sin, Cos, Swap), SinSign);
+}
+
+// carrier of 8 samples in Q14, one gather gets both cos and sin
+TARGET_AVX2 static FORCE_INLINE void CarrierAvx2(const FastMath::CarrierNco &Nco, __m256i Phase, __m256i &CosValue, __m256i &SinValue)
+{
+	__m256i Index = _mm256_and_si256(_mm256_srl_epi32(Phase, _mm_cvtsi32_si128(Nco.shift)), _mm256_set1_epi32(Nco.index_mask));
+	// angle of residual phase from bin center in Q24
+	__m256i Delta = _mm256_mullo_epi32(_mm256_sra_epi32(_mm256_sub_epi32(_mm256_and_si256(Phase, _mm256_set1_epi32(Nco.residual_mask)), _mm256_set1_epi32(Nco.half_bin)), _mm_cvtsi32_si128(Nco.delta_shift)), _mm256_set1_epi32(Nco.delta_scale_int));
+	__m256i Round = _mm256_set1_epi32(1 << 23);
+	__m256i Pair = _mm256_i32gather_epi32(Nco.lut_int16, Index, 4);
+	__m256i CosBase = _mm256_srai_epi32(_mm256_slli_epi32(Pair, 16), 16);
+	__m256i SinBase = _mm256_srai_epi32(Pair, 16);
+	__m256i Cos = _mm256_sub_epi32(CosBase, _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(SinBase, Delta), Round), 24));
+	__m256i Sin = _mm256_add_epi32(SinBase, _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(CosBase, Delta), Round), 24));
+	__m256i Swap = _mm256_srai_epi32(_mm256_slli_epi32(Phase, 1), 31);
+	__m256i CosSign = _mm256_srai_epi32(_mm256_add_epi32(Phase, _mm256_set1_epi32(0x40000000)), 31);
+	__m256i SinSign = _mm256_srai_epi32(Phase, 31);
+
+	CosValue = _mm256_blendv_epi8(Cos, Sin, Swap);
+	SinValue = _mm256_blendv_epi8(Sin, Cos, Swap);
+	CosValue = _mm256_sub_epi32(_mm256_xor_si256(CosValue, CosSign), CosSign);
+	SinValue = _mm256_sub_epi32(_mm256_xor_si256(SinValue, SinSign), SinSign);
+}
+
+// 4 samples each loop, carrier table read by gather instructions
+template <unsigned int Variant> TARGET_AVX2 static void IfSegmentAvx2(const IF_SEGMENT_PARAM *Param, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	unsigned int CarrierStep = (unsigned int)Param->CarrierStep;
+	int Count = Param->SampleCount & ~3;
+	int i;
+	double *Dest = (double *)Output;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m256i ChipPhase = _mm256_setr_epi64x((long long)Phase, (long long)(Phase + Step), (long long)(Phase + Step * 2), (long long)(Phase + Step * 3));
+	__m256i ChipStep4 = _mm256_set1_epi64x((long long)(Step * 4));
+	__m256i HighHalf = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7);
+	__m128i CarrierPhase = _mm_setr_epi32((int)Param->CarrierPhase, (int)(Param->CarrierPhase + CarrierStep), (int)(Param->CarrierPhase + CarrierStep * 2), (int)(Param->CarrierPhase + CarrierStep * 3));
+	__m128i CarrierStep4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m256d DataReal = _mm256_set1_pd(Context.DataReal), DataImag = _mm256_set1_pd(Context.DataImag);
+	__m256d PilotReal = _mm256_set1_pd(Context.PilotReal), PilotImag = _mm256_set1_pd(Context.PilotImag);
+	__m128i ChipCount, DataSign, PilotSign;
+	__m256d DataSignD, PilotSignD, PrnReal, PrnImag, CosValue, SinValue, Real, Imag, Low, High;
+
+	for (i = 0; i < Count; i += 4)
+	{
+		ChipCount = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(ChipPhase, HighHalf));
+		PrnSignAvx2<Variant>(Context, ChipCount, DataSign, PilotSign);
+		DataSignD = _mm256_cvtepi32_pd(DataSign);
+		PilotSignD = _mm256_cvtepi32_pd(PilotSign);
+
+		PrnReal = PrnModulation<Variant>(DataSignD, DataReal, PilotSignD, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSignD, DataImag, PilotSignD, PilotImag);
+		CarrierAvx2(Nco, CarrierPhase, CosValue, SinValue);
+		Real = _mm256_sub_pd(_mm256_mul_pd(PrnReal, CosValue), _mm256_mul_pd(PrnImag, SinValue));
+		Imag = _mm256_add_pd(_mm256_mul_pd(PrnReal, SinValue), _mm256_mul_pd(PrnImag, CosValue));
+		// interleave into real/imag pairs
+		Low = _mm256_unpacklo_pd(Real, Imag);
+		High = _mm256_unpackhi_pd(Real, Imag);
+		_mm256_storeu_pd(Dest + i * 2, _mm256_permute2f128_pd(Low, High, 0x20));
+		_mm256_storeu_pd(Dest + i * 2 + 4, _mm256_permute2f128_pd(Low, High, 0x31));
+
+		ChipPhase = _mm256_add_epi64(ChipPhase, ChipStep4);
+		CarrierPhase = _mm_add_epi32(CarrierPhase, CarrierStep4);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// float32 version, 8 samples each loop
+template <unsigned int Variant> TARGET_AVX2 static void IfSegmentAvx2(const IF_SEGMENT_PARAM *Param, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	int Count = Param->SampleCount & ~7;
+	int i;
+	float *Dest = (float *)Output;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m256i ChipPhase0 = _mm256_setr_epi64x((long long)Phase, (long long)(Phase + Step), (long long)(Phase + Step * 2), (long long)(Phase + Step * 3));
+	__m256i ChipPhase1 = _mm256_add_epi64(ChipPhase0, _mm256_set1_epi64x((long long)(Step * 4)));
+	__m256i ChipStep8 = _mm256_set1_epi64x((long long)(Step * 8));
+	__m256i HighHalf = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7);
+	__m256i CarrierPhase = _mm256_add_epi32(_mm256_set1_epi32((int)Param->CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(Param->CarrierStep)));
+	__m256i CarrierStep8 = _mm256_set1_epi32((int)((unsigned int)Param->CarrierStep * 8));
+	__m256 DataReal = _mm256_set1_ps((float)Context.DataReal), DataImag = _mm256_set1_ps((float)Context.DataImag);
+	__m256 PilotReal = _mm256_set1_ps((float)Context.PilotReal), PilotImag = _mm256_set1_ps((float)Context.PilotImag);
+	__m128i ChipCount, DataSign0, DataSign1, PilotSign0, PilotSign1;
+	__m256 DataSignF, PilotSignF, PrnReal, PrnImag, CosValue, SinValue, Real, Imag, Low, High;
+
+	for (i = 0; i < Count; i += 8)
+	{
+		ChipCount = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(ChipPhase0, HighHalf));
+		PrnSignAvx2<Variant>(Context, ChipCount, DataSign0, PilotSign0);
+		ChipCount = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(ChipPhase1, HighHalf));
+		PrnSignAvx2<Variant>(Context, ChipCount, DataSign1, PilotSign1);
+		DataSignF = _mm256_cvtepi32_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(DataSign0), DataSign1, 1));
+		PilotSignF = _mm256_cvtepi32_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(PilotSign0), PilotSign1, 1));
+
+		PrnReal = PrnModulation<Variant>(DataSignF, DataReal, PilotSignF, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSignF, DataImag, PilotSignF, PilotImag);
+		CarrierAvx2(Nco, CarrierPhase, CosValue, SinValue);
+		Real = _mm256_sub_ps(_mm256_mul_ps(PrnReal, CosValue), _mm256_mul_ps(PrnImag, SinValue));
+		Imag = _mm256_add_ps(_mm256_mul_ps(PrnReal, SinValue), _mm256_mul_ps(PrnImag, CosValue));
+		// interleave into real/imag pairs
+		Low = _mm256_unpacklo_ps(Real, Imag);
+		High = _mm256_unpackhi_ps(Real, Imag);
+		_mm256_storeu_ps(Dest + i * 2, _mm256_permute2f128_ps(Low, High, 0x20));
+		_mm256_storeu_ps(Dest + i * 2 + 8, _mm256_permute2f128_ps(Low, High, 0x31));
+
+		ChipPhase0 = _mm256_add_epi64(ChipPhase0, ChipStep8);
+		ChipPhase1 = _mm256_add_epi64(ChipPhase1, ChipStep8);
+		CarrierPhase = _mm256_add_epi32(CarrierPhase, CarrierStep8);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// int16 version, 8 samples each loop
+template <unsigned int Variant> TARGET_AVX2 static void IfSegmentAvx2(const IF_SEGMENT_PARAM *Param, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	int Count = Param->SampleCount & ~7;
+	int i;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m256i ChipPhase0 = _mm256_setr_epi64x((long long)Phase, (long long)(Phase + Step), (long long)(Phase + Step * 2), (long long)(Phase + Step * 3));
+	__m256i ChipPhase1 = _mm256_add_epi64(ChipPhase0, _mm256_set1_epi64x((long long)(Step * 4)));
+	__m256i ChipStep8 = _mm256_set1_epi64x((long long)(Step * 8));
+	__m256i HighHalf = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7);
+	__m256i CarrierPhase = _mm256_add_epi32(_mm256_set1_epi32((int)Param->CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(Param->CarrierStep)));
+	__m256i CarrierStep8 = _mm256_set1_epi32((int)((unsigned int)Param->CarrierStep * 8));
+	__m256i DataReal = _mm256_set1_epi32(Context.DataRealInt), DataImag = _mm256_set1_epi32(Context.DataImagInt);
+	__m256i PilotReal = _mm256_set1_epi32(Context.PilotRealInt), PilotImag = _mm256_set1_epi32(Context.PilotImagInt);
+	__m256i Round = _mm256_set1_epi32(INT_SAMPLE_ROUND), LowMask = _mm256_set1_epi32(0xffff);
+	__m128i ChipCount, DataSign0, DataSign1, PilotSign0, PilotSign1;
+	__m256i DataSign, PilotSign, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 8)
+	{
+		ChipCount = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(ChipPhase0, HighHalf));
+		PrnSignAvx2<Variant>(Context, ChipCount, DataSign0, PilotSign0);
+		ChipCount = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(ChipPhase1, HighHalf));
+		PrnSignAvx2<Variant>(Context, ChipCount, DataSign1, PilotSign1);
+		DataSign = _mm256_inserti128_si256(_mm256_castsi128_si256(DataSign0), DataSign1, 1);
+		PilotSign = _mm256_inserti128_si256(_mm256_castsi128_si256(PilotSign0), PilotSign1, 1);
+
+		PrnReal = PrnModulation<Variant>(DataSign, DataReal, PilotSign, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSign, DataImag, PilotSign, PilotImag);
+		CarrierAvx2(Nco, CarrierPhase, CosValue, SinValue);
+		Real = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(_mm256_mullo_epi32(PrnReal, CosValue), _mm256_mullo_epi32(PrnImag, SinValue)), Round), INT_SAMPLE_SHIFT);
+		Imag = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(PrnReal, SinValue), _mm256_mullo_epi32(PrnImag, CosValue)), Round), INT_SAMPLE_SHIFT);
+		_mm256_storeu_si256((__m256i *)(Output + i), _mm256_or_si256(_mm256_and_si256(Real, LowMask), _mm256_slli_epi32(Imag, 16)));
+
+		ChipPhase0 = _mm256_add_epi64(ChipPhase0, ChipStep8);
+		ChipPhase1 = _mm256_add_epi64(ChipPhase1, ChipStep8);
+		CarrierPhase = _mm256_add_epi32(CarrierPhase, CarrierStep8);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// GCC 12 reports '__Y' used uninitialized inside avx512fintrin.h for unmasked AVX-512
+// intrinsics, which pass an undefined merge source that never reaches the result, the false
+// warning is disabled for AVX-512 kernels (and AVX2 helpers inlined into them) only
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+//*************** AVX-512 kernels ****************
+// PRN sign of data and pilot channel for 8 samples, packed PRN words read by gather instructions
+template <unsigned int Variant> TARGET_AVX512 static FORCE_INLINE void PrnSignAvx512(const PRN_CONTEXT &Context, __m256i ChipCount, __m256i &DataSign, __m256i &PilotSign)
+{
+	typedef PrnVariant<Variant> Traits;
+	__m256i One = _mm256_set1_epi32(1);
+	__m256i TmdMask = _mm256_set1_epi32(-Traits::IsTmd(Context)), BocMask = _mm256_set1_epi32(-Traits::IsBoc(Context));
+	__m128i HalfChip = _mm_cvtsi32_si128(Traits::HalfChip(Context));
+	__m256i Chip = _mm256_sub_epi32(ChipCount, _mm256_set1_epi32(Context.DataBase));
+	__m256i CodeIndex = _mm256_srl_epi32(Chip, HalfChip);
+	__m256i Symbol, DataBit, PilotBit = _mm256_setzero_si256(), OddMask, SignMask;
+
+	if (Traits::Combined(Context))
+	{
+		// one gather gets both data and pilot code
+		Symbol = _mm256_i32gather_epi32((const int *)Context.CombinedPrn, _mm256_srli_epi32(CodeIndex, 4), 4);
+		Symbol = _mm256_srlv_epi32(Symbol, _mm256_slli_epi32(_mm256_and_si256(CodeIndex, _mm256_set1_epi32(0xf)), 1));
+		DataBit = _mm256_and_si256(Symbol, One);
+		PilotBit = _mm256_and_si256(_mm256_srli_epi32(Symbol, 1), One);
+	}
+	else
+	{
+		DataBit = _mm256_i32gather_epi32((const int *)Context.DataPrn, _mm256_srli_epi32(CodeIndex, 5), 4);
+		DataBit = _mm256_and_si256(_mm256_srlv_epi32(DataBit, _mm256_and_si256(CodeIndex, _mm256_set1_epi32(0x1f))), One);
+		if (Traits::Pilot)
+		{
+			CodeIndex = _mm256_srl_epi32(_mm256_add_epi32(Chip, _mm256_set1_epi32(Context.PilotBase)), HalfChip);
+			PilotBit = _mm256_i32gather_epi32((const int *)Context.PilotPrn, _mm256_srli_epi32(CodeIndex, 5), 4);
+			PilotBit = _mm256_and_si256(_mm256_srlv_epi32(PilotBit, _mm256_and_si256(CodeIndex, _mm256_set1_epi32(0x1f))), One);
+		}
+	}
+	DataSign = _mm256_sub_epi32(One, _mm256_slli_epi32(DataBit, 1));
+	PilotSign = Traits::Pilot ? _mm256_and_si256(_mm256_sub_epi32(One, _mm256_slli_epi32(PilotBit, 1)), _mm256_set1_epi32(-Traits::HasPilot(Context))) : _mm256_setzero_si256();
+	OddMask = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_and_si256(ChipCount, One));
+	if (Traits::Generic || Traits::IsTmd(Context))
+	{
+		DataSign = _mm256_andnot_si256(_mm256_and_si256(TmdMask, OddMask), DataSign);
+		PilotSign = _mm256_andnot_si256(_mm256_andnot_si256(OddMask, TmdMask), PilotSign);
+	}
+	if (Traits::Generic || Traits::IsBoc(Context))
+	{
+		SignMask = _mm256_and_si256(BocMask, OddMask);
+		DataSign = _mm256_sub_epi32(_mm256_xor_si256(DataSign, SignMask), SignMask);
+		PilotSign = _mm256_sub_epi32(_mm256_xor_si256(PilotSign, SignMask), SignMask);
+	}
+}
+
+// data plus pilot modulation of 8 or 16 samples
+template <unsigned int Variant> TARGET_AVX512 static FORCE_INLINE __m512d PrnModulation(__m512d DataSign, __m512d DataAmp, __m512d PilotSign, __m512d PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm512_add_pd(_mm512_mul_pd(DataSign, DataAmp), _mm512_mul_pd(PilotSign, PilotAmp)) : _mm512_mul_pd(DataSign, DataAmp);
+}
+
+template <unsigned int Variant> TARGET_AVX512 static FORCE_INLINE __m512 PrnModulation(__m512 DataSign, __m512 DataAmp, __m512 PilotSign, __m512 PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm512_add_ps(_mm512_mul_ps(DataSign, DataAmp), _mm512_mul_ps(PilotSign, PilotAmp)) : _mm512_mul_ps(DataSign, DataAmp);
+}
+
+// no sign instruction in AVX-512F, sign is +1/-1/0 so multiply instead
+template <unsigned int Variant> TARGET_AVX512 static FORCE_INLINE __m512i PrnModulation(__m512i DataSign, __m512i DataAmp, __m512i PilotSign, __m512i PilotAmp)
+{
+	return PrnVariant<Variant>::Pilot ? _mm512_add_epi32(_mm512_mullo_epi32(DataAmp, DataSign), _mm512_mullo_epi32(PilotAmp, PilotSign)) : _mm512_mullo_epi32(DataAmp, DataSign);
+}
+
+// carrier of 8 samples in double, quadrant of each lane selected by mask registers
+TARGET_AVX512 static FORCE_INLINE void CarrierAvx512(const FastMath::CarrierNco &Nco, __m256i Phase, __m512d &CosValue, __m512d &SinValue)
+{
+	__m256i Index = _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(Phase, _mm_cvtsi32_si128(Nco.shift)), _mm256_set1_epi32(Nco.index_mask)), 1);
+	__m256i Residual = _mm256_sub_epi32(_mm256_and_si256(Phase, _mm256_set1_epi32(Nco.residual_mask)), _mm256_set1_epi32(Nco.half_bin));
+	__m512d Delta = _mm512_mul_pd(_mm512_cvtepi32_pd(Residual), _mm512_set1_pd(Nco.delta_scale));
+	__m512d CosBase = _mm512_i32gather_pd(Index, Nco.lut, 8);
+	__m512d SinBase = _mm512_i32gather_pd(Index, Nco.lut + 1, 8);
+	__m512d Cos = _mm512_sub_pd(CosBase, _mm512_mul_pd(Delta, SinBase));
+	__m512d Sin = _mm512_add_pd(SinBase, _mm512_mul_pd(Delta, CosBase));
+	__m512i SignBit = _mm512_set1_epi64(0x80000000);
+	__mmask8 Swap = _mm512_test_epi64_mask(_mm512_cvtepu32_epi64(Phase), _mm512_set1_epi64(0x40000000));
+	__mmask8 CosNegate = _mm512_test_epi64_mask(_mm512_cvtepu32_epi64(_mm256_add_epi32(Phase, _mm256_set1_epi32(0x40000000))), SignBit);
+	__mmask8 SinNegate = _mm512_test_epi64_mask(_mm512_cvtepu32_epi64(Phase), SignBit);
+
+	CosValue = _mm512_mask_blend_pd(Swap, Cos, Sin);
+	SinValue = _mm512_mask_blend_pd(Swap, Sin, Cos);
+	CosValue = _mm512_mask_sub_pd(CosValue, CosNegate, _mm512_setzero_pd(), CosValue);
+	SinValue = _mm512_mask_sub_pd(SinValue, SinNegate, _mm512_setzero_pd(), SinValue);
+}
+
+// carrier of 16 samples in float
+TARGET_AVX512 static FORCE_INLINE void CarrierAvx512(const FastMath::CarrierNco &Nco, __m512i Phase, __m512 &CosValue, __m512 &SinValue)
+{
+	__m512i Index = _mm512_slli_epi32(_mm512_and_si512(_mm512_srl_epi32(Phase, _mm_cvtsi32_si128(Nco.shift)), _mm512_set1_epi32(Nco.index_mask)), 1);
+	__m512i Residual = _mm512_sub_epi32(_mm512_and_si512(Phase, _mm512_set1_epi32(Nco.residual_mask)), _mm512_set1_epi32(Nco.half_bin));
+	__m512 Delta = _mm512_mul_ps(_mm512_cvtepi32_ps(Residual), _mm512_set1_ps((float)Nco.delta_scale));
+	__m512 CosBase = _mm512_i32gather_ps(Index, Nco.lut_float, 4);
+	__m512 SinBase = _mm512_i32gather_ps(Index, Nco.lut_float + 1, 4);
+	__m512 Cos = _mm512_sub_ps(CosBase, _mm512_mul_ps(Delta, SinBase));
+	__m512 Sin = _mm512_add_ps(SinBase, _mm512_mul_ps(Delta, CosBase));
+	__m512i SignBit = _mm512_set1_epi32(0x80000000);
+	__mmask16 Swap = _mm512_test_epi32_mask(Phase, _mm512_set1_epi32(0x40000000));
+	__mmask16 CosNegate = _mm512_test_epi32_mask(_mm512_add_epi32(Phase, _mm512_set1_epi32(0x40000000)), SignBit);
+	__mmask16 SinNegate = _mm512_test_epi32_mask(Phase, SignBit);
+
+	CosValue = _mm512_mask_blend_ps(Swap, Cos, Sin);
+	SinValue = _mm512_mask_blend_ps(Swap, Sin, Cos);
+	CosValue = _mm512_mask_sub_ps(CosValue, CosNegate, _mm512_setzero_ps(), CosValue);
+	SinValue = _mm512_mask_sub_ps(SinValue, SinNegate, _mm512_setzero_ps(), SinValue);
+}
+
+// carrier of 16 samples in Q14
+TARGET_AVX512 static FORCE_INLINE void CarrierAvx512(const FastMath::CarrierNco &Nco, __m512i Phase, __m512i &CosValue, __m512i &SinValue)
+{
+	__m512i Index = _mm512_and_si512(_mm512_srl_epi32(Phase, _mm_cvtsi32_si128(Nco.shift)), _mm512_set1_epi32(Nco.index_mask));
+	// angle of residual phase from bin center in Q24
+	__m512i Delta = _mm512_mullo_epi32(_mm512_sra_epi32(_mm512_sub_epi32(_mm512_and_si512(Phase, _mm512_set1_epi32(Nco.residual_mask)), _mm512_set1_epi32(Nco.half_bin)), _mm_cvtsi32_si128(Nco.delta_shift)), _mm512_set1_epi32(Nco.delta_scale_int));
+	__m512i Round = _mm512_set1_epi32(1 << 23);
+	__m512i Pair = _mm512_i32gather_epi32(Index, Nco.lut_int16, 4);
+	__m512i CosBase = _mm512_srai_epi32(_mm512_slli_epi32(Pair, 16), 16);
+	__m512i SinBase = _mm512_srai_epi32(Pair, 16);
+	__m512i Cos = _mm512_sub_epi32(CosBase, _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(SinBase, Delta), Round), 24));
+	__m512i Sin = _mm512_add_epi32(SinBase, _mm512_srai_epi32(_mm512_add_epi32(_mm512_mullo_epi32(CosBase, Delta), Round), 24));
+	__m512i SignBit = _mm512_set1_epi32(0x80000000);
+	__mmask16 Swap = _mm512_test_epi32_mask(Phase, _mm512_set1_epi32(0x40000000));
+	__mmask16 CosNegate = _mm512_test_epi32_mask(_mm512_add_epi32(Phase, _mm512_set1_epi32(0x40000000)), SignBit);
+	__mmask16 SinNegate = _mm512_test_epi32_mask(Phase, SignBit);
+
+	CosValue = _mm512_mask_blend_epi32(Swap, Cos, Sin);
+	SinValue = _mm512_mask_blend_epi32(Swap, Sin, Cos);
+	CosValue = _mm512_mask_sub_epi32(CosValue, CosNegate, _mm512_setzero_si512(), CosValue);
+	SinValue = _mm512_mask_sub_epi32(SinValue, SinNegate, _mm512_setzero_si512(), SinValue);
+}
+
+// 8 samples each loop, carrier table read by gather instructions
+template <unsigned int Variant> TARGET_AVX512 static void IfSegmentAvx512(const IF_SEGMENT_PARAM *Param, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	int Count = Param->SampleCount & ~7;
+	int i;
+	double *Dest = (double *)Output;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m512i ChipPhase = _mm512_set_epi64((long long)(Phase + Step * 7), (long long)(Phase + Step * 6), (long long)(Phase + Step * 5), (long long)(Phase + Step * 4),
+		(long long)(Phase + Step * 3), (long long)(Phase + Step * 2), (long long)(Phase + Step), (long long)Phase);
+	__m512i ChipStep8 = _mm512_set1_epi64((long long)(Step * 8));
+	__m256i CarrierPhase = _mm256_add_epi32(_mm256_set1_epi32((int)Param->CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(Param->CarrierStep)));
+	__m256i CarrierStep8 = _mm256_set1_epi32((int)((unsigned int)Param->CarrierStep * 8));
+	__m512i InterleaveLow = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+	__m512i InterleaveHigh = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+	__m512d DataReal = _mm512_set1_pd(Context.DataReal), DataImag = _mm512_set1_pd(Context.DataImag);
+	__m512d PilotReal = _mm512_set1_pd(Context.PilotReal), PilotImag = _mm512_set1_pd(Context.PilotImag);
+	__m256i ChipCount, DataSign, PilotSign;
+	__m512d DataSignD, PilotSignD, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 8)
+	{
+		ChipCount = _mm512_cvtepi64_epi32(_mm512_srli_epi64(ChipPhase, 32));
+		PrnSignAvx512<Variant>(Context, ChipCount, DataSign, PilotSign);
+		DataSignD = _mm512_cvtepi32_pd(DataSign);
+		PilotSignD = _mm512_cvtepi32_pd(PilotSign);
+
+		PrnReal = PrnModulation<Variant>(DataSignD, DataReal, PilotSignD, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSignD, DataImag, PilotSignD, PilotImag);
+		CarrierAvx512(Nco, CarrierPhase, CosValue, SinValue);
+		Real = _mm512_sub_pd(_mm512_mul_pd(PrnReal, CosValue), _mm512_mul_pd(PrnImag, SinValue));
+		Imag = _mm512_add_pd(_mm512_mul_pd(PrnReal, SinValue), _mm512_mul_pd(PrnImag, CosValue));
+		_mm512_storeu_pd(Dest + i * 2, _mm512_permutex2var_pd(Real, InterleaveLow, Imag));
+		_mm512_storeu_pd(Dest + i * 2 + 8, _mm512_permutex2var_pd(Real, InterleaveHigh, Imag));
+
+		ChipPhase = _mm512_add_epi64(ChipPhase, ChipStep8);
+		CarrierPhase = _mm256_add_epi32(CarrierPhase, CarrierStep8);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// float32 version, 16 samples each loop
+template <unsigned int Variant> TARGET_AVX512 static void IfSegmentAvx512(const IF_SEGMENT_PARAM *Param, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	int Count = Param->SampleCount & ~15;
+	int i;
+	float *Dest = (float *)Output;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m512i ChipPhase0 = _mm512_set_epi64((long long)(Phase + Step * 7), (long long)(Phase + Step * 6), (long long)(Phase + Step * 5), (long long)(Phase + Step * 4),
+		(long long)(Phase + Step * 3), (long long)(Phase + Step * 2), (long long)(Phase + Step), (long long)Phase);
+	__m512i ChipPhase1 = _mm512_add_epi64(ChipPhase0, _mm512_set1_epi64((long long)(Step * 8)));
+	__m512i ChipStep16 = _mm512_set1_epi64((long long)(Step * 16));
+	__m512i CarrierPhase = _mm512_add_epi32(_mm512_set1_epi32((int)Param->CarrierPhase), _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(Param->CarrierStep)));
+	__m512i CarrierStep16 = _mm512_set1_epi32((int)((unsigned int)Param->CarrierStep * 16));
+	__m512i InterleaveLow = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+	__m512i InterleaveHigh = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+	__m512 DataReal = _mm512_set1_ps((float)Context.DataReal), DataImag = _mm512_set1_ps((float)Context.DataImag);
+	__m512 PilotReal = _mm512_set1_ps((float)Context.PilotReal), PilotImag = _mm512_set1_ps((float)Context.PilotImag);
+	__m256i ChipCount, DataSign0, DataSign1, PilotSign0, PilotSign1;
+	__m512 DataSignF, PilotSignF, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 16)
+	{
+		ChipCount = _mm512_cvtepi64_epi32(_mm512_srli_epi64(ChipPhase0, 32));
+		PrnSignAvx512<Variant>(Context, ChipCount, DataSign0, PilotSign0);
+		ChipCount = _mm512_cvtepi64_epi32(_mm512_srli_epi64(ChipPhase1, 32));
+		PrnSignAvx512<Variant>(Context, ChipCount, DataSign1, PilotSign1);
+		DataSignF = _mm512_cvtepi32_ps(_mm512_inserti64x4(_mm512_castsi256_si512(DataSign0), DataSign1, 1));
+		PilotSignF = _mm512_cvtepi32_ps(_mm512_inserti64x4(_mm512_castsi256_si512(PilotSign0), PilotSign1, 1));
+
+		PrnReal = PrnModulation<Variant>(DataSignF, DataReal, PilotSignF, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSignF, DataImag, PilotSignF, PilotImag);
+		CarrierAvx512(Nco, CarrierPhase, CosValue, SinValue);
+		Real = _mm512_sub_ps(_mm512_mul_ps(PrnReal, CosValue), _mm512_mul_ps(PrnImag, SinValue));
+		Imag = _mm512_add_ps(_mm512_mul_ps(PrnReal, SinValue), _mm512_mul_ps(PrnImag, CosValue));
+		_mm512_storeu_ps(Dest + i * 2, _mm512_permutex2var_ps(Real, InterleaveLow, Imag));
+		_mm512_storeu_ps(Dest + i * 2 + 16, _mm512_permutex2var_ps(Real, InterleaveHigh, Imag));
+
+		ChipPhase0 = _mm512_add_epi64(ChipPhase0, ChipStep16);
+		ChipPhase1 = _mm512_add_epi64(ChipPhase1, ChipStep16);
+		CarrierPhase = _mm512_add_epi32(CarrierPhase, CarrierStep16);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+// int16 version, 16 samples each loop
+template <unsigned int Variant> TARGET_AVX512 static void IfSegmentAvx512(const IF_SEGMENT_PARAM *Param, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	unsigned long long Phase = Param->ChipPhase, Step = Param->ChipStep;
+	int Count = Param->SampleCount & ~15;
+	int i;
+	PRN_CONTEXT Context;
+
+	GetPrnContext(Param, Context);
+	__m512i ChipPhase0 = _mm512_set_epi64((long long)(Phase + Step * 7), (long long)(Phase + Step * 6), (long long)(Phase + Step * 5), (long long)(Phase + Step * 4),
+		(long long)(Phase + Step * 3), (long long)(Phase + Step * 2), (long long)(Phase + Step), (long long)Phase);
+	__m512i ChipPhase1 = _mm512_add_epi64(ChipPhase0, _mm512_set1_epi64((long long)(Step * 8)));
+	__m512i ChipStep16 = _mm512_set1_epi64((long long)(Step * 16));
+	__m512i CarrierPhase = _mm512_add_epi32(_mm512_set1_epi32((int)Param->CarrierPhase), _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(Param->CarrierStep)));
+	__m512i CarrierStep16 = _mm512_set1_epi32((int)((unsigned int)Param->CarrierStep * 16));
+	__m512i DataReal = _mm512_set1_epi32(Context.DataRealInt), DataImag = _mm512_set1_epi32(Context.DataImagInt);
+	__m512i PilotReal = _mm512_set1_epi32(Context.PilotRealInt), PilotImag = _mm512_set1_epi32(Context.PilotImagInt);
+	__m512i Round = _mm512_set1_epi32(INT_SAMPLE_ROUND), LowMask = _mm512_set1_epi32(0xffff);
+	__m256i ChipCount, DataSign0, DataSign1, PilotSign0, PilotSign1;
+	__m512i DataSign, PilotSign, PrnReal, PrnImag, CosValue, SinValue, Real, Imag;
+
+	for (i = 0; i < Count; i += 16)
+	{
+		ChipCount = _mm512_cvtepi64_epi32(_mm512_srli_epi64(ChipPhase0, 32));
+		PrnSignAvx512<Variant>(Context, ChipCount, DataSign0, PilotSign0);
+		ChipCount = _mm512_cvtepi64_epi32(_mm512_srli_epi64(ChipPhase1, 32));
+		PrnSignAvx512<Variant>(Context, ChipCount, DataSign1, PilotSign1);
+		DataSign = _mm512_inserti64x4(_mm512_castsi256_si512(DataSign0), DataSign1, 1);
+		PilotSign = _mm512_inserti64x4(_mm512_castsi256_si512(PilotSign0), PilotSign1, 1);
+
+		PrnReal = PrnModulation<Variant>(DataSign, DataReal, PilotSign, PilotReal);
+		PrnImag = PrnModulation<Variant>(DataSign, DataImag, PilotSign, PilotImag);
+		CarrierAvx512(Nco, CarrierPhase, CosValue, SinValue);
+		Real = _mm512_srai_epi32(_mm512_add_epi32(_mm512_sub_epi32(_mm512_mullo_epi32(PrnReal, CosValue), _mm512_mullo_epi32(PrnImag, SinValue)), Round), INT_SAMPLE_SHIFT);
+		Imag = _mm512_srai_epi32(_mm512_add_epi32(_mm512_add_epi32(_mm512_mullo_epi32(PrnReal, SinValue), _mm512_mullo_epi32(PrnImag, CosValue)), Round), INT_SAMPLE_SHIFT);
+		_mm512_storeu_si512(Output + i, _mm512_or_si512(_mm512_and_si512(Real, LowMask), _mm512_slli_epi32(Imag, 16)));
+
+		ChipPhase0 = _mm512_add_epi64(ChipPhase0, ChipStep16);
+		ChipPhase1 = _mm512_add_epi64(ChipPhase1, ChipStep16);
+		CarrierPhase = _mm512_add_epi32(CarrierPhase, CarrierStep16);
+	}
+	IfSegmentScalar<Variant>(Param, Output, Count, Param->SampleCount);
+}
+
+//*************** Carrier rotation for chip run engine ****************
+TARGET_SSE42 static void RotateSse42(const double *PrnReal, const double *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, k, Count4 = Count & ~3;
+	double CosArray[4], SinArray[4];
+	double *Dest = (double *)Output;
+	__m128i Phase = _mm_setr_epi32((int)CarrierPhase, (int)(CarrierPhase + CarrierStep), (int)(CarrierPhase + CarrierStep * 2), (int)(CarrierPhase + CarrierStep * 3));
+	__m128i Step4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m128d Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count4; i += 4)
+	{
+		CarrierSse42(Nco, Phase, CosArray, SinArray);
+		for (k = 0; k < 4; k += 2)
+		{
+			CosValue = _mm_loadu_pd(CosArray + k);
+			SinValue = _mm_loadu_pd(SinArray + k);
+			Real = _mm_sub_pd(_mm_mul_pd(_mm_loadu_pd(PrnReal + i + k), CosValue), _mm_mul_pd(_mm_loadu_pd(PrnImag + i + k), SinValue));
+			Imag = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(PrnReal + i + k), SinValue), _mm_mul_pd(_mm_loadu_pd(PrnImag + i + k), CosValue));
+			_mm_storeu_pd(Dest + (i + k) * 2, _mm_unpacklo_pd(Real, Imag));
+			_mm_storeu_pd(Dest + (i + k) * 2 + 2, _mm_unpackhi_pd(Real, Imag));
+		}
+		Phase = _mm_add_epi32(Phase, Step4);
+	}
+	RotateScalar(PrnReal + Count4, PrnImag + Count4, CarrierPhase + CarrierStep * Count4, CarrierStep, Count - Count4, Output + Count4);
+}
+
+TARGET_SSE42 static void RotateSse42(const float *PrnReal, const float *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count4 = Count & ~3;
+	float CosArray[4], SinArray[4];
+	float *Dest = (float *)Output;
+	__m128i Phase = _mm_setr_epi32((int)CarrierPhase, (int)(CarrierPhase + CarrierStep), (int)(CarrierPhase + CarrierStep * 2), (int)(CarrierPhase + CarrierStep * 3));
+	__m128i Step4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m128 Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count4; i += 4)
+	{
+		CarrierSse42(Nco, Phase, CosArray, SinArray);
+		CosValue = _mm_loadu_ps(CosArray);
+		SinValue = _mm_loadu_ps(SinArray);
+		Real = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(PrnReal + i), CosValue), _mm_mul_ps(_mm_loadu_ps(PrnImag + i), SinValue));
+		Imag = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(PrnReal + i), SinValue), _mm_mul_ps(_mm_loadu_ps(PrnImag + i), CosValue));
+		_mm_storeu_ps(Dest + i * 2, _mm_unpacklo_ps(Real, Imag));
+		_mm_storeu_ps(Dest + i * 2 + 4, _mm_unpackhi_ps(Real, Imag));
+		Phase = _mm_add_epi32(Phase, Step4);
+	}
+	RotateScalar(PrnReal + Count4, PrnImag + Count4, CarrierPhase + CarrierStep * Count4, CarrierStep, Count - Count4, Output + Count4);
+}
+
+TARGET_AVX2 static void RotateAvx2(const double *PrnReal, const double *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count4 = Count & ~3;
+	double *Dest = (double *)Output;
+	__m128i Phase = _mm_setr_epi32((int)CarrierPhase, (int)(CarrierPhase + CarrierStep), (int)(CarrierPhase + CarrierStep * 2), (int)(CarrierPhase + CarrierStep * 3));
+	__m128i Step4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m256d Real, Imag, CosValue, SinValue, Low, High;
+
+	for (i = 0; i < Count4; i += 4)
+	{
+		CarrierAvx2(Nco, Phase, CosValue, SinValue);
+		Real = _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(PrnReal + i), CosValue), _mm256_mul_pd(_mm256_loadu_pd(PrnImag + i), SinValue));
+		Imag = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(PrnReal + i), SinValue), _mm256_mul_pd(_mm256_loadu_pd(PrnImag + i), CosValue));
+		Low = _mm256_unpacklo_pd(Real, Imag);
+		High = _mm256_unpackhi_pd(Real, Imag);
+		_mm256_storeu_pd(Dest + i * 2, _mm256_permute2f128_pd(Low, High, 0x20));
+		_mm256_storeu_pd(Dest + i * 2 + 4, _mm256_permute2f128_pd(Low, High, 0x31));
+		Phase = _mm_add_epi32(Phase, Step4);
+	}
+	RotateScalar(PrnReal + Count4, PrnImag + Count4, CarrierPhase + CarrierStep * Count4, CarrierStep, Count - Count4, Output + Count4);
+}
+
+TARGET_AVX2 static void RotateAvx2(const float *PrnReal, const float *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count8 = Count & ~7;
+	float *Dest = (float *)Output;
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32((int)CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)CarrierStep)));
+	__m256i Step8 = _mm256_set1_epi32((int)(CarrierStep * 8));
+	__m256 Real, Imag, CosValue, SinValue, Low, High;
+
+	for (i = 0; i < Count8; i += 8)
+	{
+		CarrierAvx2(Nco, Phase, CosValue, SinValue);
+		Real = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(PrnReal + i), CosValue), _mm256_mul_ps(_mm256_loadu_ps(PrnImag + i), SinValue));
+		Imag = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(PrnReal + i), SinValue), _mm256_mul_ps(_mm256_loadu_ps(PrnImag + i), CosValue));
+		Low = _mm256_unpacklo_ps(Real, Imag);
+		High = _mm256_unpackhi_ps(Real, Imag);
+		_mm256_storeu_ps(Dest + i * 2, _mm256_permute2f128_ps(Low, High, 0x20));
+		_mm256_storeu_ps(Dest + i * 2 + 8, _mm256_permute2f128_ps(Low, High, 0x31));
+		Phase = _mm256_add_epi32(Phase, Step8);
+	}
+	RotateScalar(PrnReal + Count8, PrnImag + Count8, CarrierPhase + CarrierStep * Count8, CarrierStep, Count - Count8, Output + Count8);
+}
+
+TARGET_AVX512 static void RotateAvx512(const double *PrnReal, const double *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count8 = Count & ~7;
+	double *Dest = (double *)Output;
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32((int)CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)CarrierStep)));
+	__m256i Step8 = _mm256_set1_epi32((int)(CarrierStep * 8));
+	__m512i InterleaveLow = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+	__m512i InterleaveHigh = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+	__m512d Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count8; i += 8)
+	{
+		CarrierAvx512(Nco, Phase, CosValue, SinValue);
+		Real = _mm512_sub_pd(_mm512_mul_pd(_mm512_loadu_pd(PrnReal + i), CosValue), _mm512_mul_pd(_mm512_loadu_pd(PrnImag + i), SinValue));
+		Imag = _mm512_add_pd(_mm512_mul_pd(_mm512_loadu_pd(PrnReal + i), SinValue), _mm512_mul_pd(_mm512_loadu_pd(PrnImag + i), CosValue));
+		_mm512_storeu_pd(Dest + i * 2, _mm512_permutex2var_pd(Real, InterleaveLow, Imag));
+		_mm512_storeu_pd(Dest + i * 2 + 8, _mm512_permutex2var_pd(Real, InterleaveHigh, Imag));
+		Phase = _mm256_add_epi32(Phase, Step8);
+	}
+	RotateScalar(PrnReal + Count8, PrnImag + Count8, CarrierPhase + CarrierStep * Count8, CarrierStep, Count - Count8, Output + Count8);
+}
+
+TARGET_AVX512 static void RotateAvx512(const float *PrnReal, const float *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count16 = Count & ~15;
+	float *Dest = (float *)Output;
+	__m512i Phase = _mm512_add_epi32(_mm512_set1_epi32((int)CarrierPhase), _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32((int)CarrierStep)));
+	__m512i Step16 = _mm512_set1_epi32((int)(CarrierStep * 16));
+	__m512i InterleaveLow = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+	__m512i InterleaveHigh = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+	__m512 Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count16; i += 16)
+	{
+		CarrierAvx512(Nco, Phase, CosValue, SinValue);
+		Real = _mm512_sub_ps(_mm512_mul_ps(_mm512_loadu_ps(PrnReal + i), CosValue), _mm512_mul_ps(_mm512_loadu_ps(PrnImag + i), SinValue));
+		Imag = _mm512_add_ps(_mm512_mul_ps(_mm512_loadu_ps(PrnReal + i), SinValue), _mm512_mul_ps(_mm512_loadu_ps(PrnImag + i), CosValue));
+		_mm512_storeu_ps(Dest + i * 2, _mm512_permutex2var_ps(Real, InterleaveLow, Imag));
+		_mm512_storeu_ps(Dest + i * 2 + 16, _mm512_permutex2var_ps(Real, InterleaveHigh, Imag));
+		Phase = _mm512_add_epi32(Phase, Step16);
+	}
+	RotateScalar(PrnReal + Count16, PrnImag + Count16, CarrierPhase + CarrierStep * Count16, CarrierStep, Count - Count16, Output + Count16);
+}
+
+TARGET_SSE42 static void RotateSse42(const short *PrnReal, const short *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count4 = Count & ~3;
+	int CosArray[4], SinArray[4];
+	__m128i Phase = _mm_setr_epi32((int)CarrierPhase, (int)(CarrierPhase + CarrierStep), (int)(CarrierPhase + CarrierStep * 2), (int)(CarrierPhase + CarrierStep * 3));
+	__m128i Step4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m128i Round = _mm_set1_epi32(INT_SAMPLE_ROUND), LowMask = _mm_set1_epi32(0xffff);
+	__m128i PrnRealValue, PrnImagValue, Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count4; i += 4)
+	{
+		CarrierSse42(Nco, Phase, CosArray, SinArray);
+		CosValue = _mm_loadu_si128((const __m128i *)CosArray);
+		SinValue = _mm_loadu_si128((const __m128i *)SinArray);
+		PrnRealValue = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(PrnReal + i)));
+		PrnImagValue = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(PrnImag + i)));
+		Real = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_mullo_epi32(PrnRealValue, CosValue), _mm_mullo_epi32(PrnImagValue, SinValue)), Round), INT_SAMPLE_SHIFT);
+		Imag = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(PrnRealValue, SinValue), _mm_mullo_epi32(PrnImagValue, CosValue)), Round), INT_SAMPLE_SHIFT);
+		_mm_storeu_si128((__m128i *)(Output + i), _mm_or_si128(_mm_and_si128(Real, LowMask), _mm_slli_epi32(Imag, 16)));
+		Phase = _mm_add_epi32(Phase, Step4);
+	}
+	RotateScalar(PrnReal + Count4, PrnImag + Count4, CarrierPhase + CarrierStep * Count4, CarrierStep, Count - Count4, Output + Count4);
+}
+
+TARGET_AVX2 static void RotateAvx2(const short *PrnReal, const short *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count8 = Count & ~7;
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32((int)CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)CarrierStep)));
+	__m256i Step8 = _mm256_set1_epi32((int)(CarrierStep * 8));
+	__m256i Round = _mm256_set1_epi32(INT_SAMPLE_ROUND), LowMask = _mm256_set1_epi32(0xffff);
+	__m256i PrnRealValue, PrnImagValue, Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count8; i += 8)
+	{
+		CarrierAvx2(Nco, Phase, CosValue, SinValue);
+		PrnRealValue = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(PrnReal + i)));
+		PrnImagValue = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(PrnImag + i)));
+		Real = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(_mm256_mullo_epi32(PrnRealValue, CosValue), _mm256_mullo_epi32(PrnImagValue, SinValue)), Round), INT_SAMPLE_SHIFT);
+		Imag = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(PrnRealValue, SinValue), _mm256_mullo_epi32(PrnImagValue, CosValue)), Round), INT_SAMPLE_SHIFT);
+		_mm256_storeu_si256((__m256i *)(Output + i), _mm256_or_si256(_mm256_and_si256(Real, LowMask), _mm256_slli_epi32(Imag, 16)));
+		Phase = _mm256_add_epi32(Phase, Step8);
+	}
+	RotateScalar(PrnReal + Count8, PrnImag + Count8, CarrierPhase + CarrierStep * Count8, CarrierStep, Count - Count8, Output + Count8);
+}
+
+TARGET_AVX512 static void RotateAvx512(const short *PrnReal, const short *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count16 = Count & ~15;
+	__m512i Phase = _mm512_add_epi32(_mm512_set1_epi32((int)CarrierPhase), _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32((int)CarrierStep)));
+	__m512i Step16 = _mm512_set1_epi32((int)(CarrierStep * 16));
+	__m512i Round = _mm512_set1_epi32(INT_SAMPLE_ROUND), LowMask = _mm512_set1_epi32(0xffff);
+	__m512i PrnRealValue, PrnImagValue, Real, Imag, CosValue, SinValue;
+
+	for (i = 0; i < Count16; i += 16)
+	{
+		CarrierAvx512(Nco, Phase, CosValue, SinValue);
+		PrnRealValue = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(PrnReal + i)));
+		PrnImagValue = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(PrnImag + i)));
+		Real = _mm512_srai_epi32(_mm512_add_epi32(_mm512_sub_epi32(_mm512_mullo_epi32(PrnRealValue, CosValue), _mm512_mullo_epi32(PrnImagValue, SinValue)), Round), INT_SAMPLE_SHIFT);
+		Imag = _mm512_srai_epi32(_mm512_add_epi32(_mm512_add_epi32(_mm512_mullo_epi32(PrnRealValue, SinValue), _mm512_mullo_epi32(PrnImagValue, CosValue)), Round), INT_SAMPLE_SHIFT);
+		_mm512_storeu_si512(Output + i, _mm512_or_si512(_mm512_and_si512(Real, LowMask), _mm512_slli_epi32(Imag, 16)));
+		Phase = _mm512_add_epi32(Phase, Step16);
+	}
+	RotateScalar(PrnReal + Count16, PrnImag + Count16, CarrierPhase + CarrierStep * Count16, CarrierStep, Count - Count16, Output + Count16);
+}
+
+//*************** Carrier NCO block generation ****************
+TARGET_AVX2 static void NcoAvx2(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count4 = Count & ~3;
+	double *Dest = (double *)Output;
+	__m128i Phase = _mm_setr_epi32((int)CarrierPhase, (int)(CarrierPhase + CarrierStep), (int)(CarrierPhase + CarrierStep * 2), (int)(CarrierPhase + CarrierStep * 3));
+	__m128i Step4 = _mm_set1_epi32((int)(CarrierStep * 4));
+	__m256d CosValue, SinValue, Low, High;
+
+	for (i = 0; i < Count4; i += 4)
+	{
+		CarrierAvx2(Nco, Phase, CosValue, SinValue);
+		Low = _mm256_unpacklo_pd(CosValue, SinValue);
+		High = _mm256_unpackhi_pd(CosValue, SinValue);
+		_mm256_storeu_pd(Dest + i * 2, _mm256_permute2f128_pd(Low, High, 0x20));
+		_mm256_storeu_pd(Dest + i * 2 + 4, _mm256_permute2f128_pd(Low, High, 0x31));
+		Phase = _mm_add_epi32(Phase, Step4);
+	}
+	NcoScalar(CarrierPhase + CarrierStep * Count4, CarrierStep, Count - Count4, Output + Count4);
+}
+
+TARGET_AVX2 static void NcoAvx2(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count8 = Count & ~7;
+	float *Dest = (float *)Output;
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32((int)CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)CarrierStep)));
+	__m256i Step8 = _mm256_set1_epi32((int)(CarrierStep * 8));
+	__m256 CosValue, SinValue, Low, High;
+
+	for (i = 0; i < Count8; i += 8)
+	{
+		CarrierAvx2(Nco, Phase, CosValue, SinValue);
+		Low = _mm256_unpacklo_ps(CosValue, SinValue);
+		High = _mm256_unpackhi_ps(CosValue, SinValue);
+		_mm256_storeu_ps(Dest + i * 2, _mm256_permute2f128_ps(Low, High, 0x20));
+		_mm256_storeu_ps(Dest + i * 2 + 8, _mm256_permute2f128_ps(Low, High, 0x31));
+		Phase = _mm256_add_epi32(Phase, Step8);
+	}
+	NcoScalar(CarrierPhase + CarrierStep * Count8, CarrierStep, Count - Count8, Output + Count8);
+}
+
+TARGET_AVX2 static void NcoAvx2(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count8 = Count & ~7;
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32((int)CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)CarrierStep)));
+	__m256i Step8 = _mm256_set1_epi32((int)(CarrierStep * 8));
+	__m256i LowMask = _mm256_set1_epi32(0xffff);
+	__m256i CosValue, SinValue;
+
+	for (i = 0; i < Count8; i += 8)
+	{
+		CarrierAvx2(Nco, Phase, CosValue, SinValue);
+		_mm256_storeu_si256((__m256i *)(Output + i), _mm256_or_si256(_mm256_and_si256(CosValue, LowMask), _mm256_slli_epi32(SinValue, 16)));
+		Phase = _mm256_add_epi32(Phase, Step8);
+	}
+	NcoScalar(CarrierPhase + CarrierStep * Count8, CarrierStep, Count - Count8, Output + Count8);
+}
+
+TARGET_AVX512 static void NcoAvx512(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_number *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count8 = Count & ~7;
+	double *Dest = (double *)Output;
+	__m256i Phase = _mm256_add_epi32(_mm256_set1_epi32((int)CarrierPhase), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)CarrierStep)));
+	__m256i Step8 = _mm256_set1_epi32((int)(CarrierStep * 8));
+	__m512i InterleaveLow = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+	__m512i InterleaveHigh = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+	__m512d CosValue, SinValue;
+
+	for (i = 0; i < Count8; i += 8)
+	{
+		CarrierAvx512(Nco, Phase, CosValue, SinValue);
+		_mm512_storeu_pd(Dest + i * 2, _mm512_permutex2var_pd(CosValue, InterleaveLow, SinValue));
+		_mm512_storeu_pd(Dest + i * 2 + 8, _mm512_permutex2var_pd(CosValue, InterleaveHigh, SinValue));
+		Phase = _mm256_add_epi32(Phase, Step8);
+	}
+	NcoScalar(CarrierPhase + CarrierStep * Count8, CarrierStep, Count - Count8, Output + Count8);
+}
+
+TARGET_AVX512 static void NcoAvx512(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_float *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count16 = Count & ~15;
+	float *Dest = (float *)Output;
+	__m512i Phase = _mm512_add_epi32(_mm512_set1_epi32((int)CarrierPhase), _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32((int)CarrierStep)));
+	__m512i Step16 = _mm512_set1_epi32((int)(CarrierStep * 16));
+	__m512i InterleaveLow = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+	__m512i InterleaveHigh = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+	__m512 CosValue, SinValue;
+
+	for (i = 0; i < Count16; i += 16)
+	{
+		CarrierAvx512(Nco, Phase, CosValue, SinValue);
+		_mm512_storeu_ps(Dest + i * 2, _mm512_permutex2var_ps(CosValue, InterleaveLow, SinValue));
+		_mm512_storeu_ps(Dest + i * 2 + 16, _mm512_permutex2var_ps(CosValue, InterleaveHigh, SinValue));
+		Phase = _mm512_add_epi32(Phase, Step16);
+	}
+	NcoScalar(CarrierPhase + CarrierStep * Count16, CarrierStep, Count - Count16, Output + Count16);
+}
+
+TARGET_AVX512 static void NcoAvx512(unsigned int CarrierPhase, unsigned int CarrierStep, int Count, complex_int16 *Output)
+{
+	const FastMath::CarrierNco Nco = FastMath::GetCarrierNco();
+	int i, Count16 = Count & ~15;
+	__m512i Phase = _mm512_add_epi32(_mm512_set1_epi32((int)CarrierPhase), _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32((int)CarrierStep)));
+	__m512i Step16 = _mm512_set1_epi32((int)(CarrierStep * 16));
+	__m512i LowMask = _mm512_set1_epi32(0xffff);
+	__m512i CosValue, SinValue;
+
+	for (i = 0; i < Count16; i += 16)
+	{
+		CarrierAvx512(Nco, Phase, CosValue, SinValue);
+		_mm512_storeu_si512(Output + i, _mm512_or_si512(_mm512_and_si512(CosValue, LowMask), _mm512_slli_epi32(SinValue, 16)));
+		Phase = _mm512_add_epi32(Phase, Step16);
+	}
+	NcoScalar(CarrierPhase + CarrierStep * Count16, CarrierStep, Count - Count16, Output + Count16);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+//*************** CPU feature detection ****************
+static void CpuId(unsigned int Leaf, unsigned int SubLeaf, unsigned int Reg[4])
+{
+#if defined(_MSC_VER)
+	int Info[4];
+	__cpuidex(Info, (int)Leaf, (int)SubLeaf);
+	Reg[0] = Info[0]; Reg[1] = Info[1]; Reg[2] = Info[2]; Reg[3] = Info[3];
+#else
+	__cpuid_count(Leaf, SubLeaf, Reg[0], Reg[1], Reg[2], Reg[3]);
+#endif
+}
+
+// get OS enabled register state (XCR0), call only when OSXSAVE is set
+static unsigned long long GetXcr0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int Low, High;
+	__asm__ __volatile__("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+	return ((unsigned long long)High << 32) | Low;
+#endif
+}
+#endif
+
+// highest kernel supported by both CPU and OS
+IfKernelIsa DetectIfKernelIsa()
+{
+#if defined(IF_KERNEL_X86)
+	unsigned int Reg[4], MaxLeaf;
+	unsigned long long Xcr0 = 0;
+	IfKernelIsa Isa = IfKernelScalar;
+
+	CpuId(0, 0, Reg);
+	MaxLeaf = Reg[0];
+	if (MaxLeaf < 1)
+		return IfKernelScalar;
+	CpuId(1, 0, Reg);
+	if (Reg[2] & (1 << 20))	// SSE4.2
+		Isa = IfKernelSse42;
+	if (!(Reg[2] & (1 << 27)) || !(Reg[2] & (1 << 28)) || MaxLeaf < 7)	// no OSXSAVE or AVX
+		return Isa;
+	Xcr0 = GetXcr0();
+	if ((Xcr0 & 0x6) != 0x6)	// XMM/YMM state not enabled by OS
+		return Isa;
+	CpuId(7, 0, Reg);
+	if (Reg[1] & (1 << 5))	// AVX2
+		Isa = IfKernelAvx2;
+	else
+		return Isa;
+	if ((Reg[1] & (1 << 16)) && (Xcr0 & 0xe6) == 0xe6)	// AVX-512F with opmask/ZMM state enabled
+		Isa = IfKernelAvx512;
+	return Isa;
+#else
+	return IfKernelScalar;
+#endif
+}
+
+BOOL IfKernelSupported(IfKernelIsa Isa)
+{
+	static IfKernelIsa MaxIsa = DetectIfKernelIsa();
+
+	if (Isa == IfKernelAuto)
+		return TRUE;
+	return (Isa >= IfKernelScalar && Isa <= MaxIsa) ? TRUE : FALSE;
+}
+
+BOOL SetIfKernelIsa(IfKernelIsa Isa)
+{
+	if (!IfKernelSupported(Isa))
+		return FALSE;
+	CurrentIsa = (Isa == IfKernelAuto) ? DetectIfKernelIsa() : Isa;
+	return TRUE;
+}
+
+IfKernelIsa GetIfKernelIsa()
+{
+	return CurrentIsa;
+}
+
+const char *IfKernelName(IfKernelIsa Isa)
+{
+	switch (Isa)
+	{
+	case IfKernelScalar: return "scalar";
+	case IfKernelSse42: return "sse4.2";
+	case IfKernelAvx2: return "avx2";
+	case IfKernelAvx512: return "avx512";
+	default: return "auto";
+	}
+}
+
+// return IfKernelAuto for unknown name
+IfKernelIsa IfKernelFromName(const char *Name)
+{
+	int i;
+
+	for (i = IfKernelScalar; i < IfKernelAuto; i ++)
+		if (strcmp(Name, IfKernelName((IfKernelIsa)i)) == 0)
+			return (IfKernelIsa)i;
+	return IfKernelAuto;
+}
+
+void SetIfChipRunMode(IfChipRunMode Mode)
+{
+	CurrentChipRun = Mode;
+}
+
+IfChipRunMode GetIfChipRunMode()
+{
+	return CurrentChipRun;
+}
+
+// get PRN variant from segment attribute and code pointers
+unsigned int GetIfPrnVariant(const IF_SEGMENT_PARAM *Param)
+{
+	unsigned int Variant = 0;
+
+	if (Param->Attribute & PRN_ATTRIBUTE_BOC)
+		Variant |= IF_PRN_BOC;
+	if (Param->Attribute & PRN_ATTRIBUTE_TMD)
+		Variant |= IF_PRN_TMD;
+	if (Param->PilotPrn)
+		Variant |= IF_PRN_PILOT;
+	if (Param->CombinedPrn && Param->PilotPrn)	// data bit of combined code is the same as data code
+		Variant |= IF_PRN_COMBINED;
+	if ((Variant & IF_PRN_BOC) && (Variant & IF_PRN_TMD))	// no such signal, no specialized kernel
+		Variant = IF_PRN_GENERIC;
+	// BPSK data+pilot from combined code measured slower than generic kernel (GPS L5), use generic one
+	if (Variant == (IF_PRN_COMBINED | IF_PRN_PILOT))
+		Variant = IF_PRN_GENERIC;
+	return Variant;
+}
+
+const char *IfPrnVariantName(unsigned int Variant)
+{
+	// variants not given by GetIfPrnVariant() use generic kernel
+	static const char *VariantName[IF_PRN_GENERIC] = {
+		"BPSK", "BOC", "TMD", "generic", "BPSK+pilot", "BOC+pilot", "TMD+pilot", "generic",
+		"generic", "generic", "generic", "generic", "generic", "BOC+pilot/cmb", "TMD+pilot/cmb", "generic",
+	};
+
+	return (Variant < IF_PRN_GENERIC) ? VariantName[Variant] : "generic";
+}
+
+void SetIfPrnSpecialized(BOOL Enable)
+{
+	CurrentPrnSpecialized = Enable;
+}
+
+BOOL GetIfPrnSpecialized()
+{
+	return CurrentPrnSpecialized;
+}
+
+#if defined(IF_KERNEL_X86)
+// GCC does not insert vzeroupper at return of functions with AVX target attribute, so clear
+// upper half of YMM/ZMM registers after AVX kernels, otherwise following legacy SSE code
+// (chip run fill, libm, caller's mixing loop) runs with AVX-SSE transition penalty
+TARGET_AVX2 static void ZeroUpperAvx()
+{
+	_mm256_zeroupper();
+}
+#endif
+
+// per-sample kernel of given instruction set
+template <unsigned int Variant, typename T> static void IfSegmentIsa(const IF_SEGMENT_PARAM *Param, T *Output, IfKernelIsa Isa)
+{
+	switch (Isa)
+	{
+#if defined(IF_KERNEL_X86)
+	case IfKernelSse42: IfSegmentSse42<Variant>(Param, Output); break;
+	case IfKernelAvx2: IfSegmentAvx2<Variant>(Param, Output); ZeroUpperAvx(); break;
+	case IfKernelAvx512: IfSegmentAvx512<Variant>(Param, Output); ZeroUpperAvx(); break;
+#endif
+	default: IfSegmentScalar<Variant>(Param, Output, 0, Param->SampleCount); break;
+	}
+}
+
+// carrier rotation of chip run engine of given instruction set
+template <typename T> static void RotateIsa(const typename IfSampleTraits<T>::ValueType *PrnReal, const typename IfSampleTraits<T>::ValueType *PrnImag, unsigned int CarrierPhase, unsigned int CarrierStep, int Count, T *Output, IfKernelIsa Isa)
+{
+	switch (Isa)
+	{
+#if defined(IF_KERNEL_X86)
+	case IfKernelSse42: RotateSse42(PrnReal, PrnImag, CarrierPhase, CarrierStep, Count, Output); break;
+	case IfKernelAvx2: RotateAvx2(PrnReal, PrnImag, CarrierPhase, CarrierStep, Count, Output); ZeroUpperAvx(); break;
+	case IfKernelAvx512: RotateAvx512(PrnReal, PrnImag, CarrierPhase, CarrierStep, Count, Output); ZeroUpperAvx(); break;
+#endif
+	default: RotateScalar(PrnReal, PrnImag, CarrierPhase, CarrierStep, Count, Output); break;
+	}
+}
+
+// generate segment with chip run engine, PRN expanded block by block then rotated by carrier
+template <unsigned int Variant, typename T> static void IfSegmentChipRun(const IF_SEGMENT_PARAM *Param, T *Output, IfKernelIsa Isa)
+{
+	typedef typename IfSampleTraits<T>::ValueType ValueType;
+	ValueType PrnReal[CHIP_RUN_BLOCK + CHIP_RUN_PAD], PrnImag[CHIP_RUN_BLOCK + CHIP_RUN_PAD];
+	unsigned int CarrierStep = (unsigned int)Param->CarrierStep;
+	unsigned int CarrierPhase;
+	int i, Count;
+
+	for (i = 0; i < Param->SampleCount; i += Count)
+	{
+		Count = Param->SampleCount - i;
+		if (Count > CHIP_RUN_BLOCK)
+			Count = CHIP_RUN_BLOCK;
+		ChipRunFill<Variant>(Param, i, i + Count, PrnReal, PrnImag);
+		CarrierPhase = Param->CarrierPhase + (unsigned int)i * CarrierStep;
+		RotateIsa(PrnReal, PrnImag, CarrierPhase, CarrierStep, Count, Output + i, Isa);
+	}
+}
+
+template <unsigned int Variant, typename T> static void GenerateVariant(const IF_SEGMENT_PARAM *Param, T *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	if (ChipRun == IfChipRunOn)
+		IfSegmentChipRun<Variant>(Param, Output, Isa);
+	else
+		IfSegmentIsa<Variant>(Param, Output, Isa);
+}
+
+template <typename T> static void GenerateSegment(const IF_SEGMENT_PARAM *Param, T *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	if (Isa == IfKernelAuto)
+		Isa = CurrentIsa;
+	if (ChipRun == IfChipRunDefault)
+		ChipRun = CurrentChipRun;
+	if (ChipRun == IfChipRunAuto)	// use chip run engine if enough samples within each chip
+		ChipRun = (4294967296. / Param->ChipStep >= ChipRunThreshold[Isa]) ? IfChipRunOn : IfChipRunOff;
+	switch (CurrentPrnSpecialized ? Param->PrnVariant : IF_PRN_GENERIC)
+	{
+	case 0: GenerateVariant<0>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_BOC: GenerateVariant<IF_PRN_BOC>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_TMD: GenerateVariant<IF_PRN_TMD>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_PILOT: GenerateVariant<IF_PRN_PILOT>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_PILOT | IF_PRN_BOC: GenerateVariant<IF_PRN_PILOT | IF_PRN_BOC>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_PILOT | IF_PRN_TMD: GenerateVariant<IF_PRN_PILOT | IF_PRN_TMD>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_COMBINED | IF_PRN_PILOT | IF_PRN_BOC: GenerateVariant<IF_PRN_COMBINED | IF_PRN_PILOT | IF_PRN_BOC>(Param, Output, Isa, ChipRun); break;
+	case IF_PRN_COMBINED | IF_PRN_PILOT | IF_PRN_TMD: GenerateVariant<IF_PRN_COMBINED | IF_PRN_PILOT | IF_PRN_TMD>(Param, Output, Isa, ChipRun); break;
+	default: GenerateVariant<IF_PRN_GENERIC>(Param, Output, Isa, ChipRun); break;
+	}
+}
+
+// carrier NCO of given instruction set, SSE4.2 has no gather so uses scalar version
+template <typename T> static void GenerateNco(unsigned int CarrierPhase, int CarrierStep, int Count, T *Output, IfKernelIsa Isa)
+{
+	if (Isa == IfKernelAuto)
+		Isa = CurrentIsa;
+	switch (Isa)
+	{
+#if defined(IF_KERNEL_X86)
+	case IfKernelAvx2: NcoAvx2(CarrierPhase, (unsigned int)CarrierStep, Count, Output); ZeroUpperAvx(); break;
+	case IfKernelAvx512: NcoAvx512(CarrierPhase, (unsigned int)CarrierStep, Count, Output); ZeroUpperAvx(); break;
+#endif
+	default: NcoScalar(CarrierPhase, (unsigned int)CarrierStep, Count, Output); break;
+	}
+}
+
+void GenerateCarrier(unsigned int CarrierPhase, int CarrierStep, int Count, complex_number *Output, IfKernelIsa Isa)
+{
+	GenerateNco(CarrierPhase, CarrierStep, Count, Output, Isa);
+}
+
+void GenerateCarrier(unsigned int CarrierPhase, int CarrierStep, int Count, complex_float *Output, IfKernelIsa Isa)
+{
+	GenerateNco(CarrierPhase, CarrierStep, Count, Output, Isa);
+}
+
+void GenerateCarrier(unsigned int CarrierPhase, int CarrierStep, int Count, complex_int16 *Output, IfKernelIsa Isa)
+{
+	GenerateNco(CarrierPhase, CarrierStep, Count, Output, Isa);
+}
+
+void GenerateIfSegment(const IF_SEGMENT_PARAM *Param, complex_number *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	GenerateSegment(Param, Output, Isa, ChipRun);
+}
+
+void GenerateIfSegment(const IF_SEGMENT_PARAM *Param, complex_float *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	GenerateSegment(Param, Output, Isa, ChipRun);
+}
+
+void GenerateIfSegment(const IF_SEGMENT_PARAM *Param, complex_int16 *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	GenerateSegment(Param, Output, Isa, ChipRun);
+}
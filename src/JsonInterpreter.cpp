@@ -34,6 +34,8 @@ static const char *KeyDictionaryListEphAlm[] = {
 static const char *KeyDictionaryListOutput[] = {
 //     0        1        2         3          4            5               6             7          8        9       10        11          12            13
 	"type", "format", "name", "interval", "config", "systemSelect", "elevationMask", "maskOut", "system", "svid", "signal", "enable", "sampleFreq", "centerFreq",
+//      14
+	"sampleType",
 };
 static const char *KeyDictionaryListPower[] = {
 //       0             1              2                 3           4       5         6        7         8            9      10
@@ -63,6 +65,10 @@ static const char *DictionaryListOutputFormat[] = {
 //     0      1       2      3       4        5      6      7      8	
 	"ECEF", "LLA", "NMEA", "KML", "RINEX", "IQ16", "IQ8", "IQ4", "IQ2",
 };
+static const char *DictionaryListSampleType[] = {
+//     0         1        2
+	"double", "float", "int16",
+};
 static const char *DictionaryListSignal[] = {
 //    0      1      2      3      4      5     6   7
 	"L1CA","L1C", "L2C", "L2P", "L5",  "",    "", "",
@@ -276,6 +282,7 @@ BOOL SetOutputParam(JsonObject *Object, OUTPUT_PARAM &OutputParam)
 	OutputParam.BdsMaskOut = OutputParam.GalileoMaskOut = 0LL;
 	OutputParam.ElevationMask = DEG2RAD(5);
 	OutputParam.Interval = 1000;
+	OutputParam.SampleType = IfSampleDouble;
 	// default output GPS L1 only
 	OutputParam.FreqSelect[0] = 0x1;
 	OutputParam.FreqSelect[1] = OutputParam.FreqSelect[2] = OutputParam.FreqSelect[3] = 0;
@@ -315,6 +322,10 @@ BOOL SetOutputParam(JsonObject *Object, OUTPUT_PARAM &OutputParam)
 			OutputParam.SampleFreq = (int)(GET_DOUBLE_VALUE(Object) * 1000 + 0.5); break;
 		case 13:	// "centerFreq"
 			OutputParam.CenterFreq = (int)(GET_DOUBLE_VALUE(Object) * 1000 + 0.5); break;
+		case 14:	// "sampleType"
+			if (Object->Type == JsonObject::ValueTypeString && SearchDictionary(Object->String, PARAMETER(DictionaryListSampleType)) >= 0)
+				OutputParam.SampleType = (IfSampleType)SearchDictionary(Object->String, PARAMETER(DictionaryListSampleType));
+			break;
 		}
 	}
 
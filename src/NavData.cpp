@@ -15,6 +15,7 @@
 #include "Almanac.h"
 #include "GnssTime.h"
 #include "MessageOutput.h"
+#include "Coordinate.h"
 
 #ifdef _WIN32
 #define IS_ABSOLUTE(path) (isalpha((path)[0]) && (path)[1] == ':')
@@ -46,9 +47,13 @@ CNavData::CNavData()
 
 CNavData::~CNavData()
 {
+	int i;
+
 	free(GpsEphemerisPool);
 	free(BdsEphemerisPool);
 	free(GalileoEphemerisPool);
+	for (i = 0; i < GlonassEphemerisNumber; i ++)
+		free(GlonassEphemerisPool[i].OrbitTable);
 	free(GlonassEphemerisPool);
 }
 
@@ -212,6 +217,8 @@ bool CNavData::AddNavData(NavDataType Type, void *NavData)
 			GlonassEphemerisPool = (PGLONASS_EPHEMERIS)NewEphmerisPool;
 		}
 		memcpy(&GlonassEphemerisPool[GlonassEphemerisNumber], NavData, sizeof(GLONASS_EPHEMERIS));
+		// integrate orbit once, position within validity interpolated from table
+		GlonassEphemerisPool[GlonassEphemerisNumber].OrbitTable = BuildGlonassOrbitTable(&GlonassEphemerisPool[GlonassEphemerisNumber]);
 		GlonassEphemerisNumber ++;
 		break;
 	case NavDataGpsUtc:
@@ -0,0 +1,523 @@
+//----------------------------------------------------------------------
+// OrbitBatch.cpp:
+//   Implementation of batched satellite orbit calculation of GPS/BDS/Galileo
+//   ephemerides with runtime instruction set dispatch
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+#include <math.h>
+
+#include "ConstVal.h"
+#include "BasicTypes.h"
+#include "Coordinate.h"
+#include "FastMath.h"
+#include "OrbitBatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IF_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+// Newton iterations of Kepler equation starting from Mk, error after 4 iterations is below
+// 1e-18 rad for eccentricity up to 0.3 (quadratic convergence from initial error below ecc)
+#define KEPLER_ITERATION 4
+
+// sin/cos: x reduced by k*pi/2 (Cody-Waite with 31+32 bit pi/2 so that k*PIO2_1 and
+// k*PIO2_2 are exact), fdlibm polynomials within [-pi/4, pi/4]
+#define TWO_OVER_PI 6.36619772367581382433e-01
+#define ROUND_MAGIC 6755399441055744.0	// 1.5*2^52, adding it rounds to integer with integer in low mantissa bits
+#define PIO2_1 1.57079632673412561417e+00
+#define PIO2_2 6.07710050630396597660e-11
+#define PIO2_2T 2.02226624879595063154e-21
+#define SIN_S1 -1.66666666666666324348e-01
+#define SIN_S2 8.33333333332248946124e-03
+#define SIN_S3 -1.98412698298579493134e-04
+#define SIN_S4 2.75573137070700676789e-06
+#define SIN_S5 -2.50507602534068634195e-08
+#define SIN_S6 1.58969099521155010221e-10
+#define COS_C1 4.16666666666666019037e-02
+#define COS_C2 -1.38888888888741095749e-03
+#define COS_C3 2.48015872894767294178e-05
+#define COS_C4 -2.75573143513906633035e-07
+#define COS_C5 2.08757232129817482790e-09
+#define COS_C6 -1.13596475577881948265e-11
+
+// atan: Cephes rational approximation within [0, 0.66], (t-1)/(t+1)+pi/4 within [0.66, 1]
+#define ATAN_SPLIT 0.66
+#define ATAN_P0 -8.750608600031904122785e-01
+#define ATAN_P1 -1.615753718733365076637e+01
+#define ATAN_P2 -7.500855792314704667340e+01
+#define ATAN_P3 -1.228866684490136173410e+02
+#define ATAN_P4 -6.485021904942025371773e+01
+#define ATAN_Q0 2.485846490142306297962e+01
+#define ATAN_Q1 1.650270098316988542046e+02
+#define ATAN_Q2 4.328810604912902668951e+02
+#define ATAN_Q3 4.853903996359136964868e+02
+#define ATAN_Q4 1.945506571482613964425e+02
+#define PI_HI 3.14159265358979311600e+00
+#define PI_LO 1.22464679914735317723e-16
+#define PIO2_HI 1.57079632679489655800e+00
+#define PIO2_LO 6.12323399573676588613e-17
+#define PIO4_HI 7.85398163397448278999e-01
+
+static bool Avx2Supported();
+static void OrbitScalar(const ORBIT_BATCH *Batch, int Start, int End, double TransmitTime, KINEMATIC_INFO PosVel[], double Acc[][3]);
+#if defined(IF_KERNEL_X86)
+static void OrbitAvx2(const ORBIT_BATCH *Batch, double TransmitTime, KINEMATIC_INFO PosVel[], double Acc[][3]);
+#endif
+
+int SetOrbitBatch(PORBIT_BATCH Batch, GnssSystem system, const GPS_EPHEMERIS *const Eph[], int Number)
+{
+	int i, Index;
+
+	if (Number > ORBIT_BATCH_SIZE)
+		Number = ORBIT_BATCH_SIZE;
+	Batch->system = system;
+	Batch->SatNumber = Number;
+	if (Number == 0)
+		return 0;
+	// pad to multiple of vector width with last satellite
+	for (i = 0; i < ((Number + ORBIT_BATCH_WIDTH - 1) & ~(ORBIT_BATCH_WIDTH - 1)); i ++)
+	{
+		Index = (i < Number) ? i : Number - 1;
+		Batch->Eph[i] = Eph[Index];
+		Batch->toe[i] = (double)Eph[Index]->toe;
+		Batch->toc[i] = (double)Eph[Index]->toc;
+		Batch->M0[i] = Eph[Index]->M0;
+		Batch->n[i] = Eph[Index]->n;
+		Batch->delta_n_dot[i] = Eph[Index]->delta_n_dot;
+		Batch->ecc[i] = Eph[Index]->ecc;
+		Batch->root_ecc[i] = Eph[Index]->root_ecc;
+		Batch->w[i] = Eph[Index]->w;
+		Batch->axis[i] = Eph[Index]->axis;
+		Batch->axis_dot[i] = Eph[Index]->axis_dot;
+		Batch->i0[i] = Eph[Index]->i0;
+		Batch->idot[i] = Eph[Index]->idot;
+		Batch->omega_t[i] = Eph[Index]->omega_t;
+		Batch->omega_delta[i] = Eph[Index]->omega_delta;
+		Batch->cuc[i] = Eph[Index]->cuc;
+		Batch->cus[i] = Eph[Index]->cus;
+		Batch->crc[i] = Eph[Index]->crc;
+		Batch->crs[i] = Eph[Index]->crs;
+		Batch->cic[i] = Eph[Index]->cic;
+		Batch->cis[i] = Eph[Index]->cis;
+		Batch->af0[i] = Eph[Index]->af0;
+		Batch->af1[i] = Eph[Index]->af1;
+		Batch->af2[i] = Eph[Index]->af2;
+	}
+	return Number;
+}
+
+void OrbitBatchPosSpeed(const ORBIT_BATCH *Batch, double TransmitTime, KINEMATIC_INFO PosVel[], double Acc[][3], double ClockCorrection[], bool Valid[], IfKernelIsa Isa)
+{
+	double AccBuffer[ORBIT_BATCH_SIZE][3], (*AccOut)[3] = Acc ? Acc : AccBuffer;
+	double DeltaT;
+	int i;
+	static const bool UseAvx2 = Avx2Supported();
+
+	if (Isa == IfKernelAuto || ((Isa == IfKernelAvx2 || Isa == IfKernelAvx512) && !UseAvx2))
+		Isa = UseAvx2 ? IfKernelAvx2 : IfKernelScalar;
+	switch (Isa)
+	{
+#if defined(IF_KERNEL_X86)
+	case IfKernelAvx2:
+	case IfKernelAvx512: OrbitAvx2(Batch, TransmitTime, PosVel, AccOut); break;
+#endif
+	default: OrbitScalar(Batch, 0, Batch->SatNumber, TransmitTime, PosVel, AccOut); break;
+	}
+
+	for (i = 0; i < Batch->SatNumber; i ++)
+	{
+		DeltaT = TransmitTime - Batch->toe[i];
+		if (DeltaT > 302400.0)
+			DeltaT -= 604800;
+		if (DeltaT < -302400.0)
+			DeltaT += 604800;
+		if (Batch->system == BdsSystem && (Batch->Eph[i]->svid <= 5 || Batch->Eph[i]->svid >= 59))
+			BdsGeoToCgcs2000(DeltaT, &PosVel[i], Acc ? Acc[i] : NULL);
+		if (Valid)
+			Valid[i] = (fabs(DeltaT) <= ((Batch->system == BdsSystem) ? 3600.0 : 7200.0));
+		if (ClockCorrection)
+		{
+			DeltaT = TransmitTime - Batch->toc[i];
+			if (DeltaT > 302400.0)
+				DeltaT -= 604800;
+			if (DeltaT < -302400.0)
+				DeltaT += 604800;
+			ClockCorrection[i] = (Batch->af0[i] + (Batch->af1[i] + Batch->af2[i] * DeltaT) * DeltaT) * (1 - Batch->af1[i]);
+		}
+	}
+}
+
+// CPU and OS support of AVX2, detected here as the ObsGen tools do not link IF sample kernels
+static bool Avx2Supported()
+{
+#if defined(IF_KERNEL_X86)
+	unsigned int Reg[4];
+	unsigned long long Xcr0;
+#if defined(_MSC_VER)
+	int Info[4];
+
+	__cpuidex(Info, 0, 0);
+	if (Info[0] < 7)
+		return false;
+	__cpuidex(Info, 1, 0);
+	Reg[2] = (unsigned int)Info[2];
+	if (!(Reg[2] & (1 << 27)) || !(Reg[2] & (1 << 28)))	// no OSXSAVE or AVX
+		return false;
+	Xcr0 = _xgetbv(0);
+	__cpuidex(Info, 7, 0);
+	Reg[1] = (unsigned int)Info[1];
+#else
+	unsigned int Low, High;
+
+	__cpuid_count(0, 0, Reg[0], Reg[1], Reg[2], Reg[3]);
+	if (Reg[0] < 7)
+		return false;
+	__cpuid_count(1, 0, Reg[0], Reg[1], Reg[2], Reg[3]);
+	if (!(Reg[2] & (1 << 27)) || !(Reg[2] & (1 << 28)))	// no OSXSAVE or AVX
+		return false;
+	__asm__ __volatile__("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+	Xcr0 = ((unsigned long long)High << 32) | Low;
+	__cpuid_count(7, 0, Reg[0], Reg[1], Reg[2], Reg[3]);
+#endif
+	return ((Xcr0 & 0x6) == 0x6) && (Reg[1] & (1 << 5));	// YMM state enabled by OS and AVX2
+#else
+	return false;
+#endif
+}
+
+//----------------------------------------------------------------------
+// Scalar kernel, reference of vector kernel, each operation in the same order
+//----------------------------------------------------------------------
+
+static FORCE_INLINE void SinCosScalar(double x, double &SinValue, double &CosValue)
+{
+	double y = x * TWO_OVER_PI + ROUND_MAGIC;
+	double k = y - ROUND_MAGIC;
+	double r = x - k * PIO2_1 - k * PIO2_2 - k * PIO2_2T;
+	double z = r * r;
+	double s = r + r * z * (SIN_S1 + z * (SIN_S2 + z * (SIN_S3 + z * (SIN_S4 + z * (SIN_S5 + z * SIN_S6)))));
+	double c = 1.0 - 0.5 * z + z * z * (COS_C1 + z * (COS_C2 + z * (COS_C3 + z * (COS_C4 + z * (COS_C5 + z * COS_C6)))));
+	int Quadrant = (int)k & 3;
+
+	SinValue = (Quadrant & 1) ? c : s;
+	CosValue = (Quadrant & 1) ? s : c;
+	if (Quadrant & 2)
+		SinValue = -SinValue;
+	if ((Quadrant + 1) & 2)
+		CosValue = -CosValue;
+}
+
+static FORCE_INLINE double Atan2Scalar(double y, double x)
+{
+	double AbsX = fabs(x), AbsY = fabs(y);
+	double Max = (AbsX > AbsY) ? AbsX : AbsY;
+	double Min = (AbsX < AbsY) ? AbsX : AbsY;
+	double t = Min / Max;
+	bool Upper = (t > ATAN_SPLIT);
+	double u = Upper ? (t - 1.0) / (t + 1.0) : t;
+	double z = u * u;
+	double a;
+
+	z = z * ((((ATAN_P0 * z + ATAN_P1) * z + ATAN_P2) * z + ATAN_P3) * z + ATAN_P4) / (((((z + ATAN_Q0) * z + ATAN_Q1) * z + ATAN_Q2) * z + ATAN_Q3) * z + ATAN_Q4);
+	a = (Upper ? PIO4_HI : 0.0) + (u * z + u + (Upper ? 0.5 * PIO2_LO : 0.0));
+	if (AbsY > AbsX)
+		a = PIO2_HI - a + PIO2_LO;
+	if (x < 0)
+		a = PI_HI - a + PI_LO;
+	return (y < 0) ? -a : a;
+}
+
+// same calculation as GpsSatPosSpeedEph() without BDS GEO rotation
+static void OrbitScalar(const ORBIT_BATCH *Batch, int Start, int End, double TransmitTime, KINEMATIC_INFO PosVel[], double Acc[][3])
+{
+	int i, j;
+	double delta_t, alpha, beta;
+	double Mk, Ek, Ek1, sin_e, cos_e;
+	double phi, phi_dot, phi_dot2;
+	double uk, rk, ik;
+	double duk, drk, dik;
+	double uk_dot, rk_dot, ik_dot;
+	double duk_dot, drk_dot, dik_dot;
+	double uk_dot2, rk_dot2, ik_dot2;
+	double Ek_dot, Ek_dot2;
+	double xp, yp, xp_dot, yp_dot, xp_dot2, yp_dot2;
+	double sin_temp, cos_temp, sin_o, cos_o, sin_i, cos_i, omega;
+	double x, y, z, vx, vy, vz;
+
+	for (i = Start; i < End; i ++)
+	{
+		delta_t = TransmitTime - Batch->toe[i];
+		if (delta_t > 302400.0)
+			delta_t -= 604800.0;
+		if (delta_t < -302400.0)
+			delta_t += 604800.0;
+
+		// Kepler equation with fixed number of Newton iterations
+		alpha = Batch->delta_n_dot[i] * delta_t;
+		Ek = Mk = Batch->M0[i] + (Batch->n[i] + alpha * 0.5) * delta_t;
+		for (j = 0; j < KEPLER_ITERATION; j ++)
+		{
+			SinCosScalar(Ek, sin_e, cos_e);
+			Ek = Ek - (Ek - Batch->ecc[i] * sin_e - Mk) / (1.0 - Batch->ecc[i] * cos_e);
+		}
+		SinCosScalar(Ek, sin_e, cos_e);
+		Ek1 = 1.0 - Batch->ecc[i] * cos_e;
+
+		phi = Atan2Scalar(Batch->root_ecc[i] * sin_e, cos_e - Batch->ecc[i]) + Batch->w[i];
+		SinCosScalar(phi + phi, sin_temp, cos_temp);
+		// u(k), r(k) and i(k) with 2nd order correction
+		rk = (Batch->axis[i] + Batch->axis_dot[i] * delta_t) * Ek1;
+		ik = Batch->i0[i] + Batch->idot[i] * delta_t;
+		duk = Batch->cuc[i] * cos_temp + Batch->cus[i] * sin_temp;
+		drk = Batch->crc[i] * cos_temp + Batch->crs[i] * sin_temp;
+		dik = Batch->cic[i] * cos_temp + Batch->cis[i] * sin_temp;
+		uk = phi + duk;
+		rk = rk + drk;
+		ik = ik + dik;
+		// derivatives of r(k), u(k) and i(k)
+		Ek_dot = (Batch->n[i] + alpha) / Ek1;
+		uk_dot = Ek_dot * Batch->root_ecc[i] / Ek1;
+		phi_dot = uk_dot * 2.0;
+		rk_dot = Batch->axis[i] * Batch->ecc[i] * sin_e * Ek_dot + Batch->axis_dot[i] * Ek1;
+		drk_dot = (Batch->crs[i] * cos_temp - Batch->crc[i] * sin_temp) * phi_dot;
+		duk_dot = (Batch->cus[i] * cos_temp - Batch->cuc[i] * sin_temp) * phi_dot;
+		dik_dot = (Batch->cis[i] * cos_temp - Batch->cic[i] * sin_temp) * phi_dot;
+		rk_dot = rk_dot + drk_dot;
+		uk_dot = uk_dot + duk_dot;
+		ik_dot = Batch->idot[i] + dik_dot;
+		// second order derivatives
+		Ek_dot2 = -Ek_dot * Ek_dot * Batch->ecc[i] * sin_e / Ek1;
+		phi_dot2 = 2.0 * Ek_dot2 * Batch->root_ecc[i] / Ek1;
+		alpha = 2.0 * phi_dot2 / phi_dot;
+		beta = phi_dot * phi_dot;
+		rk_dot2 = Batch->axis[i] * Batch->ecc[i] * (sin_e * Ek_dot2 + cos_e * Ek_dot * Ek_dot);
+		rk_dot2 = rk_dot2 + (alpha * drk_dot - beta * drk);
+		uk_dot2 = phi_dot2 + alpha * duk_dot - beta * duk;
+		ik_dot2 = alpha * dik_dot - beta * dik;
+
+		// Xp and Yp and derivatives
+		SinCosScalar(uk, sin_temp, cos_temp);
+		xp = rk * cos_temp;
+		yp = rk * sin_temp;
+		xp_dot = rk_dot * cos_temp - yp * uk_dot;
+		yp_dot = rk_dot * sin_temp + xp * uk_dot;
+		xp_dot2 = rk_dot2 * cos_temp - 2.0 * uk_dot * rk_dot * sin_temp - uk_dot * uk_dot * xp - uk_dot2 * yp;
+		yp_dot2 = rk_dot2 * sin_temp + 2.0 * uk_dot * rk_dot * cos_temp - uk_dot * uk_dot * yp + uk_dot2 * xp;
+
+		// position, velocity and acceleration in ECEF
+		omega = Batch->omega_t[i] + Batch->omega_delta[i] * delta_t;
+		SinCosScalar(omega, sin_o, cos_o);
+		SinCosScalar(ik, sin_i, cos_i);
+		z = yp * sin_i;
+		vz = yp_dot * sin_i;
+		x = xp * cos_o - yp * cos_i * sin_o;
+		y = xp * sin_o + yp * cos_i * cos_o;
+		phi_dot = yp_dot * cos_i - z * ik_dot;
+		vx = xp_dot * cos_o - phi_dot * sin_o;
+		vy = xp_dot * sin_o + phi_dot * cos_o;
+		vx = vx - y * Batch->omega_delta[i];
+		vy = vy + x * Batch->omega_delta[i];
+		vz = vz + yp * ik_dot * cos_i;
+		alpha = vz * ik_dot + z * ik_dot2 - xp_dot * Batch->omega_delta[i];
+		alpha = alpha + (yp_dot * ik_dot * sin_i - yp_dot2 * cos_i);
+		beta = xp_dot2 + z * ik_dot * Batch->omega_delta[i] - yp_dot * Batch->omega_delta[i] * cos_i;
+		PosVel[i].x = x; PosVel[i].y = y; PosVel[i].z = z;
+		PosVel[i].vx = vx; PosVel[i].vy = vy; PosVel[i].vz = vz;
+		Acc[i][0] = -vy * Batch->omega_delta[i] + alpha * sin_o + beta * cos_o;
+		Acc[i][1] = vx * Batch->omega_delta[i] - alpha * cos_o + beta * sin_o;
+		Acc[i][2] = (yp_dot2 - yp * ik_dot * ik_dot) * sin_i + (yp * ik_dot2 + 2.0 * yp_dot * ik_dot) * cos_i;
+	}
+}
+
+//----------------------------------------------------------------------
+// AVX2 kernel, ORBIT_BATCH_WIDTH satellites in each loop
+//----------------------------------------------------------------------
+#if defined(IF_KERNEL_X86)
+
+TARGET_AVX2 static FORCE_INLINE __m256d Poly6Avx2(__m256d z, double c0, double c1, double c2, double c3, double c4, double c5)
+{
+	__m256d p = _mm256_add_pd(_mm256_set1_pd(c4), _mm256_mul_pd(z, _mm256_set1_pd(c5)));
+	p = _mm256_add_pd(_mm256_set1_pd(c3), _mm256_mul_pd(z, p));
+	p = _mm256_add_pd(_mm256_set1_pd(c2), _mm256_mul_pd(z, p));
+	p = _mm256_add_pd(_mm256_set1_pd(c1), _mm256_mul_pd(z, p));
+	return _mm256_add_pd(_mm256_set1_pd(c0), _mm256_mul_pd(z, p));
+}
+
+TARGET_AVX2 static FORCE_INLINE void SinCosAvx2(__m256d x, __m256d &SinValue, __m256d &CosValue)
+{
+	const __m256i One = _mm256_set1_epi64x(1), Two = _mm256_set1_epi64x(2);
+	__m256d y = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(TWO_OVER_PI)), _mm256_set1_pd(ROUND_MAGIC));
+	__m256d k = _mm256_sub_pd(y, _mm256_set1_pd(ROUND_MAGIC));
+	__m256i Quadrant = _mm256_castpd_si256(y);	// k in low bits of mantissa
+	__m256d r = _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(PIO2_1))), _mm256_mul_pd(k, _mm256_set1_pd(PIO2_2))), _mm256_mul_pd(k, _mm256_set1_pd(PIO2_2T)));
+	__m256d z = _mm256_mul_pd(r, r);
+	__m256d s = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), Poly6Avx2(z, SIN_S1, SIN_S2, SIN_S3, SIN_S4, SIN_S5, SIN_S6)));
+	__m256d c = _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(0.5), z)), _mm256_mul_pd(_mm256_mul_pd(z, z), Poly6Avx2(z, COS_C1, COS_C2, COS_C3, COS_C4, COS_C5, COS_C6)));
+	__m256d Swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(Quadrant, One), One));
+
+	SinValue = _mm256_blendv_pd(s, c, Swap);
+	CosValue = _mm256_blendv_pd(c, s, Swap);
+	SinValue = _mm256_xor_pd(SinValue, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(Quadrant, Two), 62)));
+	CosValue = _mm256_xor_pd(CosValue, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(Quadrant, One), Two), 62)));
+}
+
+TARGET_AVX2 static FORCE_INLINE __m256d Atan2Avx2(__m256d y, __m256d x)
+{
+	const __m256d SignMask = _mm256_set1_pd(-0.0), Zero = _mm256_setzero_pd();
+	__m256d AbsX = _mm256_andnot_pd(SignMask, x), AbsY = _mm256_andnot_pd(SignMask, y);
+	__m256d t = _mm256_div_pd(_mm256_min_pd(AbsX, AbsY), _mm256_max_pd(AbsY, AbsX));
+	__m256d Upper = _mm256_cmp_pd(t, _mm256_set1_pd(ATAN_SPLIT), _CMP_GT_OQ);
+	__m256d u = _mm256_blendv_pd(t, _mm256_div_pd(_mm256_sub_pd(t, _mm256_set1_pd(1.0)), _mm256_add_pd(t, _mm256_set1_pd(1.0))), Upper);
+	__m256d z = _mm256_mul_pd(u, u), p, q, a;
+
+	p = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(ATAN_P0), z), _mm256_set1_pd(ATAN_P1));
+	p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ATAN_P2));
+	p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ATAN_P3));
+	p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(ATAN_P4));
+	q = _mm256_add_pd(z, _mm256_set1_pd(ATAN_Q0));
+	q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q1));
+	q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q2));
+	q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q3));
+	q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(ATAN_Q4));
+	z = _mm256_div_pd(_mm256_mul_pd(z, p), q);
+	a = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(u, z), u), _mm256_blendv_pd(Zero, _mm256_set1_pd(0.5 * PIO2_LO), Upper));
+	a = _mm256_add_pd(_mm256_blendv_pd(Zero, _mm256_set1_pd(PIO4_HI), Upper), a);
+	a = _mm256_blendv_pd(a, _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(PIO2_HI), a), _mm256_set1_pd(PIO2_LO)), _mm256_cmp_pd(AbsY, AbsX, _CMP_GT_OQ));
+	a = _mm256_blendv_pd(a, _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(PI_HI), a), _mm256_set1_pd(PI_LO)), _mm256_cmp_pd(x, Zero, _CMP_LT_OQ));
+	return _mm256_blendv_pd(a, _mm256_xor_pd(a, SignMask), _mm256_cmp_pd(y, Zero, _CMP_LT_OQ));
+}
+
+TARGET_AVX2 static void OrbitAvx2(const ORBIT_BATCH *Batch, double TransmitTime, KINEMATIC_INFO PosVel[], double Acc[][3])
+{
+	const __m256d SignMask = _mm256_set1_pd(-0.0), One = _mm256_set1_pd(1.0), Two = _mm256_set1_pd(2.0);
+	const __m256d HalfWeek = _mm256_set1_pd(302400.0), Week = _mm256_set1_pd(604800.0);
+	int i, j, k;
+	__m256d delta_t, alpha, beta, ecc, root_ecc, n, axis, axis_dot, omega_delta;
+	__m256d cuc, cus, crc, crs, cic, cis;
+	__m256d Mk, Ek, Ek1, sin_e, cos_e;
+	__m256d phi, phi_dot, phi_dot2;
+	__m256d uk, rk, ik;
+	__m256d duk, drk, dik;
+	__m256d uk_dot, rk_dot, ik_dot;
+	__m256d duk_dot, drk_dot, dik_dot;
+	__m256d uk_dot2, rk_dot2, ik_dot2;
+	__m256d Ek_dot, Ek_dot2;
+	__m256d xp, yp, xp_dot, yp_dot, xp_dot2, yp_dot2;
+	__m256d sin_temp, cos_temp, sin_o, cos_o, sin_i, cos_i;
+	__m256d x, y, z, vx, vy, vz, ax, ay, az;
+	double Result[9][ORBIT_BATCH_WIDTH];
+
+	for (i = 0; i < Batch->SatNumber; i += ORBIT_BATCH_WIDTH)
+	{
+		delta_t = _mm256_sub_pd(_mm256_set1_pd(TransmitTime), _mm256_loadu_pd(Batch->toe + i));
+		delta_t = _mm256_sub_pd(delta_t, _mm256_and_pd(_mm256_cmp_pd(delta_t, HalfWeek, _CMP_GT_OQ), Week));
+		delta_t = _mm256_add_pd(delta_t, _mm256_and_pd(_mm256_cmp_pd(delta_t, _mm256_xor_pd(HalfWeek, SignMask), _CMP_LT_OQ), Week));
+		ecc = _mm256_loadu_pd(Batch->ecc + i);
+		root_ecc = _mm256_loadu_pd(Batch->root_ecc + i);
+		n = _mm256_loadu_pd(Batch->n + i);
+		axis = _mm256_loadu_pd(Batch->axis + i);
+		axis_dot = _mm256_loadu_pd(Batch->axis_dot + i);
+		omega_delta = _mm256_loadu_pd(Batch->omega_delta + i);
+
+		// Kepler equation with fixed number of Newton iterations
+		alpha = _mm256_mul_pd(_mm256_loadu_pd(Batch->delta_n_dot + i), delta_t);
+		Ek = Mk = _mm256_add_pd(_mm256_loadu_pd(Batch->M0 + i), _mm256_mul_pd(_mm256_add_pd(n, _mm256_mul_pd(alpha, _mm256_set1_pd(0.5))), delta_t));
+		for (j = 0; j < KEPLER_ITERATION; j ++)
+		{
+			SinCosAvx2(Ek, sin_e, cos_e);
+			Ek = _mm256_sub_pd(Ek, _mm256_div_pd(_mm256_sub_pd(_mm256_sub_pd(Ek, _mm256_mul_pd(ecc, sin_e)), Mk), _mm256_sub_pd(One, _mm256_mul_pd(ecc, cos_e))));
+		}
+		SinCosAvx2(Ek, sin_e, cos_e);
+		Ek1 = _mm256_sub_pd(One, _mm256_mul_pd(ecc, cos_e));
+
+		phi = _mm256_add_pd(Atan2Avx2(_mm256_mul_pd(root_ecc, sin_e), _mm256_sub_pd(cos_e, ecc)), _mm256_loadu_pd(Batch->w + i));
+		SinCosAvx2(_mm256_add_pd(phi, phi), sin_temp, cos_temp);
+		// u(k), r(k) and i(k) with 2nd order correction
+		cuc = _mm256_loadu_pd(Batch->cuc + i); cus = _mm256_loadu_pd(Batch->cus + i);
+		crc = _mm256_loadu_pd(Batch->crc + i); crs = _mm256_loadu_pd(Batch->crs + i);
+		cic = _mm256_loadu_pd(Batch->cic + i); cis = _mm256_loadu_pd(Batch->cis + i);
+		rk = _mm256_mul_pd(_mm256_add_pd(axis, _mm256_mul_pd(axis_dot, delta_t)), Ek1);
+		ik = _mm256_add_pd(_mm256_loadu_pd(Batch->i0 + i), _mm256_mul_pd(_mm256_loadu_pd(Batch->idot + i), delta_t));
+		duk = _mm256_add_pd(_mm256_mul_pd(cuc, cos_temp), _mm256_mul_pd(cus, sin_temp));
+		drk = _mm256_add_pd(_mm256_mul_pd(crc, cos_temp), _mm256_mul_pd(crs, sin_temp));
+		dik = _mm256_add_pd(_mm256_mul_pd(cic, cos_temp), _mm256_mul_pd(cis, sin_temp));
+		uk = _mm256_add_pd(phi, duk);
+		rk = _mm256_add_pd(rk, drk);
+		ik = _mm256_add_pd(ik, dik);
+		// derivatives of r(k), u(k) and i(k)
+		Ek_dot = _mm256_div_pd(_mm256_add_pd(n, alpha), Ek1);
+		uk_dot = _mm256_div_pd(_mm256_mul_pd(Ek_dot, root_ecc), Ek1);
+		phi_dot = _mm256_mul_pd(uk_dot, Two);
+		rk_dot = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(axis, ecc), sin_e), Ek_dot), _mm256_mul_pd(axis_dot, Ek1));
+		drk_dot = _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(crs, cos_temp), _mm256_mul_pd(crc, sin_temp)), phi_dot);
+		duk_dot = _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(cus, cos_temp), _mm256_mul_pd(cuc, sin_temp)), phi_dot);
+		dik_dot = _mm256_mul_pd(_mm256_sub_pd(_mm256_mul_pd(cis, cos_temp), _mm256_mul_pd(cic, sin_temp)), phi_dot);
+		rk_dot = _mm256_add_pd(rk_dot, drk_dot);
+		uk_dot = _mm256_add_pd(uk_dot, duk_dot);
+		ik_dot = _mm256_add_pd(_mm256_loadu_pd(Batch->idot + i), dik_dot);
+		// second order derivatives
+		Ek_dot2 = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_xor_pd(Ek_dot, SignMask), Ek_dot), ecc), sin_e), Ek1);
+		phi_dot2 = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(Two, Ek_dot2), root_ecc), Ek1);
+		alpha = _mm256_div_pd(_mm256_mul_pd(Two, phi_dot2), phi_dot);
+		beta = _mm256_mul_pd(phi_dot, phi_dot);
+		rk_dot2 = _mm256_mul_pd(_mm256_mul_pd(axis, ecc), _mm256_add_pd(_mm256_mul_pd(sin_e, Ek_dot2), _mm256_mul_pd(_mm256_mul_pd(cos_e, Ek_dot), Ek_dot)));
+		rk_dot2 = _mm256_add_pd(rk_dot2, _mm256_sub_pd(_mm256_mul_pd(alpha, drk_dot), _mm256_mul_pd(beta, drk)));
+		uk_dot2 = _mm256_sub_pd(_mm256_add_pd(phi_dot2, _mm256_mul_pd(alpha, duk_dot)), _mm256_mul_pd(beta, duk));
+		ik_dot2 = _mm256_sub_pd(_mm256_mul_pd(alpha, dik_dot), _mm256_mul_pd(beta, dik));
+
+		// Xp and Yp and derivatives
+		SinCosAvx2(uk, sin_temp, cos_temp);
+		xp = _mm256_mul_pd(rk, cos_temp);
+		yp = _mm256_mul_pd(rk, sin_temp);
+		xp_dot = _mm256_sub_pd(_mm256_mul_pd(rk_dot, cos_temp), _mm256_mul_pd(yp, uk_dot));
+		yp_dot = _mm256_add_pd(_mm256_mul_pd(rk_dot, sin_temp), _mm256_mul_pd(xp, uk_dot));
+		alpha = _mm256_mul_pd(_mm256_mul_pd(Two, uk_dot), rk_dot);
+		beta = _mm256_mul_pd(uk_dot, uk_dot);
+		xp_dot2 = _mm256_sub_pd(_mm256_sub_pd(_mm256_sub_pd(_mm256_mul_pd(rk_dot2, cos_temp), _mm256_mul_pd(alpha, sin_temp)), _mm256_mul_pd(beta, xp)), _mm256_mul_pd(uk_dot2, yp));
+		yp_dot2 = _mm256_add_pd(_mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(rk_dot2, sin_temp), _mm256_mul_pd(alpha, cos_temp)), _mm256_mul_pd(beta, yp)), _mm256_mul_pd(uk_dot2, xp));
+
+		// position, velocity and acceleration in ECEF
+		SinCosAvx2(_mm256_add_pd(_mm256_loadu_pd(Batch->omega_t + i), _mm256_mul_pd(omega_delta, delta_t)), sin_o, cos_o);
+		SinCosAvx2(ik, sin_i, cos_i);
+		z = _mm256_mul_pd(yp, sin_i);
+		vz = _mm256_mul_pd(yp_dot, sin_i);
+		x = _mm256_sub_pd(_mm256_mul_pd(xp, cos_o), _mm256_mul_pd(_mm256_mul_pd(yp, cos_i), sin_o));
+		y = _mm256_add_pd(_mm256_mul_pd(xp, sin_o), _mm256_mul_pd(_mm256_mul_pd(yp, cos_i), cos_o));
+		phi_dot = _mm256_sub_pd(_mm256_mul_pd(yp_dot, cos_i), _mm256_mul_pd(z, ik_dot));
+		vx = _mm256_sub_pd(_mm256_mul_pd(xp_dot, cos_o), _mm256_mul_pd(phi_dot, sin_o));
+		vy = _mm256_add_pd(_mm256_mul_pd(xp_dot, sin_o), _mm256_mul_pd(phi_dot, cos_o));
+		vx = _mm256_sub_pd(vx, _mm256_mul_pd(y, omega_delta));
+		vy = _mm256_add_pd(vy, _mm256_mul_pd(x, omega_delta));
+		vz = _mm256_add_pd(vz, _mm256_mul_pd(_mm256_mul_pd(yp, ik_dot), cos_i));
+		alpha = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(vz, ik_dot), _mm256_mul_pd(z, ik_dot2)), _mm256_mul_pd(xp_dot, omega_delta));
+		alpha = _mm256_add_pd(alpha, _mm256_sub_pd(_mm256_mul_pd(_mm256_mul_pd(yp_dot, ik_dot), sin_i), _mm256_mul_pd(yp_dot2, cos_i)));
+		beta = _mm256_sub_pd(_mm256_add_pd(xp_dot2, _mm256_mul_pd(_mm256_mul_pd(z, ik_dot), omega_delta)), _mm256_mul_pd(_mm256_mul_pd(yp_dot, omega_delta), cos_i));
+		ax = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_xor_pd(vy, SignMask), omega_delta), _mm256_mul_pd(alpha, sin_o)), _mm256_mul_pd(beta, cos_o));
+		ay = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(vx, omega_delta), _mm256_mul_pd(alpha, cos_o)), _mm256_mul_pd(beta, sin_o));
+		az = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(yp_dot2, _mm256_mul_pd(_mm256_mul_pd(yp, ik_dot), ik_dot)), sin_i),
+			_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(yp, ik_dot2), _mm256_mul_pd(_mm256_mul_pd(Two, yp_dot), ik_dot)), cos_i));
+
+		_mm256_storeu_pd(Result[0], x); _mm256_storeu_pd(Result[1], y); _mm256_storeu_pd(Result[2], z);
+		_mm256_storeu_pd(Result[3], vx); _mm256_storeu_pd(Result[4], vy); _mm256_storeu_pd(Result[5], vz);
+		_mm256_storeu_pd(Result[6], ax); _mm256_storeu_pd(Result[7], ay); _mm256_storeu_pd(Result[8], az);
+		for (k = 0; k < ORBIT_BATCH_WIDTH && i + k < Batch->SatNumber; k ++)
+		{
+			PosVel[i+k].x = Result[0][k]; PosVel[i+k].y = Result[1][k]; PosVel[i+k].z = Result[2][k];
+			PosVel[i+k].vx = Result[3][k]; PosVel[i+k].vy = Result[4][k]; PosVel[i+k].vz = Result[5][k];
+			Acc[i+k][0] = Result[6][k]; Acc[i+k][1] = Result[7][k]; Acc[i+k][2] = Result[8][k];
+		}
+	}
+	_mm256_zeroupper();
+}
+
+#endif
@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------
+// OrbitCache.cpp:
+//   Implementation of satellite orbit interpolation from broadcast
+//   ephemeris evaluated at coarse nodes
+//
+//          Copyright (C) 2020-2029 by Jun Mo, All rights reserved.
+//
+//----------------------------------------------------------------------
+#include <math.h>
+
+#include "ConstVal.h"
+#include "BasicTypes.h"
+#include "Coordinate.h"
+#include "OrbitCache.h"
+
+#define ORBIT_GLONASS_STEP 10.0	// maximum Runge-Kutta step between GLONASS nodes
+
+static bool EphPosSpeed(GnssSystem system, double TransmitTime, const void *Eph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CONTEXT Context);
+static void CalcNode(GnssSystem system, const void *Eph, PORBIT_CACHE Cache, int Node);
+static void CalcSegment(PORBIT_CACHE Cache, int Segment);
+
+void InitOrbitCache(PORBIT_CACHE Cache, double Interval)
+{
+	Cache->Eph = NULL;
+	Cache->Interval = Interval;
+	Cache->Ek = 0.0;
+	Cache->Context.Eph = NULL;
+	Cache->Context.Ek = Cache->Context.Ek_dot = 0.0;
+}
+
+bool SatPosSpeedCache(GnssSystem system, double TransmitTime, const void *Eph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CACHE Cache)
+{
+	const double Interval = Cache->Interval;
+	int i, j, Segment;
+	double s, *Coef;
+
+	if (Interval <= 0)
+	{
+		bool Valid = EphPosSpeed(system, TransmitTime, Eph, pPosVel, Acc, &Cache->Context);
+		Cache->Ek = Cache->Context.Ek;
+		return Valid;
+	}
+
+	// calculate all nodes again on new ephemeris or time out of nodes range
+	// (Interval after last node allowed to move forward without gap)
+	if (Cache->Eph != Eph || TransmitTime < Cache->NodeTime[0] || TransmitTime > Cache->NodeTime[2] + Interval)
+	{
+		Cache->Eph = Eph;
+		Cache->NodeTime[1] = floor(TransmitTime / Interval) * Interval;
+		Cache->NodeTime[0] = Cache->NodeTime[1] - Interval;
+		Cache->NodeTime[2] = Cache->NodeTime[1] + Interval;
+		for (i = 0; i < 3; i ++)
+			CalcNode(system, Eph, Cache, i);
+		CalcSegment(Cache, 0);
+		CalcSegment(Cache, 1);
+	}
+	else if (TransmitTime > Cache->NodeTime[2])	// move nodes forward
+	{
+		for (i = 0; i < 2; i ++)
+		{
+			Cache->NodeTime[i] = Cache->NodeTime[i+1];
+			Cache->NodePosVel[i] = Cache->NodePosVel[i+1];
+			Cache->NodeAcc[i][0] = Cache->NodeAcc[i+1][0]; Cache->NodeAcc[i][1] = Cache->NodeAcc[i+1][1]; Cache->NodeAcc[i][2] = Cache->NodeAcc[i+1][2];
+			Cache->NodeEk[i] = Cache->NodeEk[i+1];
+			Cache->NodeEkDot[i] = Cache->NodeEkDot[i+1];
+			Cache->NodeValid[i] = Cache->NodeValid[i+1];
+		}
+		Cache->NodeTime[2] = Cache->NodeTime[1] + Interval;
+		CalcNode(system, Eph, Cache, 2);
+		for (i = 0; i < 3; i ++)
+			for (j = 0; j < 6; j ++)
+				Cache->Coef[0][i][j] = Cache->Coef[1][i][j];
+		for (i = 0; i < 4; i ++)
+			Cache->EkCoef[0][i] = Cache->EkCoef[1][i];
+		CalcSegment(Cache, 1);
+	}
+
+	Segment = (TransmitTime < Cache->NodeTime[1]) ? 0 : 1;
+	s = (TransmitTime - Cache->NodeTime[Segment]) / Interval;
+	HermitePosSpeed(Cache->Coef[Segment], s, Interval, pPosVel, Acc);
+	Coef = Cache->EkCoef[Segment];
+	Cache->Ek = Coef[0] + s * (Coef[1] + s * (Coef[2] + s * Coef[3]));
+
+	return Cache->NodeValid[Segment] && Cache->NodeValid[Segment+1];
+}
+
+bool EphPosSpeed(GnssSystem system, double TransmitTime, const void *Eph, PKINEMATIC_INFO pPosVel, double Acc[3], PORBIT_CONTEXT Context)
+{
+	if (system == GlonassSystem)
+		return GlonassSatPosSpeedEph(TransmitTime, (const GLONASS_EPHEMERIS *)Eph, pPosVel, Acc, Context);
+	else
+		return GpsSatPosSpeedEph(system, TransmitTime, (const GPS_EPHEMERIS *)Eph, pPosVel, Acc, Context);
+}
+
+void CalcNode(GnssSystem system, const void *Eph, PORBIT_CACHE Cache, int Node)
+{
+	KINEMATIC_INFO PosVel;
+	double Time;
+
+	// GLONASS orbit integrated from last node in steps not longer than ORBIT_GLONASS_STEP
+	if (system == GlonassSystem && Cache->Context.Eph == Eph)
+	{
+		for (Time = Cache->Context.tc + ORBIT_GLONASS_STEP; Time < Cache->NodeTime[Node] - 1e-3; Time += ORBIT_GLONASS_STEP)
+			EphPosSpeed(system, Time, Eph, &PosVel, NULL, &Cache->Context);
+	}
+	Cache->NodeValid[Node] = EphPosSpeed(system, Cache->NodeTime[Node], Eph, &Cache->NodePosVel[Node], Cache->NodeAcc[Node], &Cache->Context);
+	Cache->NodeEk[Node] = Cache->Context.Ek;
+	Cache->NodeEkDot[Node] = Cache->Context.Ek_dot;
+}
+
+void CalcSegment(PORBIT_CACHE Cache, int Segment)
+{
+	const double h = Cache->Interval;
+	double Delta, D0, D1, *Coef;
+
+	HermiteCoef(&Cache->NodePosVel[Segment], Cache->NodeAcc[Segment], &Cache->NodePosVel[Segment+1], Cache->NodeAcc[Segment+1], h, Cache->Coef[Segment]);
+	// cubic Hermite of Ek from Ek and Ek_dot
+	Coef = Cache->EkCoef[Segment];
+	Delta = Cache->NodeEk[Segment+1] - Cache->NodeEk[Segment];
+	D0 = Cache->NodeEkDot[Segment] * h;
+	D1 = Cache->NodeEkDot[Segment+1] * h;
+	Coef[0] = Cache->NodeEk[Segment];
+	Coef[1] = D0;
+	Coef[2] = 3 * Delta - 2 * D0 - D1;
+	Coef[3] = -2 * Delta + D0 + D1;
+}
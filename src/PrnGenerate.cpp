@@ -7,129 +7,149 @@
 //----------------------------------------------------------------------
 
 #include <string.h>
+#include <map>
+#include <vector>
+#include <mutex>
 #include "PrnGenerate.h"
 
-const unsigned int PrnGenerate::L1CAPrnInit[32] = {
+// tables used by compile time code generation need to be constexpr
+#ifdef PRN_STATIC_TABLES
+#define PRN_TABLE_CONST constexpr
+#else
+#define PRN_TABLE_CONST const
+#endif
+
+typedef struct
+{
+	PrnGenerate *Prn;
+	int RefCount;
+} PRN_CACHE_ENTRY;
+
+static std::mutex PrnCacheMutex;
+static std::map<unsigned int, PRN_CACHE_ENTRY> PrnCacheMap;
+static int PrnCacheHits = 0, PrnCacheGenerates = 0;
+
+PRN_TABLE_CONST unsigned int PrnGenerate::L1CAPrnInit[32] = {
 0x0df, 0x06f, 0x037, 0x01b, 0x1a4, 0x0d2, 0x1a6, 0x0d3, 0x069, 0x0bb, 0x05d, 0x017, 0x00b, 0x005, 0x002, 0x001, 
 0x191, 0x0c8, 0x064, 0x032, 0x019, 0x00c, 0x1cc, 0x039, 0x01c, 0x00e, 0x007, 0x003, 0x1a8, 0x0d4, 0x06a, 0x035, };
 
-const unsigned int PrnGenerate::L5IPrnInit[32] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::L5IPrnInit[32] = {
 0x04ea, 0x1583, 0x0202, 0x0c8d, 0x1d77, 0x0be6, 0x1f25, 0x04bd, 0x1a9f, 0x0f7e, 0x0b90, 0x13e7, 0x0738, 0x1c82, 0x0b56, 0x1278, 
 0x1e32, 0x0f0f, 0x1f13, 0x16d6, 0x0204, 0x1ef7, 0x0fe1, 0x05a3, 0x16cb, 0x0d35, 0x0f6a, 0x0d5e, 0x10fa, 0x1da1, 0x0f28, 0x13a0, };
 
-const unsigned int PrnGenerate::L5QPrnInit[32] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::L5QPrnInit[32] = {
 0x0669, 0x0de2, 0x188f, 0x0adc, 0x09bc, 0x12aa, 0x103f, 0x02d6, 0x185d, 0x0c24, 0x1408, 0x146a, 0x14b2, 0x1f85, 0x1e3d, 0x1f4b, 
 0x0267, 0x04ed, 0x1b4c, 0x11c3, 0x0136, 0x0e34, 0x17d1, 0x19f6, 0x1b22, 0x07aa, 0x0be1, 0x085f, 0x048a, 0x13c1, 0x14fa, 0x0a89, };
 
-const unsigned int PrnGenerate::L2CMPrnInit[32] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::L2CMPrnInit[32] = {
 0x15ef0f5, 0x50f811e, 0x10e553d, 0x16b0258, 0x416f3bc, 0x65bc21e, 0x0f5be58, 0x496777f,
 0x4a5a8e2, 0x36e44d6, 0x5e84705, 0x345ea19, 0x6965b5b, 0x447fb02, 0x0043a6e, 0x35e5896,
 0x3059ddd, 0x5c16d2a, 0x10c80db, 0x1c754b4, 0x650324e, 0x7fb4e14, 0x74e048f, 0x0663507,
 0x1f887f9, 0x487c247, 0x5fd6d8c, 0x20818d1, 0x1ece400, 0x7aeb923, 0x656b597, 0x602e157, };
 
-const unsigned int PrnGenerate::L2CLPrnInit[32] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::L2CLPrnInit[32] = {
 0x29be220, 0x2012ed7, 0x3d7d64b, 0x12b1c4a, 0x5e3a308, 0x31c0719, 0x3b5179f, 0x74429a6,
 0x1d5fc3b, 0x3bf943a, 0x587c624, 0x0be84ce, 0x57d8717, 0x6a8376f, 0x5a13f5d, 0x4a5f5df,
 0x046b92b, 0x7a7c2ae, 0x45886a6, 0x5a9a643, 0x68872f2, 0x3e759f6, 0x6b6fdbd, 0x31b717b,
 0x048fcb0, 0x1cbc9e3, 0x6b38d5b, 0x6f5b8fa, 0x121a76e, 0x5f23c35, 0x326fd21, 0x3cb4e3c, };
 
-const unsigned int PrnGenerate::B1IPrnInit[63] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::B1IPrnInit[63] = {
 0x187, 0x639, 0x1e6, 0x609, 0x605, 0x1f8, 0x606, 0x1f9, 0x704, 0x7be, 0x061, 0x78e, 0x782, 0x07f, 0x781, 0x07e,
 0x7df, 0x030, 0x03c, 0x7c1, 0x03f, 0x7c0, 0x7ef, 0x7e3, 0x01e, 0x7e0, 0x01f, 0x00c, 0x7f1, 0x00f, 0x7f0, 0x7fd,
 0x003, 0x7fc, 0x7fe, 0x001, 0x7ff, 0x457, 0x4ed, 0x4dd, 0x4d1, 0x4d2, 0x32d, 0x48c, 0x492, 0x4bc, 0x4b0, 0x4b3,
 0x34c, 0x4a2, 0x4ae, 0x4ad, 0x352, 0x5d0, 0x5b1, 0x5af, 0x50b, 0x515, 0x53b, 0x537, 0x534, 0x2cb, 0x525, };
 
-const unsigned int PrnGenerate::B3IPrnInit[63] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::B3IPrnInit[63] = {
 0x1ff5, 0x1a8f, 0x0a3d, 0x1bff, 0x1f13, 0x04c9, 0x097f, 0x17f7, 0x0805, 0x1b04, 0x01d7, 0x0f34, 0x1526, 0x0c8e, 0x1231, 0x07c7, 
 0x1464, 0x06e0, 0x1d51, 0x0f68, 0x1684, 0x0a34, 0x1e68, 0x08cc, 0x025c, 0x1292, 0x196d, 0x08f5, 0x15e8, 0x1ffe, 0x1e36, 0x1235, 
 0x1aa9, 0x14b3, 0x174b, 0x05df, 0x1cd4, 0x0117, 0x013b, 0x0e6b, 0x0581, 0x137a, 0x07b6, 0x11cb, 0x089c, 0x146a, 0x0cf9, 0x025f, 
 0x1250, 0x06a1, 0x064f, 0x1e32, 0x0300, 0x0401, 0x0cac, 0x0c4d, 0x03ce, 0x0a74, 0x0df3, 0x1449, 0x008e, 0x084c, 0x0e44, };
 
-const unsigned int PrnGenerate::B2aDPrnInit[63] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::B2aDPrnInit[63] = {
 0x1481, 0x0581, 0x16a1, 0x1e51, 0x1551, 0x0eb1, 0x0ef1, 0x1bf1, 0x1299, 0x0b79, 0x1585, 0x0445, 0x1545, 0x1b45, 0x0745, 0x18a5, 
 0x1de5, 0x1015, 0x0f95, 0x1ab5, 0x11b5, 0x194d, 0x08cd, 0x032d, 0x0dad, 0x09ed, 0x1fed, 0x091d, 0x079d, 0x10bd, 0x027d, 0x057d, 
 0x1afd, 0x19fd, 0x1143, 0x0523, 0x1da3, 0x1113, 0x1313, 0x1ab3, 0x11b3, 0x0973, 0x154b, 0x05cb, 0x1a6b, 0x1d5b, 0x0587, 0x1827, 
 0x1a27, 0x18a7, 0x02a7, 0x1b97, 0x1d37, 0x024f, 0x052f, 0x132f, 0x0b6f, 0x03ef, 0x1fef, 0x15bf, 0x0804, 0x15fb, 0x0978, };
 
-const unsigned int PrnGenerate::B2aPPrnInit[63] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::B2aPPrnInit[63] = {
 0x1481, 0x0581, 0x16a1, 0x1e51, 0x1551, 0x0eb1, 0x0ef1, 0x1bf1, 0x1299, 0x0b79, 0x1585, 0x0445, 0x1545, 0x1b45, 0x0745, 0x18a5, 
 0x1de5, 0x1015, 0x0f95, 0x1ab5, 0x11b5, 0x194d, 0x08cd, 0x032d, 0x0dad, 0x09ed, 0x1fed, 0x091d, 0x079d, 0x10bd, 0x027d, 0x057d, 
 0x1afd, 0x19fd, 0x1143, 0x0523, 0x1da3, 0x1113, 0x1313, 0x1ab3, 0x11b3, 0x0973, 0x154b, 0x05cb, 0x1a6b, 0x1d5b, 0x0587, 0x1827, 
 0x1a27, 0x18a7, 0x02a7, 0x1b97, 0x1d37, 0x024f, 0x052f, 0x132f, 0x0b6f, 0x03ef, 0x1fef, 0x15bf, 0x0c25, 0x03f4, 0x1558, };
 
-const unsigned int PrnGenerate::B2bPrnInit[63] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::B2bPrnInit[63] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0eb1, 0x0ef1, 0x1bf1, 0x1299, 0x0b79, 0x1585, 0x0445, 0x1545, 0x1b45, 0x0745, 0x18a5, 
 0x1de5, 0x1015, 0x0f95, 0x1ab5, 0x11b5, 0x194d, 0x08cd, 0x032d, 0x0dad, 0x09ed, 0x1fed, 0x091d, 0x079d, 0x10bd, 0x027d, 0x057d, 
 0x1afd, 0x19fd, 0x1143, 0x0523, 0x1da3, 0x1113, 0x1313, 0x1ab3, 0x11b3, 0x0973, 0x154b, 0x05cb, 0x1a6b, 0x1d5b, 0x0587, 0x1827, 
 0x1a27, 0x18a7, 0x02a7, 0x1b97, 0x1d37, 0x024f, 0x052f, 0x132f, 0x0b6f, 0x03ef, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, };
 
-const unsigned int PrnGenerate::E5aIPrnInit[50] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::E5aIPrnInit[50] = {
 0x30c5, 0x189c, 0x2e8b, 0x217f, 0x26ca, 0x3733, 0x1b8c, 0x155f, 0x0357, 0x309e, 0x2ee4, 0x0eba, 0x3cff, 0x1e26, 0x0d1c, 0x1b05, 
 0x28aa, 0x1399, 0x29fe, 0x0198, 0x1370, 0x1eba, 0x2f25, 0x33c2, 0x160a, 0x1901, 0x39d7, 0x2597, 0x3193, 0x2eae, 0x0350, 0x1889, 
 0x3335, 0x2474, 0x374e, 0x05df, 0x22ce, 0x3b15, 0x3b9b, 0x29ad, 0x182c, 0x2e17, 0x0d84, 0x332d, 0x3935, 0x2abb, 0x21f3, 0x33d1, 
 0x1eca, 0x16bf, };
 
-const unsigned int PrnGenerate::E5aQPrnInit[50] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::E5aQPrnInit[50] = {
 0x2baa, 0x0a62, 0x29d3, 0x33e9, 0x2ef6, 0x29b0, 0x37ad, 0x2f28, 0x0f96, 0x03c5, 0x15cf, 0x3452, 0x1c3d, 0x1da4, 0x3f6e, 0x053f, 
 0x04b5, 0x0d18, 0x2a26, 0x15dd, 0x08b2, 0x1298, 0x001f, 0x0c5f, 0x08ca, 0x2186, 0x1272, 0x24aa, 0x315b, 0x298c, 0x0ff7, 0x35c5, 
 0x0a2a, 0x2f6b, 0x07c9, 0x0421, 0x39fd, 0x0abc, 0x3eee, 0x1c85, 0x3cb8, 0x0d80, 0x2dfb, 0x1efd, 0x3ab7, 0x3cad, 0x1424, 0x2d22, 
 0x2391, 0x2b09, };
 
-const unsigned int PrnGenerate::E5bIPrnInit[50] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::E5bIPrnInit[50] = {
 0x0e90, 0x2c27, 0x00aa, 0x1e76, 0x1871, 0x0560, 0x035f, 0x2c13, 0x03d5, 0x219f, 0x04f4, 0x2fd9, 0x31a0, 0x387c, 0x0d34, 0x0fbe, 
 0x3499, 0x10eb, 0x01ed, 0x2c3f, 0x13a4, 0x135f, 0x3a4d, 0x212a, 0x39a5, 0x2bb4, 0x2303, 0x34ab, 0x04df, 0x31ff, 0x2e52, 0x24ff, 
 0x3c7d, 0x363d, 0x3669, 0x165c, 0x0f1b, 0x108e, 0x3b36, 0x055b, 0x0ae9, 0x3051, 0x1808, 0x357e, 0x30d6, 0x3f1b, 0x2c12, 0x3bf8, 
 0x0db8, 0x140f, };
 
-const unsigned int PrnGenerate::E5bQPrnInit[50] = {
+PRN_TABLE_CONST unsigned int PrnGenerate::E5bQPrnInit[50] = {
 0x06d9, 0x0c63, 0x2ad2, 0x26f9, 0x010b, 0x3c9d, 0x1fe8, 0x09e5, 0x1605, 0x3e60, 0x306d, 0x209f, 0x0731, 0x33b2, 0x2e66, 0x0b67, 
 0x052e, 0x300b, 0x00d2, 0x11f1, 0x2df7, 0x3c04, 0x31cb, 0x0fb2, 0x2388, 0x205c, 0x12b2, 0x11c6, 0x3863, 0x1229, 0x2b30, 0x1fb5, 
 0x34ec, 0x2298, 0x2066, 0x12f2, 0x3ea6, 0x1ce4, 0x1a1c, 0x2b39, 0x2ba6, 0x246f, 0x08de, 0x1cee, 0x083d, 0x0596, 0x13c6, 0x3e09, 
 0x2e21, 0x3214, };
 
-const int PrnGenerate::B1CDataTruncation[63] = {
+PRN_TABLE_CONST int PrnGenerate::B1CDataTruncation[63] = {
   699,  694, 7318, 2127,  715, 6682, 7850, 5495, 1162, 7682, 6792, 9973, 6596, 2092,   19,10151,
  6297, 5766, 2359, 7136, 1706, 2128, 6827,  693, 9729, 1620, 6805,  534,  712, 1929, 5355, 6139,
  6339, 1470, 6867, 7851, 1162, 7659, 1156, 2672, 6043, 2862,  180, 2663, 6940, 1645, 1582,  951,
  6878, 7701, 1823, 2391, 2606,  822, 6403,  239,  442, 6769, 2560, 2502, 5072, 7268,  341, };
  
- const int PrnGenerate::B1CDataPhaseDiff[63] = {
+PRN_TABLE_CONST int PrnGenerate::B1CDataPhaseDiff[63] = {
  2678, 4802,  958,  859, 3843, 2232,  124, 4352, 1816, 1126, 1860, 4800, 2267,  424, 4192, 4333,
  2656, 4148,  243, 1330, 1593, 1470,  882, 3202, 5095, 2546, 1733, 4795, 4577, 1627, 3638, 2553,
  3646, 1087, 1843,  216, 2245,  726, 1966,  670, 4130,   53, 4830,  182, 2181, 2006, 1080, 2288,
  2027,  271,  915,  497,  139, 3693, 2054, 4342, 3342, 2592, 1007,  310, 4203,  455, 4318, };
 
-const int PrnGenerate::B1CPilotTruncation[63] = {
+PRN_TABLE_CONST int PrnGenerate::B1CPilotTruncation[63] = {
  7575, 2369, 5688,  539, 2270, 7306, 6457, 6254, 5644, 7119, 1402, 5557, 5764, 1073, 7001, 5910,
 10060, 2710, 1546, 6887, 1883, 5613, 5062, 1038,10170, 6484, 1718, 2535, 1158, 526 , 7331, 5844,
  6423, 6968, 1280, 1838, 1989, 6468, 2091, 1581, 1453, 6252, 7122, 7711, 7216, 2113, 1095, 1628,
  1713, 6102, 6123, 6070, 1115, 8047, 6795, 2575,   53, 1729, 6388,  682, 5565, 7160, 2277, };
 
-const int PrnGenerate::B1CPilotPhaseDiff[63] = {
+PRN_TABLE_CONST int PrnGenerate::B1CPilotPhaseDiff[63] = {
   796,  156, 4198, 3941, 1374, 1338, 1833, 2521, 3175,  168, 2715, 4408, 3160, 2796,  459, 3594,
  4813,  586, 1428, 2371, 2285, 3377, 4965, 3779, 4547, 1646, 1430,  607, 2118, 4709, 1149, 3283,
  2473, 1006, 3670, 1817,  771, 2173,  740, 1433, 2458, 3459, 2155, 1205,  413,  874, 2463, 1106,
  1590, 3873, 4026, 4272, 3556,  128, 1200,  130, 4494, 1871, 3073, 4386, 4098, 1923, 1176, };
 
-const int PrnGenerate::L1CDataInsertIndex[63] = {
+PRN_TABLE_CONST int PrnGenerate::L1CDataInsertIndex[63] = {
   181,  359,   72, 1110, 1480, 5034, 4622,    1, 4547,  826, 6284, 4195,  368,    1, 4796,  523,
   151,  713, 9850, 5734,   34, 6142,  190,  644,  467, 5384,  801,  594, 4450, 9437, 4307, 5906,
   378, 9448, 9432, 5849, 5547, 9546, 9132,  403, 3766,    3,  684, 9711,  333, 6124,10216, 4251,
  9893, 9884, 4627, 4449, 9798,  985, 4272,  126,10024,  434, 1029,  561,  289,  638, 4353, };
 
-const int PrnGenerate::L1CDataPhaseDiff[63] = {
+PRN_TABLE_CONST int PrnGenerate::L1CDataPhaseDiff[63] = {
  5097, 5110, 5079, 4403, 4121, 5043, 5042, 5104, 4940, 5035, 4372, 5064, 5084, 5048, 4950, 5019,
  5076, 3736, 4993, 5060, 5061, 5096, 4983, 4783, 4991, 4815, 4443, 4769, 4879, 4894, 4985, 5056,
  4921, 5036, 4812, 4838, 4855, 4904, 4753, 4483, 4942, 4813, 4957, 4618, 4669, 4969, 5031, 5038,
  4740, 4073, 4843, 4979, 4867, 4964, 5025, 4579, 4390, 4763, 4612, 4784, 3716, 4703, 4851, };
 
-const int PrnGenerate::L1CPilotInsertIndex[63] = {
+PRN_TABLE_CONST int PrnGenerate::L1CPilotInsertIndex[63] = {
   412,  161,    1,  303,  207, 4971, 4496,    5, 4557,  485,  253, 4676,    1,   66, 4485,  282,
   193, 5211,  729, 4848,  982, 5955, 9805,  670,  464,   29,  429,  394,  616, 9457, 4429, 4771,
   365, 9705, 9489, 4193, 9947,  824,  864,  347,  677, 6544, 6312, 9804,  278, 9461,  444, 4839,
  4144, 9875,  197, 1156, 4674,10035, 4504,    5, 9937,  430,    5,  355,  909, 1622, 6284,};
 
-const int PrnGenerate::L1CPilotPhaseDiff[63] = {
+PRN_TABLE_CONST int PrnGenerate::L1CPilotPhaseDiff[63] = {
  5111, 5109, 5108, 5106, 5103, 5101, 5100, 5098, 5095, 5094, 5093, 5091, 5090, 5081, 5080, 5069,
  5068, 5054, 5044, 5027, 5026, 5014, 5004, 4980, 4915, 4909, 4893, 4885, 4832, 4824, 4591, 3706,
  5092, 4986, 4965, 4920, 4917, 4858, 4847, 4790, 4770, 4318, 4126, 3961, 3790, 4911, 4881, 4827,
@@ -153,6 +173,341 @@ const PrnAttribute PrnGenerate::PrnAttributes[] = {
 	{   511,       1,         1,                 0 },	// index 10 for G1/G2
 };
 
+#ifdef PRN_STATIC_TABLES
+// Compile time PRN code generation. Results are identical to PackPrnBits()/PackCombinedBits()
+// applied to the output of the runtime generators, but generated word by word to keep
+// constant evaluation fast enough:
+//  - LFSR m-sequence s[n] = XOR s[n-k-1] for each feedback tap k, raising the feedback
+//    polynomial to the power 32 gives s[n] = XOR s[n-32(k+1)], so after the first Depth
+//    words each word is XOR of previous words
+//  - Weil code is XOR of two Legendre sequence segments, extracted from packed Legendre
+//    sequence repeated twice
+//  - memory code is bit reversed and re-aligned from 1023 chip sectors
+// Codes are passed by value and arrays indexed directly, access through pointers is much
+// slower in constant evaluation
+#define PRN_WORDS(Chips) (((Chips) + 31) / 32)
+#define PRN_COMBINED_WORDS(Chips) (((Chips) + 15) / 16)
+
+// one more word after the last chip for StaticGetBits()
+template <int Words> struct PrnCodeWords { unsigned int Word[Words + 1]; };
+template <int Count, int Words> struct PrnCodeTable { unsigned int Code[Count][Words]; };
+
+static constexpr unsigned int StaticParity(unsigned int Value)
+{
+	Value ^= Value >> 16; Value ^= Value >> 8; Value ^= Value >> 4;
+	return (0x6996 >> (Value & 0xf)) & 1;
+}
+
+static constexpr unsigned int StaticReverseBits(unsigned int Value)
+{
+	Value = ((Value >> 1) & 0x55555555) | ((Value & 0x55555555) << 1);
+	Value = ((Value >> 2) & 0x33333333) | ((Value & 0x33333333) << 2);
+	Value = ((Value >> 4) & 0x0f0f0f0f) | ((Value & 0x0f0f0f0f) << 4);
+	Value = ((Value >> 8) & 0x00ff00ff) | ((Value & 0x00ff00ff) << 8);
+	return (Value >> 16) | (Value << 16);
+}
+
+// spread 16 bits to even bit positions of 32 bits
+static constexpr unsigned int StaticSpreadBits(unsigned int Value)
+{
+	Value = (Value | (Value << 8)) & 0x00ff00ff;
+	Value = (Value | (Value << 4)) & 0x0f0f0f0f;
+	Value = (Value | (Value << 2)) & 0x33333333;
+	return (Value | (Value << 1)) & 0x55555555;
+}
+
+static constexpr unsigned int StaticLastWordMask(int Length)
+{
+	return (Length & 31) ? ((1U << (Length & 31)) - 1) : 0xffffffff;
+}
+
+// 32 bits starting from bit Offset
+template <int Words>
+static constexpr unsigned int StaticGetBits(const PrnCodeWords<Words> &Packed, int Offset)
+{
+	return (Offset & 31) ? ((Packed.Word[Offset >> 5] >> (Offset & 31)) | (Packed.Word[(Offset >> 5) + 1] << (32 - (Offset & 31)))) : Packed.Word[Offset >> 5];
+}
+
+// same output as LsfrSequence::GetOutput() called Words * 32 times
+template <int Words>
+static constexpr PrnCodeWords<Words> StaticLfsrWords(unsigned int Init, unsigned int Poly, int Depth)
+{
+	PrnCodeWords<Words> Sequence = {};
+	unsigned int State = Init, Value = 0;
+	int Lag[32] = {}, LagCount = 0;
+	int i = 0, k = 0;
+
+	for (i = 0; i < Depth * 32 && i < Words * 32; i ++)
+	{
+		Sequence.Word[i >> 5] |= ((State >> (Depth - 1)) & 1) << (i & 31);
+		State = (State << 1) | StaticParity(State & Poly);
+	}
+	for (k = 0; k < Depth; k ++)
+		if (Poly & (1U << k))
+			Lag[LagCount ++] = k + 1;
+	for (i = Depth; i < Words; i ++)
+	{
+		Value = 0;
+		for (k = 0; k < LagCount; k ++)
+			Value ^= Sequence.Word[i - Lag[k]];
+		Sequence.Word[i] = Value;
+	}
+	return Sequence;
+}
+
+// same as PackPrnBits(GetGoldCode(...)), G2 restarts at ResetPos
+template <int Length>
+static constexpr PrnCodeWords<PRN_WORDS(Length)> StaticGoldCode(unsigned int G1Init, unsigned int G1Poly, unsigned int G2Init, unsigned int G2Poly, int Depth, int ResetPos)
+{
+	PrnCodeWords<PRN_WORDS(Length)> Code = StaticLfsrWords<PRN_WORDS(Length)>(G1Init, G1Poly, Depth);
+	int i = 0, Start = 0;
+
+	if (ResetPos <= 0 || ResetPos >= Length)
+		ResetPos = Length;
+	if (G2Init != 0)	// G2 is all zero if initial state is 0
+	{
+		PrnCodeWords<PRN_WORDS(Length)> G2 = StaticLfsrWords<PRN_WORDS(Length)>(G2Init, G2Poly, Depth);
+		for (i = 0; i < PRN_WORDS(Length); i ++)
+		{
+			Start = i * 32;
+			if (Start + 32 <= ResetPos)
+				Code.Word[i] ^= G2.Word[i];
+			else if (Start >= ResetPos)
+				Code.Word[i] ^= StaticGetBits(G2, Start - ResetPos);
+			else
+				Code.Word[i] ^= (G2.Word[i] & ((1U << (ResetPos - Start)) - 1)) ^ (G2.Word[0] << (ResetPos - Start));
+		}
+	}
+	Code.Word[PRN_WORDS(Length) - 1] &= StaticLastWordMask(Length);
+	return Code;
+}
+
+// Legendre sequence repeated twice
+template <int Length>
+static constexpr PrnCodeWords<PRN_WORDS(Length * 2)> StaticLegendre()
+{
+	PrnCodeWords<PRN_WORDS(Length * 2)> Legendre = {};
+	int i = 0, Index = 0;
+
+	for (i = 1; i < Length; i ++)
+	{
+		Index = (i * i) % Length;
+		Legendre.Word[Index >> 5] |= 1U << (Index & 31);
+		Legendre.Word[(Index + Length) >> 5] |= 1U << ((Index + Length) & 31);
+	}
+	return Legendre;
+}
+
+static constexpr PrnCodeWords<PRN_WORDS(10223 * 2)> L1CLegendre = StaticLegendre<10223>();
+static constexpr PrnCodeWords<PRN_WORDS(10243 * 2)> B1CLegendre = StaticLegendre<10243>();
+
+// same as PackPrnBits(GetL1CWeil(InsertIndex, PhaseDiff))
+static constexpr PrnCodeWords<PRN_WORDS(10230)> StaticL1CWeil(int InsertIndex, int PhaseDiff)
+{
+	const unsigned int InsertSequence = 0x16;	// {0, 1, 1, 0, 1, 0, 0} with first chip at LSB
+	PrnCodeWords<PRN_WORDS(10230)> Code = {};
+	int i = 0, j = 0, Start = 0, Index = 0;
+
+	for (i = 0; i < PRN_WORDS(10230); i ++)
+	{
+		Start = i * 32;
+		if (Start + 32 <= InsertIndex - 1)
+			Code.Word[i] = StaticGetBits(L1CLegendre, Start) ^ StaticGetBits(L1CLegendre, Start + PhaseDiff);
+		else if (Start >= InsertIndex + 6)
+			Code.Word[i] = StaticGetBits(L1CLegendre, Start - 7) ^ StaticGetBits(L1CLegendre, Start - 7 + PhaseDiff);
+		else	// word contains inserted chips
+		{
+			for (j = Start; j < Start + 32; j ++)
+			{
+				if (j >= InsertIndex - 1 && j < InsertIndex + 6)
+					Code.Word[i] |= ((InsertSequence >> (j - InsertIndex + 1)) & 1) << (j & 31);
+				else
+				{
+					Index = (j < InsertIndex - 1) ? j : j - 7;
+					Code.Word[i] |= ((StaticGetBits(L1CLegendre, Index) ^ StaticGetBits(L1CLegendre, Index + PhaseDiff)) & 1) << (j & 31);
+				}
+			}
+		}
+	}
+	Code.Word[PRN_WORDS(10230) - 1] &= StaticLastWordMask(10230);
+	return Code;
+}
+
+// same as PackPrnBits(GetB1CWeil(TruncationPoint, PhaseDiff))
+static constexpr PrnCodeWords<PRN_WORDS(10230)> StaticB1CWeil(int TruncationPoint, int PhaseDiff)
+{
+	PrnCodeWords<PRN_WORDS(10230)> Code = {};
+	int i = 0, Index1 = (TruncationPoint - 1) % 10243, Index2 = (TruncationPoint + PhaseDiff - 1) % 10243;
+
+	for (i = 0; i < PRN_WORDS(10230); i ++)
+		Code.Word[i] = StaticGetBits(B1CLegendre, Index1 + i * 32) ^ StaticGetBits(B1CLegendre, Index2 + i * 32);
+	Code.Word[PRN_WORDS(10230) - 1] &= StaticLastWordMask(10230);
+	return Code;
+}
+
+// same as PackPrnBits(GetMemorySequence(BinarySequence, SectorLength)), each sector has
+// 1023 chips MSB first in 32 words, so chip n is at bit (n + n / 1023) of reversed sequence
+template <int SectorLength>
+static constexpr PrnCodeWords<PRN_WORDS(SectorLength * 1023)> StaticMemoryCode(const unsigned int *BinarySequence)
+{
+	PrnCodeWords<SectorLength * 32> Reversed = {};
+	PrnCodeWords<PRN_WORDS(SectorLength * 1023)> Code = {};
+	int i = 0, Start = 0, Sector = 0, Boundary = 0;
+
+	for (i = 0; i < SectorLength * 32; i ++)
+		Reversed.Word[i] = StaticReverseBits(BinarySequence[i]);
+	for (i = 0; i < PRN_WORDS(SectorLength * 1023); i ++)
+	{
+		Start = i * 32;
+		Sector = Start / 1023;
+		Boundary = (Sector + 1) * 1023 - Start;	// chip offset of next sector within this word
+		if (Boundary >= 32)
+			Code.Word[i] = StaticGetBits(Reversed, Start + Sector);
+		else
+			Code.Word[i] = (StaticGetBits(Reversed, Start + Sector) & ((1U << Boundary) - 1)) | (StaticGetBits(Reversed, Start + Sector + 1) & ~((1U << Boundary) - 1));
+	}
+	Code.Word[PRN_WORDS(SectorLength * 1023) - 1] &= StaticLastWordMask(SectorLength * 1023);
+	return Code;
+}
+
+// table builders, generating functions are called with index into the code parameter tables
+template <int Count, int Length>
+static constexpr PrnCodeTable<Count, PRN_WORDS(Length)> StaticGoldTable(const unsigned int *G1Init, unsigned int G1Poly, unsigned int G2Init, unsigned int G2Poly, int Depth, int ResetPos)
+{
+	PrnCodeTable<Count, PRN_WORDS(Length)> Table = {};
+	PrnCodeWords<PRN_WORDS(Length)> Code = {};
+	int i = 0, j = 0;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Code = StaticGoldCode<Length>(G1Init[i], G1Poly, G2Init, G2Poly, Depth, ResetPos);
+		for (j = 0; j < PRN_WORDS(Length); j ++)
+			Table.Code[i][j] = Code.Word[j];
+	}
+	return Table;
+}
+
+// B2b G2 initial state is 0 for SVID 1~5 and 59~63
+static constexpr PrnCodeTable<63, PRN_WORDS(10230)> StaticB2bTable(const unsigned int *G1Init)
+{
+	PrnCodeTable<63, PRN_WORDS(10230)> Table = {};
+	PrnCodeWords<PRN_WORDS(10230)> Code = {};
+	int i = 0, j = 0;
+
+	for (i = 0; i < 63; i ++)
+	{
+		Code = StaticGoldCode<10230>(G1Init[i], 0x192c, (i < 5) || (i > 57) ? 0 : 0x1fff, 0x1301, 13, 8190);
+		for (j = 0; j < PRN_WORDS(10230); j ++)
+			Table.Code[i][j] = Code.Word[j];
+	}
+	return Table;
+}
+
+template <int Count>
+static constexpr PrnCodeTable<Count, PRN_WORDS(10230)> StaticL1CTable(const int *InsertIndex, const int *PhaseDiff)
+{
+	PrnCodeTable<Count, PRN_WORDS(10230)> Table = {};
+	PrnCodeWords<PRN_WORDS(10230)> Code = {};
+	int i = 0, j = 0;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Code = StaticL1CWeil(InsertIndex[i], PhaseDiff[i]);
+		for (j = 0; j < PRN_WORDS(10230); j ++)
+			Table.Code[i][j] = Code.Word[j];
+	}
+	return Table;
+}
+
+template <int Count>
+static constexpr PrnCodeTable<Count, PRN_WORDS(10230)> StaticB1CTable(const int *TruncationPoint, const int *PhaseDiff)
+{
+	PrnCodeTable<Count, PRN_WORDS(10230)> Table = {};
+	PrnCodeWords<PRN_WORDS(10230)> Code = {};
+	int i = 0, j = 0;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Code = StaticB1CWeil(TruncationPoint[i], PhaseDiff[i]);
+		for (j = 0; j < PRN_WORDS(10230); j ++)
+			Table.Code[i][j] = Code.Word[j];
+	}
+	return Table;
+}
+
+template <int Count, int SectorLength>
+static constexpr PrnCodeTable<Count, PRN_WORDS(SectorLength * 1023)> StaticMemoryTable(const unsigned int *BinarySequence)
+{
+	PrnCodeTable<Count, PRN_WORDS(SectorLength * 1023)> Table = {};
+	PrnCodeWords<PRN_WORDS(SectorLength * 1023)> Code = {};
+	int i = 0, j = 0;
+
+	for (i = 0; i < Count; i ++)
+	{
+		Code = StaticMemoryCode<SectorLength>(BinarySequence + i * SectorLength * 32);
+		for (j = 0; j < PRN_WORDS(SectorLength * 1023); j ++)
+			Table.Code[i][j] = Code.Word[j];
+	}
+	return Table;
+}
+
+// same as PackCombinedBits() with data and pilot code given as packed bits
+template <int Count, int Length>
+static constexpr PrnCodeTable<Count, PRN_COMBINED_WORDS(Length)> StaticCombinedTable(const PrnCodeTable<Count, PRN_WORDS(Length)> &DataTable, const PrnCodeTable<Count, PRN_WORDS(Length)> &PilotTable)
+{
+	PrnCodeTable<Count, PRN_COMBINED_WORDS(Length)> Table = {};
+	int i = 0, j = 0;
+
+	for (i = 0; i < Count; i ++)
+		for (j = 0; j < PRN_COMBINED_WORDS(Length); j ++)
+			Table.Code[i][j] = StaticSpreadBits((DataTable.Code[i][j >> 1] >> ((j & 1) * 16)) & 0xffff) |
+				(StaticSpreadBits((PilotTable.Code[i][j >> 1] >> ((j & 1) * 16)) & 0xffff) << 1);
+	return Table;
+}
+
+// compile time generated tables, friend of PrnGenerate to access code parameters
+struct PrnStaticTable
+{
+	// GPS
+	static constexpr PrnCodeTable<32, PRN_WORDS(1023)> L1CAPrnTable = StaticGoldTable<32, 1023>(PrnGenerate::L1CAPrnInit, 0x3a6, 0x3ff, 0x204, 10, 1023);
+	static constexpr PrnCodeTable<32, PRN_WORDS(10230)> L1CDataPrnTable = StaticL1CTable<32>(PrnGenerate::L1CDataInsertIndex, PrnGenerate::L1CDataPhaseDiff);
+	static constexpr PrnCodeTable<32, PRN_WORDS(10230)> L1CPilotPrnTable = StaticL1CTable<32>(PrnGenerate::L1CPilotInsertIndex, PrnGenerate::L1CPilotPhaseDiff);
+	static constexpr PrnCodeTable<32, PRN_COMBINED_WORDS(10230)> L1CCombinedPrnTable = StaticCombinedTable<32, 10230>(L1CDataPrnTable, L1CPilotPrnTable);
+	static constexpr PrnCodeTable<32, PRN_WORDS(10230)> L2CMPrnTable = StaticGoldTable<32, 10230>(PrnGenerate::L2CMPrnInit, 0x0494953c, 0x0, 0x0, 27, 10230);
+	static constexpr PrnCodeTable<32, PRN_WORDS(10230*75)> L2CLPrnTable = StaticGoldTable<32, 10230*75>(PrnGenerate::L2CLPrnInit, 0x0494953c, 0x0, 0x0, 27, 0);
+	static constexpr unsigned int L2PZeroCode[PRN_WORDS(10230*2)] = {};
+	static constexpr PrnCodeTable<32, PRN_WORDS(10230)> L5IPrnTable = StaticGoldTable<32, 10230>(PrnGenerate::L5IPrnInit, 0x18ed, 0x1fff, 0x1b00, 13, 8190);
+	static constexpr PrnCodeTable<32, PRN_WORDS(10230)> L5QPrnTable = StaticGoldTable<32, 10230>(PrnGenerate::L5QPrnInit, 0x18ed, 0x1fff, 0x1b00, 13, 8190);
+	static constexpr PrnCodeTable<32, PRN_COMBINED_WORDS(10230)> L5CombinedPrnTable = StaticCombinedTable<32, 10230>(L5IPrnTable, L5QPrnTable);
+	// BDS
+	static constexpr PrnCodeTable<63, PRN_WORDS(2046)> B1IPrnTable = StaticGoldTable<63, 2046>(PrnGenerate::B1IPrnInit, 0x59f, 0x2aa, 0x7c1, 11, 2046);
+	static constexpr PrnCodeTable<63, PRN_WORDS(10230)> B3IPrnTable = StaticGoldTable<63, 10230>(PrnGenerate::B3IPrnInit, 0x1b71, 0x1fff, 0x100d, 13, 8190);
+	static constexpr PrnCodeTable<63, PRN_WORDS(10230)> B1CDataPrnTable = StaticB1CTable<63>(PrnGenerate::B1CDataTruncation, PrnGenerate::B1CDataPhaseDiff);
+	static constexpr PrnCodeTable<63, PRN_WORDS(10230)> B1CPilotPrnTable = StaticB1CTable<63>(PrnGenerate::B1CPilotTruncation, PrnGenerate::B1CPilotPhaseDiff);
+	static constexpr PrnCodeTable<63, PRN_COMBINED_WORDS(10230)> B1CCombinedPrnTable = StaticCombinedTable<63, 10230>(B1CDataPrnTable, B1CPilotPrnTable);
+	static constexpr PrnCodeTable<63, PRN_WORDS(10230)> B2aDPrnTable = StaticGoldTable<63, 10230>(PrnGenerate::B2aDPrnInit, 0x1d14, 0x1fff, 0x1411, 13, 8190);
+	static constexpr PrnCodeTable<63, PRN_WORDS(10230)> B2aPPrnTable = StaticGoldTable<63, 10230>(PrnGenerate::B2aPPrnInit, 0x18d1, 0x1fff, 0x1064, 13, 8190);
+	static constexpr PrnCodeTable<63, PRN_COMBINED_WORDS(10230)> B2aCombinedPrnTable = StaticCombinedTable<63, 10230>(B2aDPrnTable, B2aPPrnTable);
+	static constexpr PrnCodeTable<63, PRN_WORDS(10230)> B2bPrnTable = StaticB2bTable(PrnGenerate::B2bPrnInit);
+	// Galileo, data code of SVID n at sector n-1 and pilot code at sector n+49 of memory code
+	static constexpr PrnCodeTable<36, PRN_WORDS(4092)> E1BPrnTable = StaticMemoryTable<36, 4>(PrnGenerate::E1MemoryCode);
+	static constexpr PrnCodeTable<36, PRN_WORDS(4092)> E1CPrnTable = StaticMemoryTable<36, 4>(PrnGenerate::E1MemoryCode + 50 * 128);
+	static constexpr PrnCodeTable<36, PRN_COMBINED_WORDS(4092)> E1CombinedPrnTable = StaticCombinedTable<36, 4092>(E1BPrnTable, E1CPrnTable);
+	static constexpr PrnCodeTable<36, PRN_WORDS(10230)> E5aIPrnTable = StaticGoldTable<36, 10230>(PrnGenerate::E5aIPrnInit, 0x28d8, 0x3fff, 0x20a1, 14, 10230);
+	static constexpr PrnCodeTable<36, PRN_WORDS(10230)> E5aQPrnTable = StaticGoldTable<36, 10230>(PrnGenerate::E5aQPrnInit, 0x28d8, 0x3fff, 0x20a1, 14, 10230);
+	static constexpr PrnCodeTable<36, PRN_COMBINED_WORDS(10230)> E5aCombinedPrnTable = StaticCombinedTable<36, 10230>(E5aIPrnTable, E5aQPrnTable);
+	static constexpr PrnCodeTable<36, PRN_WORDS(10230)> E5bIPrnTable = StaticGoldTable<36, 10230>(PrnGenerate::E5bIPrnInit, 0x2992, 0x3fff, 0x3408, 14, 10230);
+	static constexpr PrnCodeTable<36, PRN_WORDS(10230)> E5bQPrnTable = StaticGoldTable<36, 10230>(PrnGenerate::E5bQPrnInit, 0x2331, 0x3fff, 0x3408, 14, 10230);
+	static constexpr PrnCodeTable<36, PRN_COMBINED_WORDS(10230)> E5bCombinedPrnTable = StaticCombinedTable<36, 10230>(E5bIPrnTable, E5bQPrnTable);
+	static constexpr PrnCodeTable<36, PRN_WORDS(5115)> E6BPrnTable = StaticMemoryTable<36, 5>(PrnGenerate::E6MemoryCode);
+	static constexpr PrnCodeTable<36, PRN_WORDS(5115)> E6CPrnTable = StaticMemoryTable<36, 5>(PrnGenerate::E6MemoryCode + 50 * 160);
+	static constexpr PrnCodeTable<36, PRN_COMBINED_WORDS(5115)> E6CombinedPrnTable = StaticCombinedTable<36, 5115>(E6BPrnTable, E6CPrnTable);
+	// GLONASS, same code for all satellites
+	static constexpr unsigned int GloPrnInit[1] = { 0x1fc };
+	static constexpr PrnCodeTable<1, PRN_WORDS(511)> GloPrnTable = StaticGoldTable<1, 511>(GloPrnInit, 0x110, 0x0, 0x0, 9, 511);
+};
+#endif
+
 LsfrSequence::LsfrSequence(unsigned int InitState, unsigned int Polynomial, int Length) : mInitState(InitState), mPolynomial(Polynomial), mOutputMask(1<<(Length-1))
 {
 	mCurrentState = mInitState;
@@ -183,8 +538,15 @@ int LsfrSequence::GetOutput()
 	return Output;
 }
 
-PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid)
+PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid, BOOL StaticTable)
 {
+	int *DataCode, *PilotCode;
+	int DataChips, PilotChips;
+
+	DataPrn = PilotPrn = CombinedPrn = NULL;
+	StaticCode = FALSE;
+	if (StaticTable && GetStaticCode(System, SignalIndex, Svid))
+		return;
 	// signal and navigation bit match
 	switch (System)
 	{
@@ -192,39 +554,40 @@ PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid)
 		// validate GPS SVID range
 		if (Svid < 1 || Svid > 32)
 		{
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 			break;
 		}
 		switch (SignalIndex)
 		{
 		case SIGNAL_INDEX_L1CA:
-			DataPrn  = GetGoldCode(L1CAPrnInit[Svid-1], 0x3a6, 0x3ff, 0x204, 1023, 10, 1023);
-			PilotPrn = NULL;
+			DataCode  = GetGoldCode(L1CAPrnInit[Svid-1], 0x3a6, 0x3ff, 0x204, 1023, 10, 1023);
+			PilotCode = NULL;
 			Attribute = &PrnAttributes[0];
 			break;
 		case SIGNAL_INDEX_L1C:
-			DataPrn  = GetL1CWeil(L1CDataInsertIndex[Svid-1], L1CDataPhaseDiff[Svid-1]);
-			PilotPrn = GetL1CWeil(L1CPilotInsertIndex[Svid-1], L1CPilotPhaseDiff[Svid-1]);
+			DataCode  = GetL1CWeil(L1CDataInsertIndex[Svid-1], L1CDataPhaseDiff[Svid-1]);
+			PilotCode = GetL1CWeil(L1CPilotInsertIndex[Svid-1], L1CPilotPhaseDiff[Svid-1]);
 			Attribute = &PrnAttributes[1];
 			break;
 		case SIGNAL_INDEX_L2C:
-			DataPrn  = GetGoldCode(L2CMPrnInit[Svid-1], 0x0494953c, 0x0, 0x0, 10230, 27, 10230);
-			PilotPrn = GetGoldCode(L2CLPrnInit[Svid-1], 0x0494953c, 0x0, 0x0, 10230*75, 27, 0);
+			DataCode  = GetGoldCode(L2CMPrnInit[Svid-1], 0x0494953c, 0x0, 0x0, 10230, 27, 10230);
+			PilotCode = GetGoldCode(L2CLPrnInit[Svid-1], 0x0494953c, 0x0, 0x0, 10230*75, 27, 0);
 			Attribute = &PrnAttributes[2];
 			break;
 		case SIGNAL_INDEX_L2P:
-			DataPrn  = new int[10230*2];
-			PilotPrn = NULL;
+			DataCode  = NULL;	// P code not generated, leave all zero
+			PilotCode = NULL;
+			DataPrn = new unsigned int[(10230*2 + 31) / 32]();
 			Attribute = &PrnAttributes[3];
 			break;
 		case SIGNAL_INDEX_L5:
-			DataPrn  = GetGoldCode(L5IPrnInit[Svid-1], 0x18ed, 0x1fff, 0x1b00, 10230, 13, 8190);
-			PilotPrn = GetGoldCode(L5QPrnInit[Svid-1], 0x18ed, 0x1fff, 0x1b00, 10230, 13, 8190);
+			DataCode  = GetGoldCode(L5IPrnInit[Svid-1], 0x18ed, 0x1fff, 0x1b00, 10230, 13, 8190);
+			PilotCode = GetGoldCode(L5QPrnInit[Svid-1], 0x18ed, 0x1fff, 0x1b00, 10230, 13, 8190);
 			Attribute = &PrnAttributes[4];
 			break;
 		default:	// unknown SignalIndex
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 		}
 		break;
@@ -232,7 +595,7 @@ PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid)
 		// validate BDS SVID range
 		if (Svid < 1 || Svid > 63)
 		{
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 			break;
 		}
@@ -240,32 +603,32 @@ PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid)
 		{
 		case SIGNAL_INDEX_B1I:
 		case SIGNAL_INDEX_B2I:
-			DataPrn  = GetGoldCode(B1IPrnInit[Svid-1], 0x59f, 0x2aa, 0x7c1, 2046, 11, 2046);
-			PilotPrn = NULL;
+			DataCode  = GetGoldCode(B1IPrnInit[Svid-1], 0x59f, 0x2aa, 0x7c1, 2046, 11, 2046);
+			PilotCode = NULL;
 			Attribute = &PrnAttributes[5];
 			break;
 		case SIGNAL_INDEX_B3I:
-			DataPrn  = GetGoldCode(B3IPrnInit[Svid-1], 0x1b71, 0x1fff, 0x100d, 10230, 13, 8190);
-			PilotPrn = NULL;
+			DataCode  = GetGoldCode(B3IPrnInit[Svid-1], 0x1b71, 0x1fff, 0x100d, 10230, 13, 8190);
+			PilotCode = NULL;
 			Attribute = &PrnAttributes[6];
 			break;
 		case SIGNAL_INDEX_B1C: 
-			DataPrn  = GetB1CWeil(B1CDataTruncation[Svid-1], B1CDataPhaseDiff[Svid-1]);
-			PilotPrn = GetB1CWeil(B1CPilotTruncation[Svid-1], B1CPilotPhaseDiff[Svid-1]);
+			DataCode  = GetB1CWeil(B1CDataTruncation[Svid-1], B1CDataPhaseDiff[Svid-1]);
+			PilotCode = GetB1CWeil(B1CPilotTruncation[Svid-1], B1CPilotPhaseDiff[Svid-1]);
 			Attribute = &PrnAttributes[1];
 			break;
 		case SIGNAL_INDEX_B2a:
-			DataPrn  = GetGoldCode(B2aDPrnInit[Svid-1], 0x1d14, 0x1fff, 0x1411, 10230, 13, 8190);
-			PilotPrn = GetGoldCode(B2aPPrnInit[Svid-1], 0x18d1, 0x1fff, 0x1064, 10230, 13, 8190);
+			DataCode  = GetGoldCode(B2aDPrnInit[Svid-1], 0x1d14, 0x1fff, 0x1411, 10230, 13, 8190);
+			PilotCode = GetGoldCode(B2aPPrnInit[Svid-1], 0x18d1, 0x1fff, 0x1064, 10230, 13, 8190);
 			Attribute = &PrnAttributes[4];
 			break;
 		case SIGNAL_INDEX_B2b:
-			DataPrn  = GetGoldCode(B2bPrnInit[Svid-1], 0x192c, (Svid < 6) || (Svid > 58) ? 0 : 0x1fff, 0x1301, 10230, 13, 8190);
-			PilotPrn = NULL;
+			DataCode  = GetGoldCode(B2bPrnInit[Svid-1], 0x192c, (Svid < 6) || (Svid > 58) ? 0 : 0x1fff, 0x1301, 10230, 13, 8190);
+			PilotCode = NULL;
 			Attribute = &PrnAttributes[7];
 			break;
 		default:	// unknown SignalIndex
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 		}
 		break;
@@ -273,34 +636,34 @@ PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid)
 		// validate Galileo SVID range
 		if (Svid < 1 || Svid > 36)
 		{
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 			break;
 		}
 		switch (SignalIndex)
 		{
 		case SIGNAL_INDEX_E1 :
-			DataPrn  = GetMemorySequence(E1MemoryCode + (Svid - 1) * 128, 4);
-			PilotPrn = GetMemorySequence(E1MemoryCode + (Svid + 49) * 128, 4);
+			DataCode  = GetMemorySequence(E1MemoryCode + (Svid - 1) * 128, 4);
+			PilotCode = GetMemorySequence(E1MemoryCode + (Svid + 49) * 128, 4);
 			Attribute = &PrnAttributes[8];
 			break;
 		case SIGNAL_INDEX_E5a:
-			DataPrn  = GetGoldCode(E5aIPrnInit[Svid-1], 0x28d8, 0x3fff, 0x20a1, 10230, 14, 10230);
-			PilotPrn = GetGoldCode(E5aQPrnInit[Svid-1], 0x28d8, 0x3fff, 0x20a1, 10230, 14, 10230);
+			DataCode  = GetGoldCode(E5aIPrnInit[Svid-1], 0x28d8, 0x3fff, 0x20a1, 10230, 14, 10230);
+			PilotCode = GetGoldCode(E5aQPrnInit[Svid-1], 0x28d8, 0x3fff, 0x20a1, 10230, 14, 10230);
 			Attribute = &PrnAttributes[4];
 			break;
 		case SIGNAL_INDEX_E5b:
-			DataPrn  = GetGoldCode(E5bIPrnInit[Svid-1], 0x2992, 0x3fff, 0x3408, 10230, 14, 10230);
-			PilotPrn = GetGoldCode(E5bQPrnInit[Svid-1], 0x2331, 0x3fff, 0x3408, 10230, 14, 10230);
+			DataCode  = GetGoldCode(E5bIPrnInit[Svid-1], 0x2992, 0x3fff, 0x3408, 10230, 14, 10230);
+			PilotCode = GetGoldCode(E5bQPrnInit[Svid-1], 0x2331, 0x3fff, 0x3408, 10230, 14, 10230);
 			Attribute = &PrnAttributes[4];
 			break;
 		case SIGNAL_INDEX_E6 :
-			DataPrn  = GetMemorySequence(E6MemoryCode + (Svid - 1) * 160, 5);
-			PilotPrn = GetMemorySequence(E6MemoryCode + (Svid + 49) * 160, 5);
+			DataCode  = GetMemorySequence(E6MemoryCode + (Svid - 1) * 160, 5);
+			PilotCode = GetMemorySequence(E6MemoryCode + (Svid + 49) * 160, 5);
 			Attribute = &PrnAttributes[9];
 			break;
 		default:	// unknown SignalIndex
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 		}
 		break;
@@ -309,27 +672,183 @@ PrnGenerate::PrnGenerate(GnssSystem System, int SignalIndex, int Svid)
 		{
 		case SIGNAL_INDEX_G1:
 		case SIGNAL_INDEX_G2:
-			DataPrn  = GetGoldCode(0x1fc, 0x110, 0x0, 0x0, 511, 9, 511);
-			PilotPrn = NULL;
+			DataCode  = GetGoldCode(0x1fc, 0x110, 0x0, 0x0, 511, 9, 511);
+			PilotCode = NULL;
 			Attribute = &PrnAttributes[10];
 			break;
 		default:	// unknown SignalIndex
-			DataPrn = NULL; PilotPrn = NULL;
+			DataCode = NULL; PilotCode = NULL;
 			Attribute = NULL;
 		}
 		break;
 	default:	// unknown system
-		DataPrn = NULL; PilotPrn = NULL;
+		DataCode = NULL; PilotCode = NULL;
 		Attribute = NULL;
 	}
+
+	if (!DataCode)
+		return;
+
+	// BOC and TMD signals have 2 modulated chips for each PRN chip
+	DataChips = Attribute->DataPeriod * Attribute->ChipRate;
+	PilotChips = Attribute->PilotPeriod * Attribute->ChipRate;
+	if (Attribute->Attribute & (PRN_ATTRIBUTE_BOC | PRN_ATTRIBUTE_TMD))
+	{
+		DataChips >>= 1;
+		PilotChips >>= 1;
+	}
+	DataPrn = PackPrnBits(DataCode, DataChips);
+	if (PilotCode)
+	{
+		PilotPrn = PackPrnBits(PilotCode, PilotChips);
+		if (PilotChips == DataChips)
+			CombinedPrn = PackCombinedBits(DataCode, PilotCode, DataChips);
+	}
+	delete[] DataCode;
+	delete[] PilotCode;
 }
 
 PrnGenerate::~PrnGenerate()
 {
-	if (DataPrn)
-		delete DataPrn;
-	if (PilotPrn)
-		delete PilotPrn;
+	if (StaticCode)
+		return;
+	delete[] DataPrn;
+	delete[] PilotPrn;
+	delete[] CombinedPrn;
+}
+
+BOOL PrnGenerate::HasStaticTable()
+{
+#ifdef PRN_STATIC_TABLES
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+// point code arrays to compile time generated tables, return FALSE if not available
+BOOL PrnGenerate::GetStaticCode(GnssSystem System, int SignalIndex, int Svid)
+{
+#ifdef PRN_STATIC_TABLES
+	int Index = Svid - 1;
+
+	switch (System)
+	{
+	case GpsSystem:
+		if (Svid < 1 || Svid > 32)
+			return FALSE;
+		switch (SignalIndex)
+		{
+		case SIGNAL_INDEX_L1CA:
+			DataPrn = PrnStaticTable::L1CAPrnTable.Code[Index];
+			Attribute = &PrnAttributes[0];
+			break;
+		case SIGNAL_INDEX_L1C:
+			DataPrn = PrnStaticTable::L1CDataPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::L1CPilotPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::L1CCombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[1];
+			break;
+		case SIGNAL_INDEX_L2C:
+			DataPrn = PrnStaticTable::L2CMPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::L2CLPrnTable.Code[Index];
+			Attribute = &PrnAttributes[2];
+			break;
+		case SIGNAL_INDEX_L2P:
+			DataPrn = PrnStaticTable::L2PZeroCode;
+			Attribute = &PrnAttributes[3];
+			break;
+		case SIGNAL_INDEX_L5:
+			DataPrn = PrnStaticTable::L5IPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::L5QPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::L5CombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[4];
+			break;
+		default:
+			return FALSE;
+		}
+		break;
+	case BdsSystem:
+		if (Svid < 1 || Svid > 63)
+			return FALSE;
+		switch (SignalIndex)
+		{
+		case SIGNAL_INDEX_B1I:
+		case SIGNAL_INDEX_B2I:
+			DataPrn = PrnStaticTable::B1IPrnTable.Code[Index];
+			Attribute = &PrnAttributes[5];
+			break;
+		case SIGNAL_INDEX_B3I:
+			DataPrn = PrnStaticTable::B3IPrnTable.Code[Index];
+			Attribute = &PrnAttributes[6];
+			break;
+		case SIGNAL_INDEX_B1C:
+			DataPrn = PrnStaticTable::B1CDataPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::B1CPilotPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::B1CCombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[1];
+			break;
+		case SIGNAL_INDEX_B2a:
+			DataPrn = PrnStaticTable::B2aDPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::B2aPPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::B2aCombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[4];
+			break;
+		case SIGNAL_INDEX_B2b:
+			DataPrn = PrnStaticTable::B2bPrnTable.Code[Index];
+			Attribute = &PrnAttributes[7];
+			break;
+		default:
+			return FALSE;
+		}
+		break;
+	case GalileoSystem:
+		if (Svid < 1 || Svid > 36)
+			return FALSE;
+		switch (SignalIndex)
+		{
+		case SIGNAL_INDEX_E1:
+			DataPrn = PrnStaticTable::E1BPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::E1CPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::E1CombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[8];
+			break;
+		case SIGNAL_INDEX_E5a:
+			DataPrn = PrnStaticTable::E5aIPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::E5aQPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::E5aCombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[4];
+			break;
+		case SIGNAL_INDEX_E5b:
+			DataPrn = PrnStaticTable::E5bIPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::E5bQPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::E5bCombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[4];
+			break;
+		case SIGNAL_INDEX_E6:
+			DataPrn = PrnStaticTable::E6BPrnTable.Code[Index];
+			PilotPrn = PrnStaticTable::E6CPrnTable.Code[Index];
+			CombinedPrn = PrnStaticTable::E6CombinedPrnTable.Code[Index];
+			Attribute = &PrnAttributes[9];
+			break;
+		default:
+			return FALSE;
+		}
+		break;
+	case GlonassSystem:
+		if (SignalIndex != SIGNAL_INDEX_G1 && SignalIndex != SIGNAL_INDEX_G2)
+			return FALSE;
+		DataPrn = PrnStaticTable::GloPrnTable.Code[0];
+		Attribute = &PrnAttributes[10];
+		break;
+	default:
+		return FALSE;
+	}
+	StaticCode = TRUE;
+	return TRUE;
+#else
+	return FALSE;
+#endif
 }
 
 int *PrnGenerate::GetGoldCode(unsigned int G1Init, unsigned int G1Poly, unsigned int G2Init, unsigned int G2Poly, int Length, int Depth, int ResetPos)
@@ -404,3 +923,184 @@ int *PrnGenerate::GetMemorySequence(const unsigned int *BinarySequence, int Sect
 
 	return PrnSequence;
 }
+
+unsigned int *PrnGenerate::PackPrnBits(const int *Code, int Length)
+{
+	unsigned int *PackedCode = new unsigned int[(Length + 31) / 32]();
+	int i;
+
+	for (i = 0; i < Length; i ++)
+		if (Code[i])
+			PackedCode[i >> 5] |= 1U << (i & 0x1f);
+	return PackedCode;
+}
+
+unsigned int *PrnGenerate::PackCombinedBits(const int *DataCode, const int *PilotCode, int Length)
+{
+	unsigned int *PackedCode = new unsigned int[(Length + 15) / 16]();
+	int i;
+
+	for (i = 0; i < Length; i ++)
+		PackedCode[i >> 4] |= ((DataCode[i] ? 1U : 0U) | (PilotCode[i] ? 2U : 0U)) << ((i & 0xf) * 2);
+	return PackedCode;
+}
+
+unsigned int PrnCache::CacheKey(GnssSystem System, int SignalIndex, int Svid)
+{
+	// signals generating identical code share one entry
+	if (System == GlonassSystem && (SignalIndex == SIGNAL_INDEX_G1 || SignalIndex == SIGNAL_INDEX_G2))	// FDMA, same code for all satellites and both bands
+		Svid = SignalIndex = 0;
+	else if (System == BdsSystem && SignalIndex == SIGNAL_INDEX_B2I)
+		SignalIndex = SIGNAL_INDEX_B1I;
+	return ((unsigned int)System << 16) | ((unsigned int)(SignalIndex & 0xff) << 8) | (unsigned int)(Svid & 0xff);
+}
+
+int PrnCache::CodeBytes(const PrnGenerate *Prn)
+{
+	int DataChips, PilotChips;
+
+	if (!Prn->Attribute || !Prn->DataPrn)
+		return 0;
+	DataChips = Prn->Attribute->DataPeriod * Prn->Attribute->ChipRate;
+	PilotChips = Prn->Attribute->PilotPeriod * Prn->Attribute->ChipRate;
+	if (Prn->Attribute->Attribute & (PRN_ATTRIBUTE_BOC | PRN_ATTRIBUTE_TMD))
+	{
+		DataChips >>= 1;
+		PilotChips >>= 1;
+	}
+	// same word count as PackPrnBits() and PackCombinedBits()
+	return (((DataChips + 31) >> 5) + (Prn->PilotPrn ? ((PilotChips + 31) >> 5) : 0) + (Prn->CombinedPrn ? ((DataChips + 15) >> 4) : 0)) * (int)sizeof(unsigned int);
+}
+
+const PrnGenerate *PrnCache::Acquire(GnssSystem System, int SignalIndex, int Svid)
+{
+	unsigned int Key = CacheKey(System, SignalIndex, Svid);
+	std::map<unsigned int, PRN_CACHE_ENTRY>::iterator Entry;
+	PrnGenerate *Prn;
+
+	{
+		std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+		Entry = PrnCacheMap.find(Key);
+		if (Entry != PrnCacheMap.end())
+		{
+			Entry->second.RefCount ++;
+			PrnCacheHits ++;
+			return Entry->second.Prn;
+		}
+	}
+
+	// generate outside the lock, another thread may insert the same code meanwhile
+	Prn = new PrnGenerate(System, SignalIndex, Svid);
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+	Entry = PrnCacheMap.find(Key);
+	if (Entry != PrnCacheMap.end())
+	{
+		delete Prn;
+		Entry->second.RefCount ++;
+		PrnCacheHits ++;
+		return Entry->second.Prn;
+	}
+	PrnCacheMap[Key].Prn = Prn;
+	PrnCacheMap[Key].RefCount = 1;
+	PrnCacheGenerates ++;
+	return Prn;
+}
+
+void PrnCache::Release(const PrnGenerate *Prn)
+{
+	std::map<unsigned int, PRN_CACHE_ENTRY>::iterator Entry;
+
+	if (!Prn)
+		return;
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+	for (Entry = PrnCacheMap.begin(); Entry != PrnCacheMap.end(); Entry ++)
+	{
+		if (Entry->second.Prn != Prn)
+			continue;
+		if (-- Entry->second.RefCount <= 0)
+		{
+			delete Entry->second.Prn;
+			PrnCacheMap.erase(Entry);
+		}
+		return;
+	}
+}
+
+// generate all codes in Keys[] not in cache yet, return number of codes generated
+int PrnCache::Preload(const PRN_CACHE_KEY Keys[], int Count)
+{
+	std::vector<PRN_CACHE_KEY> Missing;
+	std::vector<unsigned int> MissingKey;
+	std::vector<PrnGenerate *> Generated;
+	unsigned int Key;
+	int i, j, GenerateCount = 0;
+
+	{
+		std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+		for (i = 0; i < Count; i ++)
+		{
+			Key = CacheKey(Keys[i].System, Keys[i].SignalIndex, Keys[i].Svid);
+			if (PrnCacheMap.find(Key) != PrnCacheMap.end())
+				continue;
+			for (j = 0; j < (int)MissingKey.size(); j ++)
+				if (MissingKey[j] == Key)
+					break;
+			if (j == (int)MissingKey.size())
+			{
+				Missing.push_back(Keys[i]);
+				MissingKey.push_back(Key);
+			}
+		}
+	}
+
+	Generated.resize(Missing.size());
+	#pragma omp parallel for schedule(dynamic)
+	for (i = 0; i < (int)Missing.size(); i ++)
+		Generated[i] = new PrnGenerate(Missing[i].System, Missing[i].SignalIndex, Missing[i].Svid);
+
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+	for (i = 0; i < (int)Generated.size(); i ++)
+	{
+		if (PrnCacheMap.find(MissingKey[i]) != PrnCacheMap.end())
+		{
+			delete Generated[i];
+			continue;
+		}
+		PrnCacheMap[MissingKey[i]].Prn = Generated[i];
+		PrnCacheMap[MissingKey[i]].RefCount = 0;
+		PrnCacheGenerates ++;
+		GenerateCount ++;
+	}
+	return GenerateCount;
+}
+
+// free all entries not referenced by any channel
+void PrnCache::Flush()
+{
+	std::map<unsigned int, PRN_CACHE_ENTRY>::iterator Entry;
+
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+	for (Entry = PrnCacheMap.begin(); Entry != PrnCacheMap.end(); )
+	{
+		if (Entry->second.RefCount > 0)
+		{
+			Entry ++;
+			continue;
+		}
+		delete Entry->second.Prn;
+		PrnCacheMap.erase(Entry ++);
+	}
+}
+
+void PrnCache::GetStatistics(int &EntryCount, int &HitCount, int &GenerateCount, int &TotalBytes)
+{
+	std::map<unsigned int, PRN_CACHE_ENTRY>::iterator Entry;
+
+	std::lock_guard<std::mutex> Lock(PrnCacheMutex);
+	EntryCount = (int)PrnCacheMap.size();
+	HitCount = PrnCacheHits;
+	GenerateCount = PrnCacheGenerates;
+	TotalBytes = 0;
+	for (Entry = PrnCacheMap.begin(); Entry != PrnCacheMap.end(); Entry ++)
+		TotalBytes += CodeBytes(Entry->second.Prn);
+}
@@ -8,15 +8,20 @@
 #include <math.h>
 #include <stdio.h>
 #include <memory.h>
+#include <algorithm>
 
 #include "SatIfSignal.h"
 #include "FastMath.h"
 
-CSatIfSignal::CSatIfSignal(int MsSampleNumber, int SatIfFreq, GnssSystem SatSystem, int SatSignalIndex, unsigned char SatId) : SampleNumber(MsSampleNumber), IfFreq(SatIfFreq), System(SatSystem), SignalIndex(SatSignalIndex), Svid((int)SatId)
+CSatIfSignal::CSatIfSignal(int MsSampleNumber, int SatIfFreq, GnssSystem SatSystem, int SatSignalIndex, unsigned char SatId, IfSampleType SatSampleType) : SampleType(SatSampleType), SampleNumber(MsSampleNumber), IfFreq(SatIfFreq), System(SatSystem), SignalIndex(SatSignalIndex), Svid((int)SatId)
 {
-	SampleArray = new complex_number[SampleNumber];
-	PrnSequence = new PrnGenerate(System, SignalIndex, Svid);
+	SampleArray = NULL;
+	FloatSampleArray = NULL;
+	Int16SampleArray = NULL;
+	PrnSequence = PrnCache::Acquire(System, SignalIndex, Svid);
 	SatParam = NULL;
+	SegmentNumber = 0;
+	PrnVariant = IF_PRN_GENERIC;
 
 	if (!PrnSequence->Attribute || !PrnSequence->DataPrn)
 		DataLength = PilotLength = 0;
@@ -31,13 +36,31 @@ CSatIfSignal::~CSatIfSignal()
 {
 	delete[] SampleArray;
 	SampleArray = NULL;
-	delete PrnSequence;
+	delete[] FloatSampleArray;
+	FloatSampleArray = NULL;
+	delete[] Int16SampleArray;
+	Int16SampleArray = NULL;
+	PrnCache::Release(PrnSequence);
 	PrnSequence = NULL;
 }
 
 void CSatIfSignal::InitState(GNSS_TIME CurTime, CSatelliteParam *pSatParam, NavBit* pNavData)
 {
+	int i;
+
 	SatParam = pSatParam;
+	// build FastMath tables here (called before any generation thread starts), lazy
+	// initialization within GenerateSegments() is not safe with concurrent channels
+	FastMath::InitializeLUT();
+	// PRN code and kernel variant of the channel do not change with time, so set once for all segments
+	for (i = 0; i < MAX_IF_SEGMENT * MAX_IF_BLOCK_MS; i ++)
+	{
+		Segments[i].DataPrn = PrnSequence->DataPrn;
+		Segments[i].PilotPrn = (PilotLength > 0) ? PrnSequence->PilotPrn : NULL;
+		Segments[i].CombinedPrn = (PilotLength == DataLength) ? PrnSequence->CombinedPrn : NULL;
+		Segments[i].Attribute = PrnSequence->Attribute ? PrnSequence->Attribute->Attribute : 0;
+		Segments[i].PrnVariant = PrnVariant = GetIfPrnVariant(&Segments[i]);
+	}
 	if (!SatelliteSignal.SetSignalAttribute(System, SignalIndex, pNavData, Svid))
 		SatelliteSignal.NavData = (NavBit*)0;	// if system/frequency and navigation data not match, set pointer to NULL
 //	StartCarrierPhase = GetCarrierPhase(SatParam, SignalIndex);
@@ -49,16 +72,46 @@ void CSatIfSignal::InitState(GNSS_TIME CurTime, CSatelliteParam *pSatParam, NavB
 
 void CSatIfSignal::GetIfSample(GNSS_TIME CurTime)
 {
-	int i, TransmitMsDiff;
+	PrepareIfSample(CurTime);
+	if (SampleType == IfSampleFloat)
+	{
+		if (!FloatSampleArray)
+			FloatSampleArray = new complex_float[SampleNumber];
+		GenerateIfSample(FloatSampleArray);
+	}
+	else if (SampleType == IfSampleInt16)
+	{
+		if (!Int16SampleArray)
+			Int16SampleArray = new complex_int16[SampleNumber];
+		GenerateIfSample(Int16SampleArray);
+	}
+	else
+	{
+		if (!SampleArray)
+			SampleArray = new complex_number[SampleNumber];
+		GenerateIfSample(SampleArray);
+	}
+}
+
+// calculate code/carrier NCO of next millisecond and split samples into segments
+// at data code period boundaries, data/pilot modulation keeps unchanged within each segment
+// segments of millisecond MsIndex are appended to segments of previous milliseconds of the block
+void CSatIfSignal::PrepareIfSample(GNSS_TIME CurTime, int MsIndex)
+{
+	int i, Count, TransmitMsDiff, ChipCount, DataBase, LastSegment;
 	double CurPhase, PhaseStep, CurChip, CodeDiff, CodeStep;
 	unsigned int CurIntPhase;
 	int IntPhaseStep;
+	unsigned long long ChipPhase, ChipStep, Distance;
 	const PrnAttribute* CodeAttribute = PrnSequence->Attribute;
-	complex_number IfSample;
+	PIF_SEGMENT_PARAM Segment;
 	double Amp;
 
-	if (!SatParam)
+	if (MsIndex == 0)
+		SegmentNumber = 0;
+	if (!SatParam || MsIndex >= MAX_IF_BLOCK_MS)
 		return;
+	LastSegment = SegmentNumber + MAX_IF_SEGMENT - 1;
 	Amp = pow(10, (SatParam->CN0 - 3000) / 2000.) / sqrt(SampleNumber);
 	SignalTime = StartTransmitTime;
 	SatelliteSignal.GetSatelliteSignal(SignalTime, DataSignal, PilotSignal);
@@ -86,126 +139,117 @@ void CSatIfSignal::GetIfSample(GNSS_TIME CurTime)
 	CodeStep = CodeDiff / SampleNumber;	// code increase between each sample
 	CurChip = (StartTransmitTime.MilliSeconds % CodeAttribute->PilotPeriod + StartTransmitTime.SubMilliSeconds) * CodeAttribute->ChipRate;
 	StartTransmitTime = EndTransmitTime;
+	if (DataLength == 0)
+		return;
 
-	FastMath::InitializeLUT();
-	for (i = 0; i < SampleNumber; i ++)
+	// code NCO in 32.32 fixed point
+	ChipPhase = (unsigned long long)(CurChip * 4294967296. + 0.5);
+	ChipStep = (unsigned long long)(CodeStep * 4294967296. + 0.5);
+	if (ChipStep == 0)
+		ChipStep = 1;
+	for (i = 0; i < SampleNumber && SegmentNumber <= LastSegment; i += Count)
 	{
-//		SampleArray[i] = GetPrnValue(CurChip, CodeStep) * GetRotateValue(CurPhase, PhaseStep) * Amp;
-		SampleArray[i] = GetPrnValue(CurChip, CodeStep) * GetRotateValue(CurIntPhase, IntPhaseStep) * Amp;
+		ChipCount = (int)(ChipPhase >> 32);
+		DataBase = ChipCount - ChipCount % DataLength;
+		// number of samples before code phase reaches next data code period
+		Distance = ((unsigned long long)(DataBase + DataLength) << 32) - ChipPhase;
+		Count = (int)((Distance + ChipStep - 1) / ChipStep);
+		if (Count > SampleNumber - i || SegmentNumber == LastSegment)
+			Count = SampleNumber - i;
+		Segment = &Segments[SegmentNumber ++];
+		Segment->SampleCount = Count;
+		Segment->ChipPhase = ChipPhase;
+		Segment->ChipStep = ChipStep;
+		Segment->CarrierPhase = CurIntPhase;
+		Segment->CarrierStep = IntPhaseStep;
+		Segment->DataBase = DataBase;
+		Segment->PilotBase = (PilotLength > 0) ? DataBase % PilotLength : 0;
+		Segment->DataSignal = DataSignal * Amp;
+		Segment->PilotSignal = PilotSignal * Amp;
+		ChipPhase += ChipStep * Count;
+		CurIntPhase += (unsigned int)IntPhaseStep * (unsigned int)Count;
+		// next segment starts a new data code period (pilot code period multiple of data code period)
+		if (i + Count < SampleNumber)
+		{
+			SignalTime.MilliSeconds += CodeAttribute->DataPeriod;
+			SatelliteSignal.GetSatelliteSignal(SignalTime, DataSignal, PilotSignal);
+		}
 	}
 }
 
-complex_number CSatIfSignal::GetPrnValue(double& CurChip, double CodeStep)
+// generate samples of current millisecond prepared by PrepareIfSample()
+void CSatIfSignal::GenerateIfSample(complex_number *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
 {
-	int ChipCount = (int)CurChip;
-	int DataChip, PilotChip;
-	complex_number PrnValue;
-	int IsBoc = (PrnSequence->Attribute->Attribute) & PRN_ATTRIBUTE_BOC;
-	int IsL2C = (PrnSequence->Attribute->Attribute) & PRN_ATTRIBUTE_TMD;
+	GenerateSegments(Output, 0, SampleNumber, Isa, ChipRun);
+}
 
-	if (DataLength == 0)
-		return complex_number(0, 0);
+void CSatIfSignal::GenerateIfSample(complex_float *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	GenerateSegments(Output, 0, SampleNumber, Isa, ChipRun);
+}
 
-	DataChip = ChipCount % DataLength;
-	if (IsBoc || IsL2C)
-		DataChip >>= 1;
-	PrnValue = PrnSequence->DataPrn[DataChip] ? -DataSignal : DataSignal;
-	if (PrnSequence->PilotPrn && PilotLength > 0)
-	{
-		PilotChip = ChipCount % PilotLength;
-		if (IsBoc || IsL2C)
-			PilotChip >>= 1;
-		if (IsL2C)
-		{
-			if (ChipCount & 1)	// L2CL slot
-				PrnValue = PrnSequence->PilotPrn[PilotChip] ? -PilotSignal : PilotSignal;
-		}
-		else
-			PrnValue += PrnSequence->PilotPrn[PilotChip] ? -PilotSignal : PilotSignal;
-	}
-	if (IsBoc && (ChipCount & 1))	// second half of BOC code
-		PrnValue *= -1;
-	CurChip += CodeStep;
-	// check whether go beyond next code period (pilot code period multiple of data code period, so only check data period)
-	if ((((int)CurChip) % DataLength) < DataChip)
-	{
-		SignalTime.MilliSeconds += PrnSequence->Attribute->DataPeriod;
-		SatelliteSignal.GetSatelliteSignal(SignalTime, DataSignal, PilotSignal);
-	}
-	return PrnValue;
+void CSatIfSignal::GenerateIfSample(complex_int16 *Output, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	GenerateSegments(Output, 0, SampleNumber, Isa, ChipRun);
 }
 
-complex_number CSatIfSignal::GetRotateValue(double& CurPhase, double PhaseStep)
+void CSatIfSignal::GenerateIfSample(complex_number *Output, int Start, int Count, IfKernelIsa Isa, IfChipRunMode ChipRun)
 {
-//	complex_number Rotate = complex_number(cos(CurPhase * PI2), sin(CurPhase * PI2));
-	complex_number Rotate = FastMath::FastRotate(CurPhase * PI2);	// TODO: further optimize with integer phase
-	CurPhase += PhaseStep;
-	return Rotate;
+	GenerateSegments(Output, Start, Count, Isa, ChipRun);
 }
 
-complex_number CSatIfSignal::GetRotateValue(unsigned int & CurPhase, int PhaseStep)
+void CSatIfSignal::GenerateIfSample(complex_float *Output, int Start, int Count, IfKernelIsa Isa, IfChipRunMode ChipRun)
 {
-	complex_number Rotate = FastMath::FastRotate(CurPhase);
-	CurPhase += PhaseStep;
-	return Rotate;
+	GenerateSegments(Output, Start, Count, Isa, ChipRun);
 }
 
-#if 0
-// Cannot correctly deal with data/secondary code modulation yet, just put here for future optimize
-void CSatIfSignal::GenerateSamplesVectorized(int SampleCount, double& CurChip, double CodeStep, double& CurPhase, double PhaseStep, double Amp)
+void CSatIfSignal::GenerateIfSample(complex_int16 *Output, int Start, int Count, IfKernelIsa Isa, IfChipRunMode ChipRun)
 {
-	// MEGA-OPTIMIZED generation for maximum speed
-	if (!PrnSequence || !PrnSequence->DataPrn)
-	{
-		// Fast zero-padding
-		memset(SampleArray, 0, SampleCount * sizeof(complex_number));
-		CurChip += CodeStep * SampleCount;
-		CurPhase += PhaseStep * SampleCount;
-		return;
-	}
+	GenerateSegments(Output, Start, Count, Isa, ChipRun);
+}
+
+// code/carrier NCO and modulation of sample Offset within current block in closed form,
+// segments are split at data code period boundaries, which are also the only places navigation
+// data bit, secondary code chip and pilot overlay code can change, so the state of any sample is
+// its segment start state plus Offset times NCO step in fixed point. SampleCount of State is set
+// to number of samples from Offset to end of the segment. Return FALSE if Offset out of range
+BOOL CSatIfSignal::GetSampleState(int Offset, PIF_SEGMENT_PARAM State)
+{
+	int i, SegmentStart;
 
-	// Precomputed constants for speed
-	const int* __restrict DataPrn = PrnSequence->DataPrn;
-	const int* __restrict PilotPrn = PrnSequence->PilotPrn;
-	const double DataReal = DataSignal.real;
-	const double DataImag = DataSignal.imag;
-	const double PilotReal = PilotSignal.real;
-	const double PilotImag = PilotSignal.imag;
-	const double PI2_local = PI2;
-
-	// SUPER-FAST generation without unnecessary checks
-//	#pragma omp simd
-	for (int i = 0; i < SampleCount; i++)
+	if (Offset < 0)
+		return FALSE;
+	for (i = 0, SegmentStart = 0; i < SegmentNumber; SegmentStart += Segments[i ++].SampleCount)
 	{
-		// PRN index with minimal calculations
-		const int ChipCount = (int)(CurChip + i * CodeStep);
-		const int DataChip = ChipCount % DataLength;
+		if (Offset >= SegmentStart + Segments[i].SampleCount)
+			continue;
+		*State = Segments[i];
+		Offset -= SegmentStart;
+		State->SampleCount -= Offset;
+		State->ChipPhase += State->ChipStep * Offset;
+		State->CarrierPhase += (unsigned int)State->CarrierStep * (unsigned int)Offset;
+		return TRUE;
+	}
+	return FALSE;
+}
 
-		// Fast getting of PRN value
-		const double dataSign = DataPrn[DataChip] ? -1.0 : 1.0;
-		double prnReal = DataReal * dataSign;
-		double prnImag = DataImag * dataSign;
+// generate samples Start to Start+Count-1 of current block, state of the first sample of each
+// segment within the range comes from GetSampleState(), so any sub-range gives exactly the same
+// samples as generating whole block and a channel can be split across threads
+template <typename T> void CSatIfSignal::GenerateSegments(T *Output, int Start, int Count, IfKernelIsa Isa, IfChipRunMode ChipRun)
+{
+	int Offset, Length;
+	IF_SEGMENT_PARAM Segment;
 
-		// Pilot PRN only if present
-		if (PilotPrn && PilotLength > 0)
+	for (Offset = 0; Offset < Count; Offset += Length)
+	{
+		if (!GetSampleState(Start + Offset, &Segment))
 		{
-			const int PilotChip = ChipCount % PilotLength;
-			const double pilotSign = PilotPrn[PilotChip] ? -1.0 : 1.0;
-			prnReal += PilotReal * pilotSign;
-			prnImag += PilotImag * pilotSign;
+			std::fill(Output + Offset, Output + Count, T());
+			return;
 		}
-
-		// Fast phase rotation
-		const double phase = (CurPhase + i * PhaseStep) * PI2_local;
-		const complex_number rotation = FastMath::FastRotate(phase);
-
-		// Final signal with inline multiplication
-		SampleArray[i].real = (prnReal * rotation.real - prnImag * rotation.imag) * Amp;
-		SampleArray[i].imag = (prnReal * rotation.imag + prnImag * rotation.real) * Amp;
+		Length = (Segment.SampleCount < Count - Offset) ? Segment.SampleCount : Count - Offset;
+		Segment.SampleCount = Length;
+		GenerateIfSegment(&Segment, Output + Offset, Isa, ChipRun);
 	}
-
-	// Update state
-	CurChip += CodeStep * SampleCount;
-	CurPhase += PhaseStep * SampleCount;
 }
-#endif
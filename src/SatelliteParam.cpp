@@ -10,6 +10,7 @@
 #include "ConstVal.h"
 #include "SatelliteParam.h"
 #include "Coordinate.h"
+#include "OrbitBatch.h"
 #include "GnssTime.h"
 #include "XmlInterpreter.h"
 
@@ -17,38 +18,52 @@ static void GetSatPosVel(GnssSystem system, double SatelliteTime, PGPS_EPHEMERIS
 
 int GetVisibleSatellite(KINEMATIC_INFO Position, GNSS_TIME time, OUTPUT_PARAM OutputParam, GnssSystem system, PGPS_EPHEMERIS Eph[], int Number, PGPS_EPHEMERIS EphVisible[])
 {
-	int i;
+	int i, j, First, EphNumber;
 	int SatNumber = 0;
-	KINEMATIC_INFO SatPosition;
+	ORBIT_BATCH Batch;
+	const GPS_EPHEMERIS *EphList[ORBIT_BATCH_SIZE];
+	KINEMATIC_INFO SatPosition[ORBIT_BATCH_SIZE];
+	bool Valid[ORBIT_BATCH_SIZE];
 	double Elevation, Azimuth;
 
-	for (i = 0; i < Number; i ++)
+	// positions of ephemerides in use calculated together, ORBIT_BATCH_SIZE satellites each batch
+	for (First = 0; First < Number; First += ORBIT_BATCH_SIZE)
 	{
-		if (Eph[i] == NULL || Eph[i]->valid == 0 || Eph[i]->health != 0)
-			continue;
-		if (system == GpsSystem)
+		EphNumber = 0;
+		for (i = First; i < Number && i < First + ORBIT_BATCH_SIZE; i ++)
 		{
-			if (OutputParam.GpsMaskOut & (1 << i))
+			if (Eph[i] == NULL || Eph[i]->valid == 0 || Eph[i]->health != 0)
 				continue;
-		}
-		else if (system == BdsSystem)
-		{
-			if (OutputParam.BdsMaskOut & (1LL << i))
+			if (system == GpsSystem)
+			{
+				if (OutputParam.GpsMaskOut & (1 << i))
+					continue;
+			}
+			else if (system == BdsSystem)
+			{
+				if (OutputParam.BdsMaskOut & (1LL << i))
+					continue;
+			}
+			else if (system == GalileoSystem)
+			{
+				if (OutputParam.GalileoMaskOut & (1LL << i))
+					continue;
+			}
+			else
 				continue;
+			EphList[EphNumber ++] = Eph[i];
 		}
-		else if (system == GalileoSystem)
+		SetOrbitBatch(&Batch, system, EphList, EphNumber);
+		OrbitBatchPosSpeed(&Batch, time.MilliSeconds / 1000., SatPosition, NULL, NULL, Valid);
+		for (j = 0; j < EphNumber; j ++)
 		{
-			if (OutputParam.GalileoMaskOut & (1LL << i))
+			if (!Valid[j])
+				continue;
+			SatElAz(&Position, &SatPosition[j], &Elevation, &Azimuth);
+			if (Elevation < OutputParam.ElevationMask)
 				continue;
+			EphVisible[SatNumber ++] = (PGPS_EPHEMERIS)EphList[j];
 		}
-		else
-			continue;
-		if (!GpsSatPosSpeedEph(system, time.MilliSeconds / 1000., Eph[i], &SatPosition, NULL))
-			continue;
-		SatElAz(&Position, &SatPosition, &Elevation, &Azimuth);
-		if (Elevation < OutputParam.ElevationMask)
-			continue;
-		EphVisible[SatNumber ++] = Eph[i];
 	}
 
 	return SatNumber;
@@ -379,6 +394,9 @@ GNSS_TIME GetTransmitTime(GNSS_TIME ReceiverTime, double TravelTime)
 CSatelliteParam::CSatelliteParam()
 {
 	TimeTag = -1;
+	AtmosInterval = (int)(ATMOS_UPDATE_INTERVAL * 1000 + 0.5);
+	AtmosOrder = 2;
+	AtmosNodeTime = -1;
 }
 
 CSatelliteParam::~CSatelliteParam()
@@ -390,7 +408,10 @@ void CSatelliteParam::Initialize(GnssSystem SatSystem, PGPS_EPHEMERIS Eph, CIono
 	system = SatSystem;
 	EphCur = EphPrev = Eph;
 	GloEphCur = GloEphPrev = (PGLONASS_EPHEMERIS)Eph;
+	InitOrbitCache(&OrbitCur);
+	InitOrbitCache(&OrbitPrev);
 	IonoDelayModel = IonoModel;
+	AtmosNodeTime = -1;
 	if (Eph)
 	{
 		if (system == GlonassSystem)
@@ -416,12 +437,16 @@ void CSatelliteParam::UpdateEphemeris(PGPS_EPHEMERIS Eph)
 {
 	if (system == GlonassSystem && GloEphCur != (PGLONASS_EPHEMERIS)Eph)
 	{
+		if (EphTransition == 0)	// orbit nodes of GloEphPrev continue from GloEphCur
+			OrbitPrev = OrbitCur;
 		GloEphCur = (PGLONASS_EPHEMERIS)Eph;
 		if (GloEphPrev != NULL && GloEphPrev != GloEphCur)
 			EphTransition = TRANSIT_PERIOD_MS;
 	}
 	else if (EphCur != Eph)
 	{
+		if (EphTransition == 0)
+			OrbitPrev = OrbitCur;
 		EphCur = Eph;
 		if (EphPrev != NULL && EphPrev != EphCur)
 			EphTransition = TRANSIT_PERIOD_MS;
@@ -450,9 +475,9 @@ void CSatelliteParam::CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION P
 
 	// first estimate the travel time, ignore tgd, ionosphere and troposphere delay
 	if (system == GlonassSystem)
-		GlonassSatPosSpeedEph(SatelliteTime, GloEphCur, &PosVel, NULL);
+		SatPosSpeedCache(system, SatelliteTime, GloEphCur, &PosVel, NULL, &OrbitCur);
 	else
-		GpsSatPosSpeedEph(system, SatelliteTime, EphCur, &PosVel, NULL);
+		SatPosSpeedCache(system, SatelliteTime, EphCur, &PosVel, NULL, &OrbitCur);
 
 	TravelTime = GeometryDistance(&PositionEcef, &PosVel, LosVector) / LIGHT_SPEED;
 	PosVel.x -= TravelTime * PosVel.vx; PosVel.y -= TravelTime * PosVel.vy; PosVel.z -= TravelTime * PosVel.vz;
@@ -463,24 +488,24 @@ void CSatelliteParam::CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION P
 	// travel_time = (d + dtrop)/c + tgd - dts - trel + diono
 	if (system == GlonassSystem)
 	{
-		GlonassSatPosSpeedEph(SatelliteTime, GloEphCur, &PosVel, Acc);
+		SatPosSpeedCache(system, SatelliteTime, GloEphCur, &PosVel, Acc, &OrbitCur);
 		ClockError = GlonassClockCorrection(GloEphCur, SatelliteTime);
 	}
 	else
 	{
-		GpsSatPosSpeedEph(system, SatelliteTime, EphCur, &PosVel, Acc);
+		SatPosSpeedCache(system, SatelliteTime, EphCur, &PosVel, Acc, &OrbitCur);
 		ClockError = GpsClockCorrection(EphCur, SatelliteTime);
 	}
 	if (EphTransition > 0)
 	{
 		if (system == GlonassSystem)
 		{
-			GlonassSatPosSpeedEph(SatelliteTime, GloEphPrev, &PosVelPrev, NULL);
+			SatPosSpeedCache(system, SatelliteTime, GloEphPrev, &PosVelPrev, NULL, &OrbitPrev);
 			ClockErrorPrev = GlonassClockCorrection(GloEphPrev, SatelliteTime);
 		}
 		else
 		{
-			GpsSatPosSpeedEph(system, SatelliteTime, EphPrev, &PosVelPrev, NULL);
+			SatPosSpeedCache(system, SatelliteTime, EphPrev, &PosVelPrev, NULL, &OrbitPrev);
 			ClockErrorPrev = GpsClockCorrection(EphPrev, SatelliteTime);
 		}
 		if (EphTransition <= TimeStep)
@@ -488,6 +513,7 @@ void CSatelliteParam::CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION P
 			EphTransition = 0;
 			EphPrev = EphCur;
 			GloEphPrev = GloEphCur;
+			OrbitPrev = OrbitCur;
 		}
 		else
 			EphTransition -= TimeStep;
@@ -503,8 +529,16 @@ void CSatelliteParam::CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION P
 
 	Distance = GeometryDistance(&PositionEcef, &PosVel, LosVector);
 	SatElAz(&PositionLla, LosVector, &Elevation, &Azimuth);
-	IonoDelayMeter = IonoDelayModel->GetDelay(SatelliteTime, PositionLla.lat, PositionLla.lon, Elevation, Azimuth);
-	Distance += (TropoDelayMeter = TropoDelay(PositionLla.lat, PositionLla.alt, Elevation));
+	// interpolate atmosphere delay only if called more than once within node interval
+	if (AtmosInterval > 0 && TimeStep > 0 && TimeStep < AtmosInterval)
+		UpdateAtmosDelay(PositionEcef, SatelliteTime);
+	else
+	{
+		IonoDelayMeter = IonoDelayModel->GetDelay(SatelliteTime, PositionLla.lat, PositionLla.lon, Elevation, Azimuth);
+		TropoDelayMeter = TropoDelay(PositionLla.lat, PositionLla.alt, Elevation);
+		AtmosNodeTime = -1;
+	}
+	Distance += TropoDelayMeter;
 	if (system == GlonassSystem)
 	{
 		TravelTime = Distance / LIGHT_SPEED - ClockError;
@@ -512,7 +546,7 @@ void CSatelliteParam::CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION P
 	else
 	{
 		TravelTime = Distance / LIGHT_SPEED - ClockError;
-		TravelTime -= WGS_F_GTR * EphCur->ecc * EphCur->sqrtA * sin(EphCur->Ek);		// relativity correction
+		TravelTime -= WGS_F_GTR * EphCur->ecc * EphCur->sqrtA * sin(OrbitCur.Ek);		// relativity correction
 		// assign GroupDelay[]
 		switch (system)
 		{
@@ -540,7 +574,8 @@ void CSatelliteParam::CalculateParam(KINEMATIC_INFO PositionEcef, LLA_POSITION P
 			break;
 		}
 	}
-	RelativeSpeed = SatRelativeSpeed(&PositionEcef, &PosVel) - LIGHT_SPEED * EphCur->af1;
+	// clock drift of GLONASS is gamma, EphCur is not a GPS_EPHEMERIS for GLONASS
+	RelativeSpeed = SatRelativeSpeed(&PositionEcef, &PosVel) - LIGHT_SPEED * ((system == GlonassSystem) ? GloEphCur->gamma : EphCur->af1);
 }
 
 void CSatelliteParam::UpdateCN0(int PowerListCount, SIGNAL_POWER PowerList[])
@@ -579,6 +614,88 @@ void CSatelliteParam::UpdateCN0(int PowerListCount, SIGNAL_POWER PowerList[])
 		CN0 = (int)(NewCN0 * 100 + 0.5);
 }
 
+// interval of orbit interpolation nodes in second, 0 to calculate each time from ephemeris
+void CSatelliteParam::SetOrbitInterval(double Interval)
+{
+	InitOrbitCache(&OrbitCur, Interval);
+	InitOrbitCache(&OrbitPrev, Interval);
+}
+
+// interval of atmosphere delay nodes in second and interpolation order (1 for linear, 2 for
+// quadratic), interval 0 to calculate each time
+void CSatelliteParam::SetAtmosInterval(double Interval, int Order)
+{
+	AtmosInterval = (int)(Interval * 1000 + 0.5);
+	AtmosOrder = (Order == 1) ? 1 : 2;
+	AtmosNodeTime = -1;
+}
+
+// set IonoDelayMeter and TropoDelayMeter by interpolation of nodes on multiples of AtmosInterval,
+// linear between node 1 and 2 or quadratic (Lagrange) on node 0, 1 and 2, nodes move forward as
+// time increases and are calculated again on time jump
+void CSatelliteParam::UpdateAtmosDelay(KINEMATIC_INFO &PositionEcef, double SatelliteTime)
+{
+	int i, Diff = TimeTag - AtmosNodeTime;
+	double s, Weight0, Weight2;
+
+	if (Diff < 0)	// across week boundary
+		Diff += 604800000;
+	if (AtmosNodeTime < 0 || Diff > 2 * AtmosInterval)
+	{
+		AtmosNodeTime = TimeTag - TimeTag % AtmosInterval;
+		Diff = TimeTag - AtmosNodeTime;
+		for (i = 0; i < 3; i ++)
+			CalcAtmosNode(i, PositionEcef, SatelliteTime, ((i - 1) * AtmosInterval - Diff) / 1000.0);
+	}
+	else if (Diff >= AtmosInterval)	// move nodes forward
+	{
+		for (i = 0; i < 2; i ++)
+		{
+			NodeIonoDelay[i] = NodeIonoDelay[i+1];
+			NodeTropoDelay[i] = NodeTropoDelay[i+1];
+		}
+		AtmosNodeTime += AtmosInterval;
+		if (AtmosNodeTime >= 604800000)
+			AtmosNodeTime -= 604800000;
+		Diff -= AtmosInterval;
+		CalcAtmosNode(2, PositionEcef, SatelliteTime, (AtmosInterval - Diff) / 1000.0);
+	}
+
+	s = (double)Diff / AtmosInterval;
+	if (AtmosOrder == 1)
+	{
+		IonoDelayMeter = NodeIonoDelay[1] + s * (NodeIonoDelay[2] - NodeIonoDelay[1]);
+		TropoDelayMeter = NodeTropoDelay[1] + s * (NodeTropoDelay[2] - NodeTropoDelay[1]);
+	}
+	else
+	{
+		Weight0 = s * (s - 1) / 2;
+		Weight2 = s * (s + 1) / 2;
+		IonoDelayMeter = NodeIonoDelay[1] + Weight0 * (NodeIonoDelay[0] - NodeIonoDelay[1]) + Weight2 * (NodeIonoDelay[2] - NodeIonoDelay[1]);
+		TropoDelayMeter = NodeTropoDelay[1] + Weight0 * (NodeTropoDelay[0] - NodeTropoDelay[1]) + Weight2 * (NodeTropoDelay[2] - NodeTropoDelay[1]);
+	}
+}
+
+// atmosphere delay at DeltaT seconds from current time, receiver moves with current velocity
+// and satellite with current velocity and acceleration (a few mm of satellite position error at
+// DeltaT of 2s), node calculated in advance keeps its value so that delay has no step at nodes
+void CSatelliteParam::CalcAtmosNode(int Node, KINEMATIC_INFO &PositionEcef, double SatelliteTime, double DeltaT)
+{
+	KINEMATIC_INFO Receiver = PositionEcef, Satellite = PosVel;
+	LLA_POSITION ReceiverLla;
+	double Los[3], NodeElevation, NodeAzimuth;
+
+	Receiver.x += Receiver.vx * DeltaT; Receiver.y += Receiver.vy * DeltaT; Receiver.z += Receiver.vz * DeltaT;
+	Satellite.x += (Satellite.vx + 0.5 * Acc[0] * DeltaT) * DeltaT;
+	Satellite.y += (Satellite.vy + 0.5 * Acc[1] * DeltaT) * DeltaT;
+	Satellite.z += (Satellite.vz + 0.5 * Acc[2] * DeltaT) * DeltaT;
+	ReceiverLla = EcefToLla(Receiver);
+	GeometryDistance(&Receiver, &Satellite, Los);
+	SatElAz(&ReceiverLla, Los, &NodeElevation, &NodeAzimuth);
+	NodeIonoDelay[Node] = IonoDelayModel->GetDelay(SatelliteTime + DeltaT, ReceiverLla.lat, ReceiverLla.lon, NodeElevation, NodeAzimuth);
+	NodeTropoDelay[Node] = TropoDelay(ReceiverLla.lat, ReceiverLla.alt, NodeElevation);
+}
+
 double CSatelliteParam::GetTravelTime(int SignalIndex)
 {
 	double TotalTravelTime = TravelTime + GroupDelay[SignalIndex];
@@ -598,6 +715,31 @@ double CSatelliteParam::GetDoppler(int SignalIndex)
 	return -RelativeSpeed / GetWaveLength(SignalIndex);
 }
 
+void CSatelliteParam::SetBlockNode(int Node)
+{
+	BlockTravelTime[Node] = TravelTime;
+	BlockIonoDelay[Node] = IonoDelayMeter;
+}
+
+// set TravelTime and IonoDelayMeter at Ms within a block of BlockMs milliseconds by quadratic
+// (Lagrange) interpolation of the values at 0, MidMs and BlockMs, difference to block start is
+// interpolated to keep precision of travel time, other parameters keep values at block end
+void CSatelliteParam::InterpolateBlock(int Ms, int MidMs, int BlockMs)
+{
+	double Weight1, Weight2;
+
+	if (Ms >= BlockMs || MidMs <= 0 || MidMs >= BlockMs)
+	{
+		TravelTime = BlockTravelTime[2];
+		IonoDelayMeter = BlockIonoDelay[2];
+		return;
+	}
+	Weight1 = (double)Ms * (Ms - BlockMs) / ((double)MidMs * (MidMs - BlockMs));
+	Weight2 = (double)Ms * (Ms - MidMs) / ((double)BlockMs * (BlockMs - MidMs));
+	TravelTime = BlockTravelTime[0] + Weight1 * (BlockTravelTime[1] - BlockTravelTime[0]) + Weight2 * (BlockTravelTime[2] - BlockTravelTime[0]);
+	IonoDelayMeter = BlockIonoDelay[0] + Weight1 * (BlockIonoDelay[1] - BlockIonoDelay[0]) + Weight2 * (BlockIonoDelay[2] - BlockIonoDelay[0]);
+}
+
 double CSatelliteParam::GetWaveLength(int SignalIndex)
 {
 	double Freq;